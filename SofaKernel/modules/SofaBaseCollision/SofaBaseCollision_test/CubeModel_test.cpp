@@ -0,0 +1,171 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseCollision/CubeModel.h>
+using sofa::component::collision::Cube;
+using sofa::component::collision::CubeCollisionModel;
+
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <random>
+
+namespace cubemodel_test
+{
+
+using sofa::type::Vector3;
+using sofa::Index;
+
+struct CubeModel_test : public BaseTest
+{
+    CubeCollisionModel::SPtr model;
+    sofa::type::vector<std::pair<Vector3, Vector3> > boxes;
+
+    void createBoxes(std::size_t nbBoxes)
+    {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<SReal> position(-10, 10), size(0.01, 0.5);
+        boxes.resize(nbBoxes);
+        for (auto& box : boxes)
+        {
+            const Vector3 center(position(gen), position(gen), position(gen));
+            const Vector3 half(size(gen), size(gen), size(gen));
+            box = std::make_pair(center - half, center + half);
+        }
+        model = sofa::core::objectmodel::New<CubeCollisionModel>();
+        model->resize(Index(nbBoxes));
+        setBoxes();
+    }
+
+    void setBoxes()
+    {
+        for (Index i = 0; i < boxes.size(); ++i)
+            model->setParentOf(i, boxes[i].first, boxes[i].second);
+    }
+
+    static bool contains(const Cube& cell, const Vector3& min, const Vector3& max)
+    {
+        for (int j = 0; j < 3; ++j)
+            if (min[j] < cell.minVect()[j] || max[j] > cell.maxVect()[j]) return false;
+        return true;
+    }
+
+    /// Check that each cell contains its subcells, and that each box is in exactly one leaf
+    void checkTree()
+    {
+        std::vector<int> found(boxes.size(), 0);
+        std::vector<Cube> cells { Cube(static_cast<CubeCollisionModel*>(model->getFirst()), 0) };
+        ASSERT_EQ(model->getFirst()->getSize(), 1u);
+        while (!cells.empty())
+        {
+            const Cube cell = cells.back();
+            cells.pop_back();
+            for (Cube c = cell.subcells().first; c != cell.subcells().second; ++c)
+            {
+                EXPECT_TRUE(contains(cell, c.minVect(), c.maxVect()));
+                if (c.getCollisionModel() == model.get())
+                    ++found[model->getLeafIndex(c.getIndex())];
+                else
+                    cells.push_back(c);
+            }
+        }
+        for (std::size_t i = 0; i < boxes.size(); ++i)
+            EXPECT_EQ(found[i], 1) << "box " << i;
+    }
+};
+
+TEST_F(CubeModel_test, medianTree)
+{
+    createBoxes(1000);
+    model->computeBoundingTree(6);
+    checkTree();
+}
+
+TEST_F(CubeModel_test, sahTree)
+{
+    createBoxes(1000);
+    model->setBoundingTreeParameters(CubeCollisionModel::BuildMethod::SAH, 0);
+    model->computeBoundingTree(6);
+    checkTree();
+}
+
+TEST_F(CubeModel_test, rebuildWhenDegraded)
+{
+    createBoxes(1000);
+    model->setBoundingTreeParameters(CubeCollisionModel::BuildMethod::SAH, 1.5);
+    model->computeBoundingTree(6);
+    const SReal builtCost = model->getTreeCost();
+    EXPECT_GT(builtCost, 0);
+
+    // small motion: the tree is only updated
+    for (auto& box : boxes)
+    {
+        box.first += Vector3(0.01, 0, 0);
+        box.second += Vector3(0.01, 0, 0);
+    }
+    setBoxes();
+    model->computeBoundingTree(6);
+    checkTree();
+    EXPECT_LT(model->getTreeCost(), 1.5 * builtCost);
+
+    // shuffle the boxes: the updated tree degrades, and is rebuilt
+    std::mt19937 gen(0);
+    std::shuffle(boxes.begin(), boxes.end(), gen);
+    setBoxes();
+    model->computeBoundingTree(6);
+    checkTree();
+    EXPECT_LT(model->getTreeCost(), 1.5 * builtCost);
+}
+
+TEST_F(CubeModel_test, rebuildFromEmptyRootBox)
+{
+    // all the boxes at the same point: the root box has no area, and the cost of the built tree is 0
+    createBoxes(100);
+    for (auto& box : boxes)
+        box = std::make_pair(Vector3(1, 2, 3), Vector3(1, 2, 3));
+    setBoxes();
+    model->setBoundingTreeParameters(CubeCollisionModel::BuildMethod::SAH, 1.5);
+    model->computeBoundingTree(6);
+    checkTree();
+    EXPECT_EQ(model->getTreeCost(), 0);
+    model->computeBoundingTree(6);
+    checkTree();
+    EXPECT_EQ(model->getTreeCost(), 0);
+
+    // the boxes move apart: the tree is compared with the minimum cost, and rebuilt
+    for (Index i = 0; i < boxes.size(); ++i)
+    {
+        boxes[i].first += Vector3(0.1 * ((i * 37) % 100), 0, 0);
+        boxes[i].second += Vector3(0.1 * ((i * 37) % 100), 0.01, 0.01);
+    }
+    setBoxes();
+    model->computeBoundingTree(6);
+    checkTree();
+    const SReal rebuiltCost = model->getTreeCost();
+    EXPECT_GT(rebuiltCost, 0);
+
+    // same boxes: the tree is kept
+    model->computeBoundingTree(6);
+    checkTree();
+    EXPECT_EQ(model->getTreeCost(), rebuiltCost);
+}
+
+}
@@ -0,0 +1,160 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseCollision/DefaultContactManager.h>
+using sofa::component::collision::DefaultContactManager;
+
+#include <SofaBaseCollision/SphereModel.h>
+using sofa::component::collision::SphereCollisionModel;
+
+#include <sofa/core/collision/Contact.h>
+#include <sofa/core/collision/DetectionOutput.h>
+using sofa::core::collision::Contact;
+using sofa::core::collision::DetectionOutput;
+using sofa::core::collision::DetectionOutputVector;
+using sofa::core::collision::TDetectionOutputVector;
+
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+namespace defaultcontactmanager_test
+{
+
+using sofa::core::CollisionModel;
+using sofa::core::objectmodel::New;
+using SphereModel = SphereCollisionModel<sofa::defaulttype::Vec3Types>;
+
+/// A contact without response, counting how many times it is created and destroyed
+class CacheTestContact : public Contact
+{
+public:
+    SOFA_CLASS(CacheTestContact, Contact);
+
+    static inline int nbCreated { 0 };
+    static inline int nbCleanups { 0 };
+
+    static Contact::SPtr create(CacheTestContact*, Contact::Factory::Argument arg)
+    {
+        ++nbCreated;
+        return New<CacheTestContact>(arg.first.first, arg.first.second);
+    }
+
+    std::pair<CollisionModel*, CollisionModel*> getCollisionModels() override { return m_models; }
+    void setDetectionOutputs(DetectionOutputVector* outputs) override { m_outputs = outputs; }
+    void createResponse(sofa::core::objectmodel::BaseContext*) override {}
+    void removeResponse() override {}
+    void cleanup() override { ++nbCleanups; }
+
+    DetectionOutputVector* getDetectionOutputs() const { return m_outputs; }
+
+protected:
+    CacheTestContact(CollisionModel* model1, CollisionModel* model2) : m_models(model1, model2) {}
+
+    std::pair<CollisionModel*, CollisionModel*> m_models;
+    DetectionOutputVector* m_outputs { nullptr };
+};
+
+sofa::helper::Creator<Contact::Factory, CacheTestContact> CacheTestContactClass("CacheTestContact", true);
+
+struct DefaultContactManager_test : public BaseTest
+{
+    DefaultContactManager::SPtr manager;
+    SphereModel::SPtr model1;
+    SphereModel::SPtr model2;
+    TDetectionOutputVector<SphereModel, SphereModel> outputs;
+    DefaultContactManager::DetectionOutputMap collidingMap;
+    DefaultContactManager::DetectionOutputMap emptyMap;
+
+    void SetUp() override
+    {
+        CacheTestContact::nbCreated = 0;
+        CacheTestContact::nbCleanups = 0;
+
+        manager = New<DefaultContactManager>();
+        manager->setDefaultResponseType("CacheTestContact");
+        model1 = New<SphereModel>();
+        model2 = New<SphereModel>();
+
+        outputs.resize(1);
+        collidingMap[std::make_pair(model1.get(), model2.get())] = &outputs;
+    }
+
+    void TearDown() override
+    {
+        manager->cleanup();
+    }
+
+    /// Run a sequence of steps alternating collision and no collision, and return the number of created contacts
+    int runSequence(const std::vector<bool>& colliding)
+    {
+        for (const bool c : colliding)
+        {
+            manager->createContacts(c ? collidingMap : emptyMap);
+            EXPECT_EQ(manager->getContacts().size(), c ? 1u : 0u);
+            if (c)
+            {
+                const auto* contact = dynamic_cast<CacheTestContact*>(manager->getContacts().front().get());
+                EXPECT_NE(contact, nullptr);
+                if (contact)
+                {
+                    EXPECT_EQ(contact->getDetectionOutputs(), &outputs);
+                }
+            }
+        }
+        return CacheTestContact::nbCreated;
+    }
+};
+
+TEST_F(DefaultContactManager_test, noCache)
+{
+    EXPECT_EQ(runSequence({true, false, true, false, true}), 3);
+    EXPECT_EQ(CacheTestContact::nbCleanups, 2);
+}
+
+TEST_F(DefaultContactManager_test, reuseCachedContact)
+{
+    manager->d_contactCacheSteps.setValue(2);
+    EXPECT_EQ(runSequence({true, false, true, false, false, true}), 1);
+    EXPECT_EQ(CacheTestContact::nbCleanups, 0);
+
+    manager->cleanup();
+    EXPECT_EQ(CacheTestContact::nbCleanups, 1);
+}
+
+TEST_F(DefaultContactManager_test, expiredCachedContact)
+{
+    manager->d_contactCacheSteps.setValue(2);
+    EXPECT_EQ(runSequence({true, false, false, false, true}), 2);
+    EXPECT_EQ(CacheTestContact::nbCleanups, 1);
+}
+
+TEST_F(DefaultContactManager_test, responseChanged)
+{
+    manager->d_contactCacheSteps.setValue(2);
+    EXPECT_EQ(runSequence({true, false}), 1);
+
+    // the cached contact was created with another response: it cannot be reused
+    manager->responseParams.setValue("name=cached");
+    EXPECT_EQ(runSequence({true}), 2);
+    EXPECT_EQ(CacheTestContact::nbCleanups, 1);
+}
+
+}
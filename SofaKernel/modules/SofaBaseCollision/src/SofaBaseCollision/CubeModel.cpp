@@ -25,6 +25,7 @@
 #include <sofa/helper/visual/DrawTool.h>
 #include <sofa/core/ObjectFactory.h>
 #include <algorithm>
+#include <limits>
 
 namespace sofa::component::collision
 {
@@ -235,6 +236,162 @@ bool CubeCollisionModel::isLeaf(Index index ) const
     return elems[index].children.first.valid();
 }
 
+namespace
+{
+SReal surfaceArea(const Vector3& min, const Vector3& max)
+{
+    const Vector3 l = max - min;
+    return 2 * (l[0]*l[1] + l[1]*l[2] + l[2]*l[0]);
+}
+}
+
+Index CubeCollisionModel::splitMedian(Index first, Index last, const Vector3& cellMin, const Vector3& cellMax)
+{
+    // Find the biggest dimension
+    int splitAxis;
+    Vector3 l = cellMax-cellMin;
+    if(l[0]>l[1])
+        if (l[0]>l[2])
+            splitAxis = 0;
+        else
+            splitAxis = 2;
+    else if (l[1]>l[2])
+        splitAxis = 1;
+    else
+        splitAxis = 2;
+
+    // Separate cells on each side of the median cell
+    CubeSortPredicate sortpred(splitAxis);
+    std::sort(elems.begin() + first, elems.begin() + last, sortpred);
+    return first+(last-first+1)/2;
+}
+
+Index CubeCollisionModel::splitSAH(Index first, Index last, const Vector3& cellMin, const Vector3& cellMax)
+{
+    // Binned evaluation of the cost area(left)*count(left) + area(right)*count(right),
+    // using the centers of the cubes (times 2, as in CubeSortPredicate)
+    constexpr int NbBins = 16;
+
+    Vector3 cmin = elems[first].minBBox + elems[first].maxBBox;
+    Vector3 cmax = cmin;
+    for (Index i = first+1; i < last; ++i)
+    {
+        const Vector3 c = elems[i].minBBox + elems[i].maxBBox;
+        for (int j=0; j<3; j++)
+        {
+            if (c[j] < cmin[j]) cmin[j] = c[j];
+            if (c[j] > cmax[j]) cmax[j] = c[j];
+        }
+    }
+
+    const auto binOf = [&cmin, &cmax](const CubeData& cube, int axis)
+    {
+        const SReal c = cube.minBBox[axis] + cube.maxBBox[axis];
+        const int b = int(NbBins * (c - cmin[axis]) / (cmax[axis] - cmin[axis]));
+        return std::min(std::max(b, 0), NbBins-1);
+    };
+
+    int bestAxis = -1;
+    int bestBin = 0;
+    SReal bestCost = std::numeric_limits<SReal>::max();
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (!(cmax[axis] > cmin[axis])) continue;
+
+        Index count[NbBins] = {};
+        Vector3 binMin[NbBins], binMax[NbBins];
+        for (Index i = first; i < last; ++i)
+        {
+            const CubeData& cube = elems[i];
+            const int b = binOf(cube, axis);
+            if (count[b]++ == 0)
+            {
+                binMin[b] = cube.minBBox;
+                binMax[b] = cube.maxBBox;
+            }
+            else for (int j=0; j<3; j++)
+            {
+                if (cube.minBBox[j] < binMin[b][j]) binMin[b][j] = cube.minBBox[j];
+                if (cube.maxBBox[j] > binMax[b][j]) binMax[b][j] = cube.maxBBox[j];
+            }
+        }
+
+        // cost of the right side of each split, the split b separating the bins [0,b] and [b+1,NbBins)
+        SReal rightCost[NbBins];
+        Index rightCount = 0;
+        Vector3 rmin, rmax;
+        for (int b = NbBins-1; b > 0; --b)
+        {
+            if (count[b])
+            {
+                if (rightCount == 0) { rmin = binMin[b]; rmax = binMax[b]; }
+                else for (int j=0; j<3; j++)
+                {
+                    if (binMin[b][j] < rmin[j]) rmin[j] = binMin[b][j];
+                    if (binMax[b][j] > rmax[j]) rmax[j] = binMax[b][j];
+                }
+                rightCount += count[b];
+            }
+            rightCost[b-1] = rightCount ? surfaceArea(rmin, rmax) * rightCount : 0;
+        }
+
+        Index leftCount = 0;
+        Vector3 lmin, lmax;
+        for (int b = 0; b < NbBins-1; ++b)
+        {
+            if (count[b])
+            {
+                if (leftCount == 0) { lmin = binMin[b]; lmax = binMax[b]; }
+                else for (int j=0; j<3; j++)
+                {
+                    if (binMin[b][j] < lmin[j]) lmin[j] = binMin[b][j];
+                    if (binMax[b][j] > lmax[j]) lmax[j] = binMax[b][j];
+                }
+                leftCount += count[b];
+            }
+            if (leftCount == 0 || leftCount == last - first) continue;
+            const SReal cost = surfaceArea(lmin, lmax) * leftCount + rightCost[b];
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+            }
+        }
+    }
+
+    // all the centers are at the same place
+    if (bestAxis < 0)
+        return splitMedian(first, last, cellMin, cellMax);
+
+    const auto middle = std::partition(elems.begin() + first, elems.begin() + last,
+                                       [&](const CubeData& cube) { return binOf(cube, bestAxis) <= bestBin; });
+    return Index(middle - elems.begin());
+}
+
+SReal CubeCollisionModel::computeTreeCost(const std::list<CubeCollisionModel*>& levels) const
+{
+    const CubeCollisionModel* root = levels.front();
+    if (root->empty()) return 0;
+    const SReal rootArea = surfaceArea(root->elems[0].minBBox, root->elems[0].maxBBox);
+    if (rootArea <= 0) return 0;
+
+    SReal cost = 0;
+    for (const CubeCollisionModel* level : levels)
+    {
+        for (Size i = 0; i < level->size; ++i)
+        {
+            const CubeData& cell = level->elems[i];
+            const SReal area = surfaceArea(cell.minBBox, cell.maxBBox);
+            if (cell.subcells.first.getCollisionModel() == this)
+                cost += area * (cell.subcells.second.getIndex() - cell.subcells.first.getIndex());
+            else
+                cost += area;
+        }
+    }
+    return cost / rootArea;
+}
+
 void CubeCollisionModel::computeBoundingTree(int maxDepth)
 {
 
@@ -245,7 +402,33 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
         levels.push_front(levels.front()->createPrevious<CubeCollisionModel>());
     CubeCollisionModel* root = levels.front();
 
-    if (root->empty() || root->getPrevious() != nullptr)
+    bool rebuild = root->empty() || root->getPrevious() != nullptr;
+    if (!rebuild)
+    {
+        // Simply update the existing tree, starting from the bottom
+        int lvl = 0;
+        for (std::list<CubeCollisionModel*>::reverse_iterator it = levels.rbegin(); it != levels.rend(); ++it)
+        {
+            dmsg_info() << "CubeCollisionModel: update level " << lvl;
+            (*it)->updateCubes();
+            ++lvl;
+        }
+
+        // The update keeps the cells of the tree, which may fit badly the elements after large deformations
+        if (m_rebuildRatio > 0)
+        {
+            // The cost of a tree is at least 1 (the root cell), except when the root box has no area and the
+            // cost is 0: a tree built in that case is only compared with this minimum, and not rebuilt at each step
+            m_treeCost = computeTreeCost(levels);
+            if (m_treeCost > m_rebuildRatio * std::max<SReal>(m_builtTreeCost, 1))
+            {
+                dmsg_info() << "Tree cost increased from " << m_builtTreeCost << " to " << m_treeCost << ": rebuilding it";
+                rebuild = true;
+            }
+        }
+    }
+
+    if (rebuild)
     {
         // Tree must be reconstructed
         dmsg_info() << "Building Tree with depth " << maxDepth << " from " << size << " elements.";
@@ -268,7 +451,7 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
         // Then build root cell
         dmsg_info() << "CubeCollisionModel: add root cube";
         root->addCube(Cube(this,0),Cube(this,size));
-        // Construct tree by splitting cells along their biggest dimension
+        // Construct tree by splitting cells along their biggest dimension, or where the surface area heuristic is minimal
         std::list<CubeCollisionModel*>::iterator it = levels.begin();
         CubeCollisionModel* level = *it;
         ++it;
@@ -286,29 +469,15 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
                 if (ncells > 4)
                 {
                     // Only split cells with more than 4 childs
-                    // Find the biggest dimension
-                    int splitAxis;
-                    Vector3 l = cell.maxVect()-cell.minVect();
-                    Index middle = subcells.first.getIndex()+(ncells+1)/2;
-                    if(l[0]>l[1])
-                        if (l[0]>l[2])
-                            splitAxis = 0;
-                        else
-                            splitAxis = 2;
-                    else if (l[1]>l[2])
-                        splitAxis = 1;
-                    else
-                        splitAxis = 2;
-
-                    // Separate cells on each side of the median cell
-                    CubeSortPredicate sortpred(splitAxis);
-                    std::sort(elems.begin() + subcells.first.getIndex(), elems.begin() + subcells.second.getIndex(), sortpred);
+                    const Index middle = (m_buildMethod == BuildMethod::SAH)
+                            ? splitSAH(subcells.first.getIndex(), subcells.second.getIndex(), cell.minVect(), cell.maxVect())
+                            : splitMedian(subcells.first.getIndex(), subcells.second.getIndex(), cell.minVect(), cell.maxVect());
 
                     // Create the two new subcells
                     Cube cmiddle(this, middle);
                     Index c1 = clevel->addCube(subcells.first, cmiddle);
                     Index c2 = clevel->addCube(cmiddle, subcells.second);
-                    dmsg_info() << "L" << lvl << " cell " << cell.getIndex() << " split along " << (splitAxis == 0 ? 'X' : splitAxis == 1 ? 'Y' : 'Z') << " in cell " << c1 << " size " << middle - subcells.first.getIndex() << " and cell " << c2 << " size " << subcells.second.getIndex() - middle << ".";
+                    dmsg_info() << "L" << lvl << " cell " << cell.getIndex() << " split in cell " << c1 << " size " << middle - subcells.first.getIndex() << " and cell " << c2 << " size " << subcells.second.getIndex() - middle << ".";
                     //level->elems[cell.getIndex()].subcells = std::make_pair(Cube(clevel,c1),Cube(clevel,c2+1));
                     level->elems[cell.getIndex()].subcells.first = Cube(clevel,c1);
                     level->elems[cell.getIndex()].subcells.second = Cube(clevel,c2+1);
@@ -324,16 +493,10 @@ void CubeCollisionModel::computeBoundingTree(int maxDepth)
             for (Size i=0; i<size; i++)
                 parentOf[elems[i].children.first.getIndex()] = i;
         }
-    }
-    else
-    {
-        // Simply update the existing tree, starting from the bottom
-        int lvl = 0;
-        for (std::list<CubeCollisionModel*>::reverse_iterator it = levels.rbegin(); it != levels.rend(); ++it)
+
+        if (m_rebuildRatio > 0)
         {
-            dmsg_info() << "CubeCollisionModel: update level " << lvl;
-            (*it)->updateCubes();
-            ++lvl;
+            m_builtTreeCost = m_treeCost = computeTreeCost(levels);
         }
     }
     dmsg_info() << "<CubeCollisionModel::computeBoundingTree(" << maxDepth << ")";
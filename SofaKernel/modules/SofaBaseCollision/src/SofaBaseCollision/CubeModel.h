@@ -24,6 +24,7 @@
 
 #include <sofa/core/CollisionModel.h>
 #include <sofa/defaulttype/VecTypes.h>
+#include <list>
 
 namespace sofa::component::collision
 {
@@ -77,10 +78,22 @@ public:
         }
     };
 
+    /// Method used to split the cells when the tree is built
+    enum class BuildMethod
+    {
+        Median, ///< split at the median of the biggest dimension of the cell
+        SAH     ///< split where the surface area heuristic is minimal
+    };
+
 protected:
     sofa::type::vector<CubeData> elems;
     sofa::type::vector<Index> parentOf; ///< Given the index of a child leaf element, store the index of the parent cube
 
+    BuildMethod m_buildMethod { BuildMethod::Median };
+    SReal m_rebuildRatio { 0 };  ///< rebuild the tree when its cost exceeds this ratio of its cost when built (0 to never rebuild)
+    SReal m_builtTreeCost { 0 }; ///< cost of the tree when it was built
+    SReal m_treeCost { 0 };      ///< cost of the tree after the last update
+
 public:
     typedef core::CollisionElementIterator ChildIterator;
     typedef sofa::defaulttype::Vec3Types DataTypes;
@@ -98,6 +111,18 @@ public:
 
     Size getNumberCells() const { return Size(elems.size());}
 
+    /// Set how the tree is built, and when it is rebuilt instead of only updating its bounding boxes.
+    /// A rebuild ratio of 2 rebuilds the tree when its cost (see getTreeCost) doubles compared to when it was built, 0 never rebuilds it.
+    void setBoundingTreeParameters(BuildMethod method, SReal rebuildRatio)
+    {
+        m_buildMethod = method;
+        m_rebuildRatio = rebuildRatio;
+    }
+
+    /// Cost of the tree according to the surface area heuristic (area of each cell relative to the root, weighted by its
+    /// number of leaf elements for the cells of the last level). Only computed if a rebuild ratio is set.
+    SReal getTreeCost() const { return m_treeCost; }
+
     void getBoundingTree ( sofa::type::vector< std::pair< sofa::type::Vector3, sofa::type::Vector3> > &bounding )
     {
         bounding.resize(elems.size());
@@ -143,6 +168,14 @@ public:
     Index addCube(Cube subcellsBegin, Cube subcellsEnd);
     void updateCube(Index index);
     void updateCubes();
+
+protected:
+    /// Sort the leaf cubes [first,last) along the biggest dimension of the cell, and return the index of the median
+    Index splitMedian(Index first, Index last, const sofa::type::Vector3& cellMin, const sofa::type::Vector3& cellMax);
+    /// Partition the leaf cubes [first,last) where the surface area heuristic is minimal, and return the index of the partition
+    Index splitSAH(Index first, Index last, const sofa::type::Vector3& cellMin, const sofa::type::Vector3& cellMax);
+    /// Compute the surface area heuristic cost of the tree made of the given levels
+    SReal computeTreeCost(const std::list<CubeCollisionModel*>& levels) const;
 };
 
 inline Cube::Cube(CubeCollisionModel* model, Index index)
@@ -38,6 +38,9 @@ int DefaultContactManagerClass = core::RegisterObject("Default class to create r
 DefaultContactManager::DefaultContactManager()
     : response(initData(&response, "response", "contact response class"))
     , responseParams(initData(&responseParams, "responseParams", "contact response parameters (syntax: name1=value1&name2=value2&...)"))
+    , d_contactCacheSteps(initData(&d_contactCacheSteps, 0u, "contactCacheSteps", "Number of time steps a contact is kept in cache after its pair of collision models stopped colliding. "
+                                                                               "If the pair collides again meanwhile, the contact and its response (mappings, force field, ...) are reused instead of being recreated. "
+                                                                               "0 disables the cache."))
 {
 }
 
@@ -81,6 +84,7 @@ void DefaultContactManager::cleanup()
     }
     contacts.clear();
     contactMap.clear();
+    clearContactCache();
 }
 
 void DefaultContactManager::reset()
@@ -110,11 +114,14 @@ void DefaultContactManager::changeInstance(Instance inst)
     core::collision::ContactManager::changeInstance(inst);
     storedContactMap[instance].swap(contactMap);
     contactMap.swap(storedContactMap[inst]);
+    m_storedContactCache[instance].swap(m_contactCache);
+    m_contactCache.swap(m_storedContactCache[inst]);
 }
 
 void DefaultContactManager::createContacts(const DetectionOutputMap& outputsMap)
 {
     Size nbContacts = 0;
+    ++m_timeStep;
 
     // First iterate on the collision detection outputs and look for existing or new contacts
     createNewContacts(outputsMap, nbContacts);
@@ -123,6 +130,9 @@ void DefaultContactManager::createContacts(const DetectionOutputMap& outputsMap)
     // and remove inactive contacts
     removeInactiveContacts(outputsMap, nbContacts);
 
+    // destroy the contacts which stayed in cache for too long
+    removeExpiredCachedContacts();
+
     // now update contact vector from the contact map
     contacts.clear();
     contacts.reserve(nbContacts);
@@ -158,6 +168,13 @@ void DefaultContactManager::createNewContacts(const core::collision::ContactMana
             {
                 contactMap.erase(contactIt);
             }
+            else if (auto cachedContact = reuseCachedContact(outputsIt->first, responseUsed))
+            {
+                // contact created during a previous time step: its response is reused as is
+                contactIt->second = cachedContact;
+                cachedContact->setDetectionOutputs(outputsIt->second);
+                ++nbContact;
+            }
             else
             {
                 auto contact = core::collision::Contact::Create(responseUsed, model1, model2, intersectionMethod,notMuted());
@@ -215,8 +232,15 @@ DefaultContactManager::removeInactiveContacts(const core::collision::ContactMana
             }
             else
             {
-                contact->removeResponse();
-                contact->cleanup();
+                if (d_contactCacheSteps.getValue() > 0)
+                {
+                    cacheContact(contactIt->first, contact);
+                }
+                else
+                {
+                    contact->removeResponse();
+                    contact->cleanup();
+                }
                 contact.reset();
                 contactIt = contactMap.erase(contactIt);
             }
@@ -228,6 +252,66 @@ DefaultContactManager::removeInactiveContacts(const core::collision::ContactMana
     }
 }
 
+core::collision::Contact::SPtr
+DefaultContactManager::reuseCachedContact(const std::pair<core::CollisionModel*, core::CollisionModel*>& pair,
+                                          const std::string& response)
+{
+    const auto cacheIt = m_contactCache.find(pair);
+    if (cacheIt == m_contactCache.end())
+    {
+        return nullptr;
+    }
+
+    core::collision::Contact::SPtr contact = cacheIt->second.contact;
+    if (cacheIt->second.response != response)
+    {
+        // the response type changed since the contact has been created: it cannot be reused
+        contact->cleanup();
+        contact.reset();
+    }
+    m_contactCache.erase(cacheIt);
+    return contact;
+}
+
+void DefaultContactManager::cacheContact(const std::pair<core::CollisionModel*, core::CollisionModel*>& pair,
+                                         core::collision::Contact::SPtr contact)
+{
+    // The response is detached from the scene graph, but the contact keeps its internal
+    // objects (mappers, interaction force field...) until it is reused or destroyed.
+    contact->removeResponse();
+
+    CachedContact& cached = m_contactCache[pair];
+    cached.contact = contact;
+    cached.response = getContactResponse(pair.first, pair.second);
+    cached.timeStep = m_timeStep;
+}
+
+void DefaultContactManager::removeExpiredCachedContacts()
+{
+    const unsigned int nbSteps = d_contactCacheSteps.getValue();
+    for (auto cacheIt = m_contactCache.begin(); cacheIt != m_contactCache.end();)
+    {
+        if (m_timeStep - cacheIt->second.timeStep >= nbSteps)
+        {
+            cacheIt->second.contact->cleanup();
+            cacheIt = m_contactCache.erase(cacheIt);
+        }
+        else
+        {
+            ++cacheIt;
+        }
+    }
+}
+
+void DefaultContactManager::clearContactCache()
+{
+    for (auto& cached : m_contactCache)
+    {
+        cached.second.contact->cleanup();
+    }
+    m_contactCache.clear();
+}
+
 void
 DefaultContactManager::contactCreationError(std::stringstream &errorStream, const core::CollisionModel *model1,
                                             const core::CollisionModel *model2, std::string &responseUsed)
@@ -364,6 +448,20 @@ void DefaultContactManager::removeContacts(const ContactVector &c)
             }
         }
 
+        // Cached contacts
+        for (auto cacheIt = m_contactCache.begin(); cacheIt != m_contactCache.end();)
+        {
+            if (cacheIt->second.contact == *remove_it)
+            {
+                cacheIt->second.contact->cleanup();
+                cacheIt = m_contactCache.erase(cacheIt);
+            }
+            else
+            {
+                ++cacheIt;
+            }
+        }
+
         ++remove_it;
     }
 }
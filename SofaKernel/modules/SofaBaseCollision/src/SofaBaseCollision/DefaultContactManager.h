@@ -38,6 +38,7 @@ public :
 
     Data<sofa::helper::OptionsGroup> response; ///< contact response class
     Data<std::string> responseParams; ///< contact response parameters (syntax: name1=value1    Data<std::string> responseParams;name2=value2    Data<std::string> responseParams;...)
+    Data<unsigned int> d_contactCacheSteps; ///< number of time steps a contact is kept in cache after its pair of collision models stopped colliding
 
     /// outputsVec fixes the reproducibility problems by storing contacts in the collision detection saved order
     /// if not given, it is still working but with eventual reproducibility problems
@@ -90,9 +91,29 @@ protected:
     static void setContactTags(core::CollisionModel* model1, core::CollisionModel* model2,
                         core::collision::Contact::SPtr contact);
 
+    /// A contact whose pair of collision models is no longer colliding, waiting to be reused
+    struct CachedContact
+    {
+        core::collision::Contact::SPtr contact;
+        std::string response; ///< response used to create the contact
+        unsigned int timeStep { 0 }; ///< time step at which the contact entered the cache
+    };
+
+    typedef sofa::helper::map_ptr_stable_compare<
+                /* key */  std::pair<core::CollisionModel*, core::CollisionModel*>,
+                /* value */CachedContact
+            > ContactCache;
+
     ContactMap contactMap;
     std::map<Instance,ContactMap> storedContactMap;
 
+    /// Inactive contacts kept to be reused if their pair of collision models collides again
+    ContactCache m_contactCache;
+    std::map<Instance,ContactCache> m_storedContactCache;
+
+    /// Number of calls to createContacts, used to age the cached contacts
+    unsigned int m_timeStep { 0 };
+
     void changeInstance(Instance inst) override ;
 
     static sofa::helper::OptionsGroup initializeResponseOptions(sofa::core::objectmodel::BaseContext *pipeline);
@@ -109,6 +130,21 @@ protected:
 
     void removeInactiveContacts(const DetectionOutputMap &outputsMap, Size& nbContact);
 
+    /// Get a contact from the cache if one has been created for this pair with the same response.
+    /// The contact is removed from the cache. Return nullptr if no contact can be reused.
+    core::collision::Contact::SPtr reuseCachedContact(const std::pair<core::CollisionModel*, core::CollisionModel*>& pair,
+                                                      const std::string& response);
+
+    /// Detach a contact from the scene graph and store it in the cache
+    void cacheContact(const std::pair<core::CollisionModel*, core::CollisionModel*>& pair,
+                      core::collision::Contact::SPtr contact);
+
+    /// Destroy the cached contacts older than d_contactCacheSteps
+    void removeExpiredCachedContacts();
+
+    /// Destroy all the cached contacts
+    void clearContactCache();
+
     /// compute and set the number of contacts attached to each collision model
     /// The number of contacts corresponds to the number of collision models
     /// currently in contact with a collision model.
@@ -0,0 +1,135 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
+#include <SofaBaseLinearSolver/SingleMatrixAccessor.h>
+#include <sofa/simulation/MatrixWriteBuffer.h>
+#include <sofa/simulation/ParallelFor.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/type/Mat.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+namespace sofa
+{
+
+using Matrix = component::linearsolver::CompressedRowSparseMatrix< type::Mat<3,3,SReal> >;
+
+/// Stiffness of the elements of a component, written in the matrix as a FEM force field would:
+/// each element computes a 12x12 matrix B^T.D.B, and adds its 3x3 blocks to the matrix
+void addComponentStiffness(std::size_t component, std::size_t nbElements, const core::behavior::MultiMatrixAccessor* accessor)
+{
+    const auto r = accessor->getMatrix(nullptr);
+    for (std::size_t e = 0; e < nbElements; ++e)
+    {
+        const std::size_t element = component * nbElements + e;
+        type::Mat<6,12,SReal> B;
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < 12; ++j)
+                B[i][j] = std::sin(SReal(element + 7 * i + j));
+        type::Mat<6,6,SReal> D;
+        for (int i = 0; i < 6; ++i)
+            for (int j = 0; j < 6; ++j)
+                D[i][j] = (i == j) ? SReal(2) : SReal(0.1) / (1 + i + j);
+        const type::Mat<12,12,SReal> K = B.transposed() * D * B;
+
+        // the 4 nodes of the element, consecutive elements share 3 nodes
+        const Index nodes[4] = { Index(element), Index(element + 1), Index(element + 2), Index(element + 3) };
+        for (int a = 0; a < 4; ++a)
+        {
+            for (int b = 0; b < 4; ++b)
+            {
+                type::Mat3x3d block;
+                for (int i = 0; i < 3; ++i)
+                    for (int j = 0; j < 3; ++j)
+                        block[i][j] = K[3 * a + i][3 * b + j];
+                r.matrix->add(r.offset + 3 * nodes[a], r.offset + 3 * nodes[b], block);
+            }
+        }
+    }
+}
+
+/// Timings of the assembly of several components in the same matrix, sequential and concurrent using
+/// MatrixWriteBuffer. Not run with the automatic tests.
+TEST(MatrixWriteBufferBenchmark, assembly)
+{
+    const std::size_t nbComponents = 16;
+    const std::size_t nbElements = 2000;
+    const Index size = Index(3 * (nbComponents * nbElements + 3));
+    const int nbRepeat = 10;
+    const unsigned int nbThread = std::max(2u, std::thread::hardware_concurrency());
+
+    simulation::TaskScheduler* scheduler = simulation::TaskScheduler::getInstance();
+    scheduler->init(nbThread);
+
+    Matrix sequential;
+    component::linearsolver::SingleMatrixAccessor sequentialAccessor(&sequential);
+    double sequentialTime = 0;
+    for (int repeat = 0; repeat < nbRepeat; ++repeat)
+    {
+        sequential.resize(size, size);
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (std::size_t c = 0; c < nbComponents; ++c)
+            addComponentStiffness(c, nbElements, &sequentialAccessor);
+        sequential.compress();
+        const auto end = std::chrono::high_resolution_clock::now();
+        sequentialTime += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    Matrix buffered;
+    component::linearsolver::SingleMatrixAccessor accessor(&buffered);
+    std::mutex accessorMutex;
+    double writeTime = 0;
+    double flushTime = 0;
+    for (int repeat = 0; repeat < nbRepeat; ++repeat)
+    {
+        buffered.resize(size, size);
+        const auto start = std::chrono::high_resolution_clock::now();
+        std::vector<simulation::BufferedMatrixAccessor> buffers;
+        for (std::size_t c = 0; c < nbComponents; ++c)
+            buffers.emplace_back(&accessor, &accessorMutex);
+        simulation::parallelFor(scheduler, std::size_t(0), nbComponents, std::size_t(1),
+            [&](std::size_t c) { addComponentStiffness(c, nbElements, &buffers[c]); });
+        const auto written = std::chrono::high_resolution_clock::now();
+        for (auto& b : buffers)
+            b.flush();
+        buffered.compress();
+        const auto end = std::chrono::high_resolution_clock::now();
+        writeTime += std::chrono::duration<double, std::milli>(written - start).count();
+        flushTime += std::chrono::duration<double, std::milli>(end - written).count();
+    }
+
+    ASSERT_EQ(buffered.getColsIndex(), sequential.getColsIndex());
+    EXPECT_EQ(buffered.getColsValue(), sequential.getColsValue());
+
+    std::cout << nbComponents << " components of " << nbElements << " elements, " << nbThread << " threads: sequential "
+              << sequentialTime / nbRepeat << " ms, buffered " << (writeTime + flushTime) / nbRepeat << " ms (concurrent writes "
+              << writeTime / nbRepeat << " ms, flush " << flushTime / nbRepeat << " ms)" << std::endl;
+
+    scheduler->stop();
+}
+
+} // namespace sofa
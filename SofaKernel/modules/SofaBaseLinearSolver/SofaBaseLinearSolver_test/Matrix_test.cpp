@@ -39,6 +39,11 @@
 #include <sofa/testing/NumericTest.h>
 using sofa::testing::NumericTest;
 
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/ParallelFor.h>
+#include <sofa/simulation/MatrixWriteBuffer.h>
+#include <SofaBaseLinearSolver/SingleMatrixAccessor.h>
+
 #define BENCHMARK_MATRIX_PRODUCT 0
 
 
@@ -562,4 +567,361 @@ TEST_F(TsProductTimings, benchmark )
 
 #endif
 
+
+/// Compare the concurrent matrix-vector products of CompressedRowSparseMatrix with the sequential ones
+TEST(CompressedRowSparseMatrix, parallelProducts)
+{
+    typedef sofa::component::linearsolver::CompressedRowSparseMatrix< sofa::type::Mat<3,3,SReal> > Matrix;
+    typedef sofa::component::linearsolver::FullVector<SReal> Vector;
+
+    sofa::simulation::TaskScheduler::getInstance()->init(4);
+
+    // banded matrix, large enough to be split in several tasks
+    const sofa::Index n = 3 * 3000;
+    Matrix A;
+    A.resize(n, n);
+    for (sofa::Index i = 0; i < n; ++i)
+        for (sofa::Index j = (i < 10 ? 0 : i - 10); j < std::min(n, i + 20); j += 3)
+            A.add(i, j, SReal(1 + (i * 7 + j * 13) % 17) / 17);
+    A.compress();
+
+    Vector x(n), y(n);
+    for (sofa::Index i = 0; i < n; ++i)
+    {
+        x[i] = std::sin(SReal(i));
+        y[i] = std::cos(SReal(i));
+    }
+
+    Vector mulSequential, mulParallel;
+    Vector addMulSequential(y), addMulParallel(y);
+    Vector transposeSequential(y), transposeParallel(y);
+
+    A.setParallelProducts(false);
+    A.mul(mulSequential, x);
+    A.addMul(addMulSequential, x);
+    A.addMultTranspose(transposeSequential, x);
+
+    A.setParallelProducts(true);
+    A.mul(mulParallel, x);
+    A.addMul(addMulParallel, x);
+    A.addMultTranspose(transposeParallel, x);
+
+    ASSERT_EQ(mulParallel.size(), n);
+    ASSERT_EQ(transposeParallel.size(), n);
+    for (sofa::Index i = 0; i < n; ++i)
+    {
+        // the rows are computed by a single task: same operations as the sequential product
+        EXPECT_EQ(mulSequential[i], mulParallel[i]) << "row " << i;
+        EXPECT_EQ(addMulSequential[i], addMulParallel[i]) << "row " << i;
+        EXPECT_NEAR(transposeSequential[i], transposeParallel[i], 1e-12) << "row " << i;
+    }
+}
+
+/// The concurrent transposed product gives the same result for any number of threads
+TEST(CompressedRowSparseMatrix, parallelTransposeProductIsReproducible)
+{
+    typedef sofa::component::linearsolver::CompressedRowSparseMatrix< sofa::type::Mat<3,3,SReal> > Matrix;
+    typedef sofa::component::linearsolver::FullVector<SReal> Vector;
+
+    const sofa::Index n = 3 * 3000;
+    Matrix A;
+    A.resize(n, n);
+    for (sofa::Index i = 0; i < n; ++i)
+        for (sofa::Index j = (i < 10 ? 0 : i - 10); j < std::min(n, i + 20); j += 3)
+            A.add(i, j, SReal(1 + (i * 7 + j * 13) % 17) / 17);
+    A.compress();
+    A.setParallelProducts(true);
+
+    Vector x(n);
+    for (sofa::Index i = 0; i < n; ++i)
+        x[i] = std::sin(SReal(i));
+
+    const unsigned int nbThreads[3] = { 1, 2, 4 };
+    Vector results[3];
+    for (int t = 0; t < 3; ++t)
+    {
+        sofa::simulation::TaskScheduler::getInstance()->init(nbThreads[t]);
+        results[t].resize(n);
+        results[t].clear();
+        A.addMultTranspose(results[t], x);
+    }
+    sofa::simulation::TaskScheduler::getInstance()->init(4);
+
+    for (int t = 1; t < 3; ++t)
+        for (sofa::Index i = 0; i < n; ++i)
+            ASSERT_EQ(results[0][i], results[t][i]) << nbThreads[t] << " threads, row " << i;
+}
+
+/// Matrix giving access to the products with another scalar type than its own
+template<class TBloc>
+class ProductCompressedRowSparseMatrix : public sofa::component::linearsolver::CompressedRowSparseMatrix<TBloc>
+{
+public:
+    using sofa::component::linearsolver::CompressedRowSparseMatrix<TBloc>::taddMulTranspose;
+};
+
+/// The concurrent transposed product keeps the precision of the vectors when it is higher than the one of the matrix
+TEST(CompressedRowSparseMatrix, parallelTransposeProductPrecision)
+{
+    typedef ProductCompressedRowSparseMatrix< sofa::type::Mat<3,3,float> > Matrix;
+    typedef sofa::component::linearsolver::FullVector<double> Vector;
+
+    sofa::simulation::TaskScheduler::getInstance()->init(4);
+
+    const sofa::Index n = 3 * 3000;
+    Vector x(n);
+    for (sofa::Index i = 0; i < n; ++i)
+        x[i] = std::sin(double(i));
+
+    Matrix A;
+    A.resize(n, n);
+    Vector expected(n);
+    expected.clear();
+    for (sofa::Index i = 0; i < n; ++i)
+    {
+        for (sofa::Index j = (i < 10 ? 0 : i - 10); j < std::min(n, i + 20); j += 3)
+        {
+            const float v = float(1 + (i * 7 + j * 13) % 17) / 17;
+            A.add(i, j, v);
+            expected[j] += double(v) * double(float(x[i])); // the entries of the vector are read in the scalar type of the matrix
+        }
+    }
+    A.compress();
+
+    Vector transposeParallel(n);
+    transposeParallel.clear();
+    A.setParallelProducts(true);
+    A.taddMulTranspose<double>(transposeParallel, x);
+
+    for (sofa::Index i = 0; i < n; ++i)
+        EXPECT_NEAR(expected[i], transposeParallel[i], 1e-12) << "row " << i;
+}
+
+/// Concurrent transposed products with the same matrix
+TEST(CompressedRowSparseMatrix, concurrentTransposeProducts)
+{
+    typedef sofa::component::linearsolver::CompressedRowSparseMatrix< sofa::type::Mat<3,3,SReal> > Matrix;
+    typedef sofa::component::linearsolver::FullVector<SReal> Vector;
+
+    sofa::simulation::TaskScheduler* scheduler = sofa::simulation::TaskScheduler::getInstance();
+    scheduler->init(4);
+
+    const sofa::Index n = 3 * 3000;
+    Matrix A;
+    A.resize(n, n);
+    for (sofa::Index i = 0; i < n; ++i)
+        for (sofa::Index j = (i < 10 ? 0 : i - 10); j < std::min(n, i + 20); j += 3)
+            A.add(i, j, SReal(1 + (i * 7 + j * 13) % 17) / 17);
+    A.compress();
+    A.setParallelProducts(true);
+
+    Vector zero(n);
+    zero.clear();
+    sofa::type::vector<Vector> x(4, zero);
+    for (sofa::Index k = 0; k < x.size(); ++k)
+        for (sofa::Index i = 0; i < n; ++i)
+            x[k][i] = std::sin(SReal(i * (k + 1)));
+
+    sofa::type::vector<Vector> expected(x.size(), zero);
+    for (sofa::Index k = 0; k < x.size(); ++k)
+        A.addMultTranspose(expected[k], x[k]);
+
+    sofa::type::vector<Vector> results(x.size(), zero);
+    sofa::simulation::parallelFor(scheduler, sofa::Index(0), sofa::Index(x.size()), sofa::Index(1), [&](sofa::Index k)
+    {
+        A.addMultTranspose(results[k], x[k]);
+    });
+
+    for (sofa::Index k = 0; k < x.size(); ++k)
+        for (sofa::Index i = 0; i < n; ++i)
+            ASSERT_EQ(expected[k][i], results[k][i]) << "product " << k << ", row " << i;
+}
+
+/// Assemble the same matrix with and without a locked pattern, including changes of pattern and size
+TEST(CompressedRowSparseMatrix, patternLocking)
+{
+    typedef sofa::component::linearsolver::CompressedRowSparseMatrix< sofa::type::Mat<3,3,SReal> > Matrix;
+
+    // the assembly of a chain of springs, each step with different values
+    const auto assemble = [](Matrix& m, sofa::Index nbNodes, int step, bool extraBloc)
+    {
+        m.resize(3 * nbNodes, 3 * nbNodes);
+        m.clear();
+        for (sofa::Index n = 0; n + 1 < nbNodes; ++n)
+        {
+            for (sofa::Index a = 0; a < 3; ++a)
+            {
+                const SReal k = SReal(1 + (n + a + step) % 5);
+                m.add(3 * n + a, 3 * n + a, k);
+                m.add(3 * n + a, 3 * (n + 1) + a, -k);
+                m.add(3 * (n + 1) + a, 3 * n + a, -k);
+                m.add(3 * (n + 1) + a, 3 * (n + 1) + a, k);
+            }
+        }
+        if (extraBloc)
+            m.add(0, 3 * (nbNodes - 1), SReal(step));
+        m.compress();
+    };
+
+    const auto check = [](const Matrix& locked, const Matrix& reference)
+    {
+        ASSERT_EQ(locked.rowSize(), reference.rowSize());
+        for (sofa::Index i = 0; i < reference.rowSize(); ++i)
+            for (sofa::Index j = 0; j < reference.colSize(); ++j)
+                EXPECT_EQ(locked.element(i, j), reference.element(i, j)) << "(" << i << "," << j << ")";
+    };
+
+    Matrix locked, reference;
+    locked.setPatternLocking(true);
+
+    int step = 0;
+    for (; step < 3; ++step)
+    {
+        assemble(locked, 10, step, false);
+        assemble(reference, 10, step, false);
+        check(locked, reference);
+    }
+    EXPECT_TRUE(locked.isPatternLocked());
+
+    // a new bloc: the pattern is invalidated, then recorded and locked again
+    assemble(locked, 10, step, true);
+    assemble(reference, 10, step, true);
+    EXPECT_FALSE(locked.isPatternLocked());
+    check(locked, reference);
+    for (++step; step < 6; ++step)
+    {
+        assemble(locked, 10, step, true);
+        assemble(reference, 10, step, true);
+        check(locked, reference);
+    }
+    EXPECT_TRUE(locked.isPatternLocked());
+
+    // a change of size (e.g. topology change)
+    assemble(locked, 12, step, false);
+    assemble(reference, 12, step, false);
+    EXPECT_FALSE(locked.isPatternLocked());
+    check(locked, reference);
+}
+
+/// Assemble with a locked pattern a matrix in which some blocs become empty, then non-empty again
+TEST(CompressedRowSparseMatrix, patternLockingWithEmptyBlocs)
+{
+    typedef sofa::component::linearsolver::CompressedRowSparseMatrix< sofa::type::Mat<3,3,SReal> > Matrix;
+
+    // the assembly of a chain of springs, in which the spring nullSpring has a null stiffness
+    const auto assemble = [](Matrix& m, sofa::Index nbNodes, int step, sofa::Index nullSpring)
+    {
+        m.resize(3 * nbNodes, 3 * nbNodes);
+        m.clear();
+        for (sofa::Index n = 0; n + 1 < nbNodes; ++n)
+        {
+            for (sofa::Index a = 0; a < 3; ++a)
+            {
+                const SReal k = (n == nullSpring) ? SReal(0) : SReal(1 + (n + a + step) % 5);
+                m.add(3 * n + a, 3 * n + a, k);
+                m.add(3 * n + a, 3 * (n + 1) + a, -k);
+                m.add(3 * (n + 1) + a, 3 * n + a, -k);
+                m.add(3 * (n + 1) + a, 3 * (n + 1) + a, k);
+            }
+        }
+        m.compress();
+    };
+
+    const auto check = [](const Matrix& locked, const Matrix& reference)
+    {
+        ASSERT_EQ(locked.rowSize(), reference.rowSize());
+        for (sofa::Index i = 0; i < reference.rowSize(); ++i)
+            for (sofa::Index j = 0; j < reference.colSize(); ++j)
+                EXPECT_EQ(locked.element(i, j), reference.element(i, j)) << "(" << i << "," << j << ")";
+    };
+
+    constexpr sofa::Index nbNodes = 10;
+    constexpr sofa::Index noNullSpring = nbNodes;
+    const sofa::Index nullSprings[] = { noNullSpring, noNullSpring, noNullSpring, 4, 4, noNullSpring, 2, 7 };
+
+    Matrix locked, reference;
+    locked.setPatternLocking(true);
+
+    std::size_t nbBlocs = 0;
+    for (int step = 0; step < 8; ++step)
+    {
+        assemble(locked, nbNodes, step, nullSprings[step]);
+        assemble(reference, nbNodes, step, nullSprings[step]);
+        check(locked, reference);
+
+        if (step == 2)
+        {
+            EXPECT_TRUE(locked.isPatternLocked());
+            nbBlocs = locked.getColsValue().size();
+        }
+        else if (step > 2)
+        {
+            // the empty blocs are kept, and the pattern stays locked
+            EXPECT_TRUE(locked.isPatternLocked()) << "step " << step;
+            EXPECT_EQ(locked.getColsValue().size(), nbBlocs) << "step " << step;
+        }
+    }
+
+    // the empty off-diagonal blocs are removed without pattern locking
+    EXPECT_LT(reference.getColsValue().size(), nbBlocs);
+}
+
+/// Write concurrently in MatrixWriteBuffer and compare with the writes made directly in the matrix
+TEST(CompressedRowSparseMatrix, bufferedAssembly)
+{
+    typedef sofa::component::linearsolver::CompressedRowSparseMatrix< sofa::type::Mat<3,3,SReal> > Matrix;
+
+    // each component writes the stiffness of a few springs, some entries are overwritten
+    const auto write = [](std::size_t component, const sofa::core::behavior::MultiMatrixAccessor* accessor)
+    {
+        const auto r = accessor->getMatrix(nullptr);
+        for (sofa::Index n = 10 * component; n < 10 * component + 12; ++n)
+        {
+            sofa::type::Mat3x3d k;
+            for (int a = 0; a < 3; ++a)
+                for (int b = 0; b < 3; ++b)
+                    k[a][b] = 1. / (1 + n + a + 2 * b);
+            r.matrix->add(r.offset + 3 * n, r.offset + 3 * n, k);
+            r.matrix->add(r.offset + 3 * n, r.offset + 3 * (n + 1), -k);
+            r.matrix->add(r.offset + 3 * (n + 1) + 1, r.offset + 3 * n, -0.1 * n);
+        }
+        r.matrix->set(r.offset + 30 * component, r.offset + 30 * component, SReal(component));
+    };
+
+    const std::size_t nbComponents = 8;
+    const sofa::Index size = 3 * (10 * nbComponents + 13);
+
+    Matrix sequential;
+    sequential.resize(size, size);
+    sofa::component::linearsolver::SingleMatrixAccessor sequentialAccessor(&sequential);
+    for (std::size_t c = 0; c < nbComponents; ++c)
+        write(c, &sequentialAccessor);
+    sequential.compress();
+
+    sofa::simulation::TaskScheduler::getInstance()->init(4);
+
+    Matrix buffered;
+    buffered.resize(size, size);
+    sofa::component::linearsolver::SingleMatrixAccessor accessor(&buffered);
+    std::mutex accessorMutex;
+    std::vector<sofa::simulation::BufferedMatrixAccessor> buffers;
+    for (std::size_t c = 0; c < nbComponents; ++c)
+        buffers.emplace_back(&accessor, &accessorMutex);
+    sofa::simulation::parallelFor(std::size_t(0), nbComponents, std::size_t(1),
+        [&](std::size_t c) { write(c, &buffers[c]); });
+    for (auto& b : buffers)
+        b.flush();
+    buffered.compress();
+
+    ASSERT_EQ(buffered.getColsIndex(), sequential.getColsIndex());
+    for (sofa::Index i = 0; i < size; ++i)
+        for (sofa::Index j = 0; j < size; ++j)
+            EXPECT_EQ(buffered.element(i, j), sequential.element(i, j)) << "(" << i << "," << j << ")";
+
+    // the content of the matrix cannot be accessed through a buffer
+    sofa::simulation::MatrixWriteBuffer buffer(&buffered);
+    EXPECT_THROW(buffer.element(0, 0), std::logic_error);
+    EXPECT_THROW(buffer.clear(), std::logic_error);
+}
+
 }// namespace sofa
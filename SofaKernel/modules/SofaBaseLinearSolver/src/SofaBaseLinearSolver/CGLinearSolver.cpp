@@ -27,8 +27,8 @@
 #include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
 #include <sofa/core/ObjectFactory.h>
 
-#include <sofa/simulation/mechanicalvisitor/MechanicalVMultiOpVisitor.h>
-using sofa::simulation::mechanicalvisitor::MechanicalVMultiOpVisitor;
+#include <sofa/simulation/mechanicalvisitor/MechanicalVMultiOpDotVisitor.h>
+using sofa::simulation::mechanicalvisitor::MechanicalVMultiOpDotVisitor;
 
 namespace sofa::component::linearsolver
 {
@@ -44,12 +44,13 @@ inline void CGLinearSolver<component::linearsolver::GraphScatteredMatrix,compone
 }
 
 template<> SOFA_SOFABASELINEARSOLVER_API
-inline void CGLinearSolver<component::linearsolver::GraphScatteredMatrix,component::linearsolver::GraphScatteredVector>::cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, SReal alpha)
+inline SReal CGLinearSolver<component::linearsolver::GraphScatteredMatrix,component::linearsolver::GraphScatteredVector>::cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, SReal alpha)
 {
 #ifdef SOFA_NO_VMULTIOP // unoptimized version
     x.peq(p,alpha);                 // x = x + alpha p
     r.peq(q,-alpha);                // r = r - alpha q
-#else // single-operation optimization
+    return r.dot(r);
+#else // single-operation optimization, also computing r.r in the same pass
     typedef sofa::core::behavior::BaseMechanicalState::VMultiOp VMultiOp;
     VMultiOp ops;
     ops.resize(2);
@@ -59,7 +60,9 @@ inline void CGLinearSolver<component::linearsolver::GraphScatteredMatrix,compone
     ops[1].first = (MultiVecDerivId)r;
     ops[1].second.push_back(std::make_pair((MultiVecDerivId)r,1.0));
     ops[1].second.push_back(std::make_pair((MultiVecDerivId)q,-alpha));
-    this->executeVisitor(MechanicalVMultiOpVisitor(params, ops));
+    SReal rho = 0.0;
+    this->executeVisitor(MechanicalVMultiOpDotVisitor(params, ops, r, r, &rho));
+    return rho;
 #endif
 }
 
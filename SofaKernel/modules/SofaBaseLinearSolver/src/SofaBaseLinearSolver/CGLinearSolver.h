@@ -53,8 +53,8 @@ protected:
     /// It computes: p = p*beta + r
     inline void cgstep_beta(const core::ExecParams* params, Vector& p, Vector& r, SReal beta);
     /// This method is separated from the rest to be able to use custom/optimized versions depending on the types of vectors.
-    /// It computes: x += p*alpha, r -= q*alpha
-    inline void cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, SReal alpha);
+    /// It computes: x += p*alpha, r -= q*alpha, and returns the squared norm of the updated residual r.r
+    inline SReal cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, SReal alpha);
 
     int timeStepCount;
     bool equilibriumReached;
@@ -98,7 +98,7 @@ template<>
 inline void CGLinearSolver<component::linearsolver::GraphScatteredMatrix,component::linearsolver::GraphScatteredVector>::cgstep_beta(const core::ExecParams* /*params*/, Vector& p, Vector& r, SReal beta);
 
 template<>
-inline void CGLinearSolver<component::linearsolver::GraphScatteredMatrix,component::linearsolver::GraphScatteredVector>::cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, SReal alpha);
+inline SReal CGLinearSolver<component::linearsolver::GraphScatteredMatrix,component::linearsolver::GraphScatteredVector>::cgstep_alpha(const core::ExecParams* params, Vector& x, Vector& r, Vector& p, Vector& q, SReal alpha);
 
 #if  !defined(SOFA_COMPONENT_LINEARSOLVER_CGLINEARSOLVER_CPP)
 extern template class SOFA_SOFABASELINEARSOLVER_API CGLinearSolver< GraphScatteredMatrix, GraphScatteredVector >;
@@ -49,6 +49,8 @@ CGLinearSolver<TMatrix,TVector>::CGLinearSolver()
 template<class TMatrix, class TVector>
 void CGLinearSolver<TMatrix,TVector>::init()
 {
+    Inherit::init();
+
     if(d_tolerance.getValue() < 0.0)
     {
         msg_warning() << "'tolerance' must be a positive value" << msgendl
@@ -158,7 +160,11 @@ void CGLinearSolver<TMatrix,TVector>::solve(Matrix& A, Vector& x, Vector& b)
 #endif
 
             /// Compute ρ = r²
-            rho = r.dot(r);
+            /// For the next iterations, it has already been computed along with the update of r
+            if (nb_iter == 1)
+            {
+                rho = r.dot(r);
+            }
 
             /// Compute the error from the norm of ρ and b
             double normr = sqrt(rho);
@@ -268,10 +274,12 @@ void CGLinearSolver<TMatrix,TVector>::solve(Matrix& A, Vector& x, Vector& b)
                 /// Compute the coefficient α for the conjugate direction
                 alpha = rho/den;
 
-                /// End of the CG step by updating x and r
+                /// End of the CG step by updating x and r, and computing ρ for the next iteration
                 /// x = x + alpha p
                 /// r = r - alpha p
-                cgstep_alpha(params, x,r,p,q,alpha);
+                /// ρ = r²
+                rho_1 = rho;
+                rho = cgstep_alpha(params, x,r,p,q,alpha);
 
                 msg_info() << "den = " << den << ", alpha = " << alpha << ", x = " << x << ", r = " << r;
             }
@@ -281,8 +289,6 @@ void CGLinearSolver<TMatrix,TVector>::solve(Matrix& A, Vector& x, Vector& b)
                 break;
             }
 
-            rho_1 = rho;
-
 #ifdef SOFA_DUMP_VISITOR_INFO
             if (simulation::Visitor::isPrintActivated())
                 simulation::Visitor::printCloseNode(comment.str());
@@ -341,13 +347,15 @@ inline void CGLinearSolver<TMatrix,TVector>::cgstep_beta(const core::ExecParams*
 }
 
 template<class TMatrix, class TVector>
-inline void CGLinearSolver<TMatrix,TVector>::cgstep_alpha(const core::ExecParams* /*params*/, Vector& x, Vector& r, Vector& p, Vector& q, SReal alpha)
+inline SReal CGLinearSolver<TMatrix,TVector>::cgstep_alpha(const core::ExecParams* /*params*/, Vector& x, Vector& r, Vector& p, Vector& q, SReal alpha)
 {
     // x = x + alpha p
     x.peq(p,alpha);
 
     // r = r - alpha q
     r.peq(q,-alpha);
+
+    return r.dot(r);
 }
 
 } // namespace sofa::component::linearsolver
@@ -0,0 +1,33 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
+#include <sofa/simulation/ParallelFor.h>
+
+namespace sofa::component::linearsolver
+{
+
+void parallelProductRanges(std::size_t n, std::size_t grainSize, const std::function<void(std::size_t, std::size_t)>& f)
+{
+    simulation::parallelForRange(simulation::TaskScheduler::getCurrentInstance(), std::size_t(0), n, grainSize, f);
+}
+
+} // namespace sofa::component::linearsolver
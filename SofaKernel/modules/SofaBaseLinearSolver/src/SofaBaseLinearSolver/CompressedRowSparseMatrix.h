@@ -29,10 +29,16 @@
 #include <sofa/type/vector.h>
 #include <sofa/helper/rmath.h>
 #include <sofa/defaulttype/typeinfo/TypeInfo_Mat.h>
+#include <functional>
 
 namespace sofa::component::linearsolver
 {
 
+/// Loop of the concurrent products of CompressedRowSparseMatrix with vectors: calls f(begin, end) on ranges
+/// partitioning [0, n), concurrently if the current TaskScheduler runs several threads, and sequentially otherwise.
+/// The scheduler is neither created nor started.
+SOFA_SOFABASELINEARSOLVER_API void parallelProductRanges(std::size_t n, std::size_t grainSize, const std::function<void(std::size_t, std::size_t)>& f);
+
 //#define SPARSEMATRIX_CHECK
 //#define SPARSEMATRIX_VERBOSE
 
@@ -164,16 +170,40 @@ public :
     VecIndex oldRowBegin;
     VecIndex oldColsIndex;
     VecBloc  oldColsValue;
+
+    /// true if the products with vectors are computed concurrently, using the TaskScheduler
+    bool parallelProducts;
+
+    /// Minimum number of non-empty block rows processed by a task in the concurrent products
+    static constexpr Index ParallelProductGrainSize = 256;
+
+    /// Maximum number of partitions of the rows in the concurrent transposed product. It does not depend on
+    /// the number of threads, so that the result of the product does not either.
+    static constexpr Index TransposeProductPartitions = 8;
+
+    // pattern-locked assembly
+    enum class PatternState { Recording, Locked, Invalidated };
+    struct PatternEntry
+    {
+        Index l, c;     ///< indices of the bloc
+        Index position; ///< index of the bloc in colsValue, once the pattern is locked
+    };
+    bool patternLocking;  ///< true if the sequence of blocs written by an assembly is recorded and reused by the following ones
+    PatternState patternState;
+    type::vector<PatternEntry> patternEntries; ///< sequence of the blocs written during the recorded assembly
+    Index patternCursor;  ///< current entry in patternEntries during a locked assembly
 public:
     CompressedRowSparseMatrix()
-        : nRow(0), nCol(0), nBlocRow(0), nBlocCol(0), compressed(true)
+        : nRow(0), nCol(0), nBlocRow(0), nBlocCol(0), compressed(true), parallelProducts(false)
+        , patternLocking(false), patternState(PatternState::Invalidated), patternCursor(0)
     {
     }
 
     CompressedRowSparseMatrix(Index nbRow, Index nbCol)
         : nRow(nbRow), nCol(nbCol),
           nBlocRow((nbRow + NL-1) / NL), nBlocCol((nbCol + NC-1) / NC),
-          compressed(true)
+          compressed(true), parallelProducts(false)
+        , patternLocking(false), patternState(PatternState::Invalidated), patternCursor(0)
     {
     }
 
@@ -194,6 +224,41 @@ public:
         return nBlocCol;
     }
 
+    /// Compute the products with vectors (mul, addMul, addMultTranspose) concurrently.
+    /// The rows are partitioned between the tasks, so mul and addMul give the same result as the
+    /// sequential products. The transposed product accumulates a fixed partition of the rows in
+    /// separate buffers: its result differs from the sequential product by the rounding errors,
+    /// but it is the same for any number of threads.
+    void setParallelProducts(bool b) { parallelProducts = b; }
+    bool getParallelProducts() const { return parallelProducts; }
+
+    /// Record the sequence of blocs written by an assembly (calls to set, add or blocCreate between two
+    /// calls to clear or resize), and reuse it in the following assemblies: each bloc is then written
+    /// directly at its precomputed position in colsValue, without searching, sorting or allocating.
+    /// The pattern is invalidated as soon as an assembly writes a different sequence of blocs, or when
+    /// the matrix is resized or restructured (e.g. after a topology change), and it is recorded again
+    /// during the next assembly.
+    /// While pattern locking is enabled, compress keeps the blocs which became empty (e.g. a spring with
+    /// a null stiffness, or a row cleared by a projective constraint), and it has nothing to do during
+    /// a locked assembly.
+    void setPatternLocking(bool b)
+    {
+        if (b == patternLocking) return;
+        patternLocking = b;
+        invalidatePattern();
+    }
+    bool getPatternLocking() const { return patternLocking; }
+
+    /// \returns true if the assemblies currently use the recorded pattern
+    bool isPatternLocked() const { return patternLocking && patternState == PatternState::Locked; }
+
+    /// Discard the recorded pattern. Must be called if the compressed data structure is modified directly.
+    void invalidatePattern()
+    {
+        patternEntries.clear();
+        patternState = PatternState::Invalidated;
+    }
+
     const VecIndex& getRowIndex() const { return rowIndex; }
     const VecIndex& getRowBegin() const { return rowBegin; }
     Range getRowRange(Index id) const { return Range(rowBegin[id], rowBegin[id+1]); }
@@ -209,6 +274,7 @@ public:
                 traits::clear(colsValue[i]);
             compressed = colsValue.empty();
             btemp.clear();
+            beginPatternAssembly();
         }
         else
         {
@@ -225,12 +291,27 @@ public:
             colsValue.clear();
             compressed = true;
             btemp.clear();
+            invalidatePattern();
+            beginPatternAssembly();
         }
     }
 
     void compress() override
     {
         if (compressed && btemp.empty()) return;
+        if (patternState == PatternState::Locked)
+        {
+            // all the blocs were written in place: the structure is unchanged
+            if (btemp.empty())
+            {
+                compressed = true;
+                return;
+            }
+            // new blocs change the positions in colsValue
+            invalidatePattern();
+        }
+        // with pattern locking, the empty blocs are kept so that the recorded positions stay valid
+        const bool keepEmptyBlocs = patternLocking;
         if (!btemp.empty())
         {
             dmsg_info_when(EMIT_EXTRA_MESSAGE)
@@ -272,7 +353,7 @@ public:
                 Range inRow( oldRowBegin[inRowId], oldRowBegin[inRowId+1] );
                 while (!inRow.empty())
                 {
-                    if (!traits::empty(oldColsValue[inRow.begin()]))
+                    if (keepEmptyBlocs || !traits::empty(oldColsValue[inRow.begin()]))
                     {
                         colsIndex.push_back(oldColsIndex[inRow.begin()]);
                         colsValue.push_back(oldColsValue[inRow.begin()]);
@@ -316,7 +397,7 @@ public:
                 {
                     if (inColIndex < bColIndex)
                     {
-                        if (!traits::empty(oldColsValue[inRow.begin()]))
+                        if (keepEmptyBlocs || !traits::empty(oldColsValue[inRow.begin()]))
                         {
                             colsIndex.push_back(inColIndex);
                             colsValue.push_back(oldColsValue[inRow.begin()]);
@@ -381,6 +462,10 @@ public:
         colsIndex.swap(m.colsIndex);
         colsValue.swap(m.colsValue);
         btemp.swap(m.btemp);
+        std::swap(patternLocking, m.patternLocking);
+        std::swap(patternState, m.patternState);
+        patternEntries.swap(m.patternEntries);
+        std::swap(patternCursor, m.patternCursor);
     }
 
     /// Make sure all rows have an entry even if they are empty
@@ -388,6 +473,7 @@ public:
     {
         compress();
         if (rowIndex.size() >= nRow) return;
+        invalidatePattern();
         oldRowIndex.swap(rowIndex);
         oldRowBegin.swap(rowBegin);
         rowIndex.resize(nRow);
@@ -428,6 +514,7 @@ public:
             if (b<e) ++ndiag;
         }
         if (ndiag == nRow) return;
+        invalidatePattern();
 
         oldRowIndex.swap(rowIndex);
         oldRowBegin.swap(rowBegin);
@@ -546,6 +633,7 @@ public:
         colsValue.clear();
         compressed = true;
         btemp.clear();
+        invalidatePattern();
         rowIndex.reserve(M.rowIndex.size());
         rowBegin.reserve(M.rowBegin.size());
         colsIndex.reserve(M.colsIndex.size());
@@ -640,6 +728,20 @@ public:
 
     Bloc* wbloc(Index i, Index j, bool create = false)
     {
+        if (create && patternLocking)
+        {
+            if (patternState == PatternState::Locked)
+            {
+                const Index position = findLockedBloc(i, j);
+                if (position >= 0)
+                    return &colsValue[position];
+            }
+            else if (patternState == PatternState::Recording)
+            {
+                recordPatternBloc(i, j);
+            }
+        }
+
         Index rowId = i * (Index)rowIndex.size() / nBlocRow;
         if (sortedFind(rowIndex, i, rowId))
         {
@@ -669,6 +771,76 @@ public:
         return nullptr;
     }
 
+protected:
+    /// Called when a new assembly begins: lock the pattern recorded during the previous assembly
+    /// if all its blocs are found in the compressed data structure, or start recording it again
+    void beginPatternAssembly()
+    {
+        if (!patternLocking) return;
+        patternCursor = 0;
+        if (patternState == PatternState::Invalidated)
+        {
+            patternEntries.clear();
+            patternState = PatternState::Recording;
+        }
+        else if (patternState == PatternState::Recording && !patternEntries.empty())
+        {
+            Index rowId = 0, colId = 0;
+            for (PatternEntry& e : patternEntries)
+            {
+                if (!sortedFind(rowIndex, e.l, rowId))
+                {
+                    patternEntries.clear();
+                    return;
+                }
+                Range rowRange(rowBegin[rowId], rowBegin[rowId+1]);
+                if (!sortedFind(colsIndex, rowRange, e.c, colId))
+                {
+                    patternEntries.clear();
+                    return;
+                }
+                e.position = colId;
+            }
+            patternState = PatternState::Locked;
+
+            msg_info_when(EMIT_EXTRA_MESSAGE)
+                    << "("<<rowSize()<<","<<colSize()<<"): pattern locked with "<<patternEntries.size()<<" bloc writes." ;
+        }
+    }
+
+    void recordPatternBloc(Index i, Index j)
+    {
+        if (patternEntries.empty() || patternEntries.back().l != i || patternEntries.back().c != j)
+            patternEntries.push_back({i, j, -1});
+    }
+
+    /// \returns the position in colsValue of the bloc (i,j) written during a locked assembly,
+    /// or -1 if the sequence of blocs differs from the recorded one, in which case the pattern is invalidated
+    Index findLockedBloc(Index i, Index j)
+    {
+        const Index nbEntries = (Index)patternEntries.size();
+        if (patternCursor < nbEntries)
+        {
+            const PatternEntry& e = patternEntries[patternCursor];
+            if (e.l == i && e.c == j) return e.position;
+        }
+        if (patternCursor+1 < nbEntries)
+        {
+            const PatternEntry& e = patternEntries[patternCursor+1];
+            if (e.l == i && e.c == j)
+            {
+                ++patternCursor;
+                return e.position;
+            }
+        }
+
+        msg_info_when(EMIT_EXTRA_MESSAGE)
+                << "("<<rowSize()<<","<<colSize()<<"): bloc ("<<i<<","<<j<<") does not match the locked pattern, it is invalidated." ;
+        invalidatePattern();
+        return -1;
+    }
+
+public:
     ///< Mathematical size of the matrix
     Index rowSize() const override
     {
@@ -872,6 +1044,7 @@ public:
             traits::clear(colsValue[i]);
         compressed = colsValue.empty();
         btemp.clear();
+        beginPatternAssembly();
     }
 
     /// @name Get information about the content and structure of this matrix (diagonal, band, sparse, full, block size, ...)
@@ -1038,6 +1211,20 @@ public:
     /// Get write access to a bloc, possibly creating it
     BlockAccessor blocCreate(Index i, Index j) override
     {
+        if (patternLocking)
+        {
+            if (patternState == PatternState::Locked)
+            {
+                const Index position = findLockedBloc(i, j);
+                if (position >= 0)
+                    return createBlockAccessor(i, j, position);
+            }
+            else if (patternState == PatternState::Recording)
+            {
+                recordPatternBloc(i, j);
+            }
+        }
+
         Index rowId = i * (Index)rowIndex.size() / nBlocRow;
         if (sortedFind(rowIndex, i, rowId))
         {
@@ -1248,20 +1435,29 @@ protected:
                           static void vadd(defaulttype::BaseVector& vec, Index i, Real v) { vec.add(i, v); }
     template<class Real2> static void vadd(FullVector<Real2>& vec, Index i, Real2 v) { vec[i] += v; }
 
+    // same as vadd, without converting the added value to Real
+    template<class Vec, class Real2> static void vaddProduct(Vec& vec, Index i, Index j, Index k, Real2 v) { vaddProduct( vec, i*j+k, v ); }
+    template<class Vec, class Real2> static void vaddProduct(type::vector<Vec>&vec, Index i, Index /*j*/, Index k, Real2 v) { vec[i][k] += v; }
+
+                                   static void vaddProduct(defaulttype::BaseVector& vec, Index i, SReal v) { vec.add(i, v); }
+    template<class T, class Real2> static void vaddProduct(FullVector<T>& vec, Index i, Real2 v) { vec[i] += v; }
+
     template<class Vec> static void vresize(Vec& vec, Index /*blockSize*/, Index totalSize) { vec.resize( totalSize ); }
     template<class Vec> static void vresize(type::vector<Vec>&vec, Index blockSize, Index /*totalSize*/) { vec.resize( blockSize ); }
 
 
 
-      /** Product of the matrix with a templated vector res = this * vec*/
-      template<class Real2, class V1, class V2>
-      void tmul(V1& res, const V2& vec) const
+      /// \returns true if the products with vectors are computed by partitions of the rows
+      bool useParallelProducts() const
       {
-          assert( vec.size()%bColSize() == 0 ); // vec.size() must be a multiple of block size.
+          return parallelProducts && (Index)rowIndex.size() >= 2 * ParallelProductGrainSize;
+      }
 
-          ((Matrix*)this)->compress();
-          vresize( res, rowBSize(), rowSize() );
-          for (Index xi = 0; xi < (Index)rowIndex.size(); ++xi)  // for each non-empty block row
+      /** Product of the non-empty block rows [xbegin,xend) with a templated vector: res = this * vec, or res += this * vec if add is true */
+      template<class Real2, bool add, class V1, class V2>
+      void tmulRows(V1& res, const V2& vec, Index xbegin, Index xend) const
+      {
+          for (Index xi = xbegin; xi < xend; ++xi)  // for each non-empty block row
           {
               type::Vec<NL,Real2> r;  // local block-sized vector to accumulate the product of the block row  with the large vector
 
@@ -1285,45 +1481,55 @@ protected:
               // transfer the local result  to the large result vector
               //Index iN = rowIndex[xi] * NL;                      // scalar row index
               for (Index bi = 0; bi < NL; ++bi)
-                  vset(res, rowIndex[xi], NL, bi, r[bi]);
+              {
+                  if (add)
+                      vadd(res, rowIndex[xi], NL, bi, r[bi]);
+                  else
+                      vset(res, rowIndex[xi], NL, bi, r[bi]);
+              }
           }
       }
 
+      /** Product of the matrix with a templated vector: res = this * vec, or res += this * vec if add is true.
+          Each block row only writes its own entries of res, so the rows can be processed concurrently. */
+      template<class Real2, bool add, class V1, class V2>
+      void tmulAllRows(V1& res, const V2& vec) const
+      {
+          const Index nbRows = (Index)rowIndex.size();
+          if (useParallelProducts())
+          {
+              parallelProductRanges(std::size_t(nbRows), std::size_t(ParallelProductGrainSize), [&](std::size_t xbegin, std::size_t xend)
+              {
+                  tmulRows<Real2, add>(res, vec, Index(xbegin), Index(xend));
+              });
+          }
+          else
+          {
+              tmulRows<Real2, add>(res, vec, Index(0), nbRows);
+          }
+      }
 
-      /** Product of the matrix with a templated vector res += this * vec*/
+      /** Product of the matrix with a templated vector res = this * vec*/
       template<class Real2, class V1, class V2>
-      void taddMul(V1& res, const V2& vec) const
+      void tmul(V1& res, const V2& vec) const
       {
           assert( vec.size()%bColSize() == 0 ); // vec.size() must be a multiple of block size.
 
           ((Matrix*)this)->compress();
           vresize( res, rowBSize(), rowSize() );
-          for (Index xi = 0; xi < (Index)rowIndex.size(); ++xi)  // for each non-empty block row
-          {
-              type::Vec<NL,Real2> r;  // local block-sized vector to accumulate the product of the block row  with the large vector
+          tmulAllRows<Real2, false>(res, vec);
+      }
 
-              // multiply the non-null blocks with the corresponding chunks of the large vector
-              Range rowRange(rowBegin[xi], rowBegin[xi+1]);
-              for (Index xj = rowRange.begin(); xj < rowRange.end(); ++xj)
-              {
-                  // transfer a chunk of large vector to a local block-sized vector
-                  type::Vec<NC,Real2> v;
-                  //Index jN = colsIndex[xj] * NC;    // scalar column index
-                  for (Index bj = 0; bj < NC; ++bj)
-                      v[bj] = vget(vec,colsIndex[xj],NC,bj);
 
-                  // multiply the block with the local vector
-                  const Bloc& b = colsValue[xj];    // non-null block has block-indices (rowIndex[xi],colsIndex[xj]) and value colsValue[xj]
-                  for (Index bi = 0; bi < NL; ++bi)
-                      for (Index bj = 0; bj < NC; ++bj)
-                          r[bi] += traits::v(b, bi, bj) * v[bj];
-              }
+      /** Product of the matrix with a templated vector res += this * vec*/
+      template<class Real2, class V1, class V2>
+      void taddMul(V1& res, const V2& vec) const
+      {
+          assert( vec.size()%bColSize() == 0 ); // vec.size() must be a multiple of block size.
 
-              // transfer the local result  to the large result vector
-              //Index iN = rowIndex[xi] * NL;                      // scalar row index
-              for (Index bi = 0; bi < NL; ++bi)
-                  vadd(res, rowIndex[xi], NL, bi, r[bi]);
-          }
+          ((Matrix*)this)->compress();
+          vresize( res, rowBSize(), rowSize() );
+          tmulAllRows<Real2, true>(res, vec);
       }
 
 
@@ -1357,15 +1563,11 @@ protected:
           }
       }
 
-      /** Product of the transpose with a templated vector and add it to res   res += this^T * vec */
-      template<class Real2, class V1, class V2>
-      void taddMulTranspose(V1& res, const V2& vec) const
+      /** Product of the transpose of the non-empty block rows [xbegin,xend) with a templated vector, accumulated with accumulate(blockColumn, r) */
+      template<class Real2, class V2, class Accumulate>
+      void tmulTransposeRows(const V2& vec, Index xbegin, Index xend, const Accumulate& accumulate) const
       {
-          assert( vec.size()%bRowSize() == 0 ); // vec.size() must be a multiple of block size.
-
-          ((Matrix*)this)->compress();
-          vresize( res, colBSize(), colSize() );
-          for (Index xi = 0; xi < rowIndex.size(); ++xi) // for each non-empty block row (i.e. column of the transpose)
+          for (Index xi = xbegin; xi < xend; ++xi) // for each non-empty block row (i.e. column of the transpose)
           {
               // copy the corresponding chunk of the input to a local vector
               type::Vec<NL,Real2> v;
@@ -1390,12 +1592,69 @@ protected:
                           r[bj] += traits::v(b, bi, bj) * v[bi];
 
                   // accumulate the product to the result
-                  for (Index bj = 0; bj < NC; ++bj)
-                      vadd(res, colsIndex[xj], NC, bj, r[bj]);
+                  accumulate(colsIndex[xj], r);
               }
           }
       }
 
+      /** Product of the transpose with a templated vector and add it to res   res += this^T * vec */
+      template<class Real2, class V1, class V2>
+      void taddMulTranspose(V1& res, const V2& vec) const
+      {
+          assert( vec.size()%bRowSize() == 0 ); // vec.size() must be a multiple of block size.
+
+          ((Matrix*)this)->compress();
+          vresize( res, colBSize(), colSize() );
+
+          const Index nbRows = (Index)rowIndex.size();
+          if (!useParallelProducts())
+          {
+              tmulTransposeRows<Real2>(vec, Index(0), nbRows, [&](Index col, const type::Vec<NC,Real2>& r)
+              {
+                  for (Index bj = 0; bj < NC; ++bj)
+                      vadd(res, col, NC, bj, r[bj]);
+              });
+              return;
+          }
+
+          // Several rows write in the same entries of res: each partition of the rows is accumulated in its
+          // own buffer, in double so that the product keeps the precision of the vectors whatever their scalar
+          // type, then the buffers are summed column by column, in the order of the rows.
+          const Index nbPartitions = std::min<Index>(TransposeProductPartitions, nbRows / ParallelProductGrainSize);
+          const Index rowsPerPartition = (nbRows + nbPartitions - 1) / nbPartitions;
+          const Index bufferSize = colBSize() * NC;
+          type::vector< type::vector<double> > buffers(nbPartitions);
+
+          parallelProductRanges(std::size_t(nbPartitions), 1, [&](std::size_t pbegin, std::size_t pend)
+          {
+              for (Index p = Index(pbegin); p < Index(pend); ++p)
+              {
+                  type::vector<double>& buffer = buffers[p];
+                  buffer.assign(bufferSize, 0.0);
+                  tmulTransposeRows<Real2>(vec, p * rowsPerPartition, std::min(nbRows, (p+1) * rowsPerPartition), [&](Index col, const type::Vec<NC,Real2>& r)
+                  {
+                      for (Index bj = 0; bj < NC; ++bj)
+                          buffer[col * NC + bj] += r[bj];
+                  });
+              }
+          });
+
+          parallelProductRanges(std::size_t(colBSize()), std::size_t(ParallelProductGrainSize), [&](std::size_t cbegin, std::size_t cend)
+          {
+              for (Index col = Index(cbegin); col < Index(cend); ++col)
+              {
+                  for (Index bj = 0; bj < NC; ++bj)
+                  {
+                      double sum = buffers[0][col * NC + bj];
+                      for (Index p = 1; p < nbPartitions; ++p)
+                          sum += buffers[p][col * NC + bj];
+                      if (sum != 0)
+                          vaddProduct(res, col, NC, bj, Real2(sum));
+                  }
+              }
+          });
+      }
+
 
 /// @}
 
@@ -170,9 +170,15 @@ public:
     typedef typename MatrixLinearSolverInternalData<Vector>::JMatrixType JMatrixType;
     typedef typename MatrixLinearSolverInternalData<Vector>::ResMatrixType ResMatrixType;
 
+    Data<bool> d_parallelProducts; ///< Compute the products of the assembled system matrix with vectors concurrently
+    Data<bool> d_parallelAssembly; ///< Assemble concurrently the force fields and masses declaring a thread-safe assembly
+    Data<bool> d_patternLocking; ///< Record the sparsity pattern of the assembled system matrix and reuse it in the following assemblies
+
     MatrixLinearSolver();
     ~MatrixLinearSolver() override ;
 
+    void init() override;
+
     /// Reset the current linear system.
     void resetSystem() override;
 
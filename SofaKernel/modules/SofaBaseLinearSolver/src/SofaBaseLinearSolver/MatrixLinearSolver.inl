@@ -21,6 +21,7 @@
 ******************************************************************************/
 #pragma once
 #include <SofaBaseLinearSolver/MatrixLinearSolver.h>
+#include <sofa/simulation/TaskScheduler.h>
 
 #include <sofa/simulation/mechanicalvisitor/MechanicalGetConstraintJacobianVisitor.h>
 using sofa::simulation::mechanicalvisitor::MechanicalGetConstraintJacobianVisitor;
@@ -37,9 +38,41 @@ using sofa::simulation::mechanicalvisitor::MechanicalMultiVectorPeqBaseVectorVis
 namespace sofa::component::linearsolver
 {
 
+namespace matrixlinearsolver
+{
+
+/// Forward the parallelProducts option to the matrix types supporting it (e.g. CompressedRowSparseMatrix)
+template<class TMatrix>
+auto setParallelProducts(TMatrix* matrix, bool parallel, int) -> decltype(matrix->setParallelProducts(parallel), void())
+{
+    matrix->setParallelProducts(parallel);
+}
+
+template<class TMatrix>
+void setParallelProducts(TMatrix* /*matrix*/, bool /*parallel*/, long)
+{
+}
+
+/// Forward the patternLocking option to the matrix types supporting it (e.g. CompressedRowSparseMatrix)
+template<class TMatrix>
+auto setPatternLocking(TMatrix* matrix, bool locking, int) -> decltype(matrix->setPatternLocking(locking), void())
+{
+    matrix->setPatternLocking(locking);
+}
+
+template<class TMatrix>
+void setPatternLocking(TMatrix* /*matrix*/, bool /*locking*/, long)
+{
+}
+
+} // namespace matrixlinearsolver
+
 template<class Matrix, class Vector>
 MatrixLinearSolver<Matrix,Vector>::MatrixLinearSolver()
     : Inherit()
+    , d_parallelProducts(initData(&d_parallelProducts, false, "parallelProducts", "Compute the products of the assembled system matrix with vectors concurrently, using the task scheduler (compressed row sparse matrices only)"))
+    , d_parallelAssembly(initData(&d_parallelAssembly, false, "parallelAssembly", "Assemble concurrently the force fields and masses declaring a thread-safe assembly, using the task scheduler. Each one writes in its own buffer, then the buffers are written in the system matrix in the scene order"))
+    , d_patternLocking(initData(&d_patternLocking, false, "patternLocking", "Record the sparsity pattern of the assembled system matrix and write the following assemblies directly at the recorded positions. The pattern is recorded again when it changes (compressed row sparse matrices only)"))
     , invertData()
     , linearSystem()
     , currentMFactor(), currentBFactor(), currentKFactor()
@@ -49,6 +82,17 @@ MatrixLinearSolver<Matrix,Vector>::MatrixLinearSolver()
 template<class Matrix, class Vector>
 MatrixLinearSolver<Matrix,Vector>::~MatrixLinearSolver() = default;
 
+template<class Matrix, class Vector>
+void MatrixLinearSolver<Matrix,Vector>::init()
+{
+    Inherit::init();
+
+    if (d_parallelProducts.getValue() || d_parallelAssembly.getValue())
+    {
+        simulation::TaskScheduler::getInstance()->init();
+    }
+}
+
 template<class Matrix, class Vector>
 MatrixInvertData * MatrixLinearSolver<Matrix,Vector>::getMatrixInvertData(defaulttype::BaseMatrix * /*m*/)
 {
@@ -86,6 +130,8 @@ void MatrixLinearSolver<Matrix,Vector>::resizeSystem(Size n)
     {
         if (!linearSystem.systemMatrix) linearSystem.systemMatrix = createMatrix();
         linearSystem.systemMatrix->resize(n, n);
+        matrixlinearsolver::setParallelProducts(linearSystem.systemMatrix, d_parallelProducts.getValue(), 0);
+        matrixlinearsolver::setPatternLocking(linearSystem.systemMatrix, d_patternLocking.getValue(), 0);
     }
 
     if (!linearSystem.systemRHVector) linearSystem.systemRHVector = createPersistentVector();
@@ -102,6 +148,8 @@ void MatrixLinearSolver<Matrix,Vector>::setSystemMatrix(Matrix * matrix)
 {
     linearSystem.systemMatrix = matrix;
     if (matrix!=nullptr) {
+        matrixlinearsolver::setParallelProducts(matrix, d_parallelProducts.getValue(), 0);
+        matrixlinearsolver::setPatternLocking(matrix, d_patternLocking.getValue(), 0);
         if (!linearSystem.systemRHVector) linearSystem.systemRHVector = createPersistentVector();
         linearSystem.systemRHVector->resize(matrix->colSize());
         if (!linearSystem.systemLHVector) linearSystem.systemLHVector = createPersistentVector();
@@ -140,7 +188,7 @@ void MatrixLinearSolver<Matrix,Vector>::setSystemMBKMatrix(const core::Mechanica
         linearSystem.matrixAccessor.setupMatrices();
         resizeSystem(linearSystem.matrixAccessor.getGlobalDimension());
         linearSystem.systemMatrix->clear();
-        mops.addMBK_ToMatrix(&(linearSystem.matrixAccessor), mparams->mFactor(), sofa::core::mechanicalparams::bFactor(mparams), mparams->kFactor());
+        mops.addMBK_ToMatrix(&(linearSystem.matrixAccessor), mparams->mFactor(), sofa::core::mechanicalparams::bFactor(mparams), mparams->kFactor(), d_parallelAssembly.getValue());
         linearSystem.matrixAccessor.computeGlobalMatrix();
     }
 
@@ -163,7 +211,7 @@ void MatrixLinearSolver<Matrix,Vector>::rebuildSystem(double massFactor, double
         linearSystem.matrixAccessor.setupMatrices();
         resizeSystem(linearSystem.matrixAccessor.getGlobalDimension());
         linearSystem.systemMatrix->clear();
-        mops.addMBK_ToMatrix(&(linearSystem.matrixAccessor), mparams.mFactor(), mparams.bFactor(), mparams.kFactor());
+        mops.addMBK_ToMatrix(&(linearSystem.matrixAccessor), mparams.mFactor(), mparams.bFactor(), mparams.kFactor(), d_parallelAssembly.getValue());
         linearSystem.matrixAccessor.computeGlobalMatrix();
     }
 
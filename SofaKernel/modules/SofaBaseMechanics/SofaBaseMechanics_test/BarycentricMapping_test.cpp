@@ -21,14 +21,23 @@
 ******************************************************************************/
 #include <SofaBaseMechanics/BarycentricMapping.h>
 #include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperTriangleSetTopology.h>
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricPointLocator.h>
+#include <sofa/simulation/TaskScheduler.h>
 using sofa::component::mapping::BarycentricMapperTriangleSetTopology;
+using sofa::component::mapping::BarycentricPointLocator;
 using sofa::component::mapping::BarycentricMapping;
 
 #include <SofaBaseTopology/TriangleSetTopologyContainer.h>
 #include <SofaBaseTopology/TetrahedronSetTopologyContainer.h>
+#include <SofaBaseTopology/TetrahedronSetTopologyModifier.h>
+#include <SofaBaseTopology/PointSetTopologyContainer.h>
+#include <SofaBaseTopology/PointSetTopologyModifier.h>
 #include <sofa/core/topology/BaseMeshTopology.h>
 using sofa::component::topology::TriangleSetTopologyContainer;
 using sofa::component::topology::TetrahedronSetTopologyContainer;
+using sofa::component::topology::TetrahedronSetTopologyModifier;
+using sofa::component::topology::PointSetTopologyContainer;
+using sofa::component::topology::PointSetTopologyModifier;
 using sofa::core::topology::BaseMeshTopology;
 
 #include <sofa/testing/BaseTest.h>
@@ -50,7 +59,11 @@ using sofa::core::objectmodel::BaseData ;
 #include <SofaBaseMechanics/MechanicalObject.h>
 using sofa::component::container::MechanicalObject ;
 
+#include <SofaBaseVisual/VisualModelImpl.h>
+using sofa::component::visualmodel::VisualModelImpl ;
+
 #include <sofa/simulation/Node.h>
+#include <sofa/core/MechanicalParams.h>
 
 using sofa::defaulttype::Vec3dTypes;
 
@@ -60,16 +73,13 @@ struct BarycentricMapperTriangleSetTopologyTest :  public BaseTest, public Baryc
     typedef BarycentricMapperTriangleSetTopology<In,Out> Inherit;
     typedef typename In::Real Real;
 
-    using Inherit::m_hashTable;
-    using Inherit::m_hashTableSize;
     using Inherit::m_gridCellSize;
     using Inherit::m_convFactor;
     using Inherit::m_fromTopology;
     using Inherit::d_map;
 
-    using Inherit::computeHashTable;
     using Inherit::getGridIndices;
-    using Inherit::initHashing;
+    using Inherit::computeHashingCellSize;
     using Inherit::init;
 
     typename In::VecCoord m_in;
@@ -89,7 +99,7 @@ struct BarycentricMapperTriangleSetTopologyTest :  public BaseTest, public Baryc
         m_fromTopology = m_topology.get();
         m_fromTopology->addTriangle(0, 1, 2);
 
-        initHashing(m_in);
+        computeHashingCellSize(m_in);
     }
 
     void scene_test(){
@@ -147,3 +157,425 @@ TEST_F(BarycentricMapperTriangleSetTopologyTest_d, initHashing)
 }
 
 
+/// Tetrahedra of a perturbed grid, compared against an exhaustive search over all the elements
+struct BarycentricPointLocatorTest : public BaseTest
+{
+    sofa::type::vector<Vector3> m_positions;
+    sofa::type::vector<sofa::type::fixed_array<sofa::Index, 4> > m_tetras;
+    sofa::type::vector<sofa::type::Mat3x3d> m_bases;
+    sofa::type::vector<Vector3> m_centers;
+
+    void SetUp() override
+    {
+        const int n = 6;
+        for (int z = 0; z <= n; ++z)
+            for (int y = 0; y <= n; ++y)
+                for (int x = 0; x <= n; ++x)
+                    m_positions.push_back(Vector3(x + 0.2 * std::sin(3.0 * y + z), y + 0.2 * std::cos(x + 2.0 * z), 2.0 * z + 0.3 * std::sin(x * y)));
+
+        const auto id = [n](int x, int y, int z) { return sofa::Index((z * (n + 1) + y) * (n + 1) + x); };
+        for (int z = 0; z < n; ++z)
+            for (int y = 0; y < n; ++y)
+                for (int x = 0; x < n; ++x)
+                {
+                    // split each cube in 6 tetrahedra around its diagonal
+                    const sofa::Index c[8] = { id(x,y,z), id(x+1,y,z), id(x+1,y+1,z), id(x,y+1,z),
+                                               id(x,y,z+1), id(x+1,y,z+1), id(x+1,y+1,z+1), id(x,y+1,z+1) };
+                    m_tetras.push_back({ c[0], c[1], c[2], c[6] });
+                    m_tetras.push_back({ c[0], c[2], c[3], c[6] });
+                    m_tetras.push_back({ c[0], c[3], c[7], c[6] });
+                    m_tetras.push_back({ c[0], c[7], c[4], c[6] });
+                    m_tetras.push_back({ c[0], c[4], c[5], c[6] });
+                    m_tetras.push_back({ c[0], c[5], c[1], c[6] });
+                }
+
+        for (const auto& t : m_tetras)
+        {
+            sofa::type::Mat3x3d m, mt, base;
+            m[0] = m_positions[t[1]] - m_positions[t[0]];
+            m[1] = m_positions[t[2]] - m_positions[t[0]];
+            m[2] = m_positions[t[3]] - m_positions[t[0]];
+            mt.transpose(m);
+            base.invert(mt);
+            m_bases.push_back(base);
+            m_centers.push_back((m_positions[t[0]] + m_positions[t[1]] + m_positions[t[2]] + m_positions[t[3]]) * 0.25);
+        }
+    }
+
+    double distance(const sofa::Index e, const Vector3& pos, Vector3& v) const
+    {
+        v = m_bases[e] * (pos - m_positions[m_tetras[e][0]]);
+        double d = std::max(std::max(-v[0], -v[1]), std::max(-v[2], v[0] + v[1] + v[2] - 1));
+        if (d > 0) d = (pos - m_centers[e]).norm2();
+        return d;
+    }
+
+    sofa::Index findNearestExhaustive(const Vector3& pos) const
+    {
+        sofa::Index nearest = sofa::InvalidID;
+        double nearestDistance = std::numeric_limits<double>::max();
+        Vector3 v;
+        for (sofa::Index e = 0; e < m_tetras.size(); ++e)
+        {
+            const double d = distance(e, pos, v);
+            if (d < nearestDistance) { nearestDistance = d; nearest = e; }
+        }
+        return nearest;
+    }
+
+    void findNearestElements_test(SReal cellSize)
+    {
+        sofa::type::vector<BarycentricPointLocator::Box> boxes;
+        for (const auto& t : m_tetras)
+            boxes.push_back(BarycentricPointLocator::computeBox(m_positions, t));
+
+        BarycentricPointLocator locator;
+        locator.build(boxes, cellSize);
+        EXPECT_EQ(locator.getNbElements(), m_tetras.size());
+
+        // points inside the mesh, on its vertices and far outside of it
+        sofa::type::vector<Vector3> points;
+        for (int i = 0; i < 500; ++i)
+            points.push_back(Vector3(-3.0 + 0.025 * i, -2.0 + 0.02 * i + std::sin(double(i)), -4.0 + 0.04 * i));
+        points.insert(points.end(), m_positions.begin(), m_positions.end());
+        points.push_back(Vector3(100, -50, 3));
+
+        sofa::type::vector<sofa::Index> elements;
+        sofa::type::vector<Vector3> coefs;
+        const bool hasScheduler = sofa::simulation::TaskScheduler::getCurrentInstance() != nullptr;
+        locator.findNearestElements(points.size(), [&](std::size_t i) { return points[i]; },
+                                    [this](sofa::Index e, const Vector3& pos, Vector3& v) { return distance(e, pos, v); },
+                                    elements, coefs);
+
+        // the locator does not create the task scheduler
+        if (!hasScheduler)
+            EXPECT_EQ(sofa::simulation::TaskScheduler::getCurrentInstance(), nullptr);
+
+        ASSERT_EQ(elements.size(), points.size());
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            EXPECT_EQ(elements[i], findNearestExhaustive(points[i])) << "point " << i;
+            Vector3 v;
+            distance(elements[i], points[i], v);
+            EXPECT_EQ(coefs[i], v);
+        }
+    }
+};
+
+TEST_F(BarycentricPointLocatorTest, findNearestElements)
+{
+    findNearestElements_test(0);
+}
+
+TEST_F(BarycentricPointLocatorTest, findNearestElementsSmallCells)
+{
+    findNearestElements_test(0.1);
+}
+
+TEST_F(BarycentricPointLocatorTest, findNearestElementsParallel)
+{
+    sofa::simulation::TaskScheduler::getInstance()->init(4);
+    findNearestElements_test(0);
+    sofa::simulation::TaskScheduler::getInstance()->stop();
+}
+
+TEST(BarycentricPointLocator, empty)
+{
+    BarycentricPointLocator locator;
+    locator.build({});
+    Vector3 coefs;
+    EXPECT_EQ(locator.findNearestElement(Vector3(0, 0, 0), [](sofa::Index, const Vector3&, Vector3&) { return 0.0; }, coefs), sofa::InvalidID);
+}
+
+
+/// The mapping frozen in a sparse Jacobian gives the same results as the mapper
+struct BarycentricMappingSparseJacobianTest : public BaseTest
+{
+    typedef BarycentricMapping<Vec3dTypes, Vec3dTypes> Mapping;
+    typedef Vec3dTypes::VecCoord VecCoord;
+    typedef Vec3dTypes::VecDeriv VecDeriv;
+
+    Node::SPtr m_root;
+    MechanicalObject<Vec3dTypes>::SPtr m_in;
+
+    Mapping::SPtr createMapping(const std::string& name, const VecCoord& outPositions, bool useSparseJacobian)
+    {
+        Node::SPtr node = m_root->createChild(name);
+        MechanicalObject<Vec3dTypes>::SPtr out = New<MechanicalObject<Vec3dTypes>>();
+        out->x.setValue(outPositions);
+        node->addObject(out);
+
+        Mapping::SPtr mapping = New<Mapping>();
+        mapping->setModels(m_in.get(), out.get());
+        mapping->d_useSparseJacobian.setValue(useSparseJacobian);
+        node->addObject(mapping);
+        return mapping;
+    }
+
+    void compare_test()
+    {
+        Simulation* simu;
+        setSimulation(simu = new DAGSimulation());
+        m_root = simu->createNewGraph("root");
+
+        TetrahedronSetTopologyContainer::SPtr topology = New<TetrahedronSetTopologyContainer>();
+        topology->addTetra(0, 1, 2, 3);
+        topology->addTetra(1, 2, 3, 4);
+        m_root->addObject(topology);
+
+        m_in = New<MechanicalObject<Vec3dTypes>>();
+        m_in->x.setValue(VecCoord{ {0,0,0}, {1,0,0}, {0,1,0}, {0,0,1}, {1,1,1} });
+        m_root->addObject(m_in);
+
+        const VecCoord outPositions{ {0.1,0.1,0.1}, {0.5,0.5,0.5}, {0.2,0.3,0.1}, {0.9,0.8,0.7}, {2,2,2}, {0,0,0} };
+        const Mapping::SPtr mapping = createMapping("mapper", outPositions, false);
+        const Mapping::SPtr sparseMapping = createMapping("sparse", outPositions, true);
+
+        EXPECT_NO_THROW(simu->init(m_root.get()));
+
+        const auto* mparams = sofa::core::MechanicalParams::defaultInstance();
+        const VecCoord inPositions{ {0,0,0.2}, {1.1,0,0}, {0,1,0.3}, {0,-0.1,1}, {1,1.2,1} };
+        const VecDeriv inVelocities{ {1,2,3}, {-1,0,1}, {0.5,0.5,0}, {0,0,-2}, {3,1,1} };
+        const VecDeriv outForces{ {1,0,0}, {0,1,0}, {0,0,1}, {1,1,1}, {-1,2,0}, {0.5,0,0.5} };
+
+        sofa::Data<VecCoord> in(inPositions), out, sparseOut;
+        mapping->apply(mparams, out, in);
+        sparseMapping->apply(mparams, sparseOut, in);
+        EXPECT_TRUE(sparseMapping->d_useSparseJacobian.getValue());
+        ASSERT_EQ(out.getValue().size(), outPositions.size());
+        ASSERT_EQ(sparseOut.getValue().size(), outPositions.size());
+        for (std::size_t i = 0; i < outPositions.size(); ++i)
+            for (int k = 0; k < 3; ++k)
+                EXPECT_NEAR(sparseOut.getValue()[i][k], out.getValue()[i][k], 1e-12);
+
+        sofa::Data<VecDeriv> inVel(inVelocities), outVel, sparseOutVel;
+        mapping->applyJ(mparams, outVel, inVel);
+        sparseMapping->applyJ(mparams, sparseOutVel, inVel);
+        ASSERT_EQ(sparseOutVel.getValue().size(), outVel.getValue().size());
+        for (std::size_t i = 0; i < outVel.getValue().size(); ++i)
+            for (int k = 0; k < 3; ++k)
+                EXPECT_NEAR(sparseOutVel.getValue()[i][k], outVel.getValue()[i][k], 1e-12);
+
+        // applyJT accumulates into the input forces
+        sofa::Data<VecDeriv> outF(outForces), inF(VecDeriv(inPositions.size(), {1,1,1})), sparseInF(inF.getValue());
+        mapping->applyJT(mparams, inF, outF);
+        sparseMapping->applyJT(mparams, sparseInF, outF);
+        for (std::size_t i = 0; i < inPositions.size(); ++i)
+            for (int k = 0; k < 3; ++k)
+                EXPECT_NEAR(sparseInF.getValue()[i][k], inF.getValue()[i][k], 1e-12);
+
+        sofa::simulation::getSimulation()->unload(m_root);
+    }
+
+    /// Root with two tetrahedra, and a mapping to the given points with and without the sparse Jacobian
+    void createScene(const VecCoord& outPositions, bool outputTopology)
+    {
+        Simulation* simu;
+        setSimulation(simu = new DAGSimulation());
+        m_root = simu->createNewGraph("root");
+
+        m_topology = New<TetrahedronSetTopologyContainer>();
+        m_topology->addTetra(0, 1, 2, 3);
+        m_topology->addTetra(1, 2, 3, 4);
+        m_root->addObject(m_topology);
+        m_root->addObject(New<TetrahedronSetTopologyModifier>());
+
+        m_in = New<MechanicalObject<Vec3dTypes>>();
+        m_in->x.setValue(VecCoord{ {0,0,0}, {1,0,0}, {0,1,0}, {0,0,1}, {1,1,1} });
+        m_root->addObject(m_in);
+
+        m_mapping = createMapping("mapper", outPositions, false);
+        m_sparseMapping = createMapping("sparse", outPositions, true);
+        if (outputTopology)
+        {
+            for (const Mapping::SPtr& mapping : { m_mapping, m_sparseMapping })
+            {
+                Node* node = static_cast<Node*>(mapping->getContext());
+                PointSetTopologyContainer::SPtr container = New<PointSetTopologyContainer>();
+                container->setNbPoints(outPositions.size());
+                node->addObject(container);
+                node->addObject(New<PointSetTopologyModifier>());
+            }
+        }
+
+        EXPECT_NO_THROW(simu->init(m_root.get()));
+    }
+
+    /// The output states of both mappings
+    MechanicalObject<Vec3dTypes>* getOutput(const Mapping::SPtr& mapping)
+    {
+        return static_cast<MechanicalObject<Vec3dTypes>*>(mapping->getToModel());
+    }
+
+    void setOutPositions(const VecCoord& outPositions)
+    {
+        for (const Mapping::SPtr& mapping : { m_mapping, m_sparseMapping })
+        {
+            getOutput(mapping)->resize(sofa::Size(outPositions.size()));
+            getOutput(mapping)->x.setValue(outPositions);
+            getOutput(mapping)->x0.setValue(outPositions);
+        }
+    }
+
+    /// apply, applyJ and applyJT give the same results with and without the sparse Jacobian
+    void expectSameResults()
+    {
+        const auto* mparams = sofa::core::MechanicalParams::defaultInstance();
+        const std::size_t outSize = getOutput(m_mapping)->getSize();
+        ASSERT_EQ(getOutput(m_sparseMapping)->getSize(), outSize);
+        const std::size_t inSize = m_in->getSize();
+
+        VecCoord inPositions(inSize);
+        VecDeriv inVelocities(inSize);
+        for (std::size_t i = 0; i < inSize; ++i)
+        {
+            inPositions[i] = m_in->x.getValue()[i] + Vector3(0.1 * double(i), -0.05, 0.02 * double(i * i));
+            inVelocities[i] = Vector3(1.0 - double(i), 0.5, double(i) * 0.3);
+        }
+        VecDeriv outForces(outSize);
+        for (std::size_t i = 0; i < outSize; ++i)
+            outForces[i] = Vector3(double(i), 1.0, -0.5 * double(i));
+
+        sofa::Data<VecCoord> in(inPositions), out, sparseOut;
+        m_mapping->apply(mparams, out, in);
+        m_sparseMapping->apply(mparams, sparseOut, in);
+        EXPECT_TRUE(m_sparseMapping->d_useSparseJacobian.getValue());
+        ASSERT_EQ(sparseOut.getValue().size(), out.getValue().size());
+        for (std::size_t i = 0; i < out.getValue().size(); ++i)
+            for (int k = 0; k < 3; ++k)
+                EXPECT_NEAR(sparseOut.getValue()[i][k], out.getValue()[i][k], 1e-12);
+
+        sofa::Data<VecDeriv> inVel(inVelocities), outVel, sparseOutVel;
+        m_mapping->applyJ(mparams, outVel, inVel);
+        m_sparseMapping->applyJ(mparams, sparseOutVel, inVel);
+        ASSERT_EQ(sparseOutVel.getValue().size(), outVel.getValue().size());
+        for (std::size_t i = 0; i < outVel.getValue().size(); ++i)
+            for (int k = 0; k < 3; ++k)
+                EXPECT_NEAR(sparseOutVel.getValue()[i][k], outVel.getValue()[i][k], 1e-12);
+
+        sofa::Data<VecDeriv> outF(outForces), inF(VecDeriv(inSize, {1,1,1})), sparseInF(inF.getValue());
+        m_mapping->applyJT(mparams, inF, outF);
+        m_sparseMapping->applyJT(mparams, sparseInF, outF);
+        for (std::size_t i = 0; i < inSize; ++i)
+            for (int k = 0; k < 3; ++k)
+                EXPECT_NEAR(sparseInF.getValue()[i][k], inF.getValue()[i][k], 1e-12);
+    }
+
+    /// The sparse Jacobian is rebuilt by reinit when the number of outputs changes
+    void reinit_test()
+    {
+        createScene({ {0.1,0.1,0.1}, {0.5,0.5,0.5}, {0.2,0.3,0.1}, {0.9,0.8,0.7}, {2,2,2}, {0,0,0} }, false);
+        expectSameResults();
+
+        setOutPositions({ {0.9,0.8,0.7}, {0.2,0.1,0.3}, {0.4,0.4,0.4} });
+        m_mapping->reinit();
+        m_sparseMapping->reinit();
+        expectSameResults();
+
+        setOutPositions({ {0.1,0.2,0.3}, {0.7,0.6,0.8}, {1,1,0.9}, {-1,0,0}, {0.3,0.3,0.3}, {0.6,0.2,0.1}, {0,0,0.5}, {0.5,0.5,0} });
+        m_mapping->reinit();
+        m_sparseMapping->reinit();
+        expectSameResults();
+
+        sofa::simulation::getSimulation()->unload(m_root);
+    }
+
+    /// The sparse Jacobian is rebuilt after the removal of an element of the input topology
+    void removeElement_test()
+    {
+        createScene({ {0.1,0.1,0.1}, {0.5,0.5,0.5}, {0.2,0.3,0.1}, {0.9,0.8,0.7}, {2,2,2}, {0,0,0} }, false);
+        expectSameResults();
+
+        // the second tetrahedron takes the index of the first one
+        TetrahedronSetTopologyModifier* modifier = nullptr;
+        m_root->get(modifier);
+        ASSERT_NE(modifier, nullptr);
+        modifier->removeTetrahedra({ 0 }, false);
+        ASSERT_EQ(m_topology->getNbTetrahedra(), 1u);
+
+        m_mapping->reinit();
+        m_sparseMapping->reinit();
+        expectSameResults();
+
+        sofa::simulation::getSimulation()->unload(m_root);
+    }
+
+    /// The sparse Jacobian follows the removal of points of the output topology
+    void removeOutputPoints_test()
+    {
+        createScene({ {0.1,0.1,0.1}, {0.5,0.5,0.5}, {0.2,0.3,0.1}, {0.9,0.8,0.7}, {2,2,2}, {0,0,0} }, true);
+        expectSameResults();
+
+        for (const Mapping::SPtr& mapping : { m_mapping, m_sparseMapping })
+        {
+            PointSetTopologyModifier* modifier = nullptr;
+            mapping->getContext()->get(modifier);
+            ASSERT_NE(modifier, nullptr);
+            sofa::type::vector<sofa::Index> points { 1, 4 };
+            modifier->removePoints(points, true);
+            ASSERT_EQ(getOutput(mapping)->getSize(), 4u);
+        }
+        expectSameResults();
+
+        sofa::simulation::getSimulation()->unload(m_root);
+    }
+
+    /// The sparse Jacobian is also used for an output state without force mask, such as a visual model
+    void visualOutput_test()
+    {
+        const VecCoord outPositions{ {0.1,0.1,0.1}, {0.5,0.5,0.5}, {0.2,0.3,0.1}, {0.9,0.8,0.7}, {2,2,2}, {0,0,0} };
+        createScene(outPositions, false);
+
+        Node::SPtr node = m_root->createChild("visual");
+        VisualModelImpl::SPtr visual = New<VisualModelImpl>();
+        visual->write(sofa::core::VecCoordId::position())->setValue(outPositions);
+        node->addObject(visual);
+
+        Mapping::SPtr visualMapping = New<Mapping>();
+        visualMapping->setModels(m_in.get(), visual.get());
+        visualMapping->d_useSparseJacobian.setValue(true);
+        node->addObject(visualMapping);
+        EXPECT_NO_THROW(node->init(sofa::core::execparams::defaultInstance()));
+
+        const auto* mparams = sofa::core::MechanicalParams::defaultInstance();
+        sofa::Data<VecCoord> in(VecCoord{ {0,0,0.2}, {1.1,0,0}, {0,1,0.3}, {0,-0.1,1}, {1,1.2,1} }), out, visualOut;
+        m_mapping->apply(mparams, out, in);
+        visualMapping->apply(mparams, visualOut, in);
+        EXPECT_TRUE(visualMapping->d_useSparseJacobian.getValue());
+        ASSERT_EQ(visualOut.getValue().size(), out.getValue().size());
+        for (std::size_t i = 0; i < out.getValue().size(); ++i)
+            for (int k = 0; k < 3; ++k)
+                EXPECT_NEAR(visualOut.getValue()[i][k], out.getValue()[i][k], 1e-12);
+
+        sofa::simulation::getSimulation()->unload(m_root);
+    }
+
+    TetrahedronSetTopologyContainer::SPtr m_topology;
+    Mapping::SPtr m_mapping;
+    Mapping::SPtr m_sparseMapping;
+};
+
+TEST_F(BarycentricMappingSparseJacobianTest, compare)
+{
+    compare_test();
+}
+
+TEST_F(BarycentricMappingSparseJacobianTest, reinit)
+{
+    reinit_test();
+}
+
+TEST_F(BarycentricMappingSparseJacobianTest, removeElement)
+{
+    removeElement_test();
+}
+
+TEST_F(BarycentricMappingSparseJacobianTest, removeOutputPoints)
+{
+    removeOutputPoints_test();
+}
+
+TEST_F(BarycentricMappingSparseJacobianTest, visualOutput)
+{
+    visualOutput_test();
+}
@@ -20,6 +20,7 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include <SofaBaseMechanics/MechanicalObject.inl>
+#include <sofa/simulation/TaskScheduler.h>
 
 #include <sofa/testing/BaseTest.h>
 using sofa::testing::BaseTest;
@@ -110,6 +111,126 @@ TYPED_TEST(MechanicalObject_test, checkThatPositionDefaultValueIsAVectorOfValueI
     TestHelpers::CheckPosition(this->mechanicalObject);
 }
 
+TYPED_TEST(MechanicalObject_test, checkThatVMultiOpDotGivesTheSameResultAsVMultiOpAndVDot)
+{
+    using VecDeriv = typename TypeParam::VecDeriv;
+    using sofa::core::VecDerivId;
+    typedef core::behavior::BaseMechanicalState::VMultiOp VMultiOp;
+
+    constexpr Size n = 100;
+    StubMechanicalObject<TypeParam> fused;
+    StubMechanicalObject<TypeParam> separate;
+
+    // x = velocity, r = force, p = dx, q = externalForce
+    const VecDerivId x = VecDerivId::velocity();
+    const VecDerivId r = VecDerivId::force();
+    const VecDerivId p = VecDerivId::dx();
+    const VecDerivId q = VecDerivId::externalForce();
+    for (auto* mstate : {&fused, &separate})
+    {
+        for (const VecDerivId& v : {x, r, p, q})
+        {
+            helper::WriteOnlyAccessor<Data<VecDeriv> > vec = *mstate->write(v);
+            vec.resize(n);
+            for (Size i = 0; i < n; ++i)
+            {
+                for (Size j = 0; j < TypeParam::deriv_total_size; ++j)
+                {
+                    vec[i][j] = std::sin(SReal(i * TypeParam::deriv_total_size + j + v.getIndex()));
+                }
+            }
+        }
+    }
+
+    const SReal alpha = 0.3;
+    VMultiOp ops(2);
+    ops[0] = VMultiOp::value_type(x, x, p, alpha);
+    ops[1] = VMultiOp::value_type(r, r, q, -alpha);
+
+    const SReal fusedDot = fused.vMultiOpDot(nullptr, ops, r, r);
+    separate.vMultiOp(nullptr, ops);
+    const SReal separateDot = separate.vDot(nullptr, r, r);
+
+    EXPECT_EQ(fusedDot, separateDot);
+    for (const VecDerivId& v : {x, r})
+    {
+        const VecDeriv& fusedVec = fused.read(core::ConstVecDerivId(v))->getValue();
+        const VecDeriv& separateVec = separate.read(core::ConstVecDerivId(v))->getValue();
+        ASSERT_EQ(fusedVec.size(), n);
+        for (Size i = 0; i < n; ++i)
+        {
+            EXPECT_EQ(fusedVec[i], separateVec[i]);
+        }
+    }
+}
+
+TYPED_TEST(MechanicalObject_test, checkThatParallelVMultiOpDotIsReproducible)
+{
+    using VecDeriv = typename TypeParam::VecDeriv;
+    using sofa::core::VecDerivId;
+    typedef core::behavior::BaseMechanicalState::VMultiOp VMultiOp;
+
+    // large enough to be split in several ranges
+    constexpr Size n = 10000;
+    const VecDerivId x = VecDerivId::velocity();
+    const VecDerivId r = VecDerivId::force();
+    const VecDerivId p = VecDerivId::dx();
+    const VecDerivId q = VecDerivId::externalForce();
+    const auto initVectors = [&](StubMechanicalObject<TypeParam>& mstate)
+    {
+        for (const VecDerivId& v : {x, r, p, q})
+        {
+            helper::WriteOnlyAccessor<Data<VecDeriv> > vec = *mstate.write(v);
+            vec.resize(n);
+            for (Size i = 0; i < n; ++i)
+            {
+                for (Size j = 0; j < TypeParam::deriv_total_size; ++j)
+                {
+                    vec[i][j] = std::sin(SReal(i * TypeParam::deriv_total_size + j + v.getIndex()));
+                }
+            }
+        }
+    };
+
+    const SReal alpha = 0.3;
+    VMultiOp ops(2);
+    ops[0] = VMultiOp::value_type(x, x, p, alpha);
+    ops[1] = VMultiOp::value_type(r, r, q, -alpha);
+
+    StubMechanicalObject<TypeParam> separate;
+    initVectors(separate);
+    separate.vMultiOp(nullptr, ops);
+    const SReal separateDot = separate.vDot(nullptr, r, r);
+
+    SReal parallelDot[2];
+    const unsigned int nbThreads[2] = { 1, 4 };
+    for (int t = 0; t < 2; ++t)
+    {
+        simulation::TaskScheduler::getInstance()->init(nbThreads[t]);
+
+        StubMechanicalObject<TypeParam> parallel;
+        parallel.findData("parallelVMultiOpDot")->read("true");
+        initVectors(parallel);
+        parallelDot[t] = parallel.vMultiOpDot(nullptr, ops, r, r);
+
+        // the vector operations are the same as the sequential ones
+        for (const VecDerivId& v : {x, r})
+        {
+            const VecDeriv& parallelVec = parallel.read(core::ConstVecDerivId(v))->getValue();
+            const VecDeriv& separateVec = separate.read(core::ConstVecDerivId(v))->getValue();
+            ASSERT_EQ(parallelVec.size(), n);
+            for (Size i = 0; i < n; ++i)
+            {
+                EXPECT_EQ(parallelVec[i], separateVec[i]);
+            }
+        }
+    }
+
+    // the dot product is reduced in the same order for any number of threads
+    EXPECT_EQ(parallelDot[0], parallelDot[1]);
+    EXPECT_NEAR(parallelDot[0], separateDot, 1e-9 * separateDot);
+}
+
 } // namespace
 
 } // namespace sofa
@@ -56,6 +56,7 @@ public:
     void computeBase(Mat3x3d& base, const typename In::VecCoord& in, const Hexahedron& element) override;
     void computeCenter(Vector3& center, const typename In::VecCoord& in, const Hexahedron& element) override;
     void computeDistance(double& d, const Vector3& v) override;
+    BarycentricPointLocator::Box computeElementBox(const typename In::VecCoord& in, const Hexahedron& element) override;
     void addPointInElement(const Index elementIndex, const SReal* baryCoords) override;
 
     Index addPointInCube(const Index index, const SReal* baryCoords) override;
@@ -148,6 +148,12 @@ void BarycentricMapperHexahedronSetTopology<In,Out>::computeDistance(double& d,
 }
 
 
+template <class In, class Out>
+BarycentricPointLocator::Box BarycentricMapperHexahedronSetTopology<In,Out>::computeElementBox(const typename In::VecCoord& in, const Hexahedron& element)
+{
+    return BarycentricPointLocator::computeHexahedronBox(in, element);
+}
+
 template <class In, class Out>
 void BarycentricMapperHexahedronSetTopology<In,Out>::addPointInElement(const Index elementIndex, const SReal* baryCoords)
 {
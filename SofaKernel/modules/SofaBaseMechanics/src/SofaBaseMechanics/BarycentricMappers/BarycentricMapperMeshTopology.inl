@@ -21,6 +21,7 @@
 ******************************************************************************/
 #pragma once
 #include <SofaBaseMechanics/BarycentricMappers/BarycentricMapperMeshTopology.h>
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricPointLocator.h>
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/core/State.h>
 
@@ -144,30 +145,43 @@ void BarycentricMapperMeshTopology<In,Out>::init ( const typename Out::VecCoord&
                 bases[nbTriangles+q].invert ( mt );
                 centers[nbTriangles+q] = ( in[quads[q][0]]+in[quads[q][1]]+in[quads[q][2]]+in[quads[q][3]] ) *0.25;
             }
-            for ( std::size_t i=0; i<out.size(); i++ )
+            type::vector<BarycentricPointLocator::Box> boxes ( triangles.size() +quads.size() );
+            for ( std::size_t t = 0; t < triangles.size(); t++ )
+                boxes[t] = BarycentricPointLocator::computeTriangleBox ( in, triangles[t] );
+            for ( std::size_t q = 0; q < quads.size(); q++ )
+                boxes[nbTriangles+q] = BarycentricPointLocator::computeQuadBox ( in, quads[q] );
+
+            BarycentricPointLocator locator;
+            locator.build ( boxes );
+
+            const auto distance = [&] ( const Index e, const Vector3& outPos, Vector3& v )
             {
-                Vector3 outPos = Out::getCPos(out[i]);
-                Vector3 coefs;
-                Index index = sofa::InvalidID;
-                double distance = 1e10;
-                for ( Index t = 0; t < triangles.size(); t++ )
+                double d;
+                if ( e < nbTriangles )
                 {
-                    Vec3d v = bases[t] * ( outPos - in[triangles[t][0]] );
-                    double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( ( v[2]<0?-v[2]:v[2] )-0.01,v[0]+v[1]-1 ) );
-                    if ( d>0 ) d = ( outPos-centers[t] ).norm2();
-                    if ( d<distance ) { coefs = v; distance = d; index = (t); }
+                    v = bases[e] * ( outPos - in[triangles[e][0]] );
+                    d = std::max ( std::max ( -v[0],-v[1] ),std::max ( ( v[2]<0?-v[2]:v[2] )-0.01,v[0]+v[1]-1 ) );
                 }
-                for ( Index q = 0; q < quads.size(); q++ )
+                else
                 {
-                    Vec3d v = bases[nbTriangles+q] * ( outPos - in[quads[q][0]] );
-                    double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( v[1]-1,v[0]-1 ),std::max ( v[2]-0.01,-v[2]-0.01 ) ) );
-                    if ( d>0 ) d = ( outPos-centers[nbTriangles+q] ).norm2();
-                    if ( d<distance ) { coefs = v; distance = d; index = nbTriangles+q; }
+                    v = bases[e] * ( outPos - in[quads[e-nbTriangles][0]] );
+                    d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( v[1]-1,v[0]-1 ),std::max ( v[2]-0.01,-v[2]-0.01 ) ) );
                 }
+                if ( d>0 ) d = ( outPos-centers[e] ).norm2();
+                return d;
+            };
+
+            type::vector<Index> indices;
+            type::vector<Vector3> coefs;
+            locator.findNearestElements ( out.size(), [&] ( std::size_t i ) { return Out::getCPos(out[i]); }, distance, indices, coefs );
+
+            for ( std::size_t i=0; i<out.size(); i++ )
+            {
+                const Index index = indices[i];
                 if ( index < (nbTriangles) )
-                    addPointInTriangle ( index, coefs.ptr() );
+                    addPointInTriangle ( index, coefs[i].ptr() );
                 else
-                    addPointInQuad ( index-nbTriangles, coefs.ptr() );
+                    addPointInQuad ( index-nbTriangles, coefs[i].ptr() );
             }
         }
     }
@@ -197,30 +211,43 @@ void BarycentricMapperMeshTopology<In,Out>::init ( const typename Out::VecCoord&
             bases[nbTetras+h].invert ( mt );
             centers[nbTetras+h] = ( in[hexas[h][0]]+in[hexas[h][1]]+in[hexas[h][2]]+in[hexas[h][3]]+in[hexas[h][4]]+in[hexas[h][5]]+in[hexas[h][6]]+in[hexas[h][7]] ) *0.125;
         }
-        for ( std::size_t i=0; i<out.size(); i++ )
+        type::vector<BarycentricPointLocator::Box> boxes ( tetras.size() + hexas.size() );
+        for ( std::size_t t = 0; t < tetras.size(); t++ )
+            boxes[t] = BarycentricPointLocator::computeBox ( in, tetras[t] );
+        for ( std::size_t h = 0; h < hexas.size(); h++ )
+            boxes[nbTetras+h] = BarycentricPointLocator::computeHexahedronBox ( in, hexas[h] );
+
+        BarycentricPointLocator locator;
+        locator.build ( boxes );
+
+        const auto distance = [&] ( const Index e, const Vector3& pos, Vector3& v )
         {
-            Vector3 pos = Out::getCPos(out[i]);
-            Vector3 coefs;
-            Index index = sofa::InvalidID;
-            double distance = 1e10;
-            for (Index t = 0; t < tetras.size(); t++ )
+            double d;
+            if ( e < nbTetras )
             {
-                Vector3 v = bases[t] * ( pos - in[tetras[t][0]] );
-                double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( -v[2],v[0]+v[1]+v[2]-1 ) );
-                if ( d>0 ) d = ( pos-centers[t] ).norm2();
-                if ( d<distance ) { coefs = v; distance = d; index = (t); }
+                v = bases[e] * ( pos - in[tetras[e][0]] );
+                d = std::max ( std::max ( -v[0],-v[1] ),std::max ( -v[2],v[0]+v[1]+v[2]-1 ) );
             }
-            for (Index h = 0; h < hexas.size(); h++ )
+            else
             {
-                Vector3 v = bases[nbTetras+h] * ( pos - in[hexas[h][0]] );
-                double d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( -v[2],v[0]-1 ),std::max ( v[1]-1,v[2]-1 ) ) );
-                if ( d>0 ) d = ( pos-centers[nbTetras+h] ).norm2();
-                if ( d<distance ) { coefs = v; distance = d; index = (nbTetras+h); }
+                v = bases[e] * ( pos - in[hexas[e-nbTetras][0]] );
+                d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( -v[2],v[0]-1 ),std::max ( v[1]-1,v[2]-1 ) ) );
             }
+            if ( d>0 ) d = ( pos-centers[e] ).norm2();
+            return d;
+        };
+
+        type::vector<Index> indices;
+        type::vector<Vector3> coefs;
+        locator.findNearestElements ( out.size(), [&] ( std::size_t i ) { return Out::getCPos(out[i]); }, distance, indices, coefs );
+
+        for ( std::size_t i=0; i<out.size(); i++ )
+        {
+            const Index index = indices[i];
             if ( index < (nbTetras) )
-                addPointInTetra ( index, coefs.ptr() );
+                addPointInTetra ( index, coefs[i].ptr() );
             else
-                addPointInCube ( index-nbTetras, coefs.ptr() );
+                addPointInCube ( index-nbTetras, coefs[i].ptr() );
         }
     }
 }
@@ -120,6 +120,12 @@ void BarycentricMapperQuadSetTopology<In,Out>::computeDistance(double& d, const
     d = std::max ( std::max ( -v[0],-v[1] ),std::max ( std::max ( v[1]-1,v[0]-1 ),std::max ( v[2]-0.01,-v[2]-0.01 ) ) );
 }
 
+template <class In, class Out>
+BarycentricPointLocator::Box BarycentricMapperQuadSetTopology<In,Out>::computeElementBox(const typename In::VecCoord& in, const Quad& element)
+{
+    return BarycentricPointLocator::computeQuadBox(in, element);
+}
+
 template <class In, class Out>
 void BarycentricMapperQuadSetTopology<In,Out>::addPointInElement(const Index elementIndex, const SReal* baryCoords)
 {
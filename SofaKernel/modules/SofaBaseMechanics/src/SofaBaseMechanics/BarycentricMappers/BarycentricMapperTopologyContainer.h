@@ -21,6 +21,7 @@
 ******************************************************************************/
 #pragma once
 #include <SofaBaseMechanics/BarycentricMappers/TopologyBarycentricMapper.h>
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricPointLocator.h>
 
 #include <SofaBaseTopology/TopologyData.inl>
 #include <unordered_map>
@@ -134,6 +135,9 @@ protected:
     topology::PointData< type::vector<MappingDataType > > d_map;
     MatrixType* m_matrixJ {nullptr};
     bool m_updateJ {false};
+    /// Counter of d_map and revision of the input topology when m_matrixJ was computed
+    int m_matrixJMapCounter {-1};
+    int m_matrixJTopologyRevision {-1};
 
     type::vector<Mat3x3d> m_bases;
     type::vector<Vector3> m_centers;
@@ -141,6 +145,7 @@ protected:
     // Spacial hashing utils
     Real m_gridCellSize;
     Real m_convFactor;
+    // only filled by the deprecated initHashing, will be removed with it
     std::unordered_map<Key, type::vector<unsigned int>, HashFunction, HashEqual> m_hashTable;
     std::size_t m_hashTableSize;
 
@@ -156,6 +161,10 @@ protected:
     virtual void addPointInElement(const Index elementIndex, const SReal* baryCoords)=0;
     virtual void computeDistance(double& d, const Vector3& v)=0;
 
+    /// Bounding box of the region where computeDistance is <= 0, used to locate the points in init.
+    /// The default is the box of the vertices of the element.
+    virtual BarycentricPointLocator::Box computeElementBox(const typename In::VecCoord& in, const Element& element);
+
     /// Compute the distance between outPos and the element e. If this distance is smaller than the previously stored one,
     /// update nearestParams.
     /// \param e id of the element
@@ -175,8 +184,10 @@ protected:
     // Spacial hashing following paper:
     // M.Teschner et al "Optimized Spatial Hashing for Collision Detection of Deformable Objects" (2003)
     type::Vec3i getGridIndices(const Vector3& pos);
+    SOFA_ATTRIBUTE_DEPRECATED("v21.12", "v22.06", "The points are located with a BarycentricPointLocator built in init, use computeHashingCellSize for the size of its cells.")
     void initHashing(const typename In::VecCoord& in);
     void computeHashingCellSize(const typename In::VecCoord& in);
+    /// Only used by the deprecated initHashing, will be removed with it
     void computeHashTable(const typename In::VecCoord& in);
 
 };
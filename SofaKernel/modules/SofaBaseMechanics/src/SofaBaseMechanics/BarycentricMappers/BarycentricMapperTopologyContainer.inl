@@ -49,6 +49,7 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::clear(s
     vectorData.clear();
     if ( size>0 ) vectorData.reserve ( size );
     d_map.endEdit();
+    m_updateJ = true;
 }
 
 
@@ -131,65 +132,42 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::compute
 template <class In, class Out, class MappingDataType, class Element>
 void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::init ( const typename Out::VecCoord& out, const typename In::VecCoord& in )
 {
-    initHashing(in);
+    computeHashingCellSize(in);
     this->clear ( int(out.size()) );
     computeBasesAndCenters(in);
 
-    // Compute distances to get nearest element and corresponding bary coef
     const type::vector<Element>& elements = getElements();
-    for ( unsigned int i=0; i<out.size(); i++ )
-    {
-        Vector3 outPos = Out::getCPos(out[i]);
-        NearestParams nearestParams;
+    type::vector<BarycentricPointLocator::Box> boxes(elements.size());
+    for ( std::size_t e = 0; e < elements.size(); e++ )
+        boxes[e] = computeElementBox(in, elements[e]);
 
-        // Search nearest element in grid cell
-        Vec3i gridIds = getGridIndices(outPos);
-        Key key(gridIds[0],gridIds[1],gridIds[2]);
+    BarycentricPointLocator locator;
+    locator.build(boxes, m_gridCellSize);
 
-        auto it_entries = m_hashTable.find(key);
-        if( it_entries != m_hashTable.end() )
-        {
-            for(auto entry : it_entries->second)
-            {
-                Vector3 inPos = in[elements[entry][0]];
-                checkDistanceFromElement(entry, outPos, inPos, nearestParams);
-            }
-        }
+    // Compute distances to get nearest element and corresponding bary coef, the points being located in parallel
+    const auto distance = [&](const Index e, const Vector3& outPos, Vector3& bary)
+    {
+        bary = m_bases[e] * ( outPos - Vector3(in[elements[e][0]]) );
+        double dist;
+        computeDistance(dist, bary);
+        if ( dist>0 )
+            dist = ( outPos-m_centers[e] ).norm2();
+        return dist;
+    };
+
+    type::vector<Index> elementIds;
+    type::vector<Vector3> baryCoords;
+    locator.findNearestElements(out.size(), [&](std::size_t i) { return Out::getCPos(out[i]); }, distance, elementIds, baryCoords);
+
+    for ( std::size_t i=0; i<out.size(); i++ )
+        addPointInElement(elementIds[i], baryCoords[i].ptr());
+}
 
-        if(nearestParams.elementId==std::numeric_limits<unsigned int>::max()) // No element in grid cell, perform exhaustive search
-        {
-            for ( unsigned int e = 0; e < elements.size(); e++ )
-            {
-                Vector3 inPos = in[elements[e][0]];
-                checkDistanceFromElement(e, outPos, inPos, nearestParams);
-            }
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
-        }
-        else if(fabs(nearestParams.distance)>m_gridCellSize/2.) // Nearest element in grid cell may not be optimal, check neighbors
-        {
-            Vec3i centerGridIds = gridIds;
-            for(int xId=-1; xId<=1; xId++)
-                for(int yId=-1; yId<=1; yId++)
-                    for(int zId=-1; zId<=1; zId++)
-                    {
-                        gridIds = Vec3i(centerGridIds[0]+xId,centerGridIds[1]+yId,centerGridIds[2]+zId);
-                        Key key(gridIds[0],gridIds[1],gridIds[2]);
-
-                        auto it_entries = m_hashTable.find(key);
-                        if( it_entries != m_hashTable.end() )
-                        {
-                            for(auto entry : it_entries->second)
-                            {
-                                Vector3 inPos = in[elements[entry][0]];
-                                checkDistanceFromElement(entry, outPos, inPos, nearestParams);
-                            }
-                        }
-                    }
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
-        }
-        else
-            addPointInElement(nearestParams.elementId, nearestParams.baryCoords.ptr());
-    }
+
+template <class In, class Out, class MappingDataType, class Element>
+BarycentricPointLocator::Box BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::computeElementBox( const typename In::VecCoord& in, const Element& element )
+{
+    return BarycentricPointLocator::computeBox(in, element);
 }
 
 
@@ -270,7 +248,9 @@ void BarycentricMapperTopologyContainer<In,Out,MappingDataType,Element>::applyJT
 template <class In, class Out, class MappingDataType, class Element>
 const defaulttype::BaseMatrix* BarycentricMapperTopologyContainer<In,Out,MappingDataType, Element>::getJ(int outSize, int inSize)
 {
-    if (m_matrixJ && !m_updateJ)
+    // the map is also modified by the topological changes of the output, and the elements by the ones of the input
+    if (m_matrixJ && !m_updateJ && m_matrixJMapCounter == d_map.getCounter() && m_matrixJTopologyRevision == m_fromTopology->getRevision()
+        && m_matrixJ->rowBSize() == MatrixTypeIndex(outSize) && m_matrixJ->colBSize() == MatrixTypeIndex(inSize))
         return m_matrixJ;
 
     if (!m_matrixJ) m_matrixJ = new MatrixType;
@@ -281,9 +261,11 @@ const defaulttype::BaseMatrix* BarycentricMapperTopologyContainer<In,Out,Mapping
 
     const type::vector<Element>& elements = getElements();
 
-    for( size_t outId=0 ; outId<this->maskTo->size() ; ++outId)
+    // the outputs which are not mechanical states, e.g. visual models, have no force mask
+    const size_t nbOut = this->maskTo ? this->maskTo->size() : d_map.getValue().size();
+    for( size_t outId=0 ; outId<nbOut ; ++outId)
     {
-        if( !this->maskTo->getEntry(outId) ) continue;
+        if( this->maskTo && !this->maskTo->getEntry(outId) ) continue;
 
         const Element& element = elements[d_map.getValue()[outId].in_index];
 
@@ -294,6 +276,8 @@ const defaulttype::BaseMatrix* BarycentricMapperTopologyContainer<In,Out,Mapping
 
     m_matrixJ->compress();
     m_updateJ = false;
+    m_matrixJMapCounter = d_map.getCounter();
+    m_matrixJTopologyRevision = m_fromTopology->getRevision();
     return m_matrixJ;
 }
 
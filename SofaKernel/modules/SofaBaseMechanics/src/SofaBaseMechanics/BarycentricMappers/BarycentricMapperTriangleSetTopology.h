@@ -66,6 +66,7 @@ protected:
     void computeBase(Mat3x3d& base, const typename In::VecCoord& in, const Triangle& element) override;
     void computeCenter(Vector3& center, const typename In::VecCoord& in, const Triangle& element) override;
     void computeDistance(double& d, const Vector3& v) override;
+    BarycentricPointLocator::Box computeElementBox(const typename In::VecCoord& in, const Triangle& element) override;
     void addPointInElement(const Index elementIndex, const SReal* baryCoords) override;
 
     using Inherit1::d_map;
@@ -117,6 +117,12 @@ void BarycentricMapperTriangleSetTopology<In,Out>::computeDistance(double& d, co
     d = std::max ( std::max ( -v[0],-v[1] ),std::max ( ( v[2]<0?-v[2]:v[2] )-0.01,v[0]+v[1]-1 ) );
 }
 
+template <class In, class Out>
+BarycentricPointLocator::Box BarycentricMapperTriangleSetTopology<In,Out>::computeElementBox(const typename In::VecCoord& in, const Triangle& element)
+{
+    return BarycentricPointLocator::computeTriangleBox(in, element);
+}
+
 template <class In, class Out>
 void BarycentricMapperTriangleSetTopology<In,Out>::addPointInElement(const Index elementIndex, const SReal* baryCoords)
 {
@@ -0,0 +1,106 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaBaseMechanics/BarycentricMappers/BarycentricPointLocator.h>
+
+namespace sofa::component::mapping
+{
+
+void BarycentricPointLocator::build(const type::vector<Box>& boxes, SReal cellSize)
+{
+    m_nbElements = boxes.size();
+    m_cellStart.clear();
+    m_cellElements.clear();
+    m_gridSize = type::Vec<3, int>(0, 0, 0);
+    if (boxes.empty())
+        return;
+
+    Box bounds = boxes[0];
+    SReal meanSide = 0;
+    for (const Box& box : boxes)
+    {
+        bounds.add(box.min);
+        bounds.add(box.max);
+        meanSide += std::max({ box.max[0] - box.min[0], box.max[1] - box.min[1], box.max[2] - box.min[2] });
+    }
+    meanSide /= SReal(boxes.size());
+
+    const Vector3 extent = bounds.max - bounds.min;
+    if (!(cellSize > 0))
+        cellSize = meanSide;
+    if (!(cellSize > 0))
+        cellSize = std::max({ extent[0], extent[1], extent[2], SReal(1) });
+
+    // limit the number of cells to a few per element, for meshes with elements of very different sizes
+    const double maxNbCells = 8.0 * double(boxes.size()) + 64.0;
+    for (;;)
+    {
+        double nbCells = 1;
+        for (int a = 0; a < 3; ++a)
+        {
+            m_gridSize[a] = int(std::floor(extent[a] / cellSize)) + 1;
+            nbCells *= m_gridSize[a];
+        }
+        if (nbCells <= maxNbCells)
+            break;
+        cellSize *= SReal(std::cbrt(nbCells / maxNbCells) * 1.01);
+    }
+    m_cellSize = cellSize;
+    m_origin = bounds.min;
+
+    const std::size_t nbCells = std::size_t(m_gridSize[0]) * std::size_t(m_gridSize[1]) * std::size_t(m_gridSize[2]);
+
+    const auto cellRange = [this](const Box& box, int begin[3], int end[3])
+    {
+        for (int a = 0; a < 3; ++a)
+        {
+            begin[a] = std::max(0, std::min(m_gridSize[a] - 1, int(std::floor((box.min[a] - m_origin[a]) / m_cellSize))));
+            end[a] = std::max(0, std::min(m_gridSize[a] - 1, int(std::floor((box.max[a] - m_origin[a]) / m_cellSize))));
+        }
+    };
+
+    // count the elements of each cell, then store them contiguously
+    m_cellStart.assign(nbCells + 1, 0);
+    int begin[3], end[3];
+    for (const Box& box : boxes)
+    {
+        cellRange(box, begin, end);
+        for (int z = begin[2]; z <= end[2]; ++z)
+            for (int y = begin[1]; y <= end[1]; ++y)
+                for (int x = begin[0]; x <= end[0]; ++x)
+                    ++m_cellStart[(std::size_t(z) * m_gridSize[1] + y) * m_gridSize[0] + x + 1];
+    }
+    for (std::size_t cell = 0; cell < nbCells; ++cell)
+        m_cellStart[cell + 1] += m_cellStart[cell];
+
+    m_cellElements.resize(m_cellStart[nbCells]);
+    type::vector<std::size_t> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (std::size_t e = 0; e < boxes.size(); ++e)
+    {
+        cellRange(boxes[e], begin, end);
+        for (int z = begin[2]; z <= end[2]; ++z)
+            for (int y = begin[1]; y <= end[1]; ++y)
+                for (int x = begin[0]; x <= end[0]; ++x)
+                    m_cellElements[fill[(std::size_t(z) * m_gridSize[1] + y) * m_gridSize[0] + x]++] = Index(e);
+    }
+}
+
+} // namespace sofa::component::mapping
@@ -0,0 +1,281 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaBaseMechanics/config.h>
+
+#include <sofa/type/Vec.h>
+#include <sofa/type/vector.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/ParallelFor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace sofa::component::mapping
+{
+
+/**
+ * Uniform grid over the bounding boxes of the elements of a mesh, used by the barycentric mappers to find
+ * the element containing a point (or the nearest one) without testing all the elements.
+ *
+ * The elements are compared with a distance which is <= 0 inside an element, and the squared distance to
+ * the center of the element otherwise. The box of each element must contain the region where this distance
+ * is <= 0, and its center. The grid is then searched by growing rings of cells around the point, until no
+ * unvisited element can be nearer: the result is the same as an exhaustive search over all the elements,
+ * ties being resolved by the lowest element index.
+ */
+class SOFA_SOFABASEMECHANICS_API BarycentricPointLocator
+{
+public:
+    using Index = sofa::Index;
+    using Vector3 = type::Vector3;
+
+    struct Box
+    {
+        Vector3 min;
+        Vector3 max;
+
+        void add(const Vector3& p)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                min[k] = std::min(min[k], p[k]);
+                max[k] = std::max(max[k], p[k]);
+            }
+        }
+
+        void inflate(SReal margin)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                min[k] -= margin;
+                max[k] += margin;
+            }
+        }
+    };
+
+    /// Box of the vertices of an element
+    template<class VecCoord, class Element>
+    static Box computeBox(const VecCoord& in, const Element& element)
+    {
+        Box box { Vector3(in[element[0]]), Vector3(in[element[0]]) };
+        for (std::size_t i = 1; i < element.size(); ++i)
+            box.add(Vector3(in[element[i]]));
+        return box;
+    }
+
+    /// Box of a triangle, including the thickness tolerated by the barycentric mappers
+    template<class VecCoord, class Triangle>
+    static Box computeTriangleBox(const VecCoord& in, const Triangle& triangle)
+    {
+        Box box = computeBox(in, triangle);
+        box.inflate(0.01 * cross(Vector3(in[triangle[1]] - in[triangle[0]]), Vector3(in[triangle[2]] - in[triangle[0]])).norm());
+        return box;
+    }
+
+    /// Box of a quad: the barycentric coordinates are computed in the parallelogram of its first three vertices
+    template<class VecCoord, class Quad>
+    static Box computeQuadBox(const VecCoord& in, const Quad& quad)
+    {
+        const Vector3 p0(in[quad[0]]);
+        const Vector3 u = Vector3(in[quad[1]]) - p0;
+        const Vector3 v = Vector3(in[quad[3]]) - p0;
+        Box box = computeBox(in, quad);
+        box.add(p0 + u + v);
+        box.inflate(0.01 * cross(u, v).norm());
+        return box;
+    }
+
+    /// Box of a hexahedron: the barycentric coordinates are computed in the parallelepiped of its vertices 0, 1, 3 and 4
+    template<class VecCoord, class Hexahedron>
+    static Box computeHexahedronBox(const VecCoord& in, const Hexahedron& hexahedron)
+    {
+        const Vector3 p0(in[hexahedron[0]]);
+        const Vector3 u = Vector3(in[hexahedron[1]]) - p0;
+        const Vector3 v = Vector3(in[hexahedron[3]]) - p0;
+        const Vector3 w = Vector3(in[hexahedron[4]]) - p0;
+        Box box = computeBox(in, hexahedron);
+        box.add(p0 + u + v);
+        box.add(p0 + u + w);
+        box.add(p0 + v + w);
+        box.add(p0 + u + v + w);
+        return box;
+    }
+
+    /// Build the grid. With a cell size <= 0, the mean of the largest side of the boxes is used.
+    void build(const type::vector<Box>& boxes, SReal cellSize = 0);
+
+    std::size_t getNbElements() const { return m_nbElements; }
+    SReal getCellSize() const { return m_cellSize; }
+    const type::Vec<3, int>& getGridSize() const { return m_gridSize; }
+
+    /**
+     * Find the element minimizing distance(e, pos, coefs), which returns a value <= 0 inside the element e,
+     * and the squared distance to its center otherwise.
+     * @return the index of the element, or sofa::InvalidID if there are no elements
+     */
+    template<class DistanceFunction>
+    Index findNearestElement(const Vector3& pos, const DistanceFunction& distance, Vector3& coefs) const;
+
+    /**
+     * Find the nearest element of n points, in parallel if the task scheduler has been initialized
+     * (it is not initialized here), sequentially otherwise.
+     * @param getPosition function returning the position of the i-th point
+     */
+    template<class PositionFunction, class DistanceFunction>
+    void findNearestElements(std::size_t n, const PositionFunction& getPosition, const DistanceFunction& distance,
+                             type::vector<Index>& elements, type::vector<Vector3>& coefs) const;
+
+protected:
+
+    /// Call f on the elements of the cells at the distance k (in cells) of the cell c
+    template<class Function>
+    void forEachElementInRing(const long long c[3], long long k, const Function& f) const;
+
+    Vector3 m_origin;
+    SReal m_cellSize { 0 };
+    type::Vec<3, int> m_gridSize { 0, 0, 0 };
+    std::size_t m_nbElements { 0 };
+
+    /// Elements of each cell, stored contiguously: the elements of the cell c are in [m_cellStart[c], m_cellStart[c+1])
+    type::vector<std::size_t> m_cellStart;
+    type::vector<Index> m_cellElements;
+};
+
+
+template<class Function>
+void BarycentricPointLocator::forEachElementInRing(const long long c[3], const long long k, const Function& f) const
+{
+    long long begin[3], end[3];
+    for (int a = 0; a < 3; ++a)
+    {
+        begin[a] = std::max(c[a] - k, 0LL);
+        end[a] = std::min(c[a] + k, static_cast<long long>(m_gridSize[a]) - 1);
+        if (begin[a] > end[a])
+            return;
+    }
+
+    const auto visitCell = [&](long long x, long long y, long long z)
+    {
+        const std::size_t cell = static_cast<std::size_t>((z * m_gridSize[1] + y) * m_gridSize[0] + x);
+        for (std::size_t i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i)
+            f(m_cellElements[i]);
+    };
+
+    for (long long z = begin[2]; z <= end[2]; ++z)
+    {
+        const bool zOnRing = (z == c[2] - k || z == c[2] + k);
+        for (long long y = begin[1]; y <= end[1]; ++y)
+        {
+            if (zOnRing || y == c[1] - k || y == c[1] + k)
+            {
+                for (long long x = begin[0]; x <= end[0]; ++x)
+                    visitCell(x, y, z);
+            }
+            else
+            {
+                // inside the ring along y and z: only the two cells at its ends along x
+                if (c[0] - k >= begin[0])
+                    visitCell(c[0] - k, y, z);
+                if (c[0] + k <= end[0])
+                    visitCell(c[0] + k, y, z);
+            }
+        }
+    }
+}
+
+
+template<class DistanceFunction>
+BarycentricPointLocator::Index BarycentricPointLocator::findNearestElement(const Vector3& pos, const DistanceFunction& distance, Vector3& coefs) const
+{
+    Index nearest = sofa::InvalidID;
+    if (m_nbElements == 0)
+        return nearest;
+
+    // cell of the point, possibly outside the grid
+    long long c[3];
+    long long firstRing = 0;
+    long long lastRing = 0;
+    for (int a = 0; a < 3; ++a)
+    {
+        const SReal x = std::floor((pos[a] - m_origin[a]) / m_cellSize);
+        c[a] = static_cast<long long>(std::max(SReal(-1e9), std::min(x, SReal(1e9))));
+
+        const long long n = m_gridSize[a];
+        // the rings nearer than the grid are empty, the grid is covered at the last ring
+        firstRing = std::max(firstRing, c[a] < 0 ? -c[a] : (c[a] >= n ? c[a] - n + 1 : 0));
+        lastRing = std::max(lastRing, std::max(c[a], n - 1 - c[a]));
+    }
+
+    double nearestDistance = std::numeric_limits<double>::max();
+    Vector3 elementCoefs;
+    const auto checkElement = [&](const Index e)
+    {
+        const double d = distance(e, pos, elementCoefs);
+        if (d < nearestDistance || (d == nearestDistance && e < nearest))
+        {
+            nearestDistance = d;
+            nearest = e;
+            coefs = elementCoefs;
+        }
+    };
+
+    for (long long k = firstRing; k <= lastRing; ++k)
+    {
+        forEachElementInRing(c, k, checkElement);
+
+        // the elements not visited yet have their center at least k cells away from the point
+        const double ringDistance = double(k) * m_cellSize;
+        if (nearest != sofa::InvalidID && nearestDistance < ringDistance * ringDistance)
+            break;
+    }
+    return nearest;
+}
+
+
+template<class PositionFunction, class DistanceFunction>
+void BarycentricPointLocator::findNearestElements(const std::size_t n, const PositionFunction& getPosition, const DistanceFunction& distance,
+                                                  type::vector<Index>& elements, type::vector<Vector3>& coefs) const
+{
+    elements.resize(n);
+    coefs.resize(n);
+
+    const auto findPoint = [&](const std::size_t i)
+    {
+        elements[i] = findNearestElement(Vector3(getPosition(i)), distance, coefs[i]);
+    };
+
+    // the scheduler is neither created nor started here: the points are only located in parallel if it already runs
+    simulation::TaskScheduler* taskScheduler = simulation::TaskScheduler::getCurrentInstance();
+    if (taskScheduler != nullptr && taskScheduler->getThreadCount() > 1)
+    {
+        simulation::parallelFor(taskScheduler, std::size_t(0), n, std::size_t(0), findPoint);
+    }
+    else
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            findPoint(i);
+    }
+}
+
+} // namespace sofa::component::mapping
@@ -64,6 +64,7 @@ public:
 
 public:
     Data< bool > d_useRestPosition; ///< Use the rest position of the input and output models to initialize the mapping    
+    Data< bool > d_useSparseJacobian; ///< Freeze the mapping into a sparse Jacobian matrix, applied in parallel by apply, applyJ and applyJT
 
     SingleLink<BarycentricMapping<In,Out>,Mapper,BaseLink::FLAG_STRONGLINK> d_mapper;
     SingleLink<BarycentricMapping<In,Out>,BaseMeshTopology,BaseLink::FLAG_STRONGLINK> d_input_topology;
@@ -101,6 +102,23 @@ protected:
 
     defaulttype::BaseMatrix *internalMatrix;        ///< internally store a matrix for getJ/Compliant
     type::vector< defaulttype::BaseMatrix* > js;
+
+    /// Scalar weights of the mapping in compressed row storage: the input dofs of the row i (and their weights)
+    /// are the columns[k] (and values[k]), k in [rowBegin[i], rowBegin[i+1])
+    struct SparseJacobian
+    {
+        type::vector<std::size_t> rowBegin;
+        type::vector<Index> columns;
+        type::vector<Real> values;
+    };
+
+    SparseJacobian m_sparseJacobian;
+    SparseJacobian m_sparseJacobianTranspose; ///< used by applyJT to accumulate the force of each input dof without write conflicts
+    bool m_updateSparseJacobian {true};
+
+    /// Rebuild the sparse Jacobian from the mapper if the mapping changed.
+    /// @return true if apply, applyJ and applyJT can use the sparse Jacobian
+    bool updateSparseJacobian();
 private:
     void createMapperFromTopology();
     void populateTopologies();
@@ -50,6 +50,8 @@
 #include <sofa/core/behavior/MechanicalState.h>
 #include <sofa/type/vector.h>
 #include <sofa/simulation/Simulation.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/ParallelFor.h>
 
 namespace sofa::component::mapping
 {
@@ -87,6 +89,7 @@ template <class TIn, class TOut>
 BarycentricMapping<TIn, TOut>::BarycentricMapping(core::State<In>* from, core::State<Out>* to, typename Mapper::SPtr mapper)
     : Inherit1 ( from, to )
     , d_useRestPosition(core::objectmodel::Base::initData(&d_useRestPosition, false, "useRestPosition", "Use the rest position of the input and output models to initialize the mapping"))
+    , d_useSparseJacobian(core::objectmodel::Base::initData(&d_useSparseJacobian, false, "useSparseJacobian", "Freeze the mapping into a sparse Jacobian matrix after its initialization, so that apply, applyJ and applyJT are computed in parallel as sparse matrix products. The matrix is rebuilt on reinit and topological changes"))
     , d_mapper(initLink("mapper","Internal mapper created depending on the type of topology"), mapper)
     , d_input_topology(initLink("input_topology", "Input topology container (usually the surrounding domain)."))
     , d_output_topology(initLink("output_topology", "Output topology container (usually the immersed domain)."))
@@ -102,6 +105,7 @@ template <class TIn, class TOut>
 BarycentricMapping<TIn, TOut>::BarycentricMapping (core::State<In>* from, core::State<Out>* to, BaseMeshTopology * input_topology )
     : Inherit1 ( from, to )
     , d_useRestPosition(core::objectmodel::Base::initData(&d_useRestPosition, false, "useRestPosition", "Use the rest position of the input and output models to initialize the mapping"))
+    , d_useSparseJacobian(core::objectmodel::Base::initData(&d_useSparseJacobian, false, "useSparseJacobian", "Freeze the mapping into a sparse Jacobian matrix after its initialization, so that apply, applyJ and applyJT are computed in parallel as sparse matrix products. The matrix is rebuilt on reinit and topological changes"))
     , d_mapper (initLink("mapper","Internal mapper created depending on the type of topology"))
     , d_input_topology(initLink("input_topology", "Input topology container (usually the surrounding domain)."))
     , d_output_topology(initLink("output_topology", "Output topology container (usually the immersed domain)."))
@@ -278,6 +282,13 @@ void BarycentricMapping<TIn, TOut>::init()
 
     initMapper();
 
+    if (d_useSparseJacobian.getValue())
+    {
+        simulation::TaskScheduler* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+            taskScheduler->init(0);
+    }
+
     this->d_componentState.setValue(ComponentState::Valid) ;
 }
 
@@ -294,6 +305,7 @@ void BarycentricMapping<TIn, TOut>::reinit()
 template <class TIn, class TOut>
 void BarycentricMapping<TIn, TOut>::initMapper()
 {
+    m_updateSparseJacobian = true;
     if (d_mapper != nullptr && this->toModel != nullptr && this->fromModel != nullptr)
     {
         if (d_useRestPosition.getValue())
@@ -311,8 +323,25 @@ void BarycentricMapping<TIn, TOut>::apply(const core::MechanicalParams * mparams
     if (d_mapper != nullptr)
     {
         d_mapper->resize( this->toModel );
-        d_mapper->apply(*out.beginWriteOnly(), in.getValue());
-        out.endEdit();
+        if (updateSparseJacobian())
+        {
+            helper::WriteOnlyAccessor< Data< typename Out::VecCoord > > outPos = out;
+            const typename In::VecCoord& inPos = in.getValue();
+            outPos.resize(m_sparseJacobian.rowBegin.size() - 1);
+
+            simulation::parallelFor(simulation::TaskScheduler::getInstance(), std::size_t(0), outPos.size(), std::size_t(0), [&](const std::size_t i)
+            {
+                InDeriv pos;
+                for (std::size_t k = m_sparseJacobian.rowBegin[i]; k < m_sparseJacobian.rowBegin[i+1]; ++k)
+                    pos += inPos[m_sparseJacobian.columns[k]] * m_sparseJacobian.values[k];
+                Out::setCPos(outPos[i], pos);
+            });
+        }
+        else
+        {
+            d_mapper->apply(*out.beginWriteOnly(), in.getValue());
+            out.endEdit();
+        }
     }
 }
 
@@ -324,7 +353,21 @@ void BarycentricMapping<TIn, TOut>::applyJ (const core::MechanicalParams * mpara
     typename Out::VecDeriv* out = _out.beginEdit();
     if (d_mapper != nullptr)
     {
-        d_mapper->applyJ(*out, in.getValue());
+        if (updateSparseJacobian())
+        {
+            const typename In::VecDeriv& inVel = in.getValue();
+            out->resize(m_sparseJacobian.rowBegin.size() - 1);
+
+            simulation::parallelFor(simulation::TaskScheduler::getInstance(), std::size_t(0), out->size(), std::size_t(0), [&](const std::size_t i)
+            {
+                InDeriv vel;
+                for (std::size_t k = m_sparseJacobian.rowBegin[i]; k < m_sparseJacobian.rowBegin[i+1]; ++k)
+                    vel += inVel[m_sparseJacobian.columns[k]] * m_sparseJacobian.values[k];
+                Out::setDPos((*out)[i], vel);
+            });
+        }
+        else
+            d_mapper->applyJ(*out, in.getValue());
     }
     _out.endEdit();
 }
@@ -337,8 +380,114 @@ void BarycentricMapping<TIn, TOut>::applyJT (const core::MechanicalParams * mpar
 
     if (d_mapper != nullptr)
     {
-        d_mapper->applyJT(*out.beginEdit(), in.getValue());
-        out.endEdit();
+        if (updateSparseJacobian())
+        {
+            helper::WriteAccessor< Data< typename In::VecDeriv > > force = out;
+            const typename Out::VecDeriv& outForce = in.getValue();
+
+            // each task accumulates the forces of its own input dofs, using the transposed matrix
+            const std::size_t nbInputs = std::min(force.size(), m_sparseJacobianTranspose.rowBegin.size() - 1);
+            simulation::parallelFor(simulation::TaskScheduler::getInstance(), std::size_t(0), nbInputs, std::size_t(0), [&](const std::size_t j)
+            {
+                for (std::size_t k = m_sparseJacobianTranspose.rowBegin[j]; k < m_sparseJacobianTranspose.rowBegin[j+1]; ++k)
+                    force[j] += Out::getDPos(outForce[m_sparseJacobianTranspose.columns[k]]) * m_sparseJacobianTranspose.values[k];
+            });
+        }
+        else
+        {
+            d_mapper->applyJT(*out.beginEdit(), in.getValue());
+            out.endEdit();
+        }
+    }
+}
+
+
+template <class TIn, class TOut>
+bool BarycentricMapping<TIn, TOut>::updateSparseJacobian()
+{
+    // only linear mappings between vectors can be frozen: the orientation of rigid outputs is not a linear combination
+    if constexpr (!std::is_same_v<InCoord, InDeriv> || !std::is_same_v<OutCoord, OutDeriv>)
+    {
+        return false;
+    }
+    else
+    {
+        if (!d_useSparseJacobian.getValue() || d_mapper == nullptr || (this->maskTo && this->maskTo->isActivated()))
+            return false;
+
+        const std::size_t outSize = this->toModel->getSize();
+        const std::size_t inSize = this->fromModel->getSize();
+        if (!m_updateSparseJacobian && m_sparseJacobian.rowBegin.size() == outSize + 1 && m_sparseJacobianTranspose.rowBegin.size() == inSize + 1)
+            return true;
+
+        const auto* matJ = dynamic_cast<const typename Mapper::MatrixType*>(d_mapper->getJ(int(outSize), int(inSize)));
+        if (matJ == nullptr)
+        {
+            msg_warning() << "The mapper does not provide its Jacobian matrix: " << d_useSparseJacobian.getName() << " is ignored.";
+            d_useSparseJacobian.setValue(false);
+            return false;
+        }
+
+        // the blocks of a barycentric mapping are diagonal, with the same weight on the diagonal
+        const auto& rowIndex = matJ->getRowIndex();
+        const auto& rowBegin = matJ->getRowBegin();
+        const auto& colsIndex = matJ->getColsIndex();
+        const auto& colsValue = matJ->getColsValue();
+
+        for (std::size_t xi = 0; xi < rowIndex.size(); ++xi)
+        {
+            bool valid = std::size_t(rowIndex[xi]) < outSize;
+            for (auto k = rowBegin[xi]; valid && k < rowBegin[xi+1]; ++k)
+                valid = std::size_t(colsIndex[k]) < inSize;
+            if (!valid)
+            {
+                msg_error() << "The Jacobian matrix of the mapper does not match the sizes of the states ("
+                            << outSize << " outputs, " << inSize << " inputs): " << d_useSparseJacobian.getName() << " is ignored.";
+                d_useSparseJacobian.setValue(false);
+                return false;
+            }
+        }
+
+        m_sparseJacobian.rowBegin.assign(outSize + 1, 0);
+        m_sparseJacobianTranspose.rowBegin.assign(inSize + 1, 0);
+        for (std::size_t xi = 0; xi < rowIndex.size(); ++xi)
+        {
+            for (auto k = rowBegin[xi]; k < rowBegin[xi+1]; ++k)
+            {
+                ++m_sparseJacobian.rowBegin[rowIndex[xi] + 1];
+                ++m_sparseJacobianTranspose.rowBegin[colsIndex[k] + 1];
+            }
+        }
+        for (std::size_t i = 0; i < outSize; ++i)
+            m_sparseJacobian.rowBegin[i+1] += m_sparseJacobian.rowBegin[i];
+        for (std::size_t j = 0; j < inSize; ++j)
+            m_sparseJacobianTranspose.rowBegin[j+1] += m_sparseJacobianTranspose.rowBegin[j];
+
+        const std::size_t nbValues = m_sparseJacobian.rowBegin[outSize];
+        m_sparseJacobian.columns.resize(nbValues);
+        m_sparseJacobian.values.resize(nbValues);
+        m_sparseJacobianTranspose.columns.resize(nbValues);
+        m_sparseJacobianTranspose.values.resize(nbValues);
+
+        // the rows of matJ are sorted, so are the rows of the transposed matrix
+        type::vector<std::size_t> transposeFill(m_sparseJacobianTranspose.rowBegin.begin(), m_sparseJacobianTranspose.rowBegin.end() - 1);
+        for (std::size_t xi = 0; xi < rowIndex.size(); ++xi)
+        {
+            std::size_t fill = m_sparseJacobian.rowBegin[rowIndex[xi]];
+            for (auto k = rowBegin[xi]; k < rowBegin[xi+1]; ++k, ++fill)
+            {
+                const Real weight = colsValue[k][0][0];
+                m_sparseJacobian.columns[fill] = Index(colsIndex[k]);
+                m_sparseJacobian.values[fill] = weight;
+
+                const std::size_t transposeFillId = transposeFill[colsIndex[k]]++;
+                m_sparseJacobianTranspose.columns[transposeFillId] = Index(rowIndex[xi]);
+                m_sparseJacobianTranspose.values[transposeFillId] = weight;
+            }
+        }
+
+        m_updateSparseJacobian = false;
+        return true;
     }
 }
 
@@ -400,6 +549,7 @@ template <class TIn, class TOut>
 void BarycentricMapping<TIn, TOut>::handleTopologyChange ( core::topology::Topology* t )
 {
     //foward topological modifications to the mapper
+    m_updateSparseJacobian = true;
     if (this->d_mapper.get()){
         this->d_mapper->processTopologicalChanges(((const core::State<Out> *)this->toModel)->read(core::ConstVecCoordId::position())->getValue(),
                                                   ((const core::State<In> *)this->fromModel)->read(core::ConstVecCoordId::position())->getValue(),
@@ -181,6 +181,10 @@ public:
     void resize( Size vsize) override;
     virtual void reserve(Size vsize);
 
+    /// Move the memory pages of the state vectors to the NUMA nodes of the TaskScheduler threads, in contiguous
+    /// blocks as a parallel loop over the DOFs would access them (see simulation::CpuTopology::distributePages)
+    void distributeOnNumaNodes();
+
     Size getSize() const override { return d_size.getValue(); }
 
     SReal getPX(Index i) const override { Real x=0.0,y=0.0,z=0.0; DataTypes::get(x,y,z,(read(core::ConstVecCoordId::position())->getValue())[i]); return (SReal)x; }
@@ -333,6 +337,8 @@ public:
 
     void vMultiOp(const core::ExecParams* params, const VMultiOp& ops) override;
 
+    SReal vMultiOpDot(const core::ExecParams* params, const VMultiOp& ops, core::ConstVecId a, core::ConstVecId b) override;
+
     void vThreshold(core::VecId a, SReal threshold ) override;
 
     SReal vDot(const core::ExecParams* params, core::ConstVecId a, core::ConstVecId b) override;
@@ -399,6 +405,10 @@ protected :
 
     Data< int > f_reserve; ///< Size to reserve when creating vectors. (default=0)
 
+    Data< bool > d_numaDistribution; ///< Distribute the state vectors on the NUMA nodes of the TaskScheduler threads when they are resized
+
+    Data< bool > d_parallelVMultiOpDot; ///< Compute the fused vector operations and dot product of vMultiOpDot concurrently, using the TaskScheduler
+
     bool m_initialized;
 
     /// @name Integration-related data
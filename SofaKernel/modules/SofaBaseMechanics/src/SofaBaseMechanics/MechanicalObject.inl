@@ -31,6 +31,9 @@
 #include <sofa/defaulttype/DataTypeInfo.h>
 #include <sofa/helper/accessor.h>
 #include <sofa/simulation/Node.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/CpuTopology.h>
+#include <sofa/simulation/ParallelFor.h>
 
 #ifdef SOFA_DUMP_VISITOR_INFO
 #include <sofa/simulation/Visitor.h>
@@ -38,6 +41,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <functional>
 
 #ifdef SOFA_HAVE_NEW_TOPOLOGYCHANGES
 #include <SofaBaseTopology/TopologyData.inl>
@@ -98,6 +102,8 @@ MechanicalObject<DataTypes>::MechanicalObject()
     , d_size(initData(&d_size, 0, "size", "Size of the vectors"))
     , l_topology(initLink("topology","Link to the topology relevant for this object"))
     , f_reserve(initData(&f_reserve, 0, "reserve", "Size to reserve when creating vectors. (default=0)"))
+    , d_numaDistribution(initData(&d_numaDistribution, false, "numaDistribution", "Distribute the state vectors on the NUMA nodes of the TaskScheduler threads when they are resized. (default=false)"))
+    , d_parallelVMultiOpDot(initData(&d_parallelVMultiOpDot, false, "parallelVMultiOpDot", "Compute the fused vector operations and dot product of vMultiOpDot (conjugate gradient) concurrently, using the TaskScheduler. The dot product is reduced in a fixed order, independent of the number of threads, but it differs from the sequential one in the last bits. (default=false)"))
     , m_gnuplotFileX(nullptr)
     , m_gnuplotFileV(nullptr)
 {
@@ -662,6 +668,48 @@ void MechanicalObject<DataTypes>::renumberValues( const sofa::type::vector< Inde
     }
 }
 
+template <class DataTypes>
+void MechanicalObject<DataTypes>::distributeOnNumaNodes()
+{
+    simulation::TaskScheduler* taskScheduler = simulation::TaskScheduler::getInstance();
+    const simulation::ThreadPlacement& placement = taskScheduler->getThreadPlacement();
+
+    // NUMA node of each thread, in the order of the ranges of a parallel loop
+    std::vector<unsigned int> nodes;
+    if (placement.isDefault())
+    {
+        // the threads can run anywhere: spread the vectors over all the nodes
+        for (unsigned int node = 0; node < simulation::CpuTopology::getNumaNodes().size(); ++node)
+            nodes.push_back(node);
+    }
+    else
+    {
+        for (const auto& slot : simulation::CpuTopology::computeThreadSlots(taskScheduler->getThreadCount(), placement))
+            nodes.push_back(slot.numaNode);
+    }
+
+    bool supported = true;
+    for (Data< VecCoord >* vec : vectorsCoord)
+    {
+        if (vec != nullptr && vec->isSet())
+        {
+            const VecCoord& values = vec->getValue();
+            supported = simulation::CpuTopology::distributePages(values.data(), values.size() * sizeof(Coord), nodes) && supported;
+        }
+    }
+    for (Data< VecDeriv >* vec : vectorsDeriv)
+    {
+        if (vec != nullptr && vec->isSet())
+        {
+            const VecDeriv& values = vec->getValue();
+            supported = simulation::CpuTopology::distributePages(values.data(), values.size() * sizeof(Deriv), nodes) && supported;
+        }
+    }
+
+    if (!supported)
+        msg_warning() << "The state vectors cannot be distributed on the NUMA nodes on this platform";
+}
+
 template <class DataTypes>
 void MechanicalObject<DataTypes>::resize(const Size size)
 {
@@ -691,6 +739,9 @@ void MechanicalObject<DataTypes>::resize(const Size size)
             }
         }
         this->forceMask.resize(size);
+
+        if (m_initialized && d_numaDistribution.getValue())
+            distributeOnNumaNodes();
     }
     else // clear
     {
@@ -1240,6 +1291,15 @@ void MechanicalObject<DataTypes>::init()
     if (f_reserve.getValue() > 0)
         reserve(f_reserve.getValue());
 
+    if (d_numaDistribution.getValue())
+        distributeOnNumaNodes();
+
+    if (d_parallelVMultiOpDot.getValue())
+    {
+        simulation::TaskScheduler* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+            taskScheduler->init(0);
+    }
 }
 
 template <class DataTypes>
@@ -2266,6 +2326,97 @@ void MechanicalObject<DataTypes>::vMultiOp(const core::ExecParams* params, const
         Inherited::vMultiOp(params, ops);
 }
 
+template <class DataTypes>
+SReal MechanicalObject<DataTypes>::vMultiOpDot(const core::ExecParams* params, const VMultiOp& ops, core::ConstVecId a, core::ConstVecId b)
+{
+    // optimize the conjugate gradient case: v_k += w_k*f_k on derivatives, followed by a dot product,
+    // done in a single pass over the vectors
+    constexpr std::size_t maxFusedOps = 4;
+
+    bool fused = !ops.empty() && ops.size() <= maxFusedOps
+            && a.type == sofa::core::V_DERIV && b.type == sofa::core::V_DERIV;
+    for (const auto& op : ops)
+    {
+        if (!fused) break;
+        const core::VecId v = op.first.getId(this);
+        fused = v.type == sofa::core::V_DERIV
+                && op.second.size() == 2
+                && op.second[0].first.getId(this) == v
+                && op.second[0].second == 1.0
+                && op.second[1].first.getId(this).type == sofa::core::V_DERIV;
+    }
+
+    const auto vecSize = [this](core::ConstVecId v) { return this->read(core::ConstVecDerivId(v))->getValue().size(); };
+    const std::size_t n = fused ? vecSize(a) : 0;
+    if (fused)
+    {
+        fused = vecSize(b) == n;
+        for (const auto& op : ops)
+        {
+            fused = fused && vecSize(op.first.getId(this)) == n && vecSize(op.second[1].first.getId(this)) == n;
+        }
+    }
+
+    if (!fused)
+    {
+        return Inherited::vMultiOpDot(params, ops, a, b);
+    }
+
+    const std::size_t nbOps = ops.size();
+    Data<VecDeriv>* resultData[maxFusedOps];
+    Deriv* result[maxFusedOps];
+    const Deriv* operand[maxFusedOps];
+    Real factor[maxFusedOps];
+    for (std::size_t k = 0; k < nbOps; ++k)
+    {
+        resultData[k] = this->write(core::VecDerivId(ops[k].first.getId(this)));
+        result[k] = resultData[k]->beginEdit()->data();
+    }
+    // read the operands once all the results are being edited, as they can be one of them
+    for (std::size_t k = 0; k < nbOps; ++k)
+    {
+        operand[k] = this->read(core::ConstVecDerivId(ops[k].second[1].first.getId(this)))->getValue().data();
+        factor[k] = (Real)ops[k].second[1].second;
+    }
+    const Deriv* da = this->read(core::ConstVecDerivId(a))->getValue().data();
+    const Deriv* db = this->read(core::ConstVecDerivId(b))->getValue().data();
+
+    // the dot product is accumulated in the same order as vDot, so that the result is identical
+    // to a vMultiOp followed by a vDot
+    const auto fusedRange = [&](std::size_t begin, std::size_t end, Real r)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            for (std::size_t k = 0; k < nbOps; ++k)
+            {
+                result[k][i] += operand[k][i] * factor[k];
+            }
+            r += da[i] * db[i];
+        }
+        return r;
+    };
+
+    Real r = 0.0;
+    if (d_parallelVMultiOpDot.getValue())
+    {
+        // fixed grain size: the partial dot products are combined in the same order for any number of threads
+        constexpr std::size_t grainSize = 1024;
+        r = simulation::parallelReduce(simulation::TaskScheduler::getInstance(), std::size_t(0), n, grainSize, Real(0.0),
+                                       fusedRange, std::plus<Real>());
+    }
+    else
+    {
+        r = fusedRange(0, n, r);
+    }
+
+    for (std::size_t k = 0; k < nbOps; ++k)
+    {
+        resultData[k]->endEdit();
+    }
+
+    return r;
+}
+
 template <class T> inline void clear( T& t )
 {
     t.clear();
@@ -64,6 +64,67 @@ TEST_F(Data_test, getNameWithValueTypeInfo)
     EXPECT_EQ(dataVectorColor.getValueTypeInfo()->name(), "vector<RGBAColor>");
 }
 
+TEST_F(Data_test, copyOnWriteLink)
+{
+    using VecCoord = sofa::type::vector<sofa::type::Vec3>;
+    ASSERT_TRUE(dataVectorVec3.isCopyOnWrite());
+
+    dataVectorVec3.setValue(VecCoord(1000, sofa::type::Vec3(1, 2, 3)));
+    Data<VecCoord> child;
+    child.setParent(&dataVectorVec3);
+
+    /// The linked Data shares the memory of its parent
+    EXPECT_EQ(&child.getValue(), &dataVectorVec3.getValue());
+
+    /// The first write access duplicates the value
+    {
+        sofa::helper::WriteAccessor<Data<VecCoord>> x = child;
+        x[0] = sofa::type::Vec3(4, 5, 6);
+    }
+    EXPECT_NE(&child.getValue(), &dataVectorVec3.getValue());
+    EXPECT_EQ(child.getValue()[0], sofa::type::Vec3(4, 5, 6));
+    EXPECT_EQ(dataVectorVec3.getValue()[0], sofa::type::Vec3(1, 2, 3));
+
+    /// An edition of the parent is propagated to the child, sharing the memory again
+    {
+        sofa::helper::WriteAccessor<Data<VecCoord>> x = dataVectorVec3;
+        x.resize(10);
+    }
+    EXPECT_EQ(child.getValue().size(), 10u);
+    EXPECT_EQ(&child.getValue(), &dataVectorVec3.getValue());
+
+    /// Editing the parent does not modify the value seen by the child until it is updated
+    const VecCoord* shared = &child.getValue();
+    dataVectorVec3.beginEdit()->resize(20);
+    EXPECT_NE(&dataVectorVec3.getValue(), shared);
+    EXPECT_EQ(shared->size(), 10u);
+    dataVectorVec3.endEdit();
+    EXPECT_EQ(child.getValue().size(), 20u);
+}
+
+TEST_F(Data_test, copyOnWriteCopyValueFrom)
+{
+    using VecCoord = sofa::type::vector<sofa::type::Vec3>;
+    dataVectorVec3.setValue(VecCoord(1000, sofa::type::Vec3(1, 2, 3)));
+
+    Data<VecCoord> copy;
+    ASSERT_TRUE(copy.copyValueFrom(&dataVectorVec3));
+    EXPECT_TRUE(copy.isSet());
+    EXPECT_EQ(copy.getParent(), nullptr);
+    EXPECT_EQ(&copy.getValue(), &dataVectorVec3.getValue());
+
+    /// Setting a new value does not modify the other Data
+    copy.setValue(VecCoord(2, sofa::type::Vec3(4, 5, 6)));
+    EXPECT_EQ(copy.getValue().size(), 2u);
+    EXPECT_EQ(dataVectorVec3.getValue().size(), 1000u);
+    EXPECT_EQ(dataVectorVec3.getValue()[0], sofa::type::Vec3(1, 2, 3));
+
+    ASSERT_TRUE(copy.copyValueFrom(&dataVectorVec3));
+    dataVectorVec3.setValue(VecCoord(3));
+    EXPECT_EQ(copy.getValue().size(), 1000u);
+    EXPECT_EQ(dataVectorVec3.getValue().size(), 3u);
+}
+
 /** Test suite for vectorData
  *
  * @author Thomas Lemaire @date 2014
@@ -66,9 +66,19 @@ void DataEngine::updateAllInputs()
 }
 
 void DataEngine::update()
+{
+    prepareUpdate();
+    computeOutputs();
+}
+
+void DataEngine::prepareUpdate()
 {
     updateAllInputs();
     DDGNode::cleanDirty();
+}
+
+void DataEngine::computeOutputs()
+{
     doUpdate();
     m_dataTracker.clean();
 }
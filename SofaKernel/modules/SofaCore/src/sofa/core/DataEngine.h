@@ -88,6 +88,14 @@ public:
     /// User implementation moved to doUpdate()
     void update() final;
 
+    /// First half of update(): updates the inputs and calls cleanDirty().
+    /// Used by the evaluators updating several engines, which must call it sequentially.
+    void prepareUpdate();
+
+    /// Second half of update(): calls doUpdate() and cleans the data tracker.
+    /// Once their inputs are up to date, independent engines can compute their outputs concurrently.
+    void computeOutputs();
+
     /// Add a new input to this engine
     /// Automatically adds the input fields to the datatracker
     void addInput(sofa::core::objectmodel::BaseData* data);
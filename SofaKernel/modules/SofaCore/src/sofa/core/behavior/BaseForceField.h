@@ -181,6 +181,12 @@ public:
     /// \brief addMBKToMatrix only on the subMatrixIndex
     virtual void addSubMBKToMatrix(const MechanicalParams* mparams, const sofa::core::behavior::MultiMatrixAccessor* matrix, const type::vector<unsigned> subMatrixIndex);
 
+    /// \brief Return true if addMBKToMatrix can run concurrently with the addMBKToMatrix of other components
+    ///
+    /// It must then only read this component and its mechanical states, and only write through the matrix accessor.
+    /// The parallel assembly of the system matrix calls the other components sequentially (default to false).
+    virtual bool isAddMBKToMatrixThreadSafe() const { return false; }
+
     /// @}
 
 
@@ -84,6 +84,12 @@ void BaseMechanicalState::vMultiOp(const ExecParams* params, const VMultiOp& ops
     }
 }
 
+SReal BaseMechanicalState::vMultiOpDot(const ExecParams* params, const VMultiOp& ops, ConstVecId a, ConstVecId b)
+{
+    vMultiOp(params, ops);
+    return vDot(params, a, b);
+}
+
 /// Handle state Changes from a given Topology
 void BaseMechanicalState::handleStateChange(core::topology::Topology* /*t*/)
 {
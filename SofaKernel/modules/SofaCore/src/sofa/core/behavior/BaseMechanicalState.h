@@ -165,6 +165,15 @@ public:
     /// By default this method decompose the computation into multiple vOp calls.
     virtual void vMultiOp(const ExecParams* params, const VMultiOp& ops);
 
+    /// \brief Perform a vMultiOp, then compute the scalar product between vectors a and b.
+    ///
+    /// The scalar product is computed on the result of the operations. This is used to
+    /// fuse a vector update with the computation of a norm, such as in the conjugate gradient
+    /// $x = x + alpha p, r = r - alpha q, rho = r.r$, so that it can be done in one pass
+    /// over the state vectors.
+    /// By default this method calls vMultiOp then vDot.
+    virtual SReal vMultiOpDot(const ExecParams* params, const VMultiOp& ops, ConstVecId a, ConstVecId b);
+
     /// Compute the scalar products between two vectors.
     virtual SReal vDot(const ExecParams* params, ConstVecId a, ConstVecId b) = 0;
 
@@ -23,9 +23,23 @@
 #include <sofa/helper/io/Mesh.h>
 #include <sofa/helper/system/FileRepository.h>
 #include <sofa/helper/accessor.h>
+#include <sofa/helper/io/MemoryMappedFile.h>
+#include <sofa/helper/system/FileSystem.h>
+#include <sofa/helper/Utils.h>
+#include <algorithm>
 #include <fstream>
-
+#include <sstream>
+#include <limits>
+#include <functional>
+#include <memory>
+#include <set>
+
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 namespace sofa
 {
@@ -72,6 +86,8 @@ MeshLoader::MeshLoader() : BaseLoader()
   , d_rotation(initData(&d_rotation, Vec3(), "rotation", "Rotation of the DOFs"))
   , d_scale(initData(&d_scale, Vec3(1.0, 1.0, 1.0), "scale3d", "Scale of the DOFs in 3 dimensions"))
   , d_transformation(initData(&d_transformation, type::Matrix4::s_identity, "transformation", "4x4 Homogeneous matrix to transform the DOFs (when present replace any)"))
+  , d_useCache(initData(&d_useCache, false, "useCache", "Store the loaded mesh in a binary cache file, read instead of the mesh file while it is not modified"))
+  , d_cacheDirectory(initData(&d_cacheDirectory, "cacheDirectory", "Directory of the cache files (by default, cache/meshes in the SOFA directory)"))
   , d_previousTransformation(type::Matrix4::s_identity )
 {
     addAlias(&d_tetrahedra, "tetras");
@@ -87,6 +103,8 @@ MeshLoader::MeshLoader() : BaseLoader()
     d_scale.setAutoLink(false);
     d_transformation.setAutoLink(false);
     d_transformation.setDirtyValue();
+    d_useCache.setAutoLink(false);
+    d_cacheDirectory.setAutoLink(false);
 
     d_positions.setGroup("Vectors");
     d_polylines.setGroup("Vectors");
@@ -247,18 +265,491 @@ void MeshLoader::reinit()
 }
 
 bool MeshLoader::load()
+{
+    // the mesh is already being loaded
+    if (m_isLoading)
+        return true;
+
+    m_isLoading = true;
+    const bool loaded = loadMesh();
+    m_isLoading = false;
+    return loaded;
+}
+
+bool MeshLoader::loadMesh()
 {
     // Clear previously loaded buffers
     clearBuffers();
 
+    const bool useCache = d_useCache.getValue();
+    if (useCache && readCache())
+        return true;
+
+    // The Data modified while loading the file are the ones stored in the cache
+    type::vector<int> counters;
+    if (useCache)
+    {
+        for (const objectmodel::BaseData* data : this->getDataFields())
+            counters.push_back(data->getCounter());
+    }
+
     bool loaded = doLoad();
 
     // Clear (potentially) partially filled buffers
     if (!loaded)
+    {
         clearBuffers();
+    }
+    else if (useCache)
+    {
+        const VecData& dataFields = this->getDataFields();
+        if (dataFields.size() == counters.size())
+        {
+            type::vector<objectmodel::BaseData*> loadedData;
+            for (std::size_t i = 0; i < dataFields.size(); ++i)
+            {
+                if (dataFields[i]->getCounter() != counters[i] && !dataFields[i]->getParent() && !isIgnoredByCache(dataFields[i]))
+                    loadedData.push_back(dataFields[i]);
+            }
+            writeCache(loadedData);
+        }
+        else
+        {
+            msg_info() << "The mesh is not stored in the cache: Data were created while loading it.";
+        }
+    }
     return loaded;
 }
 
+namespace
+{
+
+/// Identification of the cache files, followed by their version
+constexpr char cacheMagic[8] = { 'S', 'O', 'F', 'A', 'M', 'E', 'S', 'H' };
+constexpr std::uint32_t cacheVersion = 2;
+/// Written in the native byte order, to detect the files written on another architecture
+constexpr std::uint32_t cacheByteOrder = 0x01020304;
+
+enum class CachedValue : std::uint8_t { Memory = 0, Text = 1, Groups = 2 };
+
+/// The groups are stored field by field, their text format not keeping empty names
+using GroupsData = objectmodel::Data< type::vector< PrimitiveGroup > >;
+
+/// The values stored as raw memory: resizable arrays of fixed size numerical values
+bool isStoredAsMemory(const defaulttype::AbstractTypeInfo* typeInfo)
+{
+    return typeInfo->ValidInfo() && typeInfo->Container() && !typeInfo->FixedSize() && typeInfo->SimpleLayout()
+        && typeInfo->BaseType()->FixedSize() && !typeInfo->Text() && (typeInfo->Integer() || typeInfo->Scalar());
+}
+
+/// Value of a Data as a text, without loss of precision on the floating point numbers
+std::string getExactValueString(const objectmodel::BaseData* data)
+{
+    std::ostringstream out;
+    out.precision(std::numeric_limits<double>::max_digits10);
+    data->printValue(out);
+    return out.str();
+}
+
+/// Size, modification time (in nanoseconds) and hash of the first and last pages of a file. The modification time
+/// can be truncated to a coarse resolution by the file system, the hash detects most of the edits done in between.
+bool getFileStatus(const std::string& filename, std::uint64_t& size, std::int64_t& time, std::uint64_t& hash)
+{
+    struct stat status;
+    if (stat(filename.c_str(), &status) != 0)
+        return false;
+    size = std::uint64_t(status.st_size);
+#if defined(WIN32)
+    time = std::int64_t(status.st_mtime) * 1000000000;
+#elif defined(__APPLE__)
+    time = std::int64_t(status.st_mtimespec.tv_sec) * 1000000000 + std::int64_t(status.st_mtimespec.tv_nsec);
+#else
+    time = std::int64_t(status.st_mtim.tv_sec) * 1000000000 + std::int64_t(status.st_mtim.tv_nsec);
+#endif
+
+    constexpr std::uint64_t pageSize = 4096;
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return false;
+    std::string pages(std::size_t(std::min(size, 2 * pageSize)), '\0');
+    const std::uint64_t firstPageSize = std::min(size, pageSize);
+    file.read(&pages[0], std::streamsize(firstPageSize));
+    if (pages.size() > firstPageSize)
+    {
+        file.seekg(std::streamoff(size - (pages.size() - firstPageSize)));
+        file.read(&pages[firstPageSize], std::streamsize(pages.size() - firstPageSize));
+    }
+    if (!file)
+        return false;
+
+    // FNV-1a, which does not depend on the standard library implementation
+    hash = 14695981039346656037ull;
+    for (const char c : pages)
+    {
+        hash ^= std::uint64_t(static_cast<unsigned char>(c));
+        hash *= 1099511628211ull;
+    }
+    return true;
+}
+
+class CacheWriter
+{
+public:
+    explicit CacheWriter(std::ostream& out) : m_out(out) {}
+
+    template<class T>
+    void write(const T& value)
+    {
+        m_out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(const std::string& value)
+    {
+        write(std::uint64_t(value.size()));
+        m_out.write(value.data(), std::streamsize(value.size()));
+    }
+
+    void write(const void* data, std::size_t size)
+    {
+        m_out.write(static_cast<const char*>(data), std::streamsize(size));
+    }
+
+private:
+    std::ostream& m_out;
+};
+
+/// Read the content of a mapped cache file, checking that it does not go past its end
+class CacheReader
+{
+public:
+    CacheReader(const char* data, std::size_t size) : m_cur(data), m_end(data + size) {}
+
+    bool good() const { return m_good; }
+
+    template<class T>
+    T read()
+    {
+        T value {};
+        if (const char* data = readBytes(sizeof(T)))
+            std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    std::string readString()
+    {
+        const std::uint64_t size = read<std::uint64_t>();
+        const char* data = readBytes(size);
+        return data ? std::string(data, std::size_t(size)) : std::string();
+    }
+
+    const char* readBytes(std::uint64_t size)
+    {
+        if (!m_good || size > std::uint64_t(m_end - m_cur))
+        {
+            m_good = false;
+            return nullptr;
+        }
+        const char* data = m_cur;
+        m_cur += size;
+        return data;
+    }
+
+private:
+    const char* m_cur;
+    const char* m_end;
+    bool m_good { true };
+};
+
+/// Values of the Data of a loader which are not stored in the cache, to check that the cache was written
+/// with the same parameters
+template<class IsIgnored>
+std::string getCacheParameters(const objectmodel::Base* loader, const std::set<std::string>& loadedData, const IsIgnored& isIgnored)
+{
+    std::ostringstream parameters;
+    for (const objectmodel::BaseData* data : loader->getDataFields())
+    {
+        if (isIgnored(data) || loadedData.count(data->getName()))
+            continue;
+        parameters << data->getName() << '=' << getExactValueString(data) << '\n';
+    }
+    return parameters.str();
+}
+
+} // namespace
+
+bool MeshLoader::isIgnoredByCache(const objectmodel::BaseData* data) const
+{
+    // the transformation is applied on the loaded positions, in reinit()
+    return data == &name || data == &f_printLog || data == &f_tags || data == &f_bbox || data == &d_componentState
+        || data == &f_listening || data == &d_filename || data == &d_useCache || data == &d_cacheDirectory
+        || data == &d_translation || data == &d_rotation || data == &d_scale || data == &d_transformation;
+}
+
+std::string MeshLoader::getCacheFilename() const
+{
+    std::string directory = d_cacheDirectory.getValue();
+    if (directory.empty())
+        directory = sofa::helper::Utils::getSofaPathTo("cache/meshes");
+
+    const std::string& filename = d_filename.getFullPath();
+    std::ostringstream cacheFilename;
+    cacheFilename << directory << "/" << sofa::helper::system::FileSystem::stripDirectory(filename) << "."
+                  << std::hex << std::hash<std::string>()(this->getClassName() + "\n" + filename) << ".sofamesh";
+    return cacheFilename.str();
+}
+
+bool MeshLoader::readCache()
+{
+    const std::string& filename = d_filename.getFullPath();
+    std::uint64_t fileSize = 0;
+    std::int64_t fileTime = 0;
+    std::uint64_t fileHash = 0;
+    if (filename.empty() || !getFileStatus(filename, fileSize, fileTime, fileHash))
+        return false;
+
+    const std::string cacheFilename = getCacheFilename();
+    sofa::helper::io::MemoryMappedFile cacheFile;
+    if (!sofa::helper::system::FileSystem::exists(cacheFilename) || !cacheFile.open(cacheFilename))
+        return false;
+
+    CacheReader in(cacheFile.data(), cacheFile.size());
+    const char* magic = in.readBytes(sizeof(cacheMagic));
+    if (!magic || std::memcmp(magic, cacheMagic, sizeof(cacheMagic)) != 0
+        || in.read<std::uint32_t>() != cacheVersion || in.read<std::uint32_t>() != cacheByteOrder
+        || in.readString() != this->getClassName() || in.readString() != filename
+        || in.read<std::uint64_t>() != fileSize || in.read<std::int64_t>() != fileTime
+        || in.read<std::uint64_t>() != fileHash)
+    {
+        msg_info() << "The cache file " << cacheFilename << " does not match the file " << filename;
+        return false;
+    }
+    const std::string parameters = in.readString();
+
+    // check all the stored Data before modifying them
+    struct CachedData
+    {
+        objectmodel::BaseData* data;
+        CachedValue kind;
+        std::uint64_t nbValues;
+        const char* value;
+        std::uint64_t valueSize;
+        type::vector<PrimitiveGroup> groups;
+    };
+    type::vector<CachedData> cachedData;
+    std::set<std::string> cachedNames;
+    const std::uint32_t nbData = in.read<std::uint32_t>();
+    for (std::uint32_t i = 0; i < nbData && in.good(); ++i)
+    {
+        CachedData cached {};
+        const std::string dataName = in.readString();
+        const std::string typeName = in.readString();
+        cached.kind = CachedValue(in.read<std::uint8_t>());
+        if (cached.kind == CachedValue::Memory)
+        {
+            const std::uint32_t valueByteSize = in.read<std::uint32_t>();
+            cached.nbValues = in.read<std::uint64_t>();
+            if (valueByteSize == 0 || cached.nbValues > std::numeric_limits<std::uint64_t>::max() / valueByteSize)
+            {
+                msg_warning() << "The cache file " << cacheFilename << " is corrupted.";
+                return false;
+            }
+            cached.valueSize = cached.nbValues * valueByteSize;
+            cached.data = this->findData(dataName);
+            if (cached.data && (!isStoredAsMemory(cached.data->getValueTypeInfo()) || cached.data->getValueTypeInfo()->byteSize() != valueByteSize))
+                cached.data = nullptr;
+        }
+        else if (cached.kind == CachedValue::Text)
+        {
+            cached.valueSize = in.read<std::uint64_t>();
+            cached.data = this->findData(dataName);
+        }
+        else if (cached.kind == CachedValue::Groups)
+        {
+            const std::uint64_t nbGroups = in.read<std::uint64_t>();
+            for (std::uint64_t g = 0; g < nbGroups && in.good(); ++g)
+            {
+                PrimitiveGroup group;
+                group.p0 = in.read<std::int32_t>();
+                group.nbp = in.read<std::int32_t>();
+                group.materialId = in.read<std::int32_t>();
+                group.materialName = in.readString();
+                group.groupName = in.readString();
+                cached.groups.push_back(group);
+            }
+            cached.data = dynamic_cast<GroupsData*>(this->findData(dataName));
+        }
+        else
+        {
+            msg_warning() << "The cache file " << cacheFilename << " is corrupted.";
+            return false;
+        }
+        cached.value = in.readBytes(cached.valueSize);
+
+        if (!cached.data || cached.data->getValueTypeString() != typeName || cached.data->getParent() || isIgnoredByCache(cached.data))
+        {
+            msg_info() << "The cache file " << cacheFilename << " does not match the Data " << dataName;
+            return false;
+        }
+        cachedData.push_back(cached);
+        cachedNames.insert(dataName);
+    }
+    if (!in.good())
+    {
+        msg_warning() << "The cache file " << cacheFilename << " is corrupted.";
+        return false;
+    }
+    if (parameters != getCacheParameters(this, cachedNames, [this](const objectmodel::BaseData* data) { return isIgnoredByCache(data); }))
+    {
+        msg_info() << "The cache file " << cacheFilename << " was written with other parameters.";
+        return false;
+    }
+
+    for (const CachedData& cached : cachedData)
+    {
+        bool valid = true;
+        if (cached.kind == CachedValue::Memory)
+        {
+            const defaulttype::AbstractTypeInfo* typeInfo = cached.data->getValueTypeInfo();
+            void* value = cached.data->beginEditVoidPtr();
+            typeInfo->setSize(value, sofa::Size(cached.nbValues));
+            if (cached.valueSize > 0)
+            {
+                void* values = typeInfo->getValuePtr(value);
+                valid = (values != nullptr && typeInfo->size(value) == cached.nbValues);
+                if (valid)
+                    std::memcpy(values, cached.value, std::size_t(cached.valueSize));
+            }
+            cached.data->endEditVoidPtr();
+        }
+        else if (cached.kind == CachedValue::Groups)
+        {
+            static_cast<GroupsData*>(cached.data)->setValue(cached.groups);
+        }
+        else
+        {
+            valid = cached.data->read(std::string(cached.value, std::size_t(cached.valueSize)));
+        }
+
+        if (!valid)
+        {
+            msg_warning() << "The Data " << cached.data->getName() << " could not be read from the cache file " << cacheFilename;
+            clearBuffers();
+            return false;
+        }
+    }
+
+    msg_info() << "Mesh read from the cache file " << cacheFilename;
+    return true;
+}
+
+bool MeshLoader::writeCache(const type::vector<objectmodel::BaseData*>& loadedData)
+{
+    const std::string& filename = d_filename.getFullPath();
+    std::uint64_t fileSize = 0;
+    std::int64_t fileTime = 0;
+    std::uint64_t fileHash = 0;
+    if (!getFileStatus(filename, fileSize, fileTime, fileHash))
+        return false;
+
+    // the values stored as text must be read back identically
+    type::vector<std::string> values(loadedData.size());
+    std::set<std::string> loadedNames;
+    for (std::size_t i = 0; i < loadedData.size(); ++i)
+    {
+        const objectmodel::BaseData* data = loadedData[i];
+        loadedNames.insert(data->getName());
+        if (isStoredAsMemory(data->getValueTypeInfo()) || dynamic_cast<const GroupsData*>(data))
+            continue;
+
+        values[i] = getExactValueString(data);
+        std::unique_ptr<objectmodel::BaseData> copy(const_cast<objectmodel::BaseData*>(data)->getNewInstance());
+        if (!copy || !copy->read(values[i]) || getExactValueString(copy.get()) != values[i])
+        {
+            msg_info() << "The mesh is not stored in the cache: the Data " << data->getName() << " cannot be stored.";
+            return false;
+        }
+    }
+
+    const std::string cacheFilename = getCacheFilename();
+    sofa::helper::system::FileSystem::findOrCreateAValidPath(sofa::helper::system::FileSystem::getParentDirectory(cacheFilename));
+
+    // the file is written under a temporary name, so that an incomplete file is never read
+    const std::string temporaryFilename = cacheFilename + ".tmp";
+    {
+        std::ofstream file(temporaryFilename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            msg_info() << "Cannot write the cache file " << cacheFilename;
+            return false;
+        }
+
+        CacheWriter out(file);
+        out.write(cacheMagic, sizeof(cacheMagic));
+        out.write(cacheVersion);
+        out.write(cacheByteOrder);
+        out.write(std::string(this->getClassName()));
+        out.write(filename);
+        out.write(fileSize);
+        out.write(fileTime);
+        out.write(fileHash);
+        out.write(getCacheParameters(this, loadedNames, [this](const objectmodel::BaseData* data) { return isIgnoredByCache(data); }));
+
+        out.write(std::uint32_t(loadedData.size()));
+        for (std::size_t i = 0; i < loadedData.size(); ++i)
+        {
+            const objectmodel::BaseData* data = loadedData[i];
+            const defaulttype::AbstractTypeInfo* typeInfo = data->getValueTypeInfo();
+            out.write(data->getName());
+            out.write(data->getValueTypeString());
+            if (isStoredAsMemory(typeInfo))
+            {
+                const void* value = data->getValueVoidPtr();
+                const std::uint64_t nbValues = typeInfo->size(value);
+                out.write(CachedValue::Memory);
+                out.write(std::uint32_t(typeInfo->byteSize()));
+                out.write(nbValues);
+                if (nbValues > 0)
+                    out.write(typeInfo->getValuePtr(value), std::size_t(nbValues * typeInfo->byteSize()));
+            }
+            else if (const GroupsData* groups = dynamic_cast<const GroupsData*>(data))
+            {
+                out.write(CachedValue::Groups);
+                out.write(std::uint64_t(groups->getValue().size()));
+                for (const PrimitiveGroup& group : groups->getValue())
+                {
+                    out.write(std::int32_t(group.p0));
+                    out.write(std::int32_t(group.nbp));
+                    out.write(std::int32_t(group.materialId));
+                    out.write(group.materialName);
+                    out.write(group.groupName);
+                }
+            }
+            else
+            {
+                out.write(CachedValue::Text);
+                out.write(values[i]);
+            }
+        }
+
+        if (!file.good())
+        {
+            file.close();
+            std::remove(temporaryFilename.c_str());
+            msg_info() << "Cannot write the cache file " << cacheFilename;
+            return false;
+        }
+    }
+
+    std::remove(cacheFilename.c_str());
+    if (std::rename(temporaryFilename.c_str(), cacheFilename.c_str()) != 0)
+    {
+        std::remove(temporaryFilename.c_str());
+        return false;
+    }
+    msg_info() << "Mesh stored in the cache file " << cacheFilename;
+    return true;
+}
+
 
 
 bool MeshLoader::canLoad()
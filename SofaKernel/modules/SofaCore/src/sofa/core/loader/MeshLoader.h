@@ -83,6 +83,12 @@ private:
 
     virtual void doClearBuffers() = 0;
 
+    /// Clear the buffers and fill them from the cache file or the mesh file
+    bool loadMesh();
+
+    /// load() is called again by the "filename" callback when an output is read while the mesh is loaded
+    bool m_isLoading { false };
+
 public:
     bool canLoad() override;
 
@@ -183,6 +189,9 @@ public:
     Data< Vec3 > d_scale; ///< Scale of the DOFs in 3 dimensions
     Data< type::Matrix4 > d_transformation; ///< 4x4 Homogeneous matrix to transform the DOFs (when present replace any)
 
+    Data< bool > d_useCache; ///< Store the loaded mesh in a binary cache file, read instead of the mesh file while it is not modified
+    Data< std::string > d_cacheDirectory; ///< Directory of the cache files (by default, cache/meshes in the SOFA directory)
+
 
     virtual void updateMesh();
     virtual void updateElements();
@@ -231,6 +240,24 @@ protected:
     /// Temporary method that will copy all buffers from a io::Mesh into the corresponding Data. Will be removed as soon as work on unifying meshloader is finished
     void copyMeshToData(helper::io::Mesh& _mesh);
 
+    /// @name Binary cache of the loaded meshes
+    /// The cache file stores the Data modified by doLoad(), the numerical arrays being stored as raw memory, the groups
+    /// field by field and the other values (e.g. materials) as text.
+    /// It is keyed by the path, size, modification time and a hash of the first and last pages of the mesh file, and
+    /// the values of the other Data of the loader. Other files read by a loader (e.g. materials) are not checked.
+    /// @{
+
+    /// Path of the cache file of the current mesh file
+    std::string getCacheFilename() const;
+    /// Fill the Data from the cache file, if it matches the mesh file and the parameters of the loader
+    bool readCache();
+    /// Store the given Data in the cache file
+    bool writeCache(const type::vector<objectmodel::BaseData*>& loadedData);
+    /// Data neither stored in the cache nor compared with it
+    bool isIgnoredByCache(const objectmodel::BaseData* data) const;
+
+    /// @}
+
     /// Deprecation with pointer versions
     SOFA_ATTRIBUTE_DISABLED__REFERENCES_IN_MESHLOADER()
     void addPosition(type::vector< sofa::type::Vec<3, SReal> >* pPositions, const sofa::type::Vec<3, SReal>& p) = delete;
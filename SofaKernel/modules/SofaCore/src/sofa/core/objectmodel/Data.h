@@ -178,7 +178,18 @@ public:
     /// @warning writeOnly (the Data is not updated before being set)
     void setValue(const T& value)
     {
-        *beginWriteOnly()=value;
+        if constexpr (sofa::defaulttype::DataTypeInfo<T>::CopyOnWrite)
+        {
+            // do not duplicate a value shared with other Data just to overwrite it
+            m_counter++;
+            m_isSet=true;
+            BaseData::setDirtyOutputs();
+            m_value.setValue(value);
+        }
+        else
+        {
+            *beginWriteOnly()=value;
+        }
         endEdit();
     }
 
@@ -341,7 +352,23 @@ bool Data<T>::read(const std::string& s)
 template <class T>
 bool Data<T>::copyValueFrom(const Data<T>* data)
 {
-    setValue(data->getValue());
+    if constexpr (sofa::defaulttype::DataTypeInfo<T>::CopyOnWrite)
+    {
+        if (data == this)
+            return true;
+
+        /// The memory is shared with the other Data until one of them is edited
+        data->updateIfDirty();
+        m_counter++;
+        m_isSet = true;
+        BaseData::setDirtyOutputs();
+        m_value = data->m_value;
+        endEdit();
+    }
+    else
+    {
+        setValue(data->getValue());
+    }
     return true;
 }
 
@@ -111,7 +111,7 @@ public:
 
     T* beginEdit()
     {
-        if(!(ptr.use_count() == 1))
+        if(ptr.use_count() != 1)
         {
             ptr.reset(new T(*ptr)); // a priori the Data will be modified -> copy
         }
@@ -129,7 +129,7 @@ public:
 
     void setValue(const T& value)
     {
-        if(!ptr.unique())
+        if(ptr.use_count() != 1)
         {
             ptr.reset(new T(value)); // the Data is modified -> copy
         }
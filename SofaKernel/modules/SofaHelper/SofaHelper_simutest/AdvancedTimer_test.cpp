@@ -20,6 +20,11 @@
 * Contact information: contact@sofa-framework.org                             *
 ******************************************************************************/
 #include <sofa/helper/AdvancedTimer.h>
+#include <sofa/helper/system/FileRepository.h>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
 
 #include <SofaSimulationCommon/SceneLoaderXML.h>
 using sofa::simulation::SceneLoaderXML ;
@@ -47,6 +52,12 @@ protected:
 		AdvancedTimer::setEnabled("validID", true);
 	}
 
+	void onTearDown() override
+	{
+		if (!traceFilename.empty())
+			std::remove(traceFilename.c_str());
+	}
+
 	void initScene()
 	{
 		std::stringstream scene ;
@@ -61,6 +72,7 @@ protected:
 
 public:
 	Node::SPtr root;
+	std::string traceFilename; ///< removed at the end of the test
 };
 
 TEST_F(AdvancedTimerTest, IsEnabled)
@@ -94,6 +106,17 @@ TEST_F(AdvancedTimerTest, SetOutputType)
 	ASSERT_TRUE(AdvancedTimer::getOutputType("validID") == AdvancedTimer::STDOUT);
 }
 
+TEST_F(AdvancedTimerTest, SetOutputTypeTrace)
+{
+	using namespace sofa::helper;
+
+	AdvancedTimer::setOutputType("validID", "trace");
+	ASSERT_TRUE(AdvancedTimer::getOutputType("validID") == AdvancedTimer::TRACE);
+
+	AdvancedTimer::setOutputType("validID", "STDOUT");
+	ASSERT_TRUE(AdvancedTimer::getOutputType("validID") == AdvancedTimer::STDOUT);
+}
+
 TEST_F(AdvancedTimerTest, End)
 {
 	using namespace sofa::helper;
@@ -105,5 +128,89 @@ TEST_F(AdvancedTimerTest, End)
 	EXPECT_NO_FATAL_FAILURE(AdvancedTimer::end("validId"));
 }
 
+TEST_F(AdvancedTimerTest, Trace)
+{
+	using namespace sofa::helper;
+	traceFilename = sofa::helper::system::DataRepository.getTempPath() + "/AdvancedTimer_test.trace.json";
+	const std::string& filename = traceFilename;
+
+	ASSERT_TRUE(AdvancedTimer::beginTrace(filename));
+	ASSERT_TRUE(AdvancedTimer::isTraceActive());
+
+	AdvancedTimer::stepBegin("mainStep", "mainObject");
+	std::thread worker([]()
+	{
+		AdvancedTimer::stepBegin("workerStep");
+		AdvancedTimer::valSet("workerValue", 42);
+		AdvancedTimer::stepEnd("workerStep");
+	});
+	worker.join();
+	AdvancedTimer::stepEnd("mainStep", "mainObject");
+
+	AdvancedTimer::endTrace();
+	ASSERT_FALSE(AdvancedTimer::isTraceActive());
+
+	// not recorded
+	AdvancedTimer::step("afterTrace");
+
+	std::ifstream file(filename);
+	std::stringstream content;
+	content << file.rdbuf();
+	const std::string trace = content.str();
+
+	EXPECT_EQ(trace.front(), '[');
+	EXPECT_EQ(trace.find_last_not_of("\n"), trace.rfind(']'));
+	EXPECT_NE(trace.find("\"name\":\"mainStep\",\"cat\":\"step\",\"ph\":\"B\""), std::string::npos);
+	EXPECT_NE(trace.find("\"name\":\"mainStep\",\"cat\":\"step\",\"ph\":\"E\""), std::string::npos);
+	EXPECT_NE(trace.find("\"args\":{\"object\":\"mainObject\"}"), std::string::npos);
+	EXPECT_NE(trace.find("\"name\":\"workerValue\",\"cat\":\"value\",\"ph\":\"C\""), std::string::npos);
+	EXPECT_NE(trace.find("\"args\":{\"value\":42"), std::string::npos);
+	EXPECT_EQ(trace.find("afterTrace"), std::string::npos);
+
+	// the worker events are on their own thread
+	const auto mainPos = trace.find("\"name\":\"mainStep\"");
+	const auto workerPos = trace.find("\"name\":\"workerStep\"");
+	ASSERT_NE(workerPos, std::string::npos);
+	const auto tid = [&trace](std::size_t pos) { const auto t = trace.find("\"tid\":", pos); return trace.substr(t, trace.find_first_of(",}", t) - t); };
+	EXPECT_NE(tid(mainPos), tid(workerPos));
+}
+
+TEST_F(AdvancedTimerTest, TraceShortLivedThreads)
+{
+	using namespace sofa::helper;
+	traceFilename = sofa::helper::system::DataRepository.getTempPath() + "/AdvancedTimer_test.shortLived.trace.json";
+	const std::string& filename = traceFilename;
+
+	ASSERT_TRUE(AdvancedTimer::beginTrace(filename));
+	for (int i = 0; i < 10; ++i)
+	{
+		std::thread worker([]()
+		{
+			AdvancedTimer::stepBegin("shortLivedStep");
+			AdvancedTimer::stepEnd("shortLivedStep");
+		});
+		worker.join();
+	}
+	AdvancedTimer::endTrace();
+
+	std::ifstream file(filename);
+	std::stringstream content;
+	content << file.rdbuf();
+	const std::string trace = content.str();
+
+	const auto count = [&trace](const std::string& s)
+	{
+		std::size_t n = 0;
+		for (auto pos = trace.find(s); pos != std::string::npos; pos = trace.find(s, pos + 1))
+			++n;
+		return n;
+	};
+	EXPECT_EQ(count("\"name\":\"shortLivedStep\",\"cat\":\"step\",\"ph\":\"B\""), 10u);
+	EXPECT_EQ(count("\"name\":\"shortLivedStep\",\"cat\":\"step\",\"ph\":\"E\""), 10u);
+
+	// each thread reuses the buffer of the previous one, which has exited
+	EXPECT_EQ(count("thread_name"), 1u);
+}
+
 
 } //namespace sofa
@@ -33,7 +33,11 @@
 #include <algorithm>
 #include <cctype>
 #include <iostream>
+#include <fstream>
 #include <atomic>
+#include <mutex>
+#include <memory>
+#include <unordered_set>
 
 #define DEFAULT_INTERVAL 100
 
@@ -154,6 +158,303 @@ std::pair<AdvancedTimer::SyncCallBack,void*> AdvancedTimer::setSyncCallBack(Sync
     return old;
 }
 
+// -------------------------------
+// Trace recording, in the Chrome Trace Event format
+
+namespace
+{
+
+/// An event of the trace, described with the types of the records
+struct TraceEvent
+{
+    ctime_t time;
+    Record::Type type;
+    const char* name;
+    const char* obj;
+    double val;
+};
+
+/// Ring buffer of the events of a thread, written only by this thread and read only by flushTrace, without locking.
+/// The events are stored in chunks, allocated when the thread first reaches them: a thread recording few events
+/// between two flushes only uses a few chunks. When the thread exits, the buffer is reused by the next new thread.
+class TraceBuffer
+{
+public:
+    static constexpr std::size_t Capacity = std::size_t(1) << 16;
+    static constexpr std::size_t ChunkSize = std::size_t(1) << 10;
+
+    explicit TraceBuffer(unsigned int tid) : tid(tid) {}
+
+    void push(const TraceEvent& e)
+    {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= Capacity)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // a chunk is only allocated by the writer, before publishing its first event with head
+        std::unique_ptr<TraceEvent[]>& chunk = chunks[(h & (Capacity - 1)) / ChunkSize];
+        if (!chunk)
+            chunk.reset(new TraceEvent[ChunkSize]);
+        chunk[h & (ChunkSize - 1)] = e;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    /// Event at the position i, which must be published (i < head)
+    const TraceEvent& event(std::size_t i) const
+    {
+        return chunks[(i & (Capacity - 1)) / ChunkSize][i & (ChunkSize - 1)];
+    }
+
+    std::unique_ptr<TraceEvent[]> chunks[Capacity / ChunkSize];
+    std::atomic<std::size_t> head { 0 };
+    std::atomic<std::size_t> tail { 0 };
+    std::atomic<std::size_t> dropped { 0 };
+    const unsigned int tid;
+    bool named = false; ///< true once the name of the thread is written in the trace
+    std::atomic<bool> inUse { true }; ///< false once its thread has exited
+
+    /// Names of the timer, step, value and object ids of this thread (ids are specific to each thread)
+    std::vector<const char*> names[4];
+};
+
+template<class T> struct TraceKind;
+template<> struct TraceKind<AdvancedTimer::Timer> { static constexpr int value = 0; };
+template<> struct TraceKind<AdvancedTimer::Step>  { static constexpr int value = 1; };
+template<> struct TraceKind<AdvancedTimer::Val>   { static constexpr int value = 2; };
+template<> struct TraceKind<AdvancedTimer::Obj>   { static constexpr int value = 3; };
+
+class TraceData
+{
+public:
+    std::atomic<bool> active { false };
+
+    std::mutex mutex; ///< protects the list of buffers and the output file
+    std::vector<std::unique_ptr<TraceBuffer> > buffers;
+    std::ofstream out;
+    bool firstEvent = true;
+    ctime_t start = 0;
+
+    std::mutex namesMutex;
+    std::unordered_set<std::string> names; ///< storage of the names referenced by the events
+
+    ~TraceData()
+    {
+        active = false;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (out.is_open())
+        {
+            writeAll();
+            out << "\n]\n";
+        }
+    }
+
+    const char* intern(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(namesMutex);
+        return names.insert(name).first->c_str();
+    }
+
+    /// Buffer of a new thread: the buffer of an exited thread if any, a new one otherwise
+    TraceBuffer* createBuffer()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& b : buffers)
+        {
+            if (!b->inUse.load(std::memory_order_acquire))
+            {
+                // the pending events of the previous thread are kept, only the ids are specific to each thread
+                for (auto& names : b->names)
+                    names.clear();
+                b->inUse.store(true, std::memory_order_relaxed);
+                return b.get();
+            }
+        }
+        buffers.emplace_back(new TraceBuffer(unsigned(buffers.size())));
+        return buffers.back().get();
+    }
+
+    /// Write the pending events of all the buffers, mutex must be locked
+    std::size_t writeAll()
+    {
+        std::size_t dropped = 0;
+        for (auto& b : buffers)
+        {
+            write(*b);
+            dropped += b->dropped.exchange(0);
+        }
+        out.flush();
+        return dropped;
+    }
+
+    void write(TraceBuffer& b)
+    {
+        const std::size_t h = b.head.load(std::memory_order_acquire);
+        std::size_t t = b.tail.load(std::memory_order_relaxed);
+        if (t != h && !b.named)
+        {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << b.tid
+                << ",\"args\":{\"name\":\"thread " << b.tid << "\"}}";
+            b.named = true;
+        }
+        for (; t != h; ++t)
+            write(b.event(t), b.tid);
+        b.tail.store(h, std::memory_order_release);
+    }
+
+    void write(const TraceEvent& e, unsigned int tid)
+    {
+        if (e.time < start) return;
+        const char* ph = "i";
+        const char* cat = "step";
+        switch (e.type)
+        {
+        case Record::RBEGIN:      ph = "B"; cat = "timer"; break;
+        case Record::REND:        ph = "E"; cat = "timer"; break;
+        case Record::RSTEP_BEGIN: ph = "B"; break;
+        case Record::RSTEP_END:   ph = "E"; break;
+        case Record::RVAL_SET:    ph = "C"; cat = "value"; break;
+        case Record::RVAL_ADD:    cat = "value"; break;
+        default: break;
+        }
+        separator();
+        out << "{\"name\":\"";
+        escape(e.name);
+        out << "\",\"cat\":\"" << cat << "\",\"ph\":\"" << ph << "\",\"ts\":"
+            << std::fixed << std::setprecision(3) << double(e.time - start) * 1000000.0 / double(CTime::getTicksPerSec())
+            << ",\"pid\":0,\"tid\":" << tid;
+        if (e.type == Record::RSTEP || e.type == Record::RVAL_ADD)
+            out << ",\"s\":\"t\"";
+        if (e.type == Record::RVAL_SET)
+            out << ",\"args\":{\"value\":" << std::defaultfloat << std::setprecision(6) << e.val << "}";
+        else if (e.type == Record::RVAL_ADD)
+            out << ",\"args\":{\"add\":" << std::defaultfloat << std::setprecision(6) << e.val << "}";
+        else if (e.obj)
+        {
+            out << ",\"args\":{\"object\":\"";
+            escape(e.obj);
+            out << "\"}";
+        }
+        out << "}";
+    }
+
+    void separator()
+    {
+        if (!firstEvent) out << ",\n";
+        firstEvent = false;
+    }
+
+    void escape(const char* s)
+    {
+        for (; *s; ++s)
+        {
+            const unsigned char c = static_cast<unsigned char>(*s);
+            if (c == '"' || c == '\\') out << '\\' << *s;
+            else if (c < 0x20) out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+            else out << *s;
+        }
+    }
+};
+
+TraceData traceData;
+
+/// Trace buffer of the current thread, released for reuse when the thread exits
+struct CurrentTraceBuffer
+{
+    TraceBuffer* buffer = nullptr;
+    ~CurrentTraceBuffer()
+    {
+        if (buffer)
+            buffer->inUse.store(false, std::memory_order_release);
+    }
+};
+thread_local CurrentTraceBuffer curTraceBuffer;
+
+template<class T>
+const char* getTraceName(TraceBuffer* buffer, AdvancedTimer::Id<T> id)
+{
+    std::vector<const char*>& names = buffer->names[TraceKind<T>::value];
+    const unsigned int i = id;
+    if (i >= names.size()) names.resize(i + 1, nullptr);
+    if (!names[i]) names[i] = traceData.intern(id);
+    return names[i];
+}
+
+template<class T>
+void recordTrace(Record::Type type, AdvancedTimer::Id<T> id, AdvancedTimer::IdObj obj = AdvancedTimer::IdObj(), double val = 0)
+{
+    if (!traceData.active.load(std::memory_order_relaxed)) return;
+    TraceBuffer* buffer = curTraceBuffer.buffer;
+    if (!buffer)
+        buffer = curTraceBuffer.buffer = traceData.createBuffer();
+    TraceEvent e;
+    e.time = CTime::getTime();
+    e.type = type;
+    e.name = getTraceName(buffer, id);
+    e.obj = obj ? getTraceName(buffer, obj) : nullptr;
+    e.val = val;
+    buffer->push(e);
+}
+
+} // namespace
+
+bool AdvancedTimer::beginTrace(const std::string& filename)
+{
+    endTrace();
+    std::lock_guard<std::mutex> lock(traceData.mutex);
+    traceData.out.open(filename.c_str());
+    if (!traceData.out.is_open())
+    {
+        msg_error("AdvancedTimer") << "Unable to open the trace file " << filename;
+        return false;
+    }
+    // events recorded while the previous trace was stopped are not part of this one
+    for (auto& b : traceData.buffers)
+    {
+        b->tail.store(b->head.load(std::memory_order_acquire), std::memory_order_release);
+        b->dropped = 0;
+        b->named = false;
+    }
+    traceData.out << "[\n";
+    traceData.firstEvent = true;
+    traceData.start = CTime::getTime();
+    traceData.active = true;
+    msg_info("AdvancedTimer") << "Recording trace in " << filename;
+    return true;
+}
+
+void AdvancedTimer::flushTrace()
+{
+    std::size_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(traceData.mutex);
+        if (!traceData.out.is_open()) return;
+        dropped = traceData.writeAll();
+    }
+    if (dropped)
+    {
+        msg_warning("AdvancedTimer") << dropped << " trace events were lost because a thread recorded more than "
+                                     << TraceBuffer::Capacity << " events between two flushes";
+    }
+}
+
+void AdvancedTimer::endTrace()
+{
+    traceData.active = false;
+    flushTrace();
+    std::lock_guard<std::mutex> lock(traceData.mutex);
+    if (!traceData.out.is_open()) return;
+    traceData.out << "\n]\n";
+    traceData.out.close();
+}
+
+bool AdvancedTimer::isTraceActive()
+{
+    return traceData.active.load(std::memory_order_relaxed);
+}
+
 void AdvancedTimer::clear()
 {
     setCurRecords(nullptr);
@@ -218,6 +519,11 @@ void AdvancedTimer::begin(IdTimer id)
     {
         data.init(id);
     }
+    if (data.timerOutputType == TRACE && data.interval != 0 && !isTraceActive())
+    {
+        beginTrace(std::string(id) + ".trace.json");
+    }
+    recordTrace(Record::RBEGIN, id);
     if (data.interval == 0)
     {
         setCurRecords(nullptr);
@@ -248,6 +554,7 @@ void AdvancedTimer::end(IdTimer id, std::ostream& result)
         msg_error("AdvancedTimer::end") << "timer[" << id << "] does not correspond to last call to begin(" << curTimer.top() << ")" ;
         return;
     }
+    recordTrace(Record::REND, id);
     type::vector<Record>* curRecords = getCurRecords();
     if (curRecords)
     {
@@ -262,7 +569,10 @@ void AdvancedTimer::end(IdTimer id, std::ostream& result)
         data.process();
         if (data.nbIter == data.interval)
         {
-            data.print(result);
+            if (data.timerOutputType == TRACE)
+                flushTrace();
+            else
+                data.print(result);
             data.clear();
         }
     }
@@ -292,6 +602,7 @@ void AdvancedTimer::end(IdTimer id)
         msg_error("AdvancedTimer::end") << "timer[" << id << "] does not correspond to last call to begin(" << curTimer.top() << ")" ;
         return;
     }
+    recordTrace(Record::REND, id);
 
     TimerData& dataT = timers[id];
     if (dataT.timerOutputType == GUI || dataT.timerOutputType == LJSON || dataT.timerOutputType == JSON)
@@ -314,7 +625,10 @@ void AdvancedTimer::end(IdTimer id)
         data.process();
         if (data.nbIter == data.interval)
         {
-            data.print();
+            if (data.timerOutputType == TRACE)
+                flushTrace();
+            else
+                data.print();
             data.clear();
         }
     }
@@ -343,6 +657,8 @@ std::string AdvancedTimer::end(IdTimer id, double time, double dt)
         case JSON   : return getTimeAnalysis(id, time, dt);
         case LJSON  : return getTimeAnalysis(id, time, dt);
         case GUI    : return std::string("");
+        case TRACE  : end(id);
+                      return std::string("");
         case STDOUT : end(id);
                       return std::string("");
         default :     end(id);
@@ -359,6 +675,7 @@ bool AdvancedTimer::isActive()
 
 void AdvancedTimer::stepBegin(IdStep id)
 {
+    recordTrace(Record::RSTEP_BEGIN, id);
     type::vector<Record>* curRecords = getCurRecords();
     if (!curRecords) return;
     Record r;
@@ -370,6 +687,7 @@ void AdvancedTimer::stepBegin(IdStep id)
 
 void AdvancedTimer::stepBegin(IdStep id, IdObj obj)
 {
+    recordTrace(Record::RSTEP_BEGIN, id, obj);
     type::vector<Record>* curRecords = getCurRecords();
     if (!curRecords) return;
     Record r;
@@ -382,6 +700,7 @@ void AdvancedTimer::stepBegin(IdStep id, IdObj obj)
 
 void AdvancedTimer::stepEnd  (IdStep id)
 {
+    recordTrace(Record::RSTEP_END, id);
     type::vector<Record>* curRecords = getCurRecords();
     if (!curRecords) return;
     if (syncCallBack) (*syncCallBack)(syncCallBackData);
@@ -394,6 +713,7 @@ void AdvancedTimer::stepEnd  (IdStep id)
 
 void AdvancedTimer::stepEnd  (IdStep id, IdObj obj)
 {
+    recordTrace(Record::RSTEP_END, id, obj);
     type::vector<Record>* curRecords = getCurRecords();
     if (!curRecords) return;
     Record r;
@@ -406,6 +726,8 @@ void AdvancedTimer::stepEnd  (IdStep id, IdObj obj)
 
 void AdvancedTimer::stepNext (IdStep prevId, IdStep nextId)
 {
+    recordTrace(Record::RSTEP_END, prevId);
+    recordTrace(Record::RSTEP_BEGIN, nextId);
     type::vector<Record>* curRecords = getCurRecords();
     if (!curRecords) return;
     Record r;
@@ -421,6 +743,7 @@ void AdvancedTimer::stepNext (IdStep prevId, IdStep nextId)
 
 void AdvancedTimer::step     (IdStep id)
 {
+    recordTrace(Record::RSTEP, id);
     type::vector<Record>* curRecords = getCurRecords();
     if (!curRecords) return;
     if (syncCallBack) (*syncCallBack)(syncCallBackData);
@@ -433,6 +756,7 @@ void AdvancedTimer::step     (IdStep id)
 
 void AdvancedTimer::step     (IdStep id, IdObj obj)
 {
+    recordTrace(Record::RSTEP, id, obj);
     type::vector<Record>* curRecords = getCurRecords();
     if (!curRecords) return;
     if (syncCallBack) (*syncCallBack)(syncCallBackData);
@@ -446,6 +770,7 @@ void AdvancedTimer::step     (IdStep id, IdObj obj)
 
 void AdvancedTimer::valSet(IdVal id, double val)
 {
+    recordTrace(Record::RVAL_SET, id, IdObj(), val);
     type::vector<Record>* curRecords = getCurRecords();
     if (!curRecords) return;
     Record r;
@@ -458,6 +783,7 @@ void AdvancedTimer::valSet(IdVal id, double val)
 
 void AdvancedTimer::valAdd(IdVal id, double val)
 {
+    recordTrace(Record::RVAL_ADD, id, IdObj(), val);
     type::vector<Record>* curRecords = getCurRecords();
     if (!curRecords) return;
     Record r;
@@ -483,84 +809,84 @@ void AdvancedTimer::end(const char* idStr)
 void AdvancedTimer::stepBegin(const char* idStr)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     stepBegin(IdStep(idStr));
 }
 
 void AdvancedTimer::stepBegin(const char* idStr, const char* objStr)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     stepBegin(IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::stepBegin(const char* idStr, const std::string& objStr)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     stepBegin(IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::stepEnd  (const char* idStr)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     stepEnd  (IdStep(idStr));
 }
 
 void AdvancedTimer::stepEnd  (const char* idStr, const char* objStr)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     stepEnd  (IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::stepEnd  (const char* idStr, const std::string& objStr)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     stepEnd  (IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::stepNext (const char* prevIdStr, const char* nextIdStr)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     stepNext (IdStep(prevIdStr), IdStep(nextIdStr));
 }
 
 void AdvancedTimer::step     (const char* idStr)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     step     (IdStep(idStr));
 }
 
 void AdvancedTimer::step     (const char* idStr, const char* objStr)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     step     (IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::step     (const char* idStr, const std::string& objStr)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     step     (IdStep(idStr), IdObj(objStr));
 }
 
 void AdvancedTimer::valSet(const char* idStr, double val)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     valSet(IdVal(idStr),val);
 }
 
 void AdvancedTimer::valAdd(const char* idStr, double val)
 {
     type::vector<Record>* curRecords = getCurRecords();
-    if (!curRecords) return;
+    if (!curRecords && !isTraceActive()) return;
     valAdd(IdVal(idStr),val);
 }
 
@@ -938,9 +1264,11 @@ AdvancedTimer::outputType AdvancedTimer::convertOutputType(std::string type)
 		return STDOUT;
     else if(type.compare("gui") == 0)
         return GUI;
+    else if(type.compare("trace") == 0)
+        return TRACE;
 	else // Add your own outputTypes before the else
 	{
-		msg_warning("AdvancedTimer") << "Unable to set output type to " << type << ". Switching to the default 'stdout' output. Valid types are [stdout, json, ljson].";
+		msg_warning("AdvancedTimer") << "Unable to set output type to " << type << ". Switching to the default 'stdout' output. Valid types are [stdout, json, ljson, trace].";
 		return STDOUT;
 	}
 }
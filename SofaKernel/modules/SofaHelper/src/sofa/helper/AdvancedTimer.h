@@ -81,6 +81,14 @@ namespace sofa::helper
   * When reloading/reseting the simulation:
     AdvancedTimer::clear();
 
+  * To record a timeline of all the steps of all the threads, in the Chrome Trace Event format
+    (readable by chrome://tracing or https://ui.perfetto.dev):
+    AdvancedTimer::beginTrace("trace.json");
+    ...
+    AdvancedTimer::endTrace();
+    or set the output type of a timer to "trace": the trace is then written to "<timer>.trace.json"
+    every interval iterations of this timer.
+
 
   The produced stats will looks like:
 
@@ -296,7 +304,8 @@ public:
         STDOUT,
         LJSON,
         JSON,
-        GUI
+        GUI,
+        TRACE
     };
 
 
@@ -326,6 +335,28 @@ public:
 	 */
 	static AdvancedTimer::outputType getOutputType(IdTimer id);
 
+    /**
+     * @brief beginTrace Start recording the events of all threads, and open the file to which they are written.
+     * Events are stored in a per-thread ring buffer without locking, and written by flushTrace.
+     * @param filename std::string, the Chrome Trace Event JSON file to write
+     * @return false if the file could not be opened
+     */
+    static bool beginTrace(const std::string& filename);
+
+    /**
+     * @brief flushTrace Write to the trace file the events recorded since the last flush.
+     * Events recorded while the ring buffer of a thread is full are lost, and a warning is emitted.
+     */
+    static void flushTrace();
+
+    /**
+     * @brief endTrace Stop recording events, write the remaining ones and close the trace file.
+     */
+    static void endTrace();
+
+    /// @return true if the events are recorded for the trace file
+    static bool isTraceActive();
+
 
     /**
      * @brief getTimeAnalysis Return the result of the AdvancedTimer
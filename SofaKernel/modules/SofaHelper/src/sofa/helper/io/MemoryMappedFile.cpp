@@ -0,0 +1,133 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/helper/io/MemoryMappedFile.h>
+
+#ifdef WIN32
+# include <windows.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace sofa::helper::io
+{
+
+MemoryMappedFile::MemoryMappedFile(const std::string& filename)
+{
+    open(filename);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    close();
+}
+
+bool MemoryMappedFile::open(const std::string& filename)
+{
+    close();
+
+#ifdef WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_size = static_cast<std::size_t>(fileSize.QuadPart);
+    if (m_size > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view)
+        {
+            if (mapping)
+                CloseHandle(mapping);
+            CloseHandle(file);
+            m_file = nullptr;
+            m_size = 0;
+            return false;
+        }
+        m_mapping = mapping;
+        m_data = static_cast<const char*>(view);
+    }
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(fd, &status) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    m_size = static_cast<std::size_t>(status.st_size);
+    if (m_size > 0)
+    {
+        void* view = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED)
+        {
+            ::close(fd);
+            m_size = 0;
+            return false;
+        }
+        madvise(view, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char*>(view);
+    }
+    // the mapping stays valid after the file descriptor is closed
+    ::close(fd);
+#endif
+
+    m_isOpen = true;
+    return true;
+}
+
+void MemoryMappedFile::close()
+{
+#ifdef WIN32
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if (m_data)
+        munmap(const_cast<char*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_isOpen = false;
+}
+
+} // namespace sofa::helper::io
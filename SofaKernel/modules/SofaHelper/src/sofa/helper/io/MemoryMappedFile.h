@@ -0,0 +1,65 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/helper/config.h>
+
+#include <cstddef>
+#include <string>
+
+namespace sofa::helper::io
+{
+
+/// Read-only view of the content of a file mapped in memory.
+/// The pages are loaded by the system when they are accessed, so that large files can be
+/// parsed without being copied in a buffer first.
+class SOFA_HELPER_API MemoryMappedFile
+{
+public:
+    MemoryMappedFile() = default;
+    explicit MemoryMappedFile(const std::string& filename);
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+    /// Map the whole file. An empty file is successfully opened with a size of 0.
+    bool open(const std::string& filename);
+    void close();
+
+    bool isOpen() const { return m_isOpen; }
+
+    /// Content of the file, valid until the file is closed
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    bool m_isOpen { false };
+    const char* m_data { nullptr };
+    std::size_t m_size { 0 };
+#ifdef WIN32
+    void* m_file { nullptr };
+    void* m_mapping { nullptr };
+#endif
+};
+
+} // namespace sofa::helper::io
@@ -21,9 +21,14 @@
 ******************************************************************************/
 
 #include <sofa/helper/system/FileRepository.h>
+#include <sofa/helper/system/FileSystem.h>
 #include <sofa/testing/BaseTest.h>
 
 #include <SofaLoader/MeshObjLoader.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <fstream>
+#include <iterator>
 
 #include <sofa/helper/BackTrace.h>
 using sofa::helper::BackTrace ;
@@ -50,7 +55,27 @@ public :
     /**
      * Constructor call for each test
      */
-    void SetUp() override{}
+    void SetUp() override
+    {
+        m_temporaryDirectory = sofa::helper::system::DataRepository.getTempPath() + "/MeshObjLoader_test_"
+            + ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        sofa::helper::system::FileSystem::removeAll(m_temporaryDirectory);
+        ASSERT_FALSE(sofa::helper::system::FileSystem::createDirectory(m_temporaryDirectory));
+    }
+
+    /**
+     * Remove the files written by the test, even if it failed
+     */
+    void TearDown() override
+    {
+        sofa::helper::system::FileSystem::removeAll(m_temporaryDirectory);
+    }
+
+    /// Path of a file in the temporary directory of the test
+    std::string getTemporaryPath(const std::string& filename) const
+    {
+        return m_temporaryDirectory + "/" + filename;
+    }
 
     /**
      * Helper function to check mesh loading.
@@ -76,6 +101,75 @@ public :
         EXPECT_EQ((size_t)normalPerVertexNb, this->d_normals.getValue().size());
     }
 
+    /// Load a grid written in a file of several chunks
+    void loadLargeFileTest()
+    {
+        const std::string filename = getTemporaryPath("MeshObjLoader_large.obj");
+        const int nx = 200;
+        const int ny = 300;
+        {
+            std::ofstream file(filename.c_str());
+            file << "# grid of " << nx << "x" << ny << " vertices\n";
+            file << "g first\n";
+            for (int j = 0; j < ny; ++j)
+            {
+                if (j == ny / 2)
+                    file << "g second  half\n";
+                for (int i = 0; i < nx; ++i)
+                    file << "v " << i * 0.5 << " " << j * 0.25 << " -1.5e-1\n";
+                if (j == 0)
+                    continue;
+
+                // even rows use absolute indices, odd rows indices relative to the last vertex
+                const int offset = (j % 2 == 0) ? 1 : -(j + 1) * nx;
+                for (int i = 0; i + 1 < nx; ++i)
+                {
+                    const int a = (j - 1) * nx + i + offset;
+                    const int b = a + 1;
+                    const int c = a + nx;
+                    const int d = c + 1;
+                    file << "f " << a << " " << b << " " << d << "\n";
+                    file << "f " << a << "// " << d << "/ " << c << "\t\n";
+                }
+            }
+        }
+
+        this->setFilename(filename);
+        EXPECT_TRUE(this->load());
+
+        const auto& positions = this->d_positions.getValue();
+        const auto& triangles = this->d_triangles.getValue();
+        ASSERT_EQ(positions.size(), std::size_t(nx * ny));
+        ASSERT_EQ(triangles.size(), std::size_t(2 * (nx - 1) * (ny - 1)));
+        for (int j = 0; j < ny; ++j)
+            for (int i = 0; i < nx; ++i)
+                ASSERT_EQ(positions[j * nx + i], sofa::type::Vector3(i * 0.5, j * 0.25, -0.15));
+
+        std::size_t t = 0;
+        for (int j = 1; j < ny; ++j)
+            for (int i = 0; i + 1 < nx; ++i, t += 2)
+            {
+                const PointID a = PointID((j - 1) * nx + i);
+                ASSERT_EQ(triangles[t][0], a);
+                ASSERT_EQ(triangles[t][1], a + 1);
+                ASSERT_EQ(triangles[t][2], a + nx + 1);
+                ASSERT_EQ(triangles[t + 1][0], a);
+                ASSERT_EQ(triangles[t + 1][1], a + nx + 1);
+                ASSERT_EQ(triangles[t + 1][2], a + nx);
+            }
+
+        const auto& groups = this->d_trianglesGroups.getValue();
+        ASSERT_EQ(groups.size(), 2u);
+        EXPECT_EQ(groups[0].groupName, "first");
+        EXPECT_EQ(groups[0].p0, 0);
+        EXPECT_EQ(groups[0].nbp, 2 * (nx - 1) * (ny / 2 - 1));
+        EXPECT_EQ(groups[1].groupName, "second half");
+        EXPECT_EQ(groups[1].p0, groups[0].nbp);
+        EXPECT_EQ(groups[1].nbp, int(triangles.size()) - groups[0].nbp);
+    }
+
+protected:
+    std::string m_temporaryDirectory;
 };
 
 /** MeshObjLoader::load()
@@ -97,5 +191,155 @@ TEST_F(MeshObjLoader_test, LoadCall)
     loadTest("mesh/torus.obj", 800, 0, 1600,  0, 0, 0, 0, 0, 0, 861, 0);
 }
 
+/** MeshObjLoader::load()
+ * A file parsed in several chunks, with relative indices and groups defined in different chunks
+ */
+TEST_F(MeshObjLoader_test, LoadLargeFile)
+{
+    const bool hasScheduler = sofa::simulation::TaskScheduler::getCurrentInstance() != nullptr;
+    loadLargeFileTest();
+
+    // loading a file does not create the task scheduler
+    if (!hasScheduler)
+        EXPECT_EQ(sofa::simulation::TaskScheduler::getCurrentInstance(), nullptr);
+}
+
+/// The chunks are parsed in parallel when the task scheduler runs several threads
+TEST_F(MeshObjLoader_test, LoadLargeFileParallel)
+{
+    sofa::simulation::TaskScheduler::getInstance()->init(4);
+    loadLargeFileTest();
+    sofa::simulation::TaskScheduler::getInstance()->stop();
+}
+
+/// Loader giving access to its cache
+class CachedMeshObjLoader : public MeshObjLoader
+{
+public:
+    SOFA_CLASS(CachedMeshObjLoader, MeshObjLoader);
+
+    using MeshObjLoader::getCacheFilename;
+    using MeshObjLoader::readCache;
+
+    static SPtr create(const std::string& filename, const std::string& cacheDirectory, bool handleSeams = false)
+    {
+        auto loader = sofa::core::objectmodel::New<CachedMeshObjLoader>();
+        loader->d_useCache.setValue(true);
+        loader->d_cacheDirectory.setValue(cacheDirectory);
+        loader->d_handleSeams.setValue(handleSeams);
+        loader->setFilename(filename);
+        return loader;
+    }
+};
+
+void expectSameData(const MeshObjLoader* expected, const MeshObjLoader* loader)
+{
+    for (const sofa::core::objectmodel::BaseData* data : expected->getDataFields())
+    {
+        if (data == &expected->d_useCache || data == &expected->d_cacheDirectory)
+            continue;
+        const sofa::core::objectmodel::BaseData* loaded = loader->findData(data->getName());
+        ASSERT_NE(loaded, nullptr);
+        EXPECT_EQ(data->getValueString(), loaded->getValueString()) << data->getName();
+    }
+}
+
+/** MeshLoader::load() with useCache
+ * The cache file is read instead of the mesh file while the mesh file and the parameters are not modified
+ */
+TEST_F(MeshObjLoader_test, CacheFile)
+{
+    const std::string filename = sofa::helper::system::DataRepository.getFile("mesh/caducee_base.obj");
+
+    auto reference = sofa::core::objectmodel::New<CachedMeshObjLoader>();
+    reference->setFilename(filename);
+    ASSERT_TRUE(reference->load());
+    ASSERT_FALSE(reference->d_materials.getValue().empty());
+
+    auto first = CachedMeshObjLoader::create(filename, m_temporaryDirectory);
+    const std::string cacheFilename = first->getCacheFilename();
+    ASSERT_FALSE(first->readCache());
+    ASSERT_TRUE(first->load());
+    expectSameData(reference.get(), first.get());
+    ASSERT_TRUE(sofa::helper::system::FileSystem::exists(cacheFilename));
+
+    auto second = CachedMeshObjLoader::create(filename, m_temporaryDirectory);
+    EXPECT_EQ(second->getCacheFilename(), cacheFilename);
+    EXPECT_TRUE(second->readCache());
+    ASSERT_TRUE(second->load());
+    expectSameData(reference.get(), second.get());
+
+    // other parameters
+    auto seams = CachedMeshObjLoader::create(filename, m_temporaryDirectory, true);
+    EXPECT_FALSE(seams->readCache());
+
+    // corrupted cache file
+    std::string content;
+    {
+        std::ifstream file(cacheFilename.c_str(), std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream file(cacheFilename.c_str(), std::ios::binary | std::ios::trunc);
+        file.write(content.data(), std::streamsize(content.size() / 2));
+    }
+    auto corrupted = CachedMeshObjLoader::create(filename, m_temporaryDirectory);
+    EXPECT_FALSE(corrupted->readCache());
+    ASSERT_TRUE(corrupted->load());
+    expectSameData(reference.get(), corrupted.get());
+    EXPECT_TRUE(CachedMeshObjLoader::create(filename, m_temporaryDirectory)->readCache());
+}
+
+/** MeshLoader::load() with useCache
+ * The cache file is not read once the mesh file is modified
+ */
+TEST_F(MeshObjLoader_test, CacheFileModified)
+{
+    const std::string filename = getTemporaryPath("MeshObjLoader_cache.obj");
+    {
+        std::ofstream file(filename.c_str());
+        file << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+    }
+    auto first = CachedMeshObjLoader::create(filename, m_temporaryDirectory);
+    ASSERT_TRUE(first->load());
+    EXPECT_TRUE(CachedMeshObjLoader::create(filename, m_temporaryDirectory)->readCache());
+
+    {
+        std::ofstream file(filename.c_str());
+        file << "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 3\nf 2 4 3\n";
+    }
+    auto second = CachedMeshObjLoader::create(filename, m_temporaryDirectory);
+    EXPECT_FALSE(second->readCache());
+    ASSERT_TRUE(second->load());
+    EXPECT_EQ(second->d_positions.getValue().size(), 4u);
+    EXPECT_EQ(second->d_triangles.getValue().size(), 2u);
+    EXPECT_TRUE(CachedMeshObjLoader::create(filename, m_temporaryDirectory)->readCache());
+}
+
+/** MeshLoader::load() with useCache
+ * The cache file is not read once the mesh file is modified without changing its size, in the same second
+ */
+TEST_F(MeshObjLoader_test, CacheFileModifiedSameSize)
+{
+    const std::string filename = getTemporaryPath("MeshObjLoader_cache.obj");
+    {
+        std::ofstream file(filename.c_str());
+        file << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+    }
+    auto first = CachedMeshObjLoader::create(filename, m_temporaryDirectory);
+    ASSERT_TRUE(first->load());
+    EXPECT_TRUE(CachedMeshObjLoader::create(filename, m_temporaryDirectory)->readCache());
+
+    {
+        std::ofstream file(filename.c_str());
+        file << "v 0 0 0\nv 2 0 0\nv 0 2 0\nf 1 2 3\n";
+    }
+    auto second = CachedMeshObjLoader::create(filename, m_temporaryDirectory);
+    EXPECT_FALSE(second->readCache());
+    ASSERT_TRUE(second->load());
+    ASSERT_EQ(second->d_positions.getValue().size(), 3u);
+    EXPECT_EQ(second->d_positions.getValue()[1], sofa::type::Vector3(2, 0, 0));
+}
+
 } // namespace meshobjloader_test
 } // namespace sofa
@@ -26,6 +26,13 @@
 #include <fstream>
 #include <sofa/helper/accessor.h>
 #include <sofa/helper/system/Locale.h>
+#include <sofa/helper/io/MemoryMappedFile.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/ParallelFor.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
 
 namespace sofa::component::loader
 {
@@ -90,16 +97,16 @@ bool MeshObjLoader::doLoad()
 
     // -- Loading file
     const char* filename = d_filename.getFullPath().c_str();
-    std::ifstream file(filename);
+    sofa::helper::io::MemoryMappedFile file;
 
-    if (!file.good())
+    if (!file.open(filename))
     {
         msg_error() << "Cannot read file '" << d_filename << "'.";
         return false;
     }
 
     // -- Reading file
-    fileRead = readOBJ (file,filename);
+    fileRead = readOBJ (file.data(), file.size(), filename);
     file.close();
 
     return fileRead;
@@ -145,9 +152,276 @@ void MeshObjLoader::addGroup (const PrimitiveGroup& g)
     }
 }
 
+namespace
+{
+
+/// Characters separating the tokens of a line, as for the stream extraction operator
+inline bool isBlank(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool isDigit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline void skipBlanks(const char*& cur, const char* end)
+{
+    while (cur != end && isBlank(*cur))
+        ++cur;
+}
+
+/// Parse a floating point number at the beginning of [cur, end), independently of the current locale.
+/// The numbers with at most 19 significant digits and a small exponent (almost all the numbers written in
+/// an OBJ file) are computed with a single rounding, as strtod does. The others are converted by strtod.
+bool parseReal(const char*& cur, const char* end, double& value)
+{
+    static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    const char* p = cur;
+    bool negative = false;
+    if (p != end && (*p == '+' || *p == '-'))
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    std::uint64_t mantissa = 0;
+    int nbDigits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    bool truncated = false;
+    const auto addDigit = [&](const char c, const bool fractional)
+    {
+        hasDigits = true;
+        if (mantissa == 0 && c == '0')
+        {
+            // leading zeros are not significant
+            if (fractional)
+                --exponent;
+        }
+        else if (nbDigits < 19)
+        {
+            mantissa = mantissa * 10 + std::uint64_t(c - '0');
+            ++nbDigits;
+            if (fractional)
+                --exponent;
+        }
+        else
+        {
+            truncated = true;
+            if (!fractional)
+                ++exponent;
+        }
+    };
+
+    while (p != end && isDigit(*p))
+        addDigit(*p++, false);
+    if (p != end && *p == '.')
+    {
+        ++p;
+        while (p != end && isDigit(*p))
+            addDigit(*p++, true);
+    }
+    if (!hasDigits)
+        return false;
+
+    if (p != end && (*p == 'e' || *p == 'E'))
+    {
+        const char* e = p + 1;
+        bool negativeExponent = false;
+        if (e != end && (*e == '+' || *e == '-'))
+        {
+            negativeExponent = (*e == '-');
+            ++e;
+        }
+        if (e != end && isDigit(*e))
+        {
+            int exp10 = 0;
+            while (e != end && isDigit(*e))
+            {
+                if (exp10 < 100000)
+                    exp10 = exp10 * 10 + (*e - '0');
+                ++e;
+            }
+            exponent += negativeExponent ? -exp10 : exp10;
+            p = e;
+        }
+    }
+
+    if (!truncated && mantissa <= (std::uint64_t(1) << 53) && exponent >= -22 && exponent <= 22)
+    {
+        // the mantissa and the power of 10 are exact: the product or the quotient is correctly rounded
+        value = double(mantissa);
+        value = (exponent < 0) ? value / powersOf10[-exponent] : value * powersOf10[exponent];
+        if (negative)
+            value = -value;
+    }
+    else
+    {
+        const std::string number(cur, p);
+        value = std::strtod(number.c_str(), nullptr);
+    }
+    cur = p;
+    return true;
+}
+
+/// Read the next number of a line, or 0 if there are none
+double readReal(const char*& cur, const char* end)
+{
+    double value = 0;
+    skipBlanks(cur, end);
+    parseReal(cur, end, value);
+    return value;
+}
+
+/// Same as atoi on a field of a face vertex
+int parseIndex(const char* cur, const char* end)
+{
+    bool negative = false;
+    if (cur != end && (*cur == '+' || *cur == '-'))
+    {
+        negative = (*cur == '-');
+        ++cur;
+    }
+    int value = 0;
+    while (cur != end && isDigit(*cur))
+        value = value * 10 + (*cur++ - '0');
+    return negative ? -value : value;
+}
+
+/// Definitions read in a chunk of lines of an OBJ file
+struct ObjChunk
+{
+    type::vector<Vector3> positions;
+    type::vector<Vector3> normals;
+    type::vector<Vector2> texCoords;
+
+    /// Position, texcoord and normal indices of each vertex of the faces, -1 if undefined
+    type::vector<int> faceVertices;
+    /// First vertex of each face, followed by the total number of vertices
+    type::vector<std::size_t> faceBegin { 0 };
+    /// Entries of faceVertices given relatively to the current definitions (negative indices in the file):
+    /// they are resolved with the definitions of the chunk only, and must be shifted by the ones of the previous chunks
+    type::vector<std::size_t> relativeIndices;
+
+    /// Lines changing the current group or material, with the number of faces of the chunk read before them
+    type::vector<std::pair<std::size_t, std::string> > directives;
+
+    type::vector<std::string> invalidIndices;
+
+    void parseFace(const char* cur, const char* end)
+    {
+        const std::size_t nbDefinitions[3] = { positions.size(), texCoords.size(), normals.size() };
+        for (;;)
+        {
+            skipBlanks(cur, end);
+            if (cur == end)
+                break;
+            const char* vertexEnd = cur;
+            while (vertexEnd != end && !isBlank(*vertexEnd))
+                ++vertexEnd;
+
+            // "v/vt/vn", each index being optional
+            const char* field = cur;
+            for (int j = 0; j < 3; j++)
+            {
+                int vtn = -1;
+                const char* fieldEnd = std::find(field, vertexEnd, '/');
+                if (fieldEnd != field)
+                {
+                    vtn = parseIndex(field, fieldEnd);
+                    if (vtn >= 1)
+                        vtn -= 1; // -1 because the numerotation begins at 1 and a vector begins at 0
+                    else if (vtn < 0)
+                    {
+                        vtn += int(nbDefinitions[j]);
+                        relativeIndices.push_back(faceVertices.size());
+                    }
+                    else
+                    {
+                        invalidIndices.emplace_back(field, fieldEnd);
+                        vtn = -1;
+                    }
+                }
+                faceVertices.push_back(vtn);
+                field = (fieldEnd == vertexEnd) ? vertexEnd : fieldEnd + 1;
+            }
+            cur = vertexEnd;
+        }
+        faceBegin.push_back(faceVertices.size() / 3);
+    }
+
+    void parseLine(const char* cur, const char* end)
+    {
+        const char* line = cur;
+        skipBlanks(cur, end);
+        const char* tokenBegin = cur;
+        while (cur != end && !isBlank(*cur))
+            ++cur;
+        const std::size_t tokenSize = std::size_t(cur - tokenBegin);
+        const auto tokenIs = [&](const char* token)
+        {
+            return tokenSize == std::strlen(token) && std::memcmp(tokenBegin, token, tokenSize) == 0;
+        };
+
+        if (tokenIs("v"))
+        {
+            const double x = readReal(cur, end);
+            const double y = readReal(cur, end);
+            const double z = readReal(cur, end);
+            positions.emplace_back(x, y, z);
+        }
+        else if (tokenIs("vn"))
+        {
+            const double x = readReal(cur, end);
+            const double y = readReal(cur, end);
+            const double z = readReal(cur, end);
+            normals.emplace_back(x, y, z);
+        }
+        else if (tokenIs("vt"))
+        {
+            const double u = readReal(cur, end);
+            const double v = readReal(cur, end);
+            texCoords.emplace_back(u, v);
+        }
+        else if (tokenIs("f") || tokenIs("l"))
+        {
+            parseFace(cur, end);
+        }
+        else if (tokenIs("mtllib") || tokenIs("usemtl") || tokenIs("g"))
+        {
+            directives.emplace_back(faceBegin.size() - 1, std::string(line, end));
+        }
+    }
+
+    void parse(const char* begin, const char* end)
+    {
+        while (begin < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(begin, '\n', std::size_t(end - begin)));
+            if (!lineEnd)
+                lineEnd = end;
+            if (lineEnd != begin)
+                parseLine(begin, lineEnd);
+            begin = lineEnd + 1;
+        }
+    }
+};
+
+} // namespace
+
 bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
 {
-    // Make sure that fscanf() uses a dot '.' as the decimal separator.
+    const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return readOBJ(content.data(), content.size(), filename);
+}
+
+bool MeshObjLoader::readOBJ (const char* buffer, std::size_t size, const char* filename)
+{
+    // Make sure that fscanf() and strtod() use a dot '.' as the decimal separator.
     sofa::helper::system::TemporaryLocale locale(LC_NUMERIC, "C");
 
     const bool handleSeams = d_handleSeams.getValue();
@@ -183,8 +457,6 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
     getWriteOnlyAccessor(d_trianglesGroups).clear();
     getWriteOnlyAccessor(d_quadsGroups).clear();
 
-    int vtn[3];
-    Vector3 result;
     helper::WriteOnlyAccessor<Data<type::vector< PrimitiveGroup> > > my_faceGroups[NBFACETYPE] =
     {
         d_edgesGroups,
@@ -196,37 +468,44 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
     int curMaterialId = -1;
     int nbFaces[NBFACETYPE] = {0}; // number of edges, triangles, quads
     int groupF0[NBFACETYPE] = {0}; // first primitives indices in current group for edges, triangles, quads
-    std::string line;
-    while( std::getline(file,line) )
+
+    // The lines are parsed by chunks of about 1MB, in parallel if the task scheduler already runs several threads
+    const std::size_t chunkSize = std::size_t(1) << 20;
+    const std::size_t nbChunks = size / chunkSize + 1;
+    type::vector<ObjChunk> chunks(nbChunks);
+    const auto parseChunk = [&](const std::size_t c)
+    {
+        // a chunk starts after the end of the line containing its first character, and ends with the line containing its last one
+        const auto lineStart = [&](const std::size_t offset) -> const char*
+        {
+            if (offset == 0)
+                return buffer;
+            if (offset >= size)
+                return buffer + size;
+            const void* newline = std::memchr(buffer + offset - 1, '\n', size - offset + 1);
+            return newline ? static_cast<const char*>(newline) + 1 : buffer + size;
+        };
+        chunks[c].parse(lineStart(c * chunkSize), lineStart((c + 1) * chunkSize));
+    };
+    // the scheduler is not created here, which would start its threads
+    simulation::TaskScheduler* taskScheduler = nbChunks > 1 ? simulation::TaskScheduler::getCurrentInstance() : nullptr;
+    if (taskScheduler != nullptr && taskScheduler->getThreadCount() > 1)
+    {
+        simulation::parallelFor(taskScheduler, std::size_t(0), nbChunks, std::size_t(1), parseChunk);
+    }
+    else
+    {
+        for (std::size_t c = 0; c < nbChunks; ++c)
+            parseChunk(c);
+    }
+
+    const auto readDirective = [&](const std::string& line)
     {
-        if (line.empty()) continue;
         std::istringstream values(line);
         std::string token;
         values >> token;
 
-        if (token == "#")
-        {
-            // comment
-        }
-        else if (token == "v")
-        {
-            // vertex
-            values >> result[0] >> result[1] >> result[2];
-            my_positions.push_back(Vector3(result[0],result[1], result[2]));
-        }
-        else if (token == "vn")
-        {
-            // normal
-            values >> result[0] >> result[1] >> result[2];
-            my_normals.push_back(Vector3(result[0],result[1], result[2]));
-        }
-        else if (token == "vt")
-        {
-            // texcoord
-            values >> result[0] >> result[1];
-            my_texCoords.push_back(Vector2(result[0],result[1]));
-        }
-        else if ((token == "mtllib") && d_loadMaterial.getValue())
+        if ((token == "mtllib") && d_loadMaterial.getValue())
         {
             while (!values.eof())
             {
@@ -277,91 +556,98 @@ bool MeshObjLoader::readOBJ (std::ifstream &file, const char* filename)
                 }
             }
         }
-        else if (token == "l" || token == "f")
-        {
-            // face
-            nodes.clear();
-            nIndices.clear();
-            tIndices.clear();
-
-            while (!values.eof())
-            {
-                std::string face;
-                values >> face;
-                if (face.empty()) continue;
-                for (int j = 0; j < 3; j++)
-                {
-                    vtn[j] = -1;
-                    std::string::size_type pos = face.find('/');
-                    std::string tmp = face.substr(0, pos);
-                    if (pos == std::string::npos)
-                        face = "";
-                    else
-                    {
-                        face = face.substr(pos + 1);
-                    }
-
-                    if (!tmp.empty())
-                    {
-                        vtn[j] = atoi(tmp.c_str());
-                        if (vtn[j] >= 1)
-                            vtn[j] -=1; // -1 because the numerotation begins at 1 and a vector begins at 0
-                        else if (vtn[j] < 0)
-                            vtn[j] += (j==0) ? sofa::Size(my_positions.size()) : (j==1) ? sofa::Size(my_texCoords.size()) : sofa::Size(my_normals.size());
-                        else
-                        {
-                            msg_error() << "Invalid index " << tmp;
-                            vtn[j] = -1;
-                        }
-                    }
-                }
-
-                nodes.push_back(vtn[0]);
-                tIndices.push_back(vtn[1]);
-                nIndices.push_back(vtn[2]);
-            }
+    };
 
-            my_faceList->push_back(nodes);
-            my_normalsList->push_back(nIndices);
-            my_texturesList->push_back(tIndices);
+    const auto addFace = [&]()
+    {
+        my_faceList->push_back(nodes);
+        my_normalsList->push_back(nIndices);
+        my_texturesList->push_back(tIndices);
 
-            if (nodes.size() == 2) // Edge
+        if (nodes.size() == 2) // Edge
+        {
+            if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
             {
-                if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
-                {
-                    if (nodes[0]<nodes[1])
-                        addEdge(my_edges.wref(), Edge(nodes[0], nodes[1]));
-                    else
-                        addEdge(my_edges.wref(), Edge(nodes[1], nodes[0]));
-                }
-                ++nbFaces[MeshObjLoader::EDGE];
-                faceType = MeshObjLoader::EDGE;
+                if (nodes[0]<nodes[1])
+                    addEdge(my_edges.wref(), Edge(nodes[0], nodes[1]));
+                else
+                    addEdge(my_edges.wref(), Edge(nodes[1], nodes[0]));
             }
-            else if (nodes.size()==4 && !this->d_triangulate.getValue()) // Quad
+            ++nbFaces[MeshObjLoader::EDGE];
+            faceType = MeshObjLoader::EDGE;
+        }
+        else if (nodes.size()==4 && !this->d_triangulate.getValue()) // Quad
+        {
+            if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
             {
-                if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
-                {
-                    addQuad(my_quads.wref(), Quad(nodes[0], nodes[1], nodes[2], nodes[3]));
-                }
-                ++nbFaces[MeshObjLoader::QUAD];
-                faceType = MeshObjLoader::QUAD;
+                addQuad(my_quads.wref(), Quad(nodes[0], nodes[1], nodes[2], nodes[3]));
             }
-            else // Triangulate
+            ++nbFaces[MeshObjLoader::QUAD];
+            faceType = MeshObjLoader::QUAD;
+        }
+        else // Triangulate
+        {
+            if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
             {
-                if (!handleSeams) // we have to wait for renumbering vertices if we handle seams
-                {
-                    for (size_t j=2; j<nodes.size(); j++)
-                        addTriangle(my_triangles.wref(), Triangle(nodes[0], nodes[j-1], nodes[j]));
-                }
-                ++nbFaces[MeshObjLoader::TRIANGLE];
-                faceType = MeshObjLoader::TRIANGLE;
+                for (size_t j=2; j<nodes.size(); j++)
+                    addTriangle(my_triangles.wref(), Triangle(nodes[0], nodes[j-1], nodes[j]));
             }
-
+            ++nbFaces[MeshObjLoader::TRIANGLE];
+            faceType = MeshObjLoader::TRIANGLE;
         }
-        else
+    };
+
+    // Merge the chunks in the order of the file
+    std::size_t nbPositions = 0, nbNormals = 0, nbTexCoords = 0;
+    for (const ObjChunk& chunk : chunks)
+    {
+        nbPositions += chunk.positions.size();
+        nbNormals += chunk.normals.size();
+        nbTexCoords += chunk.texCoords.size();
+    }
+    type::vector<Vector3>& positions = my_positions.wref();
+    type::vector<Vector3>& normals = my_normals.wref();
+    type::vector<Vector2>& texCoords = my_texCoords.wref();
+    positions.reserve(nbPositions);
+    normals.reserve(nbNormals);
+    texCoords.reserve(nbTexCoords);
+
+    for (ObjChunk& chunk : chunks)
+    {
+        for (const std::string& index : chunk.invalidIndices)
+            msg_error() << "Invalid index " << index;
+
+        const int nbPreviousDefinitions[3] = { int(positions.size()), int(texCoords.size()), int(normals.size()) };
+        for (const std::size_t i : chunk.relativeIndices)
+            chunk.faceVertices[i] += nbPreviousDefinitions[i % 3];
+
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+
+        auto directive = chunk.directives.begin();
+        const std::size_t nbChunkFaces = chunk.faceBegin.size() - 1;
+        for (std::size_t f = 0; f <= nbChunkFaces; ++f)
         {
+            for (; directive != chunk.directives.end() && directive->first == f; ++directive)
+                readDirective(directive->second);
+            if (f == nbChunkFaces)
+                break;
 
+            nodes.clear();
+            nIndices.clear();
+            tIndices.clear();
+            for (std::size_t v = chunk.faceBegin[f]; v < chunk.faceBegin[f + 1]; ++v)
+            {
+                nodes.push_back(chunk.faceVertices[3 * v]);
+                tIndices.push_back(chunk.faceVertices[3 * v + 1]);
+                nIndices.push_back(chunk.faceVertices[3 * v + 2]);
+            }
+            addFace();
         }
+
+        // release the memory of the chunk as soon as it is merged
+        chunk = ObjChunk();
     }
 
     // end of current group
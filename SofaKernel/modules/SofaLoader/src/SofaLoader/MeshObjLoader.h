@@ -45,6 +45,8 @@ public:
 
 protected:
     bool readOBJ (std::ifstream &file, const char* filename);
+    /// Parse the content of an OBJ file: the lines are tokenized in parallel by chunks, then merged in order
+    bool readOBJ (const char* buffer, std::size_t size, const char* filename);
     bool readMTL (const char* filename, type::vector<sofa::type::Material>& d_materials);
     void addGroup (const sofa::core::loader::PrimitiveGroup& g);
     void doClearBuffers() override;
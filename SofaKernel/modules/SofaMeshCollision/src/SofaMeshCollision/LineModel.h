@@ -147,6 +147,8 @@ public:
     void setFilter(LineLocalMinDistanceFilter * /*lmdFilter*/);
 
     Data<bool> bothSide; ///< to activate collision on both-side of the both side of the line model (when surface normals are defined on these lines)
+    Data<bool> d_sahBoundingTree; ///< build the bounding tree using the surface area heuristic instead of median splits
+    Data<SReal> d_boundingTreeRebuildRatio; ///< rebuild the bounding tree when its cost grows by this ratio after updates (0 to never rebuild)
 
     /// Pre-construction check method called by ObjectFactory.
     /// Check that DataTypes matches the MechanicalState.
@@ -39,6 +39,8 @@ using core::topology::BaseMeshTopology;
 template<class DataTypes>
 LineCollisionModel<DataTypes>::LineCollisionModel()
     : bothSide(initData(&bothSide, false, "bothSide", "activate collision on both side of the line model (when surface normals are defined on these lines)") )
+    , d_sahBoundingTree(initData(&d_sahBoundingTree, false, "sahBoundingTree", "Build the bounding tree by splitting its cells where the surface area heuristic is minimal, instead of at the median of their biggest dimension"))
+    , d_boundingTreeRebuildRatio(initData(&d_boundingTreeRebuildRatio, (SReal)0, "boundingTreeRebuildRatio", "When the elements move, the bounding tree is only updated. Rebuild it when its cost (surface area heuristic) exceeds this ratio of its cost when built (0 to never rebuild)"))
     , m_displayFreePosition(initData(&m_displayFreePosition, false, "displayFreePosition", "Display Collision Model Points free position(in green)") )
     , l_topology(initLink("topology", "link to the topology container"))
     , mstate(nullptr), topology(nullptr), meshRevision(-1), m_lmdFilter(nullptr)
@@ -495,6 +497,8 @@ void LineCollisionModel<DataTypes>::computeBoundingTree(int maxDepth)
 
             cubeModel->setParentOf(i, minElem, maxElem);
         }
+        cubeModel->setBoundingTreeParameters(d_sahBoundingTree.getValue() ? CubeCollisionModel::BuildMethod::SAH : CubeCollisionModel::BuildMethod::Median,
+                                             d_boundingTreeRebuildRatio.getValue());
         cubeModel->computeBoundingTree(maxDepth);
     }
 
@@ -543,6 +547,8 @@ void LineCollisionModel<DataTypes>::computeContinuousBoundingTree(double dt, int
             }
             cubeModel->setParentOf(i, minElem, maxElem);
         }
+        cubeModel->setBoundingTreeParameters(d_sahBoundingTree.getValue() ? CubeCollisionModel::BuildMethod::SAH : CubeCollisionModel::BuildMethod::Median,
+                                             d_boundingTreeRebuildRatio.getValue());
         cubeModel->computeBoundingTree(maxDepth);
     }
 }
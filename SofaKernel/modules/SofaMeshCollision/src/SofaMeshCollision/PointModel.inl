@@ -36,6 +36,8 @@ namespace sofa::component::collision
 template<class DataTypes>
 PointCollisionModel<DataTypes>::PointCollisionModel()
     : bothSide(initData(&bothSide, false, "bothSide", "activate collision on both side of the point model (when surface normals are defined on these points)") )
+    , d_sahBoundingTree(initData(&d_sahBoundingTree, false, "sahBoundingTree", "Build the bounding tree by splitting its cells where the surface area heuristic is minimal, instead of at the median of their biggest dimension"))
+    , d_boundingTreeRebuildRatio(initData(&d_boundingTreeRebuildRatio, (SReal)0, "boundingTreeRebuildRatio", "When the elements move, the bounding tree is only updated. Rebuild it when its cost (surface area heuristic) exceeds this ratio of its cost when built (0 to never rebuild)"))
     , mstate(nullptr)
     , computeNormals( initData(&computeNormals, false, "computeNormals", "activate computation of normal vectors (required for some collision detection algorithms)") )
     , m_lmdFilter( nullptr )
@@ -147,6 +149,8 @@ void PointCollisionModel<DataTypes>::computeBoundingTree(int maxDepth)
             const type::Vector3& pt = p.p();
             cubeModel->setParentOf(i, pt - type::Vector3(distance,distance,distance), pt + type::Vector3(distance,distance,distance));
         }
+        cubeModel->setBoundingTreeParameters(d_sahBoundingTree.getValue() ? CubeCollisionModel::BuildMethod::SAH : CubeCollisionModel::BuildMethod::Median,
+                                             d_boundingTreeRebuildRatio.getValue());
         cubeModel->computeBoundingTree(maxDepth);
     }
 
@@ -196,6 +200,8 @@ void PointCollisionModel<DataTypes>::computeContinuousBoundingTree(double dt, in
             }
             cubeModel->setParentOf(i, minElem, maxElem);
         }
+        cubeModel->setBoundingTreeParameters(d_sahBoundingTree.getValue() ? CubeCollisionModel::BuildMethod::SAH : CubeCollisionModel::BuildMethod::Median,
+                                             d_boundingTreeRebuildRatio.getValue());
         cubeModel->computeBoundingTree(maxDepth);
     }
 }
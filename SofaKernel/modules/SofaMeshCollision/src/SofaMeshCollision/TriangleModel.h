@@ -139,6 +139,8 @@ public:
     Data<bool> d_bothSide; ///< to activate collision on both side of the triangle model
     Data<bool> d_computeNormals; ///< set to false to disable computation of triangles normal
     Data<bool> d_useCurvature; ///< use the curvature of the mesh to avoid some self-intersection test
+    Data<bool> d_sahBoundingTree; ///< build the bounding tree using the surface area heuristic instead of median splits
+    Data<SReal> d_boundingTreeRebuildRatio; ///< rebuild the bounding tree when its cost grows by this ratio after updates (0 to never rebuild)
     
     /// Link to be set to the topology container in the component graph.
     SingleLink<TriangleCollisionModel<DataTypes>, sofa::core::topology::BaseMeshTopology, BaseLink::FLAG_STOREPATH | BaseLink::FLAG_STRONGLINK> l_topology;
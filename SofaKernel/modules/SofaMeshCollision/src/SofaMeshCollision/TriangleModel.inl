@@ -40,6 +40,8 @@ TriangleCollisionModel<DataTypes>::TriangleCollisionModel()
     : d_bothSide(initData(&d_bothSide, false, "bothSide", "activate collision on both side of the triangle model") )
     , d_computeNormals(initData(&d_computeNormals, true, "computeNormals", "set to false to disable computation of triangles normal"))
     , d_useCurvature(initData(&d_useCurvature, false, "useCurvature", "use the curvature of the mesh to avoid some self-intersection test"))
+    , d_sahBoundingTree(initData(&d_sahBoundingTree, false, "sahBoundingTree", "Build the bounding tree by splitting its cells where the surface area heuristic is minimal, instead of at the median of their biggest dimension"))
+    , d_boundingTreeRebuildRatio(initData(&d_boundingTreeRebuildRatio, (SReal)0, "boundingTreeRebuildRatio", "When the elements move, the bounding tree is only updated. Rebuild it when its cost (surface area heuristic) exceeds this ratio of its cost when built (0 to never rebuild)"))
     , l_topology(initLink("topology", "link to the topology container"))
     , m_mstate(nullptr)
     , m_topology(nullptr)
@@ -280,6 +282,8 @@ void TriangleCollisionModel<DataTypes>::computeBoundingTree(int maxDepth)
             else
                 cubeModel->setParentOf(i, minElem, maxElem);
         }
+        cubeModel->setBoundingTreeParameters(d_sahBoundingTree.getValue() ? CubeCollisionModel::BuildMethod::SAH : CubeCollisionModel::BuildMethod::Median,
+                                             d_boundingTreeRebuildRatio.getValue());
         cubeModel->computeBoundingTree(maxDepth);
     }
 
@@ -348,6 +352,8 @@ void TriangleCollisionModel<DataTypes>::computeContinuousBoundingTree(double dt,
             else
                 cubeModel->setParentOf(i, minElem, maxElem);
         }
+        cubeModel->setBoundingTreeParameters(d_sahBoundingTree.getValue() ? CubeCollisionModel::BuildMethod::SAH : CubeCollisionModel::BuildMethod::Median,
+                                             d_boundingTreeRebuildRatio.getValue());
         cubeModel->computeBoundingTree(maxDepth);
     }
 }
@@ -32,6 +32,8 @@ using sofa::simulation::SceneLoaderXML ;
 
 #include "ForceFieldTestCreation.h"
 
+#include <sofa/simulation/TaskScheduler.h>
+
 using sofa::core::execparams::defaultInstance; 
 
 namespace sofa {
@@ -132,6 +134,101 @@ struct TetrahedronFEMForceField_test : public ForceField_test<_TetrahedronFEMFor
 
         EXPECT_EQ(fem->getComponentState(), ComponentState::Invalid) ;
     }
+
+    /// Compare the forces computed on a tetrahedralized grid by two force fields, which only differ by the
+    /// given attributes: exactly if exact is true, up to 1e-8 otherwise
+    void checkSameForces(const std::string& method, const std::string& gridSize, const std::string& referenceAttributes,
+                         const std::string& comparedAttributes, bool exact)
+    {
+        modeling::clearScene();
+
+        std::stringstream scene ;
+        scene << "<?xml version='1.0'?>"
+                 "<Node 	name='Root'>                                \n"
+                 "  <Node name='reference'>                             \n"
+                 "    <MechanicalObject/>                               \n"
+                 "    <RegularGridTopology n='" << gridSize << "' min='0 0 0' max='1 1 2'/>\n"
+                 "    <TetrahedronFEMForceField name='fem' youngModulus='5000' poissonRatio='0.3' method='" << method << "' "
+                 << referenceAttributes << "/>\n"
+                 "  </Node>                                             \n"
+                 "  <Node name='compared'>                              \n"
+                 "    <MechanicalObject/>                               \n"
+                 "    <RegularGridTopology n='" << gridSize << "' min='0 0 0' max='1 1 2'/>\n"
+                 "    <TetrahedronFEMForceField name='fem' youngModulus='5000' poissonRatio='0.3' method='" << method << "' "
+                 << comparedAttributes << "/>\n"
+                 "  </Node>                                             \n"
+                 "</Node>                                               \n" ;
+
+        Node::SPtr root = SceneLoaderXML::loadFromMemory ("testscene",
+                                                          scene.str().c_str(),
+                                                          scene.str().size()) ;
+        root->init(sofa::core::execparams::defaultInstance()) ;
+        sofa::simulation::TaskScheduler::getInstance()->init(4);
+
+        ForceType* reference = dynamic_cast<ForceType*>(root->getTreeNode("reference")->getObject("fem"));
+        ForceType* compared = dynamic_cast<ForceType*>(root->getTreeNode("compared")->getObject("fem"));
+        ASSERT_NE(reference, nullptr);
+        ASSERT_NE(compared, nullptr);
+
+        // deformed positions
+        VecCoord x0 = reference->_initialPoints.getValue();
+        VecCoord x1 = x0;
+        VecDeriv dx(x0.size());
+        for (std::size_t i = 0; i < x1.size(); ++i)
+        {
+            DataTypes::set(x1[i], x0[i][0] + (Real)0.1 * std::sin(Real(i)), x0[i][1] * (Real)1.2, x0[i][2] - (Real)0.05 * std::cos(Real(3*i)));
+            DataTypes::set(dx[i], (Real)0.01 * std::cos(Real(i)), (Real)0.02, (Real)-0.01 * std::sin(Real(2*i)));
+        }
+
+        core::MechanicalParams mparams;
+        mparams.setKFactor(1.0);
+
+        core::objectmodel::Data<VecCoord> dataX(x1);
+        core::objectmodel::Data<VecDeriv> dataV(VecDeriv(x1.size()));
+        core::objectmodel::Data<VecDeriv> dataDx(dx);
+        core::objectmodel::Data<VecDeriv> fReference(VecDeriv(x1.size())), fCompared(VecDeriv(x1.size()));
+        core::objectmodel::Data<VecDeriv> dfReference(VecDeriv(x1.size())), dfCompared(VecDeriv(x1.size()));
+
+        // addForce extracts the rotations used by the corotational kernels of addDForce
+        reference->addForce(&mparams, fReference, dataX, dataV);
+        compared->addForce(&mparams, fCompared, dataX, dataV);
+        reference->addDForce(&mparams, dfReference, dataDx);
+        compared->addDForce(&mparams, dfCompared, dataDx);
+
+        for (std::size_t i = 0; i < x1.size(); ++i)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                if (exact)
+                {
+                    EXPECT_EQ(fReference.getValue()[i][c], fCompared.getValue()[i][c]) << "node " << i;
+                    EXPECT_EQ(dfReference.getValue()[i][c], dfCompared.getValue()[i][c]) << "node " << i;
+                }
+                else
+                {
+                    EXPECT_NEAR(fReference.getValue()[i][c], fCompared.getValue()[i][c], 1e-8) << "node " << i;
+                    EXPECT_NEAR(dfReference.getValue()[i][c], dfCompared.getValue()[i][c], 1e-8) << "node " << i;
+                }
+            }
+        }
+    }
+
+    /// Compare the forces computed sequentially and concurrently
+    void checkMultithreadingMatchesSequential(const std::string& method, bool bitReproducible)
+    {
+        checkSameForces(method, "5 4 6", "",
+                        std::string("multithreading='true' bitReproducible='") + (bitReproducible ? "true" : "false") + "'",
+                        bitReproducible);
+    }
+
+    /// Compare the forces computed by the per element code and by the structure-of-arrays kernels, on a
+    /// grid whose number of elements is not a multiple of the block size
+    void checkVectorizedMatchesPerElement(const std::string& method, bool multithreading)
+    {
+        checkSameForces(method, "4 4 4", "",
+                        std::string("vectorized='true' multithreading='") + (multithreading ? "true" : "false") + "'",
+                        false);
+    }
 };
 
 // ========= Define the list of types to instanciate.
@@ -168,4 +265,29 @@ TYPED_TEST(TetrahedronFEMForceField_test, checkGracefullHandlingWhenTopologyIsMi
     this->checkGracefullHandlingWhenTopologyIsMissing();
 }
 
+TYPED_TEST(TetrahedronFEMForceField_test, multithreadingColored)
+{
+    for (const std::string method : {"small", "large", "polar", "svd"})
+    {
+        this->checkMultithreadingMatchesSequential(method, false);
+    }
+}
+
+TYPED_TEST(TetrahedronFEMForceField_test, multithreadingBitReproducible)
+{
+    for (const std::string method : {"small", "large", "polar", "svd"})
+    {
+        this->checkMultithreadingMatchesSequential(method, true);
+    }
+}
+
+TYPED_TEST(TetrahedronFEMForceField_test, vectorized)
+{
+    for (const std::string method : {"small", "large", "polar", "svd"})
+    {
+        this->checkVectorizedMatchesPerElement(method, false);
+        this->checkVectorizedMatchesPerElement(method, true);
+    }
+}
+
 } // namespace sofa
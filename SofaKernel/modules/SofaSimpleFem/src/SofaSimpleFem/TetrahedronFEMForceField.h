@@ -21,6 +21,7 @@
 ******************************************************************************/
 #pragma once
 #include <SofaSimpleFem/config.h>
+#include <SofaSimpleFem/TetrahedronFEMSoAKernel.h>
 
 #include <sofa/core/behavior/ForceField.h>
 #include <sofa/core/topology/BaseMeshTopology.h>
@@ -125,6 +126,9 @@ protected:
     /// Symmetrical tensor written as a vector following the Voigt notation
     typedef type::VecNoInit<6,Real> VoigtTensor;
 
+    /// Contributions of an element to the forces of its 4 nodes
+    typedef type::fixed_array<Deriv,4> ElementForces;
+
     /// @}
 
     /// Vector of material stiffness of each tetrahedron
@@ -219,6 +223,10 @@ public:
 
     Data<bool>  _updateStiffness; ///< udpate structures (precomputed in init) using stiffness parameters in each iteration (set listening=1)
 
+    Data<bool> d_multithreading; ///< Compute addForce and addDForce concurrently over the elements
+    Data<bool> d_bitReproducible; ///< Multithreading only: accumulate the nodal forces in the same order as the sequential computation
+    Data<bool> d_vectorized; ///< Apply the stiffness (addDForce) with SIMD kernels on blocks of elements stored as structure of arrays
+
     /// Link to be set to the topology container in the component graph. 
     SingleLink<TetrahedronFEMForceField<DataTypes>, sofa::core::topology::BaseMeshTopology, BaseLink::FLAG_STOREPATH|BaseLink::FLAG_STRONGLINK> l_topology;
 
@@ -309,6 +317,47 @@ protected:
 
     void applyStiffnessCorotational( Vector& f, const Vector& x, Index i=0, Index a=0,Index b=1,Index c=2,Index d=3, SReal fact=1.0  );
 
+    ////////////// per element computations, shared by the sequential and the multithreaded methods
+    void computeDisplacementSmall( Displacement& D, const Vector& p, const Element& index );
+    void computeDisplacementLarge( Displacement& D, const Vector& p, const Element& index, Index elementIndex );
+    void computeElementForceSmall( ElementForces& F, const Vector& p, const Element& index, Index elementIndex );
+    void computeElementForceLarge( ElementForces& F, const Vector& p, const Element& index, Index elementIndex );
+    void computeElementForcePolar( ElementForces& F, const Vector& p, const Element& index, Index elementIndex );
+    void computeElementForceSVD( ElementForces& F, const Vector& p, const Element& index, Index elementIndex );
+    void computeElementDForceSmall( ElementForces& F, const Vector& x, Index i, Index a, Index b, Index c, Index d, SReal fact );
+    void computeElementDForceCorotational( ElementForces& F, const Vector& x, Index i, Index a, Index b, Index c, Index d, SReal fact );
+
+    ////////////// multithreading
+    /// Elements grouped by color: two elements of the same color never share a node
+    type::vector< type::vector<Index> > m_elementsPerColor;
+    /// Compressed lists of the (element*4 + local vertex) contributing to each node, sorted by element
+    type::vector<Index> m_nodeContributionsBegin;
+    type::vector<Index> m_nodeContributions;
+    /// Per element forces, used when the nodal forces are gathered in the sequential order
+    type::vector<ElementForces> m_elementForces;
+    bool m_parallelStructuresUpToDate;
+
+    void updateParallelStructures();
+    template<class ElementKernel>
+    void accumulateElementForcesConcurrently( VecDeriv& f, const ElementKernel& computeElementForces );
+    void addForceConcurrently( VecDeriv& f, const VecCoord& p );
+    void addDForceConcurrently( VecDeriv& df, const VecDeriv& dx, SReal kFactor );
+
+    ////////////// SIMD kernels
+    typedef soa::TetrahedronBlock<Real> SoABlock;
+    typedef soa::BlockValues<Real> SoABlockValues;
+    /// Stiffness terms and rotations of the elements, by blocks of SoABlock::Lanes elements
+    type::vector<SoABlock> m_soaBlocks;
+    /// Per block forces, used when the blocks are processed concurrently
+    type::vector<SoABlockValues> m_soaBlockForces;
+    bool m_soaStructuresUpToDate;
+    bool m_soaRotationsUpToDate;
+
+    bool canUseVectorizedKernels() const;
+    void updateSoAStructures();
+    void updateSoARotations();
+    void addDForceVectorized( VecDeriv& df, const VecDeriv& dx, Real kFactor );
+
     void handleTopologyChange() override { needUpdateTopology = true; }
 
     void computeVonMisesStress();
@@ -29,6 +29,7 @@
 #include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
 #include <sofa/simulation/AnimateBeginEvent.h>
 #include <sofa/simulation/AnimateEndEvent.h>
+#include <sofa/simulation/ParallelFor.h>
 
 
 namespace sofa::component::forcefield
@@ -64,7 +65,13 @@ TetrahedronFEMForceField<DataTypes>::TetrahedronFEMForceField()
     , _showVonMisesStressPerNode(initData(&_showVonMisesStressPerNode,false,"showVonMisesStressPerNode","draw points showing vonMises stress interpolated in nodes"))
     , _showVonMisesStressPerElement(initData(&_showVonMisesStressPerElement, false, "showVonMisesStressPerElement", "draw triangles showing vonMises stress interpolated in elements"))
     , _updateStiffness(initData(&_updateStiffness,false,"updateStiffness","udpate structures (precomputed in init) using stiffness parameters in each iteration (set listening=1)"))
+    , d_multithreading(initData(&d_multithreading,false,"multithreading","Compute addForce and addDForce concurrently over the elements, using graph coloring (not available when computeGlobalMatrix is set)"))
+    , d_bitReproducible(initData(&d_bitReproducible,false,"bitReproducible","Multithreading only: gather the nodal forces in the same order as the sequential computation, to get bit-identical results (uses more memory)"))
+    , d_vectorized(initData(&d_vectorized,false,"vectorized","Apply the stiffness (addDForce) with SIMD kernels working on blocks of elements stored as structures of arrays (not available with updateStiffnessMatrix)"))
     , l_topology(initLink("topology", "link to the tetrahedron topology container"))
+    , m_parallelStructuresUpToDate(false)
+    , m_soaStructuresUpToDate(false)
+    , m_soaRotationsUpToDate(false)
 {
     _poissonRatio.setRequired(true);
     _youngModulus.setRequired(true);
@@ -585,17 +592,14 @@ void TetrahedronFEMForceField<DataTypes>::initSmall(Index i, Index&a, Index&b, I
 }
 
 template<class DataTypes>
-inline void TetrahedronFEMForceField<DataTypes>::accumulateForceSmall( Vector& f, const Vector & p, typename VecElement::const_iterator elementIt, Index elementIndex )
+inline void TetrahedronFEMForceField<DataTypes>::computeDisplacementSmall( Displacement& D, const Vector& p, const Element& index )
 {
     const VecCoord &initialPoints=_initialPoints.getValue();
-    Element index = *elementIt;
     Index a = index[0];
     Index b = index[1];
     Index c = index[2];
     Index d = index[3];
 
-    // displacements
-    Displacement D;
     D[0] = 0;
     D[1] = 0;
     D[2] = 0;
@@ -608,16 +612,52 @@ inline void TetrahedronFEMForceField<DataTypes>::accumulateForceSmall( Vector& f
     D[9] =  initialPoints[d][0] - initialPoints[a][0] - p[d][0]+p[a][0];
     D[10] = initialPoints[d][1] - initialPoints[a][1] - p[d][1]+p[a][1];
     D[11] = initialPoints[d][2] - initialPoints[a][2] - p[d][2]+p[a][2];
+}
+
+template<class DataTypes>
+inline void TetrahedronFEMForceField<DataTypes>::computeElementForceSmall( ElementForces& F, const Vector& p, const Element& index, Index elementIndex )
+{
+    Displacement D;
+    computeDisplacementSmall( D, p, index );
 
     // compute force on element
-    Displacement F;
+    Displacement Fe;
+    computeForce( Fe, D, _plasticStrains[elementIndex],
+                  materialsStiffnesses[elementIndex],
+                  strainDisplacements[elementIndex] );
+
+    F[0] = Deriv( Fe[0], Fe[1], Fe[2] );
+    F[1] = Deriv( Fe[3], Fe[4], Fe[5] );
+    F[2] = Deriv( Fe[6], Fe[7], Fe[8] );
+    F[3] = Deriv( Fe[9], Fe[10], Fe[11] );
+}
+
+template<class DataTypes>
+inline void TetrahedronFEMForceField<DataTypes>::accumulateForceSmall( Vector& f, const Vector & p, typename VecElement::const_iterator elementIt, Index elementIndex )
+{
+    Element index = *elementIt;
+
     if(!_assembling.getValue())
     {
-        computeForce( F, D, _plasticStrains[elementIndex],
-                      materialsStiffnesses[elementIndex],
-                      strainDisplacements[elementIndex] );
+        ElementForces F;
+        computeElementForceSmall( F, p, index, elementIndex );
+        for(int i=0; i<4; ++i)
+            f[index[i]] += F[i];
+        return;
     }
-    else if( _plasticMaxThreshold.getValue() <= 0 )
+
+    Index a = index[0];
+    Index b = index[1];
+    Index c = index[2];
+    Index d = index[3];
+
+    // displacements
+    Displacement D;
+    computeDisplacementSmall( D, p, index );
+
+    // compute force on element
+    Displacement F;
+    if( _plasticMaxThreshold.getValue() <= 0 )
     {
         Transformation Rot;
         Rot[0][0]=Rot[1][1]=Rot[2][2]=1;
@@ -779,6 +819,18 @@ inline SReal TetrahedronFEMForceField<DataTypes>::getPotentialEnergy(const core:
 
 template<class DataTypes>
 inline void TetrahedronFEMForceField<DataTypes>::applyStiffnessSmall( Vector& f, const Vector& x, Index i, Index a, Index b, Index c, Index d, SReal fact )
+{
+    ElementForces F;
+    computeElementDForceSmall( F, x, i, a, b, c, d, fact );
+
+    f[a] += F[0];
+    f[b] += F[1];
+    f[c] += F[2];
+    f[d] += F[3];
+}
+
+template<class DataTypes>
+inline void TetrahedronFEMForceField<DataTypes>::computeElementDForceSmall( ElementForces& F, const Vector& x, Index i, Index a, Index b, Index c, Index d, SReal fact )
 {
     Displacement X;
 
@@ -798,13 +850,13 @@ inline void TetrahedronFEMForceField<DataTypes>::applyStiffnessSmall( Vector& f,
     X[10] = x[d][1];
     X[11] = x[d][2];
 
-    Displacement F;
-    computeForce( F, X, materialsStiffnesses[i], strainDisplacements[i], fact );
+    Displacement Fe;
+    computeForce( Fe, X, materialsStiffnesses[i], strainDisplacements[i], fact );
 
-    f[a] += Deriv( -F[0], -F[1],  -F[2] );
-    f[b] += Deriv( -F[3], -F[4],  -F[5] );
-    f[c] += Deriv( -F[6], -F[7],  -F[8] );
-    f[d] += Deriv( -F[9], -F[10], -F[11] );
+    F[0] = Deriv( -Fe[0], -Fe[1],  -Fe[2] );
+    F[1] = Deriv( -Fe[3], -Fe[4],  -Fe[5] );
+    F[2] = Deriv( -Fe[6], -Fe[7],  -Fe[8] );
+    F[3] = Deriv( -Fe[9], -Fe[10], -Fe[11] );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -934,11 +986,8 @@ void TetrahedronFEMForceField<DataTypes>::initLarge(Index i, Index&a, Index&b, I
 }
 
 template<class DataTypes>
-inline void TetrahedronFEMForceField<DataTypes>::accumulateForceLarge( Vector& f, const Vector & p,
-                                                                       typename VecElement::const_iterator elementIt, Index elementIndex )
+inline void TetrahedronFEMForceField<DataTypes>::computeDisplacementLarge( Displacement& D, const Vector& p, const Element& index, Index elementIndex )
 {
-    Element index = *elementIt;
-
     // Rotation matrix (deformed and displaced Tetrahedron/world)
     Transformation R_0_2;
     computeRotationLarge( R_0_2, p, index[0],index[1],index[2]);
@@ -956,7 +1005,6 @@ inline void TetrahedronFEMForceField<DataTypes>::accumulateForceLarge( Vector& f
     deforme[3] -= deforme[0];
 
     // displacement
-    Displacement D;
     D[0] = 0;
     D[1] = 0;
     D[2] = 0;
@@ -970,7 +1018,6 @@ inline void TetrahedronFEMForceField<DataTypes>::accumulateForceLarge( Vector& f
     D[10] = _rotatedInitialElements[elementIndex][3][1] - deforme[3][1];
     D[11] =_rotatedInitialElements[elementIndex][3][2] - deforme[3][2];
 
-    Displacement F;
     if(_updateStiffnessMatrix.getValue())
     {
         strainDisplacements[elementIndex][0][0]   = ( - deforme[2][1]*deforme[3][2] );
@@ -986,15 +1033,41 @@ inline void TetrahedronFEMForceField<DataTypes>::accumulateForceLarge( Vector& f
 
         strainDisplacements[elementIndex][11][2] = ( deforme[1][0]*deforme[2][1] );
     }
+}
+
+template<class DataTypes>
+inline void TetrahedronFEMForceField<DataTypes>::computeElementForceLarge( ElementForces& F, const Vector& p, const Element& index, Index elementIndex )
+{
+    Displacement D;
+    computeDisplacementLarge( D, p, index, elementIndex );
+
+    // compute force on element
+    Displacement Fe;
+    computeForce( Fe, D, _plasticStrains[elementIndex], materialsStiffnesses[elementIndex], strainDisplacements[elementIndex] );
+    for(int i=0; i<12; i+=3)
+        F[i/3] = rotations[elementIndex] * Deriv( Fe[i], Fe[i+1],  Fe[i+2] );
+}
+
+template<class DataTypes>
+inline void TetrahedronFEMForceField<DataTypes>::accumulateForceLarge( Vector& f, const Vector & p,
+                                                                       typename VecElement::const_iterator elementIt, Index elementIndex )
+{
+    Element index = *elementIt;
 
     if(!_assembling.getValue())
     {
-        // compute force on element
-        computeForce( F, D, _plasticStrains[elementIndex], materialsStiffnesses[elementIndex], strainDisplacements[elementIndex] );
-        for(int i=0; i<12; i+=3)
-            f[index[i/3]] += rotations[elementIndex] * Deriv( F[i], F[i+1],  F[i+2] );
+        ElementForces F;
+        computeElementForceLarge( F, p, index, elementIndex );
+        for(int i=0; i<4; ++i)
+            f[index[i]] += F[i];
+        return;
     }
-    else if( _plasticMaxThreshold.getValue() <= 0 )
+
+    Displacement D;
+    computeDisplacementLarge( D, p, index, elementIndex );
+
+    Displacement F;
+    if( _plasticMaxThreshold.getValue() <= 0 )
     {
         strainDisplacements[elementIndex][6][0] = 0;
         strainDisplacements[elementIndex][9][0] = 0;
@@ -1093,6 +1166,22 @@ inline void TetrahedronFEMForceField<DataTypes>::accumulateForcePolar( Vector& f
 {
     Element index = *elementIt;
 
+    if(!_assembling.getValue())
+    {
+        ElementForces F;
+        computeElementForcePolar( F, p, index, elementIndex );
+        for(int i=0; i<4; ++i)
+            f[index[i]] += F[i];
+    }
+    else
+    {
+        dmsg_error() << "Support for assembling system matrix when using polar method.";
+    }
+}
+
+template<class DataTypes>
+inline void TetrahedronFEMForceField<DataTypes>::computeElementForcePolar( ElementForces& F, const Vector& p, const Element& index, Index elementIndex )
+{
     Transformation A;
     A[0] = p[index[1]]-p[index[0]];
     A[1] = p[index[2]]-p[index[0]];
@@ -1123,25 +1212,16 @@ inline void TetrahedronFEMForceField<DataTypes>::accumulateForcePolar( Vector& f
     D[10] = _rotatedInitialElements[elementIndex][3][1] - deforme[3][1];
     D[11] = _rotatedInitialElements[elementIndex][3][2] - deforme[3][2];
 
-
-
-    Displacement F;
     if(_updateStiffnessMatrix.getValue())
     {
         // shape functions matrix
         computeStrainDisplacement( strainDisplacements[elementIndex], deforme[0],deforme[1],deforme[2],deforme[3] );
     }
 
-    if(!_assembling.getValue())
-    {
-        computeForce( F, D, _plasticStrains[elementIndex], materialsStiffnesses[elementIndex], strainDisplacements[elementIndex] );
-        for(int i=0; i<12; i+=3)
-            f[index[i/3]] += rotations[elementIndex] * Deriv( F[i], F[i+1],  F[i+2] );
-    }
-    else
-    {
-        dmsg_error() << "Support for assembling system matrix when using polar method.";
-    }
+    Displacement Fe;
+    computeForce( Fe, D, _plasticStrains[elementIndex], materialsStiffnesses[elementIndex], strainDisplacements[elementIndex] );
+    for(int i=0; i<12; i+=3)
+        F[i/3] = rotations[elementIndex] * Deriv( Fe[i], Fe[i+1],  Fe[i+2] );
 }
 
 
@@ -1194,6 +1274,15 @@ inline void TetrahedronFEMForceField<DataTypes>::accumulateForceSVD( Vector& f,
 
     Element index = *elementIt;
 
+    ElementForces F;
+    computeElementForceSVD( F, p, index, elementIndex );
+    for(int i=0; i<4; ++i)
+        f[index[i]] += F[i];
+}
+
+template<class DataTypes>
+inline void TetrahedronFEMForceField<DataTypes>::computeElementForceSVD( ElementForces& Fn, const Vector& p, const Element& index, Index elementIndex )
+{
     Transformation A;
     A[0] = p[index[1]]-p[index[0]];
     A[1] = p[index[2]]-p[index[0]];
@@ -1244,7 +1333,7 @@ inline void TetrahedronFEMForceField<DataTypes>::accumulateForceSVD( Vector& f,
     computeForce( Forces, D, _plasticStrains[elementIndex], materialsStiffnesses[elementIndex], strainDisplacements[elementIndex] );
     for( int i=0 ; i<12 ; i+=3 )
     {
-        f[index[i/3]] += rotations[elementIndex] * Deriv( Forces[i], Forces[i+1],  Forces[i+2] );
+        Fn[i/3] = rotations[elementIndex] * Deriv( Forces[i], Forces[i+1],  Forces[i+2] );
     }
 }
 
@@ -1256,6 +1345,18 @@ inline void TetrahedronFEMForceField<DataTypes>::accumulateForceSVD( Vector& f,
 
 template<class DataTypes>
 inline void TetrahedronFEMForceField<DataTypes>::applyStiffnessCorotational( Vector& f, const Vector& x, Index i, Index a, Index b, Index c, Index d, SReal fact )
+{
+    ElementForces F;
+    computeElementDForceCorotational( F, x, i, a, b, c, d, fact );
+
+    f[a] += F[0];
+    f[b] += F[1];
+    f[c] += F[2];
+    f[d] += F[3];
+}
+
+template<class DataTypes>
+inline void TetrahedronFEMForceField<DataTypes>::computeElementDForceCorotational( ElementForces& Fn, const Vector& x, Index i, Index a, Index b, Index c, Index d, SReal fact )
 {
     Displacement X;
 
@@ -1282,22 +1383,21 @@ inline void TetrahedronFEMForceField<DataTypes>::applyStiffnessCorotational( Vec
 
 
     // rotate by rotations[i]
-    f[a][0] -= rotations[i][0][0] *  F[0] +  rotations[i][0][1] * F[1]  + rotations[i][0][2] * F[2];
-    f[a][1] -= rotations[i][1][0] *  F[0] +  rotations[i][1][1] * F[1]  + rotations[i][1][2] * F[2];
-    f[a][2] -= rotations[i][2][0] *  F[0] +  rotations[i][2][1] * F[1]  + rotations[i][2][2] * F[2];
-
-    f[b][0] -= rotations[i][0][0] *  F[3] +  rotations[i][0][1] * F[4]  + rotations[i][0][2] * F[5];
-    f[b][1] -= rotations[i][1][0] *  F[3] +  rotations[i][1][1] * F[4]  + rotations[i][1][2] * F[5];
-    f[b][2] -= rotations[i][2][0] *  F[3] +  rotations[i][2][1] * F[4]  + rotations[i][2][2] * F[5];
+    Fn[0][0] = -( rotations[i][0][0] *  F[0] +  rotations[i][0][1] * F[1]  + rotations[i][0][2] * F[2] );
+    Fn[0][1] = -( rotations[i][1][0] *  F[0] +  rotations[i][1][1] * F[1]  + rotations[i][1][2] * F[2] );
+    Fn[0][2] = -( rotations[i][2][0] *  F[0] +  rotations[i][2][1] * F[1]  + rotations[i][2][2] * F[2] );
 
-    f[c][0] -= rotations[i][0][0] *  F[6] +  rotations[i][0][1] * F[7]  + rotations[i][0][2] * F[8];
-    f[c][1] -= rotations[i][1][0] *  F[6] +  rotations[i][1][1] * F[7]  + rotations[i][1][2] * F[8];
-    f[c][2] -= rotations[i][2][0] *  F[6] +  rotations[i][2][1] * F[7]  + rotations[i][2][2] * F[8];
+    Fn[1][0] = -( rotations[i][0][0] *  F[3] +  rotations[i][0][1] * F[4]  + rotations[i][0][2] * F[5] );
+    Fn[1][1] = -( rotations[i][1][0] *  F[3] +  rotations[i][1][1] * F[4]  + rotations[i][1][2] * F[5] );
+    Fn[1][2] = -( rotations[i][2][0] *  F[3] +  rotations[i][2][1] * F[4]  + rotations[i][2][2] * F[5] );
 
-    f[d][0] -= rotations[i][0][0] *  F[9] +  rotations[i][0][1] * F[10] + rotations[i][0][2] * F[11];
-    f[d][1]	-= rotations[i][1][0] *  F[9] +  rotations[i][1][1] * F[10] + rotations[i][1][2] * F[11];
-    f[d][2]	-= rotations[i][2][0] *  F[9] +  rotations[i][2][1] * F[10] + rotations[i][2][2] * F[11];
+    Fn[2][0] = -( rotations[i][0][0] *  F[6] +  rotations[i][0][1] * F[7]  + rotations[i][0][2] * F[8] );
+    Fn[2][1] = -( rotations[i][1][0] *  F[6] +  rotations[i][1][1] * F[7]  + rotations[i][1][2] * F[8] );
+    Fn[2][2] = -( rotations[i][2][0] *  F[6] +  rotations[i][2][1] * F[7]  + rotations[i][2][2] * F[8] );
 
+    Fn[3][0] = -( rotations[i][0][0] *  F[9] +  rotations[i][0][1] * F[10] + rotations[i][0][2] * F[11] );
+    Fn[3][1] = -( rotations[i][1][0] *  F[9] +  rotations[i][1][1] * F[10] + rotations[i][1][2] * F[11] );
+    Fn[3][2] = -( rotations[i][2][0] *  F[9] +  rotations[i][2][1] * F[10] + rotations[i][2][2] * F[11] );
 }
 
 
@@ -1445,6 +1545,11 @@ void TetrahedronFEMForceField<DataTypes>::init()
 
     d_componentState.setValue(ComponentState::Valid) ;
 
+    if (d_multithreading.getValue())
+    {
+        simulation::TaskScheduler::getInstance()->init();
+    }
+
     reinit(); // compute per-element stiffness matrices and other precomputed values
 
     msg_info() << "Init done with "<<_indexedElements->size()<<" tetras.";
@@ -1481,6 +1586,8 @@ inline void TetrahedronFEMForceField<DataTypes>::reinit()
     }
 
     setMethod(f_method.getValue() );
+    m_parallelStructuresUpToDate = false;
+    m_soaStructuresUpToDate = false;
     const VecCoord& p = this->mstate->read(core::ConstVecCoordId::restPosition())->getValue();
     _initialPoints.setValue(p);
     strainDisplacements.resize( _indexedElements->size() );
@@ -1635,6 +1742,17 @@ inline void TetrahedronFEMForceField<DataTypes>::addForce (const core::Mechanica
         needUpdateTopology = false;
     }
 
+    // the corotational methods update the rotations of the elements
+    m_soaRotationsUpToDate = false;
+
+    if (d_multithreading.getValue() && !_assembling.getValue())
+    {
+        addForceConcurrently(f, p);
+        d_f.endEdit();
+        updateVonMisesStress = true;
+        return;
+    }
+
     unsigned int i;
     typename VecElement::const_iterator it;
     switch(method)
@@ -1686,6 +1804,21 @@ inline void TetrahedronFEMForceField<DataTypes>::addDForce(const core::Mechanica
     Real kFactor = (Real)sofa::core::mechanicalparams::kFactorIncludingRayleighDamping(mparams, this->rayleighStiffness.getValue());
 
     df.resize(dx.size());
+
+    if (canUseVectorizedKernels())
+    {
+        addDForceVectorized(df, dx, kFactor);
+        d_df.endEdit();
+        return;
+    }
+
+    if (d_multithreading.getValue())
+    {
+        addDForceConcurrently(df, dx, kFactor);
+        d_df.endEdit();
+        return;
+    }
+
     unsigned int i;
     typename VecElement::const_iterator it;
 
@@ -1717,6 +1850,273 @@ inline void TetrahedronFEMForceField<DataTypes>::addDForce(const core::Mechanica
     d_df.endEdit();
 }
 
+template<class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::updateParallelStructures()
+{
+    const VecElement& elements = *_indexedElements;
+
+    Size nbNodes = this->mstate->getSize();
+    for (const Element& e : elements)
+        for (Index v : e)
+            nbNodes = std::max(nbNodes, Size(v + 1));
+
+    // greedy coloring: an element gets the first color not used yet by the elements sharing one of its nodes
+    m_elementsPerColor.clear();
+    type::vector< type::vector<unsigned int> > nodeColors(nbNodes);
+    type::vector<char> forbidden;
+    for (Index i = 0; i < elements.size(); ++i)
+    {
+        forbidden.assign(m_elementsPerColor.size() + 1, 0);
+        for (Index v : elements[i])
+            for (unsigned int c : nodeColors[v])
+                forbidden[c] = 1;
+
+        unsigned int color = 0;
+        while (forbidden[color])
+            ++color;
+
+        if (color == m_elementsPerColor.size())
+            m_elementsPerColor.emplace_back();
+        m_elementsPerColor[color].push_back(i);
+
+        for (Index v : elements[i])
+            nodeColors[v].push_back(color);
+    }
+
+    // contributions of the elements to each node, in the order of the sequential computation
+    m_nodeContributionsBegin.assign(nbNodes + 1, 0);
+    for (const Element& e : elements)
+        for (Index v : e)
+            ++m_nodeContributionsBegin[v + 1];
+    for (Size v = 0; v < nbNodes; ++v)
+        m_nodeContributionsBegin[v + 1] += m_nodeContributionsBegin[v];
+
+    m_nodeContributions.resize(elements.size() * 4);
+    type::vector<Index> fill(m_nodeContributionsBegin.begin(), m_nodeContributionsBegin.end() - 1);
+    for (Index i = 0; i < elements.size(); ++i)
+        for (Index k = 0; k < 4; ++k)
+            m_nodeContributions[fill[elements[i][k]]++] = i * 4 + k;
+
+    m_elementForces.clear();
+
+    msg_info() << "Multithreading: " << elements.size() << " elements in " << m_elementsPerColor.size() << " colors.";
+
+    m_parallelStructuresUpToDate = true;
+}
+
+template<class DataTypes>
+template<class ElementKernel>
+void TetrahedronFEMForceField<DataTypes>::accumulateElementForcesConcurrently( VecDeriv& f, const ElementKernel& computeElementForces )
+{
+    if (!m_parallelStructuresUpToDate)
+        updateParallelStructures();
+
+    const VecElement& elements = *_indexedElements;
+
+    if (d_bitReproducible.getValue())
+    {
+        // compute the forces of all the elements, then gather them node by node in increasing element order
+        m_elementForces.resize(elements.size());
+        simulation::parallelFor(std::size_t(0), elements.size(), std::size_t(0), [&](std::size_t i)
+        {
+            computeElementForces(m_elementForces[i], Index(i));
+        });
+
+        const std::size_t nbNodes = std::min(f.size(), m_nodeContributionsBegin.size() - 1);
+        simulation::parallelFor(std::size_t(0), nbNodes, std::size_t(0), [&](std::size_t v)
+        {
+            for (Index c = m_nodeContributionsBegin[v]; c < m_nodeContributionsBegin[v + 1]; ++c)
+                f[v] += m_elementForces[m_nodeContributions[c] / 4][m_nodeContributions[c] % 4];
+        });
+    }
+    else
+    {
+        // the elements of a color do not share any node: they can be accumulated without race
+        for (const type::vector<Index>& color : m_elementsPerColor)
+        {
+            simulation::parallelFor(std::size_t(0), color.size(), std::size_t(0), [&](std::size_t k)
+            {
+                const Index i = color[k];
+                ElementForces F;
+                computeElementForces(F, i);
+                for (int n = 0; n < 4; ++n)
+                    f[elements[i][n]] += F[n];
+            });
+        }
+    }
+}
+
+template<class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::addForceConcurrently( VecDeriv& f, const VecCoord& p )
+{
+    const VecElement& elements = *_indexedElements;
+    switch(method)
+    {
+    case SMALL :
+        accumulateElementForcesConcurrently(f, [&](ElementForces& F, Index i) { computeElementForceSmall(F, p, elements[i], i); });
+        break;
+    case LARGE :
+        accumulateElementForcesConcurrently(f, [&](ElementForces& F, Index i) { computeElementForceLarge(F, p, elements[i], i); });
+        break;
+    case POLAR :
+        accumulateElementForcesConcurrently(f, [&](ElementForces& F, Index i) { computeElementForcePolar(F, p, elements[i], i); });
+        break;
+    case SVD :
+        accumulateElementForcesConcurrently(f, [&](ElementForces& F, Index i) { computeElementForceSVD(F, p, elements[i], i); });
+        break;
+    }
+}
+
+template<class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::addDForceConcurrently( VecDeriv& df, const VecDeriv& dx, SReal kFactor )
+{
+    const VecElement& elements = *_indexedElements;
+    if( method == SMALL )
+    {
+        accumulateElementForcesConcurrently(df, [&](ElementForces& F, Index i)
+        {
+            const Element& e = elements[i];
+            computeElementDForceSmall(F, dx, i, e[0], e[1], e[2], e[3], kFactor);
+        });
+    }
+    else
+    {
+        accumulateElementForcesConcurrently(df, [&](ElementForces& F, Index i)
+        {
+            const Element& e = elements[i];
+            computeElementDForceCorotational(F, dx, i, e[0], e[1], e[2], e[3], kFactor);
+        });
+    }
+}
+
+template<class DataTypes>
+bool TetrahedronFEMForceField<DataTypes>::canUseVectorizedKernels() const
+{
+    // updateStiffnessMatrix only updates a part of the strain-displacement matrices, which then
+    // lose the structure the kernels rely on
+    return d_vectorized.getValue() && !_updateStiffnessMatrix.getValue();
+}
+
+template<class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::updateSoAStructures()
+{
+    const VecElement& elements = *_indexedElements;
+    const std::size_t lanes = SoABlock::Lanes;
+
+    m_soaBlocks.resize((elements.size() + lanes - 1) / lanes);
+    for (std::size_t b = 0; b < m_soaBlocks.size(); ++b)
+    {
+        SoABlock& block = m_soaBlocks[b];
+        block.nbElements = std::min(lanes, elements.size() - b * lanes);
+
+        for (std::size_t l = 0; l < lanes; ++l)
+        {
+            // unused lanes get null stiffnesses, their forces are never accumulated
+            const bool used = l < block.nbElements;
+            const std::size_t i = b * lanes + l;
+
+            for (int v = 0; v < 4; ++v)
+            {
+                block.vertex[v][l] = used ? elements[i][v] : 0;
+                block.J[v][0][l] = used ? strainDisplacements[i][3*v][0] : 0;
+                block.J[v][1][l] = used ? strainDisplacements[i][3*v][3] : 0;
+                block.J[v][2][l] = used ? strainDisplacements[i][3*v][5] : 0;
+            }
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    block.K[3*r + c][l] = used ? materialsStiffnesses[i][r][c] : 0;
+            for (int r = 3; r < 6; ++r)
+                block.K[6 + r][l] = used ? materialsStiffnesses[i][r][r] : 0;
+            for (int k = 0; k < 9; ++k)
+                block.R[k][l] = (k % 4 == 0) ? 1 : 0;
+        }
+    }
+
+    m_soaBlockForces.clear();
+
+    msg_info() << "Vectorized stiffness: " << elements.size() << " elements in " << m_soaBlocks.size()
+               << " blocks of " << lanes << " (" << soa::instructionSet() << ").";
+
+    m_soaStructuresUpToDate = true;
+    m_soaRotationsUpToDate = false;
+}
+
+template<class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::updateSoARotations()
+{
+    const std::size_t lanes = SoABlock::Lanes;
+    for (std::size_t b = 0; b < m_soaBlocks.size(); ++b)
+    {
+        SoABlock& block = m_soaBlocks[b];
+        for (std::size_t l = 0; l < block.nbElements; ++l)
+        {
+            const Transformation& R = rotations[b * lanes + l];
+            for (int k = 0; k < 9; ++k)
+                block.R[k][l] = R[k / 3][k % 3];
+        }
+    }
+    m_soaRotationsUpToDate = true;
+}
+
+template<class DataTypes>
+void TetrahedronFEMForceField<DataTypes>::addDForceVectorized( VecDeriv& df, const VecDeriv& dx, Real kFactor )
+{
+    if (!m_soaStructuresUpToDate)
+        updateSoAStructures();
+    if (method != SMALL && !m_soaRotationsUpToDate)
+        updateSoARotations();
+
+    const std::size_t lanes = SoABlock::Lanes;
+
+    auto computeBlockForces = [&](const SoABlock& block, SoABlockValues& F)
+    {
+        SoABlockValues X;
+        for (int v = 0; v < 4; ++v)
+        {
+            for (std::size_t l = 0; l < lanes; ++l)
+            {
+                const Deriv& x = dx[block.vertex[v][l]];
+                X.v[3*v  ][l] = x[0];
+                X.v[3*v+1][l] = x[1];
+                X.v[3*v+2][l] = x[2];
+            }
+        }
+
+        if (method == SMALL)
+            soa::applyStiffness<Real, false>(block, X, kFactor, F);
+        else
+            soa::applyStiffness<Real, true>(block, X, kFactor, F);
+    };
+
+    // accumulate in the element order, as the per element computation
+    auto accumulateBlockForces = [&](const SoABlock& block, const SoABlockValues& F)
+    {
+        for (std::size_t l = 0; l < block.nbElements; ++l)
+            for (int v = 0; v < 4; ++v)
+                df[block.vertex[v][l]] += Deriv(F.v[3*v][l], F.v[3*v+1][l], F.v[3*v+2][l]);
+    };
+
+    if (d_multithreading.getValue())
+    {
+        m_soaBlockForces.resize(m_soaBlocks.size());
+        simulation::parallelFor(std::size_t(0), m_soaBlocks.size(), std::size_t(0), [&](std::size_t b)
+        {
+            computeBlockForces(m_soaBlocks[b], m_soaBlockForces[b]);
+        });
+        for (std::size_t b = 0; b < m_soaBlocks.size(); ++b)
+            accumulateBlockForces(m_soaBlocks[b], m_soaBlockForces[b]);
+    }
+    else
+    {
+        SoABlockValues F;
+        for (const SoABlock& block : m_soaBlocks)
+        {
+            computeBlockForces(block, F);
+            accumulateBlockForces(block, F);
+        }
+    }
+}
+
 //////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////
@@ -2271,6 +2671,7 @@ void TetrahedronFEMForceField<DataTypes>::handleEvent(core::objectmodel::Event *
                 Index d = (*it)[3];
                 this->computeMaterialStiffness(i,a,b,c,d);
             }
+            m_soaStructuresUpToDate = false;
         }
     }
     if (sofa::simulation::AnimateEndEvent::checkEventType(event)) {
@@ -0,0 +1,253 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaSimpleFem/config.h>
+
+#include <sofa/config.h>
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SOFASIMPLEFEM_SOA_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFASIMPLEFEM_SOA_SSE2
+#endif
+
+/// Structure of arrays storage and SIMD kernels used by TetrahedronFEMForceField to apply the
+/// element stiffnesses (addDForce) on blocks of elements.
+///
+/// A block stores 4 elements in double precision (8 in single precision), so that each
+/// coefficient of the block fills one AVX register, or two SSE registers.
+/// The kernels do the same operations in the same order as the per element code, without
+/// fused multiply-add, so that each lane gives the result of the scalar computation.
+namespace sofa::component::forcefield::soa
+{
+
+/// Pack of values on which the operations are applied lane by lane
+template<class Real>
+struct Pack;
+
+template<>
+struct Pack<double>
+{
+    static constexpr std::size_t size = 4;
+
+#if defined(SOFASIMPLEFEM_SOA_AVX)
+    __m256d v;
+
+    static Pack load(const double* p) { return { _mm256_load_pd(p) }; }
+    static Pack set(double s) { return { _mm256_set1_pd(s) }; }
+    void store(double* p) const { _mm256_store_pd(p, v); }
+
+    friend Pack operator+(const Pack& a, const Pack& b) { return { _mm256_add_pd(a.v, b.v) }; }
+    friend Pack operator*(const Pack& a, const Pack& b) { return { _mm256_mul_pd(a.v, b.v) }; }
+    friend Pack operator-(const Pack& a) { return { _mm256_xor_pd(a.v, _mm256_set1_pd(-0.0)) }; }
+#elif defined(SOFASIMPLEFEM_SOA_SSE2)
+    __m128d lo, hi;
+
+    static Pack load(const double* p) { return { _mm_load_pd(p), _mm_load_pd(p + 2) }; }
+    static Pack set(double s) { return { _mm_set1_pd(s), _mm_set1_pd(s) }; }
+    void store(double* p) const { _mm_store_pd(p, lo); _mm_store_pd(p + 2, hi); }
+
+    friend Pack operator+(const Pack& a, const Pack& b) { return { _mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi) }; }
+    friend Pack operator*(const Pack& a, const Pack& b) { return { _mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi) }; }
+    friend Pack operator-(const Pack& a)
+    {
+        const __m128d sign = _mm_set1_pd(-0.0);
+        return { _mm_xor_pd(a.lo, sign), _mm_xor_pd(a.hi, sign) };
+    }
+#else
+    double v[size];
+
+    static Pack load(const double* p) { Pack r; for (std::size_t l = 0; l < size; ++l) r.v[l] = p[l]; return r; }
+    static Pack set(double s) { Pack r; for (std::size_t l = 0; l < size; ++l) r.v[l] = s; return r; }
+    void store(double* p) const { for (std::size_t l = 0; l < size; ++l) p[l] = v[l]; }
+
+    friend Pack operator+(const Pack& a, const Pack& b) { Pack r; for (std::size_t l = 0; l < size; ++l) r.v[l] = a.v[l] + b.v[l]; return r; }
+    friend Pack operator*(const Pack& a, const Pack& b) { Pack r; for (std::size_t l = 0; l < size; ++l) r.v[l] = a.v[l] * b.v[l]; return r; }
+    friend Pack operator-(const Pack& a) { Pack r; for (std::size_t l = 0; l < size; ++l) r.v[l] = -a.v[l]; return r; }
+#endif
+};
+
+template<>
+struct Pack<float>
+{
+    static constexpr std::size_t size = 8;
+
+#if defined(SOFASIMPLEFEM_SOA_AVX)
+    __m256 v;
+
+    static Pack load(const float* p) { return { _mm256_load_ps(p) }; }
+    static Pack set(float s) { return { _mm256_set1_ps(s) }; }
+    void store(float* p) const { _mm256_store_ps(p, v); }
+
+    friend Pack operator+(const Pack& a, const Pack& b) { return { _mm256_add_ps(a.v, b.v) }; }
+    friend Pack operator*(const Pack& a, const Pack& b) { return { _mm256_mul_ps(a.v, b.v) }; }
+    friend Pack operator-(const Pack& a) { return { _mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)) }; }
+#elif defined(SOFASIMPLEFEM_SOA_SSE2)
+    __m128 lo, hi;
+
+    static Pack load(const float* p) { return { _mm_load_ps(p), _mm_load_ps(p + 4) }; }
+    static Pack set(float s) { return { _mm_set1_ps(s), _mm_set1_ps(s) }; }
+    void store(float* p) const { _mm_store_ps(p, lo); _mm_store_ps(p + 4, hi); }
+
+    friend Pack operator+(const Pack& a, const Pack& b) { return { _mm_add_ps(a.lo, b.lo), _mm_add_ps(a.hi, b.hi) }; }
+    friend Pack operator*(const Pack& a, const Pack& b) { return { _mm_mul_ps(a.lo, b.lo), _mm_mul_ps(a.hi, b.hi) }; }
+    friend Pack operator-(const Pack& a)
+    {
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        return { _mm_xor_ps(a.lo, sign), _mm_xor_ps(a.hi, sign) };
+    }
+#else
+    float v[size];
+
+    static Pack load(const float* p) { Pack r; for (std::size_t l = 0; l < size; ++l) r.v[l] = p[l]; return r; }
+    static Pack set(float s) { Pack r; for (std::size_t l = 0; l < size; ++l) r.v[l] = s; return r; }
+    void store(float* p) const { for (std::size_t l = 0; l < size; ++l) p[l] = v[l]; }
+
+    friend Pack operator+(const Pack& a, const Pack& b) { Pack r; for (std::size_t l = 0; l < size; ++l) r.v[l] = a.v[l] + b.v[l]; return r; }
+    friend Pack operator*(const Pack& a, const Pack& b) { Pack r; for (std::size_t l = 0; l < size; ++l) r.v[l] = a.v[l] * b.v[l]; return r; }
+    friend Pack operator-(const Pack& a) { Pack r; for (std::size_t l = 0; l < size; ++l) r.v[l] = -a.v[l]; return r; }
+#endif
+};
+
+/// Name of the instruction set used by the kernels, for logging
+inline const char* instructionSet()
+{
+#if defined(SOFASIMPLEFEM_SOA_AVX)
+    return "AVX";
+#elif defined(SOFASIMPLEFEM_SOA_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+/// Stiffness terms of a block of tetrahedra.
+///
+/// The strain-displacement matrix of a tetrahedron only has 3 distinct coefficients per vertex
+/// (see TetrahedronFEMForceField::computeStrainDisplacement): J[3v][0] = J[3v+1][3] = J[3v+2][5],
+/// J[3v][3] = J[3v+1][1] = J[3v+2][4] and J[3v][5] = J[3v+1][4] = J[3v+2][2].
+/// The material stiffness only has its upper left 3x3 block and its lower right diagonal.
+template<class Real>
+struct alignas(32) TetrahedronBlock
+{
+    static constexpr std::size_t Lanes = Pack<Real>::size;
+
+    Real J[4][3][Lanes];   ///< strain-displacement coefficients, per vertex
+    Real K[12][Lanes];     ///< material stiffness: 3x3 block then the 3 shear terms
+    Real R[9][Lanes];      ///< element rotation (row major), corotational methods only
+    sofa::Index vertex[4][Lanes];
+    std::size_t nbElements; ///< number of used lanes, the last block of a mesh may be incomplete
+};
+
+/// Values of the 12 degrees of freedom of the elements of a block
+template<class Real>
+struct alignas(32) BlockValues
+{
+    static constexpr std::size_t Lanes = Pack<Real>::size;
+    Real v[12][Lanes];
+};
+
+/// Compute the forces -fact * R J K Jt Rt x of the elements of a block (R = identity if not Corotational).
+/// Mirrors TetrahedronFEMForceField::computeElementDForceSmall/Corotational and computeForce.
+template<class Real, bool Corotational>
+inline void applyStiffness(const TetrahedronBlock<Real>& block, const BlockValues<Real>& x, Real fact, BlockValues<Real>& f)
+{
+    typedef Pack<Real> P;
+
+    P X[12];
+    if (Corotational)
+    {
+        // rotate by the transposed rotation
+        P R[9];
+        for (int k = 0; k < 9; ++k)
+            R[k] = P::load(block.R[k]);
+
+        for (int v = 0; v < 4; ++v)
+        {
+            const P x0 = P::load(x.v[3*v]);
+            const P x1 = P::load(x.v[3*v+1]);
+            const P x2 = P::load(x.v[3*v+2]);
+            X[3*v  ] = R[0] * x0 + R[3] * x1 + R[6] * x2;
+            X[3*v+1] = R[1] * x0 + R[4] * x1 + R[7] * x2;
+            X[3*v+2] = R[2] * x0 + R[5] * x1 + R[8] * x2;
+        }
+    }
+    else
+    {
+        for (int k = 0; k < 12; ++k)
+            X[k] = P::load(x.v[k]);
+    }
+
+    P b[4], g[4], d[4];
+    for (int v = 0; v < 4; ++v)
+    {
+        b[v] = P::load(block.J[v][0]);
+        g[v] = P::load(block.J[v][1]);
+        d[v] = P::load(block.J[v][2]);
+    }
+
+    // Jt X
+    P JtD[6];
+    JtD[0] = b[0]*X[0] + b[1]*X[3] + b[2]*X[6] + b[3]*X[9];
+    JtD[1] = g[0]*X[1] + g[1]*X[4] + g[2]*X[7] + g[3]*X[10];
+    JtD[2] = d[0]*X[2] + d[1]*X[5] + d[2]*X[8] + d[3]*X[11];
+    JtD[3] = g[0]*X[0] + b[0]*X[1] + g[1]*X[3] + b[1]*X[4] + g[2]*X[6] + b[2]*X[7] + g[3]*X[9] + b[3]*X[10];
+    JtD[4] = d[0]*X[1] + g[0]*X[2] + d[1]*X[4] + g[1]*X[5] + d[2]*X[7] + g[2]*X[8] + d[3]*X[10] + g[3]*X[11];
+    JtD[5] = d[0]*X[0] + b[0]*X[2] + d[1]*X[3] + b[1]*X[5] + d[2]*X[6] + b[2]*X[8] + d[3]*X[9] + b[3]*X[11];
+
+    // K Jt X
+    const P factor = P::set(fact);
+    P KJtD[6];
+    KJtD[0] = (P::load(block.K[0])*JtD[0] + P::load(block.K[1])*JtD[1] + P::load(block.K[2])*JtD[2]) * factor;
+    KJtD[1] = (P::load(block.K[3])*JtD[0] + P::load(block.K[4])*JtD[1] + P::load(block.K[5])*JtD[2]) * factor;
+    KJtD[2] = (P::load(block.K[6])*JtD[0] + P::load(block.K[7])*JtD[1] + P::load(block.K[8])*JtD[2]) * factor;
+    KJtD[3] = (P::load(block.K[9])*JtD[3]) * factor;
+    KJtD[4] = (P::load(block.K[10])*JtD[4]) * factor;
+    KJtD[5] = (P::load(block.K[11])*JtD[5]) * factor;
+
+    // J K Jt X
+    for (int v = 0; v < 4; ++v)
+    {
+        const P F0 = b[v]*KJtD[0] + g[v]*KJtD[3] + d[v]*KJtD[5];
+        const P F1 = g[v]*KJtD[1] + b[v]*KJtD[3] + d[v]*KJtD[4];
+        const P F2 = d[v]*KJtD[2] + g[v]*KJtD[4] + b[v]*KJtD[5];
+
+        if (Corotational)
+        {
+            // rotate back
+            (-(P::load(block.R[0])*F0 + P::load(block.R[1])*F1 + P::load(block.R[2])*F2)).store(f.v[3*v]);
+            (-(P::load(block.R[3])*F0 + P::load(block.R[4])*F1 + P::load(block.R[5])*F2)).store(f.v[3*v+1]);
+            (-(P::load(block.R[6])*F0 + P::load(block.R[7])*F1 + P::load(block.R[8])*F2)).store(f.v[3*v+2]);
+        }
+        else
+        {
+            (-F0).store(f.v[3*v]);
+            (-F1).store(f.v[3*v+1]);
+            (-F2).store(f.v[3*v+2]);
+        }
+    }
+}
+
+} // namespace sofa::component::forcefield::soa
@@ -0,0 +1,181 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/mechanicalvisitor/MechanicalAddMBK_ToMatrixVisitor.h>
+using sofa::simulation::mechanicalvisitor::MechanicalAddMBK_ToMatrixVisitor;
+
+#include <sofa/simulation/TaskScheduler.h>
+using sofa::simulation::TaskScheduler;
+
+#include <sofa/core/behavior/ForceField.h>
+#include <sofa/core/behavior/MultiMatrixAccessor.h>
+#include <sofa/core/MechanicalParams.h>
+#include <sofa/defaulttype/VecTypes.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+#include <SofaBaseLinearSolver/CompressedRowSparseMatrix.h>
+
+#include <SofaSimulationGraph/testing/BaseSimulationTest.h>
+using sofa::testing::BaseSimulationTest;
+using sofa::simulation::Node;
+
+#include <map>
+#include <thread>
+
+namespace sofa
+{
+
+namespace
+{
+
+typedef component::linearsolver::CompressedRowSparseMatrix<SReal> Matrix;
+
+/// Force field writing a stiffness depending on its id in the matrix of its state, some entries being
+/// overwritten. It records the thread on which it is assembled.
+class AssemblyTestForceField : public core::behavior::ForceField<defaulttype::Vec3Types>
+{
+public:
+    SOFA_CLASS(AssemblyTestForceField, SOFA_TEMPLATE(core::behavior::ForceField, defaulttype::Vec3Types));
+
+    unsigned int id {0};
+    bool threadSafe {false};
+    std::thread::id assemblyThread;
+
+    void addForce(const core::MechanicalParams*, DataVecDeriv&, const DataVecCoord&, const DataVecDeriv&) override {}
+    void addDForce(const core::MechanicalParams*, DataVecDeriv&, const DataVecDeriv&) override {}
+    SReal getPotentialEnergy(const core::MechanicalParams*, const DataVecCoord&) const override { return 0; }
+
+    void addKToMatrix(defaulttype::BaseMatrix* matrix, SReal kFact, unsigned int& offset) override
+    {
+        assemblyThread = std::this_thread::get_id();
+        const Index n = Index(this->mstate->getSize());
+        for (Index i = 0; i < n; ++i)
+        {
+            type::Mat3x3d k;
+            for (int a = 0; a < 3; ++a)
+                for (int b = 0; b < 3; ++b)
+                    k[a][b] = kFact / (1 + id + i + a + 2 * b);
+            matrix->add(offset + 3 * i, offset + 3 * i, k);
+            matrix->add(offset + 3 * i, offset + 3 * ((i + 1) % n) + 1, -kFact / (1 + id));
+        }
+        matrix->set(offset + id % (3 * n), offset, SReal(id));
+    }
+
+    bool isAddMBKToMatrixThreadSafe() const override { return threadSafe; }
+};
+
+/// Accessor giving its own matrix to each mechanical state
+class PerStateMatrixAccessor : public core::behavior::MultiMatrixAccessor
+{
+public:
+    std::map<const core::behavior::BaseMechanicalState*, Matrix> matrices;
+
+    Index getGlobalDimension() const override { return 0; }
+    int getGlobalOffset(const core::behavior::BaseMechanicalState*) const override { return 0; }
+
+    MatrixRef getMatrix(const core::behavior::BaseMechanicalState* mstate) const override
+    {
+        MatrixRef r;
+        r.matrix = const_cast<Matrix*>(&matrices.at(mstate));
+        return r;
+    }
+
+    InteractionMatrixRef getMatrix(const core::behavior::BaseMechanicalState*, const core::behavior::BaseMechanicalState*) const override
+    {
+        return InteractionMatrixRef();
+    }
+};
+
+}
+
+struct MechanicalAddMBK_ToMatrixVisitor_test : public BaseSimulationTest
+{
+    SceneInstance scene;
+    std::vector<core::behavior::BaseMechanicalState*> states;
+    std::vector<AssemblyTestForceField::SPtr> forceFields;
+
+    /// Two nodes, each one with its state and force fields, one out of three not being thread-safe
+    void SetUp() override
+    {
+        unsigned int id = 0;
+        for (const char* name : {"first", "second"})
+        {
+            Node::SPtr node = scene.root->createChild(name);
+            auto state = core::objectmodel::New< component::container::MechanicalObject<defaulttype::Vec3Types> >();
+            state->resize(5);
+            node->addObject(state);
+            states.push_back(state.get());
+            for (int f = 0; f < 6; ++f, ++id)
+            {
+                auto ff = core::objectmodel::New<AssemblyTestForceField>();
+                ff->id = id;
+                ff->threadSafe = (id % 3 != 0);
+                node->addObject(ff);
+                forceFields.push_back(ff);
+            }
+        }
+        scene.initScene();
+    }
+
+    void assemble(PerStateMatrixAccessor& accessor, bool parallelAssembly)
+    {
+        for (core::behavior::BaseMechanicalState* state : states)
+            accessor.matrices[state].resize(15, 15);
+
+        core::MechanicalParams mparams;
+        mparams.setKFactor(0.5);
+        MechanicalAddMBK_ToMatrixVisitor(&mparams, &accessor, parallelAssembly).execute(scene.root.get());
+
+        for (auto& m : accessor.matrices)
+            m.second.compress();
+    }
+
+    void parallelAssemblyTest()
+    {
+        PerStateMatrixAccessor sequential;
+        assemble(sequential, false);
+
+        TaskScheduler::getInstance()->init(4);
+        PerStateMatrixAccessor parallel;
+        assemble(parallel, true);
+        TaskScheduler::getInstance()->stop();
+
+        for (core::behavior::BaseMechanicalState* state : states)
+        {
+            const Matrix& expected = sequential.matrices[state];
+            const Matrix& result = parallel.matrices[state];
+            ASSERT_EQ(result.getColsIndex(), expected.getColsIndex());
+            for (Matrix::Index i = 0; i < 15; ++i)
+                for (Matrix::Index j = 0; j < 15; ++j)
+                    EXPECT_EQ(result.element(i, j), expected.element(i, j)) << "(" << i << "," << j << ")";
+        }
+
+        // the force fields which are not thread-safe are assembled by the calling thread
+        for (const auto& ff : forceFields)
+        {
+            if (!ff->threadSafe)
+                EXPECT_EQ(ff->assemblyThread, std::this_thread::get_id()) << "force field " << ff->id;
+        }
+    }
+};
+
+TEST_F(MechanicalAddMBK_ToMatrixVisitor_test, parallelAssembly) { parallelAssemblyTest(); }
+
+}
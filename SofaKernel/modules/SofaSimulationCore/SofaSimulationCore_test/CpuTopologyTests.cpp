@@ -0,0 +1,118 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/CpuTopology.h>
+#include <sofa/testing/BaseTest.h>
+
+#include <vector>
+
+namespace sofa
+{
+    using simulation::CpuTopology;
+    using simulation::ThreadPlacement;
+
+    // two NUMA nodes of four CPUs
+    static const std::vector<CpuTopology::CpuList> twoNodes { { 0, 1, 2, 3 }, { 4, 5, 6, 7 } };
+
+    static std::vector<unsigned int> getCpus(const std::vector<CpuTopology::ThreadSlot>& slots)
+    {
+        std::vector<unsigned int> cpus;
+        for (const auto& slot : slots)
+        {
+            EXPECT_EQ(slot.cpus.size(), 1u);
+            cpus.push_back(slot.cpus.empty() ? 0 : slot.cpus.front());
+        }
+        return cpus;
+    }
+
+    static std::vector<unsigned int> getNodes(const std::vector<CpuTopology::ThreadSlot>& slots)
+    {
+        std::vector<unsigned int> nodes;
+        for (const auto& slot : slots)
+            nodes.push_back(slot.numaNode);
+        return nodes;
+    }
+
+    TEST(CpuTopologyTests, NumaNodes)
+    {
+        const auto& nodes = CpuTopology::getNumaNodes();
+        ASSERT_FALSE(nodes.empty());
+        for (const auto& node : nodes)
+            EXPECT_FALSE(node.empty());
+    }
+
+    TEST(CpuTopologyTests, DefaultPlacement)
+    {
+        const auto slots = CpuTopology::computeThreadSlots(4, ThreadPlacement(), twoNodes);
+        ASSERT_EQ(slots.size(), 4u);
+        for (const auto& slot : slots)
+            EXPECT_TRUE(slot.cpus.empty());
+    }
+
+    TEST(CpuTopologyTests, PinnedThreadsSpreadOverNodes)
+    {
+        ThreadPlacement placement;
+        placement.pinToCores = true;
+
+        const auto slots = CpuTopology::computeThreadSlots(5, placement, twoNodes);
+        EXPECT_EQ(getCpus(slots), std::vector<unsigned int>({ 0, 4, 1, 5, 2 }));
+        EXPECT_EQ(getNodes(slots), std::vector<unsigned int>({ 0, 1, 0, 1, 0 }));
+    }
+
+    TEST(CpuTopologyTests, PinnedThreadsGroupedByNode)
+    {
+        ThreadPlacement placement;
+        placement.pinToCores = true;
+        placement.groupByNumaNode = true;
+
+        // more threads than CPUs: the CPUs are reused in the same order
+        const auto slots = CpuTopology::computeThreadSlots(10, placement, twoNodes);
+        EXPECT_EQ(getCpus(slots), std::vector<unsigned int>({ 0, 1, 2, 3, 4, 5, 6, 7, 0, 1 }));
+        EXPECT_EQ(getNodes(slots), std::vector<unsigned int>({ 0, 0, 0, 0, 1, 1, 1, 1, 0, 0 }));
+    }
+
+    TEST(CpuTopologyTests, ThreadsGroupedByNode)
+    {
+        ThreadPlacement placement;
+        placement.groupByNumaNode = true;
+
+        const auto slots = CpuTopology::computeThreadSlots(6, placement, twoNodes);
+        ASSERT_EQ(slots.size(), 6u);
+        for (unsigned int i = 0; i < 6; ++i)
+        {
+            const unsigned int node = i < 4 ? 0 : 1;
+            EXPECT_EQ(slots[i].numaNode, node);
+            EXPECT_EQ(slots[i].cpus, twoNodes[node]);
+        }
+    }
+
+    TEST(CpuTopologyTests, DistributePages)
+    {
+        std::vector<double> values(1 << 16, 1.0);
+        const std::vector<unsigned int> nodes(4, 0);
+
+        // not supported everywhere, but must never alter the data
+        CpuTopology::distributePages(values.data(), values.size() * sizeof(double), nodes);
+        for (const double v : values)
+            ASSERT_EQ(v, 1.0);
+    }
+
+} // namespace sofa
@@ -0,0 +1,122 @@
+#include <sofa/simulation/ParallelFor.h>
+#include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
+#include <sofa/testing/BaseTest.h>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace sofa
+{
+    static void testParallelForVisitsEachIndexOnce(const char* schedulerName, unsigned int nbThread, std::size_t grainSize)
+    {
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(schedulerName);
+        scheduler->init(nbThread);
+        
+        const std::size_t N = 10007;
+        std::vector<int> visits(N, 0);
+        simulation::parallelFor(scheduler, std::size_t(0), N, grainSize, [&visits](std::size_t i)
+        {
+            ++visits[i];
+        });
+        
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            EXPECT_EQ(visits[i], 1) << "index " << i;
+        }
+        
+        scheduler->stop();
+    }
+    
+    TEST(ParallelForTests, ForSingle)
+    {
+        testParallelForVisitsEachIndexOnce(simulation::DefaultTaskScheduler::name(), 1, 0);
+    }
+    
+    TEST(ParallelForTests, ForMulti)
+    {
+        testParallelForVisitsEachIndexOnce(simulation::DefaultTaskScheduler::name(), 4, 0);
+        testParallelForVisitsEachIndexOnce(simulation::DefaultTaskScheduler::name(), 4, 13);
+    }
+    
+    TEST(ParallelForTests, ForMultiWorkStealing)
+    {
+        testParallelForVisitsEachIndexOnce(simulation::WorkStealingTaskScheduler::name(), 4, 1);
+        testParallelForVisitsEachIndexOnce(simulation::WorkStealingTaskScheduler::name(), 4, 100);
+    }
+    
+    TEST(ParallelForTests, ForEmptyRange)
+    {
+        std::atomic<int> count(0);
+        simulation::parallelFor(5, 5, 1, [&count](int) { ++count; });
+        simulation::parallelFor(5, 2, 1, [&count](int) { ++count; });
+        EXPECT_EQ(count.load(), 0);
+    }
+    
+    TEST(ParallelForTests, ForRangeCoversRange)
+    {
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(simulation::DefaultTaskScheduler::name());
+        scheduler->init(4);
+        
+        std::atomic<int> sum(0);
+        simulation::parallelForRange(scheduler, 0, 1000, 7, [&sum](int b, int e)
+        {
+            EXPECT_LE(e - b, 7);
+            for (int i = b; i < e; ++i)
+            {
+                sum += i;
+            }
+        });
+        EXPECT_EQ(sum.load(), 999 * 1000 / 2);
+        
+        scheduler->stop();
+    }
+    
+    static double reduceHarmonicSeries(unsigned int nbThread, std::size_t grainSize)
+    {
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(simulation::DefaultTaskScheduler::name());
+        scheduler->init(nbThread);
+        
+        const double result = simulation::parallelReduce(scheduler, std::size_t(1), std::size_t(1 << 18), grainSize, 0.0,
+            [](std::size_t b, std::size_t e, double partial)
+            {
+                for (std::size_t i = b; i < e; ++i)
+                {
+                    partial += 1.0 / double(i);
+                }
+                return partial;
+            },
+            std::plus<double>());
+        
+        scheduler->stop();
+        return result;
+    }
+    
+    TEST(ParallelForTests, ReduceSum)
+    {
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(simulation::DefaultTaskScheduler::name());
+        scheduler->init(4);
+        
+        const int64_t N = 1 << 20;
+        const int64_t sum = simulation::parallelReduce(scheduler, int64_t(1), N + 1, int64_t(0), int64_t(0),
+            [](int64_t b, int64_t e, int64_t partial) { for (; b < e; ++b) partial += b; return partial; },
+            std::plus<int64_t>());
+        EXPECT_EQ(sum, N * (N + 1) / 2);
+        
+        scheduler->stop();
+    }
+    
+    TEST(ParallelForTests, ReduceIsDeterministic)
+    {
+        // with an explicit grain size, floating point reductions must be bit-identical
+        // whatever the number of threads and the execution order
+        const double reference = reduceHarmonicSeries(1, 1000);
+        for (int i = 0; i < 5; ++i)
+        {
+            EXPECT_EQ(reduceHarmonicSeries(4, 1000), reference);
+        }
+        EXPECT_EQ(reduceHarmonicSeries(2, 1000), reference);
+    }
+
+} // namespace sofa
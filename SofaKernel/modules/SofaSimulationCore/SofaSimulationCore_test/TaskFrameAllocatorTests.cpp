@@ -0,0 +1,246 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/TaskFrameAllocator.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/CpuTask.h>
+#include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
+#include <sofa/testing/BaseTest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace sofa
+{
+    using simulation::TaskFrameAllocator;
+
+    // task freed by the scheduler once it has run
+    class CountingTask : public simulation::CpuTask
+    {
+    public:
+        CountingTask(std::atomic<int>* counter, simulation::CpuTask::Status* status)
+        : CpuTask(status)
+        , m_counter(counter)
+        {}
+
+        ~CountingTask() override {}
+
+        MemoryAlloc run() final
+        {
+            m_counter->fetch_add(1);
+            return MemoryAlloc::Dynamic;
+        }
+
+    private:
+        std::atomic<int>* m_counter;
+    };
+
+
+    TEST(TaskFrameAllocatorTests, AllocationsAreAlignedAndDistinct)
+    {
+        TaskFrameAllocator allocator(1024);
+
+        std::vector<void*> pointers;
+        for (std::size_t size = 1; size < 200; size += 7)
+        {
+            void* ptr = allocator.allocate(size);
+            ASSERT_NE(ptr, nullptr);
+            EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ptr) % alignof(std::max_align_t), 0u);
+            for (void* other : pointers)
+                EXPECT_NE(ptr, other);
+            pointers.push_back(ptr);
+        }
+        EXPECT_EQ(allocator.getArenaCount(), 1u);
+        EXPECT_GT(allocator.getBlockCount(), 1u);
+
+        for (void* ptr : pointers)
+            allocator.free(ptr, 0);
+    }
+
+    TEST(TaskFrameAllocatorTests, MemoryIsReusedByTheNextFrame)
+    {
+        TaskFrameAllocator allocator(1024);
+
+        std::size_t blockCount = 0;
+        void* first = nullptr;
+        for (int frame = 0; frame < 10; ++frame)
+        {
+            std::vector<void*> pointers;
+            for (int i = 0; i < 100; ++i)
+                pointers.push_back(allocator.allocate(64));
+
+            if (frame == 0)
+            {
+                first = pointers.front();
+                blockCount = allocator.getBlockCount();
+            }
+            EXPECT_EQ(pointers.front(), first);
+            EXPECT_EQ(allocator.getBlockCount(), blockCount);
+
+            for (void* ptr : pointers)
+                allocator.free(ptr, 64);
+            allocator.newFrame();
+        }
+    }
+
+    TEST(TaskFrameAllocatorTests, LiveAllocationsAreNotOverwritten)
+    {
+        TaskFrameAllocator allocator(1024);
+
+        int* alive = static_cast<int*>(allocator.allocate(sizeof(int)));
+        *alive = 42;
+        allocator.newFrame();
+
+        // the arena cannot be rewound while an allocation of the previous frame is alive
+        for (int i = 0; i < 100; ++i)
+        {
+            int* other = static_cast<int*>(allocator.allocate(sizeof(int)));
+            EXPECT_NE(other, alive);
+            *other = i;
+            allocator.free(other, sizeof(int));
+        }
+        EXPECT_EQ(*alive, 42);
+
+        allocator.free(alive, sizeof(int));
+        allocator.newFrame();
+        EXPECT_EQ(allocator.allocate(sizeof(int)), static_cast<void*>(alive));
+    }
+
+    TEST(TaskFrameAllocatorTests, LiveAllocationOnlyKeepsItsBlock)
+    {
+        TaskFrameAllocator allocator(1024);
+
+        // a task alive across frames, as a task allocating its successor
+        int* alive = static_cast<int*>(allocator.allocate(sizeof(int)));
+        *alive = 42;
+
+        std::size_t blockCount = 0;
+        for (int frame = 0; frame < 20; ++frame)
+        {
+            std::vector<void*> pointers;
+            for (int i = 0; i < 100; ++i)
+                pointers.push_back(allocator.allocate(64));
+            for (void* ptr : pointers)
+                allocator.free(ptr, 64);
+            allocator.newFrame();
+
+            // from the second frame, the block of the live allocation is not reused
+            if (frame == 1)
+                blockCount = allocator.getBlockCount();
+            if (frame >= 1)
+                EXPECT_EQ(allocator.getBlockCount(), blockCount);
+        }
+        EXPECT_EQ(*alive, 42);
+        allocator.free(alive, sizeof(int));
+    }
+
+    TEST(TaskFrameAllocatorTests, MemoryIsReusedWithoutNewFrame)
+    {
+        TaskFrameAllocator allocator(1024);
+
+        int* alive = static_cast<int*>(allocator.allocate(sizeof(int)));
+        *alive = 42;
+
+        // no newFrame(), e.g. tasks run while the animation is paused
+        for (int i = 0; i < 10000; ++i)
+        {
+            int* other = static_cast<int*>(allocator.allocate(sizeof(int)));
+            EXPECT_NE(other, alive);
+            *other = i;
+            allocator.free(other, sizeof(int));
+        }
+        EXPECT_EQ(*alive, 42);
+        EXPECT_LE(allocator.getBlockCount(), 2u);
+        allocator.free(alive, sizeof(int));
+    }
+
+    TEST(TaskFrameAllocatorTests, LargeAllocationsUseTheHeap)
+    {
+        TaskFrameAllocator allocator(256);
+
+        char* ptr = static_cast<char*>(allocator.allocate(4096));
+        ASSERT_NE(ptr, nullptr);
+        ptr[0] = 1;
+        ptr[4095] = 1;
+        EXPECT_EQ(allocator.getBlockCount(), 0u);
+        allocator.free(ptr, 4096);
+    }
+
+    TEST(TaskFrameAllocatorTests, OneArenaPerThread)
+    {
+        TaskFrameAllocator allocator(1024);
+
+        // allocated by a thread and freed by another one
+        void* ptr = nullptr;
+        std::thread thread([&allocator, &ptr]() { ptr = allocator.allocate(32); });
+        thread.join();
+        ASSERT_NE(ptr, nullptr);
+        allocator.free(ptr, 32);
+
+        void* mainPtr = allocator.allocate(32);
+        EXPECT_NE(mainPtr, ptr);
+        EXPECT_EQ(allocator.getArenaCount(), 2u);
+        allocator.free(mainPtr, 32);
+    }
+
+    static void spawnDynamicTasks(const char* schedulerName)
+    {
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(schedulerName);
+        scheduler->init(4);
+
+        auto* allocator = dynamic_cast<TaskFrameAllocator*>(simulation::Task::getAllocator());
+        ASSERT_NE(allocator, nullptr);
+
+        std::size_t blockCount = 0;
+        for (int frame = 0; frame < 5; ++frame)
+        {
+            std::atomic<int> counter { 0 };
+            simulation::CpuTask::Status status;
+            for (int i = 0; i < 2000; ++i)
+            {
+                scheduler->addTask(new CountingTask(&counter, &status));
+            }
+            scheduler->workUntilDone(&status);
+            EXPECT_EQ(counter.load(), 2000);
+
+            allocator->newFrame();
+            if (frame == 0)
+                blockCount = allocator->getBlockCount();
+            EXPECT_EQ(allocator->getBlockCount(), blockCount);
+        }
+
+        scheduler->stop();
+    }
+
+    TEST(TaskFrameAllocatorTests, DefaultSchedulerDynamicTasks)
+    {
+        spawnDynamicTasks(simulation::DefaultTaskScheduler::name());
+    }
+
+    TEST(TaskFrameAllocatorTests, WorkStealingSchedulerDynamicTasks)
+    {
+        spawnDynamicTasks(simulation::WorkStealingTaskScheduler::name());
+    }
+
+} // namespace sofa
@@ -0,0 +1,56 @@
+#include "TaskSchedulerTestTasks.h"
+
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/CpuTask.h>
+#include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
+#include <sofa/testing/BaseTest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace sofa
+{
+    // Micro-benchmark of the schedulers with thousands of very fine-grained tasks:
+    // the cost is dominated by the push/pop/steal operations on the task queues.
+    static double runFibonacciBenchmark(const char* schedulerName, int64_t N, unsigned int nbThread, int nbRepeat, int64_t& result)
+    {
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(schedulerName);
+        scheduler->init(nbThread);
+        
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < nbRepeat; ++i)
+        {
+            simulation::CpuTask::Status status;
+            FibonacciTask task(N, &result, &status);
+            scheduler->addTask(&task);
+            scheduler->workUntilDone(&status);
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        
+        scheduler->stop();
+        return std::chrono::duration<double, std::milli>(end - start).count() / nbRepeat;
+    }
+    
+    TEST(TaskSchedulerBenchmark, FineGrainedTasks)
+    {
+        const int64_t N = 22;
+        const int nbRepeat = 5;
+        const unsigned int nbThread = std::max(2u, std::thread::hardware_concurrency());
+        
+        int64_t defaultResult = 0;
+        int64_t workStealingResult = 0;
+        const double defaultTime = runFibonacciBenchmark(simulation::DefaultTaskScheduler::name(), N, nbThread, nbRepeat, defaultResult);
+        const double workStealingTime = runFibonacciBenchmark(simulation::WorkStealingTaskScheduler::name(), N, nbThread, nbRepeat, workStealingResult);
+        
+        EXPECT_EQ(defaultResult, 17711);
+        EXPECT_EQ(workStealingResult, 17711);
+        
+        std::cout << "Fibonacci(" << N << ") with " << nbThread << " threads: "
+                  << simulation::DefaultTaskScheduler::name() << " " << defaultTime << " ms, "
+                  << simulation::WorkStealingTaskScheduler::name() << " " << workStealingTime << " ms" << std::endl;
+    }
+
+} // namespace sofa
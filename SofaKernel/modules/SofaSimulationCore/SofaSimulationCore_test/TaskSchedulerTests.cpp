@@ -3,14 +3,15 @@
 #include <sofa/simulation/TaskScheduler.h>
 #include <sofa/simulation/CpuTask.h>
 #include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
 #include <sofa/testing/BaseTest.h>
 
 namespace sofa
 {
     // compute the Fibonacci number for input N
-    static int64_t Fibonacci(int64_t N, int nbThread = 0)
+    static int64_t Fibonacci(int64_t N, int nbThread = 0, const char* schedulerName = simulation::DefaultTaskScheduler::name())
     {
-        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(simulation::DefaultTaskScheduler::name());
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(schedulerName);
         scheduler->init(nbThread);
         
         simulation::CpuTask::Status status;
@@ -26,9 +27,9 @@ namespace sofa
     
     
     // compute the sum of integers from 1 to N
-    static int64_t IntSum1ToN(const int64_t N, int nbThread = 0)
+    static int64_t IntSum1ToN(const int64_t N, int nbThread = 0, const char* schedulerName = simulation::DefaultTaskScheduler::name())
     {
-        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(simulation::DefaultTaskScheduler::name());
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(schedulerName);
         scheduler->init(nbThread);
         
         simulation::CpuTask::Status status;
@@ -98,5 +99,109 @@ namespace sofa
         return;
     }
     
+    // same computations with the work-stealing scheduler
+    TEST(TaskSchedulerTests, WorkStealingFibonacciSingle)
+    {
+        const int64_t res = Fibonacci(27, 1, simulation::WorkStealingTaskScheduler::name());
+        EXPECT_EQ(res, 196418);
+    }
+    
+    TEST(TaskSchedulerTests, WorkStealingFibonacciMulti)
+    {
+        const int64_t res = Fibonacci(27, 0, simulation::WorkStealingTaskScheduler::name());
+        EXPECT_EQ(res, 196418);
+    }
+    
+    TEST(TaskSchedulerTests, WorkStealingFibonacciOversubscribed)
+    {
+        // more threads than cores: exercises the stealing races and the parking of the workers
+        const int64_t res = Fibonacci(27, 8, simulation::WorkStealingTaskScheduler::name());
+        EXPECT_EQ(res, 196418);
+    }
+    
+    TEST(TaskSchedulerTests, WorkStealingIntSumMulti)
+    {
+        const int64_t N = 1 << 20;
+        int64_t res = IntSum1ToN(N, 4, simulation::WorkStealingTaskScheduler::name());
+        EXPECT_EQ(res, (N)*(N + 1) / 2);
+    }
+    
+    // compute the Fibonacci number with threads pinned and grouped by NUMA node
+    static int64_t PlacedFibonacci(int64_t N, int nbThread, const char* schedulerName)
+    {
+        simulation::ThreadPlacement placement;
+        placement.pinToCores = true;
+        placement.groupByNumaNode = true;
+
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(schedulerName, placement);
+        scheduler->init(nbThread, placement);
+        EXPECT_EQ(scheduler->getThreadPlacement(), placement);
+        EXPECT_EQ(scheduler->getThreadCount(), unsigned(nbThread));
+
+        simulation::CpuTask::Status status;
+        int64_t result = 0;
+
+        FibonacciTask task(N, &result, &status);
+        scheduler->addTask(&task);
+        scheduler->workUntilDone(&status);
+
+        // back to the default placement: the threads, main thread included, are released
+        scheduler->init(nbThread, simulation::ThreadPlacement());
+        EXPECT_TRUE(scheduler->getThreadPlacement().isDefault());
+
+        scheduler->stop();
+        return result;
+    }
+
+    // the main thread gets back its affinity when the scheduler stops
+    static void checkMainThreadAffinityRestored(const char* schedulerName)
+    {
+        simulation::CpuTopology::CpuList original;
+        if (!simulation::CpuTopology::getCurrentThreadAffinity(original))
+            return; // not supported on this platform
+
+        simulation::ThreadPlacement placement;
+        placement.pinToCores = true;
+        simulation::TaskScheduler* scheduler = simulation::TaskScheduler::create(schedulerName, placement);
+        scheduler->init(2, placement);
+
+        simulation::CpuTopology::CpuList placed;
+        EXPECT_TRUE(simulation::CpuTopology::getCurrentThreadAffinity(placed));
+        EXPECT_EQ(placed.size(), 1u);
+
+        scheduler->stop();
+        simulation::CpuTopology::CpuList restored;
+        EXPECT_TRUE(simulation::CpuTopology::getCurrentThreadAffinity(restored));
+        EXPECT_EQ(restored, original);
+
+        scheduler->init(2, simulation::ThreadPlacement());
+        scheduler->stop();
+    }
+
+    TEST(TaskSchedulerTests, MainThreadAffinityRestored)
+    {
+        checkMainThreadAffinityRestored(simulation::DefaultTaskScheduler::name());
+        checkMainThreadAffinityRestored(simulation::WorkStealingTaskScheduler::name());
+    }
+
+    TEST(TaskSchedulerTests, PlacedThreadsFibonacci)
+    {
+        const int64_t res = PlacedFibonacci(27, 4, simulation::DefaultTaskScheduler::name());
+        EXPECT_EQ(res, 196418);
+    }
+
+    TEST(TaskSchedulerTests, WorkStealingPlacedThreadsFibonacci)
+    {
+        const int64_t res = PlacedFibonacci(27, 4, simulation::WorkStealingTaskScheduler::name());
+        EXPECT_EQ(res, 196418);
+    }
+    
+    TEST(TaskSchedulerTests, UnknownNameCreatesDefaultScheduler)
+    {
+        simulation::TaskScheduler::create(simulation::WorkStealingTaskScheduler::name());
+        simulation::TaskScheduler::create("unknownScheduler");
+        EXPECT_EQ(simulation::TaskScheduler::getCurrentName(), simulation::DefaultTaskScheduler::name());
+    }
+    
 
 } // namespace sofa
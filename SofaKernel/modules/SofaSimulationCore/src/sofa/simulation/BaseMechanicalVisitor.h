@@ -59,6 +59,11 @@ public:
     /// Return true if this visitor need to write to the node-specific data if given
     virtual bool writeNodeData() const;
 
+    /// Return true if this thread-safe visitor can traverse independent sibling subtrees concurrently (see
+    /// TaskVisitorScheduler). It must then only access the components of the visited nodes, and not modify any
+    /// state shared between the subtrees (the ids of a MultiVecId, a result accumulated outside of the node data, ...)
+    virtual bool isThreadSafeAcrossSubtrees() const { return false; }
+
     virtual void setNodeData(simulation::Node* /*node*/, SReal* nodeData, const SReal* parentData);
     virtual void addNodeData(simulation::Node* /*node*/, SReal* parentData, const SReal* nodeData);
 
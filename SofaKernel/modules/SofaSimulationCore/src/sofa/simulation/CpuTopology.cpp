@@ -0,0 +1,302 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/CpuTopology.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(WIN32)
+#include <windows.h>
+#endif
+
+namespace sofa::simulation
+{
+
+namespace
+{
+
+/// Parse a list of CPUs in the Linux format, e.g. "0-3,8,10-11"
+CpuTopology::CpuList parseCpuList(const std::string& text)
+{
+    CpuTopology::CpuList cpus;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        if (range.empty() || range[0] == '\n')
+            continue;
+
+        const auto dash = range.find('-');
+        try
+        {
+            const unsigned long first = std::stoul(range.substr(0, dash));
+            const unsigned long last = (dash == std::string::npos) ? first : std::stoul(range.substr(dash + 1));
+            for (unsigned long cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(static_cast<unsigned int>(cpu));
+        }
+        catch (const std::exception&)
+        {
+            return {};
+        }
+    }
+    return cpus;
+}
+
+/// CPUs the calling thread is allowed to run on
+CpuTopology::CpuList getAvailableCpus()
+{
+    CpuTopology::CpuList cpus;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (unsigned int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty())
+    {
+        const unsigned int nbCpus = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int cpu = 0; cpu < nbCpus; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+/// CPUs of each NUMA node, and the index of the node in the operating system
+struct NumaTopology
+{
+    std::vector<CpuTopology::CpuList> nodes;
+    std::vector<unsigned int> systemIndices;
+};
+
+NumaTopology readNumaTopology()
+{
+    const CpuTopology::CpuList available = getAvailableCpus();
+
+    NumaTopology topology;
+#if defined(__linux__)
+    // node indices can be sparse
+    enum { MAX_NUMA_NODES = 256 };
+    for (unsigned int node = 0; node < MAX_NUMA_NODES; ++node)
+    {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!file)
+            continue;
+
+        std::string text;
+        std::getline(file, text);
+
+        CpuTopology::CpuList cpus;
+        for (const unsigned int cpu : parseCpuList(text))
+        {
+            if (std::find(available.begin(), available.end(), cpu) != available.end())
+                cpus.push_back(cpu);
+        }
+        if (!cpus.empty())
+        {
+            topology.nodes.push_back(cpus);
+            topology.systemIndices.push_back(node);
+        }
+    }
+#endif
+    if (topology.nodes.empty())
+    {
+        topology.nodes.push_back(available);
+        topology.systemIndices.push_back(0);
+    }
+    return topology;
+}
+
+const NumaTopology& getNumaTopology()
+{
+    static const NumaTopology topology = readNumaTopology();
+    return topology;
+}
+
+} // namespace
+
+const std::vector<CpuTopology::CpuList>& CpuTopology::getNumaNodes()
+{
+    return getNumaTopology().nodes;
+}
+
+std::vector<CpuTopology::ThreadSlot> CpuTopology::computeThreadSlots(const unsigned int nbThreads, const ThreadPlacement& placement,
+                                                                      const std::vector<CpuList>& numaNodes)
+{
+    std::vector<ThreadSlot> slots(nbThreads);
+    if (placement.isDefault())
+        return slots;
+
+    // order in which the CPUs are given to the threads: (node, cpu)
+    std::vector<std::pair<unsigned int, unsigned int> > order;
+    if (placement.groupByNumaNode)
+    {
+        for (unsigned int node = 0; node < numaNodes.size(); ++node)
+        {
+            for (const unsigned int cpu : numaNodes[node])
+                order.emplace_back(node, cpu);
+        }
+    }
+    else
+    {
+        // round robin over the nodes
+        for (std::size_t rank = 0; order.size() < nbThreads; ++rank)
+        {
+            const std::size_t previousSize = order.size();
+            for (unsigned int node = 0; node < numaNodes.size(); ++node)
+            {
+                if (rank < numaNodes[node].size())
+                    order.emplace_back(node, numaNodes[node][rank]);
+            }
+            if (order.size() == previousSize)
+                break;
+        }
+    }
+
+    if (order.empty())
+        return slots;
+
+    for (unsigned int i = 0; i < nbThreads; ++i)
+    {
+        const auto& cpu = order[i % order.size()];
+        slots[i].numaNode = cpu.first;
+        if (placement.pinToCores)
+            slots[i].cpus = { cpu.second };
+        else
+            slots[i].cpus = numaNodes[cpu.first];
+    }
+    return slots;
+}
+
+bool CpuTopology::setCurrentThreadAffinity(const CpuList& cpus)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (cpus.empty())
+    {
+        for (const CpuList& node : getNumaNodes())
+            for (const unsigned int cpu : node)
+                CPU_SET(cpu, &set);
+    }
+    else
+    {
+        for (const unsigned int cpu : cpus)
+        {
+            if (cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &set);
+        }
+    }
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#elif defined(WIN32)
+    DWORD_PTR mask = 0;
+    const CpuList& allowed = cpus.empty() ? getNumaNodes().front() : cpus;
+    for (const unsigned int cpu : allowed)
+    {
+        if (cpu < sizeof(DWORD_PTR) * 8)
+            mask |= DWORD_PTR(1) << cpu;
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#else
+    SOFA_UNUSED(cpus);
+    return false;
+#endif
+}
+
+bool CpuTopology::getCurrentThreadAffinity(CpuList& cpus)
+{
+    cpus.clear();
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0)
+        return false;
+    for (unsigned int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &set))
+            cpus.push_back(cpu);
+    }
+    return true;
+#elif defined(WIN32)
+    // the mask of a thread is only returned when it is changed: set it to the one of the process, and back
+    DWORD_PTR processMask = 0;
+    DWORD_PTR systemMask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+        return false;
+    const DWORD_PTR mask = SetThreadAffinityMask(GetCurrentThread(), processMask);
+    if (mask == 0)
+        return false;
+    SetThreadAffinityMask(GetCurrentThread(), mask);
+    for (unsigned int cpu = 0; cpu < sizeof(DWORD_PTR) * 8; ++cpu)
+    {
+        if (mask & (DWORD_PTR(1) << cpu))
+            cpus.push_back(cpu);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool CpuTopology::distributePages(const void* data, const std::size_t size, const std::vector<unsigned int>& nodes)
+{
+    if (data == nullptr || size == 0 || nodes.empty() || getNumaNodes().size() < 2)
+        return true; // nothing to distribute
+
+#if defined(__linux__) && defined(SYS_move_pages)
+    const std::uintptr_t pageSize = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(data) & ~(pageSize - 1);
+    const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(data) + size;
+    const std::size_t nbPages = (end - begin + pageSize - 1) / pageSize;
+
+    const std::vector<unsigned int>& systemIndices = getNumaTopology().systemIndices;
+    std::vector<void*> pages(nbPages);
+    std::vector<int> targetNodes(nbPages);
+    std::vector<int> status(nbPages);
+    for (std::size_t p = 0; p < nbPages; ++p)
+    {
+        pages[p] = reinterpret_cast<void*>(begin + p * pageSize);
+        const unsigned int node = nodes[(p * nodes.size()) / nbPages];
+        targetNodes[p] = static_cast<int>(node < systemIndices.size() ? systemIndices[node] : 0);
+    }
+
+    constexpr int moveOwnedPages = 1 << 1; // MPOL_MF_MOVE
+    return syscall(SYS_move_pages, 0, nbPages, pages.data(), targetNodes.data(), status.data(), moveOwnedPages) >= 0;
+#else
+    return false;
+#endif
+}
+
+} // namespace sofa::simulation
@@ -0,0 +1,102 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace sofa::simulation
+{
+
+/// Placement of the threads of a TaskScheduler on the CPUs
+struct SOFA_SIMULATION_CORE_API ThreadPlacement
+{
+    /// Pin each thread (main thread included) to a single logical CPU
+    bool pinToCores { false };
+
+    /// Fill the NUMA nodes one after the other instead of spreading the threads over the nodes.
+    /// The threads are restricted to the CPUs of their node, and steal the tasks of the threads of the same node first.
+    bool groupByNumaNode { false };
+
+    bool isDefault() const { return !pinToCores && !groupByNumaNode; }
+
+    bool operator==(const ThreadPlacement& other) const
+    {
+        return pinToCores == other.pinToCores && groupByNumaNode == other.groupByNumaNode;
+    }
+
+    bool operator!=(const ThreadPlacement& other) const { return !(*this == other); }
+};
+
+/// Access to the CPUs and NUMA nodes of the machine, and to the affinity of the threads
+class SOFA_SIMULATION_CORE_API CpuTopology
+{
+public:
+
+    using CpuList = std::vector<unsigned int>;
+
+    /// CPUs a thread is allowed to run on, and the NUMA node they belong to
+    struct ThreadSlot
+    {
+        unsigned int numaNode { 0 };
+        CpuList cpus; ///< empty: no restriction
+    };
+
+    /**
+     * Logical CPUs available to the process, grouped by NUMA node.
+     * A single node containing all the available CPUs is returned if the NUMA topology is unknown.
+     */
+    static const std::vector<CpuList>& getNumaNodes();
+
+    /**
+     * Compute where the threads of a TaskScheduler run (index 0 is the main thread).
+     * With the default placement, the threads are not restricted.
+     * When there are more threads than CPUs, the CPUs are reused in the same order.
+     */
+    static std::vector<ThreadSlot> computeThreadSlots(unsigned int nbThreads, const ThreadPlacement& placement,
+                                                      const std::vector<CpuList>& numaNodes);
+
+    static std::vector<ThreadSlot> computeThreadSlots(unsigned int nbThreads, const ThreadPlacement& placement)
+    {
+        return computeThreadSlots(nbThreads, placement, getNumaNodes());
+    }
+
+    /// Restrict the calling thread to the given CPUs (all the available CPUs if empty).
+    /// @return false if thread affinity is not supported on this platform
+    static bool setCurrentThreadAffinity(const CpuList& cpus);
+
+    /// Get the CPUs the calling thread is allowed to run on.
+    /// @return false if thread affinity is not supported on this platform
+    static bool getCurrentThreadAffinity(CpuList& cpus);
+
+    /**
+     * Move the memory pages of a buffer to the given NUMA nodes (indices in getNumaNodes()): the buffer is split in as many contiguous
+     * blocks as there are entries in nodes, as the ranges of a parallel loop over the buffer would be.
+     * This is the equivalent of a parallel first touch for buffers which are already initialized.
+     * @return false if page migration is not supported on this platform
+     */
+    static bool distributePages(const void* data, std::size_t size, const std::vector<unsigned int>& nodes);
+};
+
+} // namespace sofa::simulation
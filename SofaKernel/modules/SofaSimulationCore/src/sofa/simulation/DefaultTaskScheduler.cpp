@@ -2,6 +2,7 @@
 
 #include <sofa/helper/system/thread/thread_specific_ptr.h>
 #include <sofa/simulation/WorkerThread.h>
+#include <sofa/simulation/TaskFrameAllocator.h>
 #include <cassert>
 
 
@@ -15,23 +16,8 @@ namespace sofa
         DEFINE_TASK_SCHEDULER_PROFILER(Steal);
         
         
-        class StdTaskAllocator : public Task::Allocator
-        {
-        public:
-            
-            void* allocate(std::size_t sz) final
-            {
-                return ::operator new(sz);
-            }
-            
-            void free(void* ptr, std::size_t sz) final
-            {  
-                SOFA_UNUSED(sz);
-                ::operator delete(ptr);
-            }
-        };
-        
-        static StdTaskAllocator defaultTaskAllocator;
+        /// Never deleted: tasks may still be freed by static objects destroyed after this translation unit
+        static TaskFrameAllocator& defaultTaskAllocator = *new TaskFrameAllocator();
         
         
         
@@ -121,10 +107,18 @@ namespace sofa
                 m_threadCount = NbThread;
             }
             
+            const std::vector<CpuTopology::ThreadSlot> slots = placeThreads(m_threadCount);
+            WorkerThread* mainThread = WorkerThread::getCurrent();
+            if (mainThread && !slots.empty())
+            {
+                mainThread->m_slot = slots[0];
+            }
+            
             /* start worker threads */
             for( unsigned int i=1; i<m_threadCount; ++i)
             {
                 WorkerThread* thread = new WorkerThread(this, int(i));
+                thread->m_slot = slots[i];
                 thread->create_and_attach(this);
                 _threads[thread->getId()] = thread;
                 thread->start(this);
@@ -175,6 +169,8 @@ namespace sofa
                 WorkerThread* mainThread = mainThreadIt->second;
                 _threads.clear();
                 _threads[std::this_thread::get_id()] = mainThread;
+                
+                restoreMainThreadAffinity();
             }
             
             return;
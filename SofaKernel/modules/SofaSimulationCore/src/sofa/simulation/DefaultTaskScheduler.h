@@ -81,6 +81,8 @@ namespace sofa  {
              */
             virtual void init(const unsigned int nbThread = 0) final;
 
+            using TaskScheduler::init;
+
             /**
              * Wait and destroy worker threads
              */
@@ -0,0 +1,225 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/MatrixWriteBuffer.h>
+
+#include <stdexcept>
+
+namespace sofa::simulation
+{
+
+MatrixWriteBuffer::MatrixWriteBuffer(defaulttype::BaseMatrix* destination)
+    : m_destination(destination)
+{
+}
+
+void MatrixWriteBuffer::flush()
+{
+    for (const Entry& e : m_entries)
+    {
+        switch (e.operation)
+        {
+        case Operation::Set:         m_destination->set(e.i, e.j, e.value); break;
+        case Operation::Add:         m_destination->add(e.i, e.j, e.value); break;
+        case Operation::AddMat3x3d:  m_destination->add(e.i, e.j, m_blocks3x3d[std::size_t(e.value)]); break;
+        case Operation::AddMat3x3f:  m_destination->add(e.i, e.j, m_blocks3x3f[std::size_t(e.value)]); break;
+        case Operation::Clear:       m_destination->clear(e.i, e.j); break;
+        case Operation::ClearRow:    m_destination->clearRow(e.i); break;
+        case Operation::ClearCol:    m_destination->clearCol(e.j); break;
+        case Operation::ClearRowCol: m_destination->clearRowCol(e.i); break;
+        }
+    }
+    m_entries.clear();
+    m_blocks3x3d.clear();
+    m_blocks3x3f.clear();
+}
+
+MatrixWriteBuffer::Index MatrixWriteBuffer::rowSize() const
+{
+    return m_destination->rowSize();
+}
+
+MatrixWriteBuffer::Index MatrixWriteBuffer::colSize() const
+{
+    return m_destination->colSize();
+}
+
+SReal MatrixWriteBuffer::element(Index /*i*/, Index /*j*/) const
+{
+    throw std::logic_error("MatrixWriteBuffer: the values of the matrix cannot be read during a buffered assembly");
+}
+
+void MatrixWriteBuffer::resize(Index /*nbRow*/, Index /*nbCol*/)
+{
+    throw std::logic_error("MatrixWriteBuffer: the matrix cannot be resized during a buffered assembly");
+}
+
+void MatrixWriteBuffer::clear()
+{
+    throw std::logic_error("MatrixWriteBuffer: the matrix cannot be cleared during a buffered assembly");
+}
+
+void MatrixWriteBuffer::set(Index i, Index j, double v)
+{
+    m_entries.push_back({Operation::Set, i, j, v});
+}
+
+void MatrixWriteBuffer::add(Index i, Index j, double v)
+{
+    m_entries.push_back({Operation::Add, i, j, v});
+}
+
+void MatrixWriteBuffer::add(Index i, Index j, const type::Mat3x3d& m)
+{
+    m_entries.push_back({Operation::AddMat3x3d, i, j, double(m_blocks3x3d.size())});
+    m_blocks3x3d.push_back(m);
+}
+
+void MatrixWriteBuffer::add(Index i, Index j, const type::Mat3x3f& m)
+{
+    m_entries.push_back({Operation::AddMat3x3f, i, j, double(m_blocks3x3f.size())});
+    m_blocks3x3f.push_back(m);
+}
+
+void MatrixWriteBuffer::clear(Index i, Index j)
+{
+    m_entries.push_back({Operation::Clear, i, j, 0.0});
+}
+
+void MatrixWriteBuffer::clearRow(Index i)
+{
+    m_entries.push_back({Operation::ClearRow, i, 0, 0.0});
+}
+
+void MatrixWriteBuffer::clearCol(Index j)
+{
+    m_entries.push_back({Operation::ClearCol, 0, j, 0.0});
+}
+
+void MatrixWriteBuffer::clearRowCol(Index i)
+{
+    m_entries.push_back({Operation::ClearRowCol, i, i, 0.0});
+}
+
+defaulttype::BaseMatrix::ElementType MatrixWriteBuffer::getElementType() const
+{
+    return m_destination->getElementType();
+}
+
+std::size_t MatrixWriteBuffer::getElementSize() const
+{
+    return m_destination->getElementSize();
+}
+
+defaulttype::BaseMatrix::MatrixCategory MatrixWriteBuffer::getCategory() const
+{
+    return m_destination->getCategory();
+}
+
+MatrixWriteBuffer::Index MatrixWriteBuffer::getBlockRows() const
+{
+    return m_destination->getBlockRows();
+}
+
+MatrixWriteBuffer::Index MatrixWriteBuffer::getBlockCols() const
+{
+    return m_destination->getBlockCols();
+}
+
+
+BufferedMatrixAccessor::BufferedMatrixAccessor(const core::behavior::MultiMatrixAccessor* accessor, std::mutex* accessorMutex)
+    : m_accessor(accessor)
+    , m_accessorMutex(accessorMutex)
+{
+}
+
+BufferedMatrixAccessor::Index BufferedMatrixAccessor::getGlobalDimension() const
+{
+    std::lock_guard<std::mutex> lock(*m_accessorMutex);
+    return m_accessor->getGlobalDimension();
+}
+
+int BufferedMatrixAccessor::getGlobalOffset(const core::behavior::BaseMechanicalState* mstate) const
+{
+    std::lock_guard<std::mutex> lock(*m_accessorMutex);
+    return m_accessor->getGlobalOffset(mstate);
+}
+
+BufferedMatrixAccessor::MatrixRef BufferedMatrixAccessor::getMatrix(const core::behavior::BaseMechanicalState* mstate) const
+{
+    MatrixRef r;
+    {
+        std::lock_guard<std::mutex> lock(*m_accessorMutex);
+        r = m_accessor->getMatrix(mstate);
+    }
+    if (r.matrix)
+        r.matrix = getBuffer(r.matrix);
+    return r;
+}
+
+BufferedMatrixAccessor::InteractionMatrixRef BufferedMatrixAccessor::getMatrix(const core::behavior::BaseMechanicalState* mstate1, const core::behavior::BaseMechanicalState* mstate2) const
+{
+    InteractionMatrixRef r;
+    {
+        std::lock_guard<std::mutex> lock(*m_accessorMutex);
+        r = m_accessor->getMatrix(mstate1, mstate2);
+    }
+    if (r.matrix)
+        r.matrix = getBuffer(r.matrix);
+    return r;
+}
+
+void BufferedMatrixAccessor::flush()
+{
+    for (const auto& buffer : m_buffers)
+        buffer->flush();
+}
+
+void BufferedMatrixAccessor::flush(defaulttype::BaseMatrix* destination)
+{
+    for (const auto& buffer : m_buffers)
+    {
+        if (buffer->getDestination() == destination)
+            buffer->flush();
+    }
+}
+
+type::vector<defaulttype::BaseMatrix*> BufferedMatrixAccessor::getDestinations() const
+{
+    type::vector<defaulttype::BaseMatrix*> destinations;
+    destinations.reserve(m_buffers.size());
+    for (const auto& buffer : m_buffers)
+        destinations.push_back(buffer->getDestination());
+    return destinations;
+}
+
+MatrixWriteBuffer* BufferedMatrixAccessor::getBuffer(defaulttype::BaseMatrix* destination) const
+{
+    for (const auto& buffer : m_buffers)
+    {
+        if (buffer->getDestination() == destination)
+            return buffer.get();
+    }
+    m_buffers.push_back(std::make_unique<MatrixWriteBuffer>(destination));
+    return m_buffers.back().get();
+}
+
+} // namespace sofa::simulation
@@ -0,0 +1,140 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <sofa/core/behavior/MultiMatrixAccessor.h>
+#include <sofa/defaulttype/BaseMatrix.h>
+#include <sofa/type/Mat.h>
+#include <sofa/type/vector.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace sofa::simulation
+{
+
+/**
+ * Matrix recording the writes of a component (add, set, clear...), to replay them later in a
+ * destination matrix, in the same order.
+ *
+ * It allows several components to fill concurrently their contributions to a shared matrix: each
+ * one writes in its own buffer, and the buffers are flushed sequentially in the destination matrix.
+ * The destination matrix then receives exactly the same sequence of writes as a sequential assembly.
+ * The content of the matrix cannot be read from the buffer.
+ */
+class SOFA_SIMULATION_CORE_API MatrixWriteBuffer : public defaulttype::BaseMatrix
+{
+public:
+    explicit MatrixWriteBuffer(defaulttype::BaseMatrix* destination);
+
+    defaulttype::BaseMatrix* getDestination() const { return m_destination; }
+
+    /// Number of recorded writes
+    std::size_t size() const { return m_entries.size(); }
+
+    /// Replay the recorded writes in the destination matrix, and empty the buffer
+    void flush();
+
+    Index rowSize() const override;
+    Index colSize() const override;
+
+    /// The values are not available in a buffer: throws std::logic_error
+    SReal element(Index i, Index j) const override;
+
+    /// The matrix cannot be resized nor cleared during a buffered assembly: throw std::logic_error
+    void resize(Index nbRow, Index nbCol) override;
+    void clear() override;
+
+    void set(Index i, Index j, double v) override;
+    void add(Index i, Index j, double v) override;
+    void add(Index i, Index j, const type::Mat3x3d& m) override;
+    void add(Index i, Index j, const type::Mat3x3f& m) override;
+
+    void clear(Index i, Index j) override;
+    void clearRow(Index i) override;
+    void clearCol(Index j) override;
+    void clearRowCol(Index i) override;
+
+    ElementType getElementType() const override;
+    std::size_t getElementSize() const override;
+    MatrixCategory getCategory() const override;
+    Index getBlockRows() const override;
+    Index getBlockCols() const override;
+
+protected:
+    enum class Operation : unsigned char { Set, Add, AddMat3x3d, AddMat3x3f, Clear, ClearRow, ClearCol, ClearRowCol };
+
+    struct Entry
+    {
+        Operation operation;
+        Index i, j;
+        double value; ///< the value of Set and Add, or the index of the block of AddMat3x3d and AddMat3x3f
+    };
+
+    defaulttype::BaseMatrix* m_destination;
+    type::vector<Entry> m_entries;
+    type::vector<type::Mat3x3d> m_blocks3x3d;
+    type::vector<type::Mat3x3f> m_blocks3x3f;
+};
+
+/**
+ * MultiMatrixAccessor redirecting the matrices of another accessor to MatrixWriteBuffer.
+ *
+ * The offsets are given by the accessor it redirects, which is queried under a lock (shared by all
+ * the BufferedMatrixAccessor of the same accessor), so that several BufferedMatrixAccessor can be
+ * used concurrently.
+ */
+class SOFA_SIMULATION_CORE_API BufferedMatrixAccessor : public core::behavior::MultiMatrixAccessor
+{
+public:
+    BufferedMatrixAccessor(const core::behavior::MultiMatrixAccessor* accessor, std::mutex* accessorMutex);
+
+    Index getGlobalDimension() const override;
+    int getGlobalOffset(const core::behavior::BaseMechanicalState* mstate) const override;
+
+    MatrixRef getMatrix(const core::behavior::BaseMechanicalState* mstate) const override;
+    InteractionMatrixRef getMatrix(const core::behavior::BaseMechanicalState* mstate1, const core::behavior::BaseMechanicalState* mstate2) const override;
+
+    /// Replay the writes of all the buffers in their destination matrices
+    void flush();
+
+    /// Replay the writes of the buffer of a destination matrix, if any. The buffers of different
+    /// destination matrices can be flushed concurrently.
+    void flush(defaulttype::BaseMatrix* destination);
+
+    /// Destination matrices of the buffers, in the order of their first use
+    type::vector<defaulttype::BaseMatrix*> getDestinations() const;
+
+protected:
+    MatrixWriteBuffer* getBuffer(defaulttype::BaseMatrix* destination) const;
+
+    const core::behavior::MultiMatrixAccessor* m_accessor;
+    std::mutex* m_accessorMutex;
+
+    /// One buffer per destination matrix, in the order of their first use
+    mutable type::vector< std::unique_ptr<MatrixWriteBuffer> > m_buffers;
+};
+
+} // namespace sofa::simulation
@@ -519,14 +519,14 @@ void MechanicalOperations::getMatrixDimension(sofa::Size*  const nbRow, sofa::Si
     executeVisitor( MechanicalGetMatrixDimensionVisitor(&mparams, nbRow, nbCol, matrix) );
 }
 
-void MechanicalOperations::addMBK_ToMatrix(const sofa::core::behavior::MultiMatrixAccessor* matrix, SReal mFact, SReal bFact, SReal kFact)
+void MechanicalOperations::addMBK_ToMatrix(const sofa::core::behavior::MultiMatrixAccessor* matrix, SReal mFact, SReal bFact, SReal kFact, bool parallelAssembly)
 {
     mparams.setMFactor(mFact);
     mparams.setBFactor(bFact);
     mparams.setKFactor(kFact);
     if (matrix != nullptr)
     {
-        executeVisitor( MechanicalAddMBK_ToMatrixVisitor(&mparams, matrix) );
+        executeVisitor( MechanicalAddMBK_ToMatrixVisitor(&mparams, matrix, parallelAssembly) );
         executeVisitor( MechanicalApplyProjectiveConstraint_ToMatrixVisitor(&mparams, matrix) );
     }
 }
@@ -130,7 +130,9 @@ public:
         getMatrixDimension(nullptr, nullptr, matrix);
     }
 
-    void addMBK_ToMatrix(const sofa::core::behavior::MultiMatrixAccessor* matrix, SReal mFact, SReal bFact, SReal kFact);
+    /// Assemble the mass, damping and stiffness matrices. With parallelAssembly, the thread-safe force fields
+    /// are assembled concurrently using the TaskScheduler (see MechanicalAddMBK_ToMatrixVisitor)
+    void addMBK_ToMatrix(const sofa::core::behavior::MultiMatrixAccessor* matrix, SReal mFact, SReal bFact, SReal kFact, bool parallelAssembly = false);
     void addSubMBK_ToMatrix(const sofa::core::behavior::MultiMatrixAccessor* matrix, const type::vector<unsigned> & subMatrixIndex, SReal mFact, SReal bFact, SReal kFact);
 
     void multiVector2BaseVector(core::ConstMultiVecId src, defaulttype::BaseVector *dest, const sofa::core::behavior::MultiMatrixAccessor* matrix);
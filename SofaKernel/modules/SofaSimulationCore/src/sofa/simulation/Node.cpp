@@ -870,6 +870,16 @@ void Node::updateVisualContext()
         msg_info()<<"Node::updateVisualContext, node = "<<getName()<<", updated context = "<< *static_cast<core::objectmodel::Context*>(this) ;
 }
 
+VisitorScheduler* Node::findVisitorScheduler()
+{
+    for (Node* node = this; node != nullptr; node = down_cast<Node>(node->getFirstParent()))
+    {
+        if (node->m_visitorScheduler)
+            return node->m_visitorScheduler;
+    }
+    return nullptr;
+}
+
 /// Execute a recursive action starting from this node
 void Node::executeVisitor(Visitor* action, bool precomputedOrder)
 {
@@ -890,7 +900,11 @@ void Node::executeVisitor(Visitor* action, bool precomputedOrder)
         ++level;
     }
 
-    doExecuteVisitor(action, precomputedOrder);
+    VisitorScheduler* scheduler = precomputedOrder ? nullptr : findVisitorScheduler();
+    if (scheduler)
+        scheduler->executeVisitor(this, action);
+    else
+        doExecuteVisitor(action, precomputedOrder);
 
     if(DEBUG_VISITOR)
     {
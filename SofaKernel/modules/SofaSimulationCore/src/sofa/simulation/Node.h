@@ -503,9 +503,12 @@ public:
     /// Update the visual context values, based on parent and local ContextObjects
     virtual void updateVisualContext();
 
-    // VisitorScheduler can use doExecuteVisitor() method
+    // VisitorScheduler can use doExecuteVisitor() method and register itself in the node
     friend class VisitorScheduler;
 
+    /// Return the VisitorScheduler registered in this node or, if none, in the closest ancestor
+    VisitorScheduler* findVisitorScheduler();
+
     /// Must be called after each graph modification. Do not call it directly, apply an InitVisitor instead.
     virtual void initialize();
 
@@ -533,6 +536,9 @@ protected:
     virtual void doMoveObject(sofa::core::objectmodel::BaseObject::SPtr sobj, Node* prev_parent);
 
     std::stack<Visitor*> actionStack;
+
+    /// VisitorScheduler registered in this node (nullptr for the default recursive traversal)
+    VisitorScheduler* m_visitorScheduler { nullptr };
 private:    
     virtual void notifyBeginAddChild(Node::SPtr parent, Node::SPtr child) const;
     virtual void notifyBeginRemoveChild(Node::SPtr parent, Node::SPtr child) const;
@@ -0,0 +1,203 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/ParallelDataEngineEvaluator.h>
+
+#include <sofa/core/DataEngine.h>
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/objectmodel/BaseContext.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <sofa/helper/ScopedAdvancedTimer.h>
+#include <sofa/helper/system/thread/CTime.h>
+#include <sofa/simulation/AnimateBeginEvent.h>
+#include <sofa/simulation/ParallelFor.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <unordered_map>
+
+namespace sofa::simulation
+{
+
+int ParallelDataEngineEvaluatorClass = core::RegisterObject("Evaluate the dirty DataEngines of its subtree in parallel, level by level of their dependency graph")
+        .add< ParallelDataEngineEvaluator >()
+        ;
+
+namespace
+{
+
+using core::objectmodel::DDGNode;
+
+/// Depth-first traversal of the dirty part of the data dependency graph, upstream of the requested engines
+class LevelBuilder
+{
+public:
+    explicit LevelBuilder(type::vector<ParallelDataEngineEvaluator::EngineLevel>& levels) : m_levels(levels) {}
+
+    /// Number of levels of engines which must be evaluated before the node can be updated, or -1 on a cycle
+    int getInputLevels(DDGNode* node)
+    {
+        auto it = m_inputLevels.find(node);
+        if (it != m_inputLevels.end())
+            return it->second;
+        m_inputLevels[node] = InProgress;
+
+        int inputLevels = 0;
+        for (DDGNode* input : node->getInputs())
+        {
+            if (!input->isDirty())
+                continue;
+            int level = getInputLevels(input);
+            if (level < 0)
+                return -1;
+            if (dynamic_cast<core::DataEngine*>(input) != nullptr)
+                ++level; // the engine itself is evaluated at the level following its inputs
+            inputLevels = std::max(inputLevels, level);
+        }
+
+        if (auto* engine = dynamic_cast<core::DataEngine*>(node))
+        {
+            if (m_levels.size() <= std::size_t(inputLevels))
+                m_levels.resize(inputLevels + 1);
+            m_levels[inputLevels].push_back(engine);
+        }
+
+        m_inputLevels[node] = inputLevels;
+        return inputLevels;
+    }
+
+private:
+    static constexpr int InProgress = -1; ///< the node is being traversed: reaching it again means a cycle
+
+    type::vector<ParallelDataEngineEvaluator::EngineLevel>& m_levels;
+    std::unordered_map<DDGNode*, int> m_inputLevels;
+};
+
+}
+
+ParallelDataEngineEvaluator::ParallelDataEngineEvaluator()
+{
+    f_listening.setValue(true);
+}
+
+void ParallelDataEngineEvaluator::init()
+{
+    Inherit1::init();
+
+    auto* taskScheduler = TaskScheduler::getInstance();
+    assert(taskScheduler != nullptr);
+    if (taskScheduler->getThreadCount() < 1)
+    {
+        taskScheduler->init(0);
+    }
+}
+
+void ParallelDataEngineEvaluator::bwdInit()
+{
+    evaluate();
+}
+
+void ParallelDataEngineEvaluator::handleEvent(sofa::core::objectmodel::Event* event)
+{
+    if (AnimateBeginEvent::checkEventType(event))
+    {
+        evaluate();
+    }
+}
+
+void ParallelDataEngineEvaluator::evaluate()
+{
+    sofa::helper::ScopedAdvancedTimer timer("ParallelDataEngineEvaluator");
+
+    type::vector<core::DataEngine*> engines;
+    getContext()->getObjects<core::DataEngine>(&engines, core::objectmodel::BaseContext::SearchDown);
+    evaluate(engines);
+}
+
+bool ParallelDataEngineEvaluator::computeLevels(const type::vector<core::DataEngine*>& engines, type::vector<EngineLevel>& levels)
+{
+    levels.clear();
+    LevelBuilder builder(levels);
+    for (core::DataEngine* engine : engines)
+    {
+        if (engine->isDirty() && builder.getInputLevels(engine) < 0)
+        {
+            levels.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void ParallelDataEngineEvaluator::evaluate(const type::vector<core::DataEngine*>& engines)
+{
+    using sofa::helper::AdvancedTimer;
+    using sofa::helper::system::thread::CTime;
+    using sofa::helper::system::thread::ctime_t;
+
+    type::vector<EngineLevel> levels;
+    if (!computeLevels(engines, levels))
+    {
+        // the engines will be updated when their outputs are read, as usual
+        msg_warning("ParallelDataEngineEvaluator") << "The dependencies of the engines contain a cycle: they are not evaluated in parallel.";
+        return;
+    }
+
+    TaskScheduler* taskScheduler = TaskScheduler::getInstance();
+    const bool timing = AdvancedTimer::isActive();
+    const double ticksToMs = 1000.0 / double(CTime::getRefTicksPerSec());
+
+    type::vector<char> dirty;
+    type::vector<ctime_t> durations;
+    for (const EngineLevel& level : levels)
+    {
+        // the inputs of the engines are updated sequentially, as they may be shared
+        dirty.assign(level.size(), false);
+        for (std::size_t i = 0; i < level.size(); ++i)
+        {
+            if (level[i]->isDirty())
+            {
+                dirty[i] = true;
+                level[i]->prepareUpdate();
+            }
+        }
+
+        durations.assign(level.size(), 0);
+        parallelFor(taskScheduler, std::size_t(0), level.size(), std::size_t(1), [&](const std::size_t i)
+        {
+            if (!dirty[i])
+                return;
+            const ctime_t start = CTime::getRefTime();
+            level[i]->computeOutputs();
+            durations[i] = CTime::getRefTime() - start;
+        });
+
+        if (timing)
+        {
+            for (std::size_t i = 0; i < level.size(); ++i)
+            {
+                if (dirty[i])
+                    AdvancedTimer::valAdd(AdvancedTimer::IdVal("DataEngine " + level[i]->getPathName()), double(durations[i]) * ticksToMs);
+            }
+        }
+    }
+}
+
+} // namespace sofa::simulation
@@ -0,0 +1,82 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+#include <sofa/core/objectmodel/BaseObject.h>
+#include <sofa/type/vector.h>
+
+namespace sofa::core
+{
+class DataEngine;
+}
+
+namespace sofa::simulation
+{
+
+/**
+ *  \brief Evaluates the dirty DataEngines of its subtree in parallel, on the TaskScheduler.
+ *
+ *  DataEngines are normally updated lazily and recursively, one at a time, when one of their outputs is read.
+ *  This component collects the dirty engines of the subtree of its node, and the dirty engines they depend on,
+ *  and sorts them in levels: the engines of a level only depend on the engines of the previous levels. The
+ *  levels are evaluated in order, the engines of a level in parallel. It is done after the initialization of the
+ *  graph, and at the beginning of each time step.
+ *
+ *  The inputs of the engines (copies from the parent Data) are updated sequentially, only the doUpdate() of
+ *  the engines are executed concurrently. The engines must therefore only read the Data declared as their inputs.
+ *
+ *  The duration of each engine is recorded in the AdvancedTimer values, as "DataEngine <path of the engine>".
+ */
+class SOFA_SIMULATION_CORE_API ParallelDataEngineEvaluator : public core::objectmodel::BaseObject
+{
+public:
+    SOFA_CLASS(ParallelDataEngineEvaluator, core::objectmodel::BaseObject);
+
+    using EngineLevel = type::vector<core::DataEngine*>;
+
+    /// Initialize the TaskScheduler if it has not been initialized yet
+    void init() override;
+
+    /// Evaluate the engines, once they have all been initialized
+    void bwdInit() override;
+
+    /// Evaluate the engines at the beginning of each time step
+    void handleEvent(sofa::core::objectmodel::Event* event) override;
+
+    /// Update the dirty engines of the subtree of the node containing this component
+    void evaluate();
+
+    /// Update the dirty engines among the given ones, and the dirty engines they depend on
+    static void evaluate(const type::vector<core::DataEngine*>& engines);
+
+    /// Sort the dirty engines among the given ones, and the dirty engines they depend on, in levels: the engines
+    /// of a level only depend on the engines of the previous levels.
+    /// Returns false if the dependencies contain a cycle.
+    static bool computeLevels(const type::vector<core::DataEngine*>& engines, type::vector<EngineLevel>& levels);
+
+protected:
+    ParallelDataEngineEvaluator();
+    ~ParallelDataEngineEvaluator() override = default;
+};
+
+} // namespace sofa::simulation
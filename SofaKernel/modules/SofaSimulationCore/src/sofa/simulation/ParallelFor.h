@@ -0,0 +1,270 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/CpuTask.h>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace sofa::simulation
+{
+
+/**
+ * Generic data-parallel loops running on a TaskScheduler.
+ *
+ * The range [begin, end) is recursively split in two halves until the sub-ranges are not larger than
+ * the grain size. The splitting only depends on the range and on the grain size, never on the
+ * execution order, so that parallelReduce always combines the partial results in the same order:
+ * the results are bit-reproducible from one run to another.
+ *
+ * A grain size of 0 lets the functions choose one from the number of threads of the scheduler. Give an
+ * explicit grain size to get reductions which are also identical for any number of threads.
+ * If the scheduler has a single thread, parallelFor runs the whole range sequentially in the calling
+ * thread.
+ *
+ * Example:
+ * \code{.cpp}
+ * sofa::simulation::parallelFor(std::size_t(0), elements.size(), std::size_t(64),
+ *     [&](std::size_t i) { computeElement(i); });
+ *
+ * const double sum = sofa::simulation::parallelReduce(std::size_t(0), v.size(), std::size_t(0), 0.0,
+ *     [&](std::size_t b, std::size_t e, double partial) { for (; b < e; ++b) partial += v[b]; return partial; },
+ *     std::plus<double>());
+ * \endcode
+ */
+
+namespace parallel
+{
+
+/// Choose a grain size giving several ranges per thread, to leave some room for load balancing
+template<class Integer>
+Integer computeGrainSize(TaskScheduler* scheduler, Integer begin, Integer end, Integer grainSize)
+{
+    if (grainSize > Integer(0))
+    {
+        return grainSize;
+    }
+    const Integer nbThreads = static_cast<Integer>(std::max(1u, scheduler ? scheduler->getThreadCount() : 1u));
+    const Integer autoGrain = static_cast<Integer>((end - begin) / (Integer(8) * nbThreads));
+    return std::max(Integer(1), autoGrain);
+}
+
+inline bool isParallel(TaskScheduler* scheduler)
+{
+    return scheduler != nullptr && scheduler->getThreadCount() > 1;
+}
+
+/// Task calling a function on a range, splitting it recursively while it is larger than the grain size
+template<class Integer, class RangeFunction>
+class ForRangeTask : public CpuTask
+{
+public:
+    ForRangeTask(TaskScheduler* scheduler, Integer begin, Integer end, Integer grainSize,
+                 const RangeFunction& function, CpuTask::Status* status)
+        : CpuTask(status)
+        , m_scheduler(scheduler), m_begin(begin), m_end(end), m_grainSize(grainSize), m_function(function)
+    {}
+
+    ~ForRangeTask() override {}
+
+    MemoryAlloc run() final
+    {
+        if (m_end - m_begin <= m_grainSize)
+        {
+            m_function(m_begin, m_end);
+            return MemoryAlloc::Stack;
+        }
+
+        const Integer middle = m_begin + (m_end - m_begin) / 2;
+
+        CpuTask::Status status;
+        ForRangeTask task0(m_scheduler, m_begin, middle, m_grainSize, m_function, &status);
+        ForRangeTask task1(m_scheduler, middle, m_end, m_grainSize, m_function, &status);
+
+        m_scheduler->addTask(&task0);
+        m_scheduler->addTask(&task1);
+        m_scheduler->workUntilDone(&status);
+
+        return MemoryAlloc::Stack;
+    }
+
+private:
+    TaskScheduler* m_scheduler;
+    const Integer m_begin;
+    const Integer m_end;
+    const Integer m_grainSize;
+    const RangeFunction& m_function;
+};
+
+/// Task reducing a range: the partial results of the two halves are combined in a fixed order
+template<class Integer, class T, class RangeFunction, class Combine>
+class ReduceRangeTask : public CpuTask
+{
+public:
+    ReduceRangeTask(TaskScheduler* scheduler, Integer begin, Integer end, Integer grainSize, const T& identity,
+                    const RangeFunction& function, const Combine& combine, T* result, CpuTask::Status* status)
+        : CpuTask(status)
+        , m_scheduler(scheduler), m_begin(begin), m_end(end), m_grainSize(grainSize), m_identity(identity)
+        , m_function(function), m_combine(combine), m_result(result)
+    {}
+
+    ~ReduceRangeTask() override {}
+
+    MemoryAlloc run() final
+    {
+        if (m_end - m_begin <= m_grainSize)
+        {
+            *m_result = m_function(m_begin, m_end, m_identity);
+            return MemoryAlloc::Stack;
+        }
+
+        const Integer middle = m_begin + (m_end - m_begin) / 2;
+
+        CpuTask::Status status;
+        T left = m_identity;
+        T right = m_identity;
+        ReduceRangeTask task0(m_scheduler, m_begin, middle, m_grainSize, m_identity, m_function, m_combine, &left, &status);
+        ReduceRangeTask task1(m_scheduler, middle, m_end, m_grainSize, m_identity, m_function, m_combine, &right, &status);
+
+        m_scheduler->addTask(&task0);
+        m_scheduler->addTask(&task1);
+        m_scheduler->workUntilDone(&status);
+
+        *m_result = m_combine(left, right);
+
+        return MemoryAlloc::Stack;
+    }
+
+private:
+    TaskScheduler* m_scheduler;
+    const Integer m_begin;
+    const Integer m_end;
+    const Integer m_grainSize;
+    const T& m_identity;
+    const RangeFunction& m_function;
+    const Combine& m_combine;
+    T* m_result;
+};
+
+} // namespace parallel
+
+
+/**
+ * Call f(b, e) on sub-ranges [b, e) covering [begin, end), in parallel on the given scheduler.
+ */
+template<class Integer, class RangeFunction>
+void parallelForRange(TaskScheduler* scheduler, Integer begin, Integer end, Integer grainSize, const RangeFunction& f)
+{
+    static_assert(std::is_integral<Integer>::value, "parallelForRange requires an integral index type");
+    if (end <= begin)
+    {
+        return;
+    }
+
+    grainSize = parallel::computeGrainSize(scheduler, begin, end, grainSize);
+    if (!parallel::isParallel(scheduler) || end - begin <= grainSize)
+    {
+        f(begin, end);
+        return;
+    }
+
+    CpuTask::Status status;
+    parallel::ForRangeTask<Integer, RangeFunction> task(scheduler, begin, end, grainSize, f, &status);
+    scheduler->addTask(&task);
+    scheduler->workUntilDone(&status);
+}
+
+/// Same as above, on the current TaskScheduler instance
+template<class Integer, class RangeFunction>
+void parallelForRange(Integer begin, Integer end, Integer grainSize, const RangeFunction& f)
+{
+    parallelForRange(TaskScheduler::getInstance(), begin, end, grainSize, f);
+}
+
+/**
+ * Call f(i) for every i in [begin, end), in parallel on the given scheduler.
+ */
+template<class Integer, class Function>
+void parallelFor(TaskScheduler* scheduler, Integer begin, Integer end, Integer grainSize, const Function& f)
+{
+    parallelForRange(scheduler, begin, end, grainSize, [&f](Integer b, Integer e)
+    {
+        for (Integer i = b; i < e; ++i)
+        {
+            f(i);
+        }
+    });
+}
+
+/// Same as above, on the current TaskScheduler instance
+template<class Integer, class Function>
+void parallelFor(Integer begin, Integer end, Integer grainSize, const Function& f)
+{
+    parallelFor(TaskScheduler::getInstance(), begin, end, grainSize, f);
+}
+
+/**
+ * Reduce [begin, end) in parallel on the given scheduler.
+ *
+ * @param identity neutral element of combine, used to initialize every partial result
+ * @param f function T f(Integer b, Integer e, T init) accumulating the range [b, e) into init
+ * @param combine function T combine(const T& left, const T& right) merging two partial results
+ * @return the combination of all the partial results
+ */
+template<class Integer, class T, class RangeFunction, class Combine>
+T parallelReduce(TaskScheduler* scheduler, Integer begin, Integer end, Integer grainSize, const T& identity,
+                 const RangeFunction& f, const Combine& combine)
+{
+    static_assert(std::is_integral<Integer>::value, "parallelReduce requires an integral index type");
+    if (end <= begin)
+    {
+        return identity;
+    }
+
+    grainSize = parallel::computeGrainSize(scheduler, begin, end, grainSize);
+    if (scheduler == nullptr || end - begin <= grainSize)
+    {
+        return f(begin, end, identity);
+    }
+
+    // even with a single thread, the range is split the same way to get the same result
+
+    CpuTask::Status status;
+    T result = identity;
+    parallel::ReduceRangeTask<Integer, T, RangeFunction, Combine> task(scheduler, begin, end, grainSize, identity, f, combine, &result, &status);
+    scheduler->addTask(&task);
+    scheduler->workUntilDone(&status);
+    return result;
+}
+
+/// Same as above, on the current TaskScheduler instance
+template<class Integer, class T, class RangeFunction, class Combine>
+T parallelReduce(Integer begin, Integer end, Integer grainSize, const T& identity, const RangeFunction& f, const Combine& combine)
+{
+    return parallelReduce(TaskScheduler::getInstance(), begin, end, grainSize, identity, f, combine);
+}
+
+} // namespace sofa::simulation
@@ -43,6 +43,7 @@
 #include <sofa/simulation/DeleteVisitor.h>
 #include <sofa/simulation/UpdateBoundingBoxVisitor.h>
 #include <sofa/simulation/UpdateLinksVisitor.h>
+#include <sofa/simulation/Task.h>
 #include <sofa/simulation/init.h>
 #include <sofa/simulation/DefaultAnimationLoop.h>
 #include <sofa/simulation/DefaultVisualManagerLoop.h>
@@ -248,6 +249,12 @@ void Simulation::animate ( Node* root, SReal dt )
         return;
     }
 
+    // the tasks of this step are done: their memory can be reused by the next step
+    if (simulation::Task::Allocator* taskAllocator = simulation::Task::getAllocator())
+    {
+        taskAllocator->newFrame();
+    }
+
     sofa::helper::AdvancedTimer::stepEnd("Simulation::animate");
 }
 
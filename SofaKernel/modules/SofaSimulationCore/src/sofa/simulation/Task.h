@@ -50,6 +50,9 @@ namespace sofa::simulation
                 virtual void* allocate(std::size_t sz) = 0;
                 
                 virtual void free(void* ptr, std::size_t sz) = 0;
+                
+                // called at the end of each animation step, when the memory of the frame can be reused
+                virtual void newFrame() {}
             };
             
             
@@ -0,0 +1,215 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/TaskFrameAllocator.h>
+
+#include <thread>
+
+namespace sofa::simulation
+{
+
+namespace
+{
+
+/// Each allocation is preceded by the block it comes from (nullptr for the global heap)
+constexpr std::size_t HeaderSize = alignof(std::max_align_t);
+static_assert(HeaderSize >= sizeof(void*), "the allocation header must hold a pointer");
+
+constexpr std::size_t alignSize(std::size_t size)
+{
+    return (size + HeaderSize - 1) / HeaderSize * HeaderSize;
+}
+
+std::atomic<std::size_t> allocatorCounter { 0 };
+
+/// Arena of the calling thread in the last allocator it used. The id avoids any access to an arena
+/// of a destroyed allocator.
+struct CurrentArena
+{
+    std::size_t allocatorId { 0 };
+    TaskFrameAllocator::Arena* arena { nullptr };
+};
+
+thread_local CurrentArena currentArena;
+
+} // namespace
+
+
+struct TaskFrameAllocator::Block
+{
+    explicit Block(std::size_t blockSize) : memory(new char[blockSize]) {}
+
+    std::unique_ptr<char[]> memory;
+    std::atomic<std::size_t> liveCount { 0 };
+};
+
+
+struct TaskFrameAllocator::Arena
+{
+    explicit Arena(std::thread::id thread) : owner(thread) {}
+
+    /// Only called by the owner thread
+    char* allocate(std::size_t size, std::size_t blockSize, unsigned int currentFrame, Block*& allocationBlock)
+    {
+        const bool full = block == blocks.size() || offset + size > blockSize;
+        if (full || frame != currentFrame)
+        {
+            // continue in the first block whose allocations are all freed (possibly the current one)
+            frame = currentFrame;
+            const std::size_t freeBlock = findFreeBlock();
+            if (freeBlock < blocks.size())
+            {
+                block = freeBlock;
+                offset = 0;
+            }
+            else if (full)
+            {
+                blocks.emplace_back(new Block(blockSize));
+                block = blocks.size() - 1;
+                offset = 0;
+            }
+        }
+
+        allocationBlock = blocks[block].get();
+        char* memory = allocationBlock->memory.get() + offset;
+        offset += size;
+        allocationBlock->liveCount.fetch_add(1, std::memory_order_relaxed);
+        return memory;
+    }
+
+    std::size_t findFreeBlock() const
+    {
+        std::size_t i = 0;
+        while (i < blocks.size() && blocks[i]->liveCount.load(std::memory_order_acquire) != 0)
+            ++i;
+        return i;
+    }
+
+    std::thread::id owner;
+    std::vector<std::unique_ptr<Block> > blocks;
+    std::size_t block { 0 };
+    std::size_t offset { 0 };
+    unsigned int frame { 0 };
+};
+
+
+TaskFrameAllocator::TaskFrameAllocator(const std::size_t blockSize)
+    : m_id(++allocatorCounter)
+    , m_blockSize(alignSize(blockSize))
+    , m_frame(0)
+{
+}
+
+TaskFrameAllocator::~TaskFrameAllocator()
+{
+}
+
+void* TaskFrameAllocator::allocate(std::size_t sz)
+{
+    const std::size_t size = HeaderSize + alignSize(sz);
+
+    Block* block = nullptr;
+    char* memory = nullptr;
+    if (size <= m_blockSize)
+    {
+        memory = getCurrentArena()->allocate(size, m_blockSize, m_frame.load(std::memory_order_relaxed), block);
+    }
+    else
+    {
+        memory = static_cast<char*>(::operator new(size));
+    }
+
+    *reinterpret_cast<Block**>(memory) = block;
+    return memory + HeaderSize;
+}
+
+void TaskFrameAllocator::free(void* ptr, std::size_t sz)
+{
+    SOFA_UNUSED(sz);
+    if (ptr == nullptr)
+        return;
+
+    char* memory = static_cast<char*>(ptr) - HeaderSize;
+    Block* block = *reinterpret_cast<Block**>(memory);
+    if (block)
+    {
+        block->liveCount.fetch_sub(1, std::memory_order_release);
+    }
+    else
+    {
+        ::operator delete(memory);
+    }
+}
+
+void TaskFrameAllocator::newFrame()
+{
+    m_frame.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::size_t TaskFrameAllocator::getArenaCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_arenas.size();
+}
+
+std::size_t TaskFrameAllocator::getBlockCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t count = 0;
+    for (const auto& arena : m_arenas)
+    {
+        count += arena->blocks.size();
+    }
+    return count;
+}
+
+TaskFrameAllocator::Arena* TaskFrameAllocator::getCurrentArena()
+{
+    if (currentArena.allocatorId == m_id)
+    {
+        return currentArena.arena;
+    }
+
+    const std::thread::id thread = std::this_thread::get_id();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Arena* arena = nullptr;
+    for (const auto& a : m_arenas)
+    {
+        // a thread id can be reused once its thread has finished: the arena is adopted by the new thread
+        if (a->owner == thread)
+        {
+            arena = a.get();
+            break;
+        }
+    }
+    if (!arena)
+    {
+        m_arenas.emplace_back(new Arena(thread));
+        arena = m_arenas.back().get();
+    }
+
+    currentArena.allocatorId = m_id;
+    currentArena.arena = arena;
+    return arena;
+}
+
+} // namespace sofa::simulation
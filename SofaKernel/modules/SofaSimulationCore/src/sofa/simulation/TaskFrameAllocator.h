@@ -0,0 +1,90 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/Task.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sofa::simulation
+{
+
+/**
+ * Task allocator giving each thread its own arena, whose memory is reused frame by frame.
+ *
+ * An allocation only moves a pointer in the current block of the arena of the calling thread: no lock and no
+ * global heap allocation once the arena has grown to the size needed by a frame. Freeing a task only decrements
+ * the number of live allocations of its block, from any thread.
+ * After newFrame() (called at the end of each animation step), and whenever its current block is full, a thread
+ * continues its allocations at the start of the first block of its arena whose allocations have all been freed.
+ * A task alive across several frames therefore only keeps its own block, and the memory is also reused when
+ * newFrame() is not called (e.g. while the animation is paused).
+ */
+class SOFA_SIMULATION_CORE_API TaskFrameAllocator : public Task::Allocator
+{
+public:
+
+    /// Memory of one thread
+    struct Arena;
+
+    /// Memory of an arena, reused once all its allocations are freed
+    struct Block;
+
+    /// Allocations larger than a block use the global heap
+    explicit TaskFrameAllocator(std::size_t blockSize = 64 * 1024);
+
+    ~TaskFrameAllocator();
+
+    TaskFrameAllocator(const TaskFrameAllocator&) = delete;
+    TaskFrameAllocator& operator=(const TaskFrameAllocator&) = delete;
+
+    void* allocate(std::size_t sz) final;
+
+    void free(void* ptr, std::size_t sz) final;
+
+    void newFrame() final;
+
+    std::size_t getBlockSize() const { return m_blockSize; }
+
+    /// Number of arenas, i.e. threads which allocated tasks
+    std::size_t getArenaCount() const;
+
+    /// Number of blocks allocated by all the arenas. Only meaningful when no thread is allocating.
+    std::size_t getBlockCount() const;
+
+private:
+
+    Arena* getCurrentArena();
+
+    const std::size_t m_id;
+    const std::size_t m_blockSize;
+    std::atomic<unsigned int> m_frame;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Arena> > m_arenas;
+};
+
+} // namespace sofa::simulation
@@ -1,6 +1,7 @@
 #include <sofa/simulation/TaskScheduler.h>
 
 #include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
 
 //#include <sofa/helper/system/thread/CTime.h>
 
@@ -20,6 +21,7 @@ namespace sofa
         
         // register default task scheduler
         const bool DefaultTaskScheduler::isRegistered = TaskScheduler::registerScheduler(DefaultTaskScheduler::name(), &DefaultTaskScheduler::create);
+        const bool WorkStealingTaskScheduler::isRegistered = TaskScheduler::registerScheduler(WorkStealingTaskScheduler::name(), &WorkStealingTaskScheduler::create);
         
         
         TaskScheduler* TaskScheduler::create(const char* name)
@@ -34,8 +36,7 @@ namespace sofa
             {
                 // error scheduler not registered
                 // create the default task scheduler
-                iter = _schedulers.end();
-                --iter;
+                iter = _schedulers.find(DefaultTaskScheduler::name());
             }
             
             if (_currentScheduler != nullptr)
@@ -54,6 +55,58 @@ namespace sofa
         }
         
         
+        TaskScheduler* TaskScheduler::create(const char* name, const ThreadPlacement& placement)
+        {
+            TaskScheduler* scheduler = create(name);
+            if (scheduler->m_threadPlacement != placement)
+            {
+                scheduler->stop();
+                scheduler->m_threadPlacement = placement;
+            }
+            return scheduler;
+        }
+        
+        
+        void TaskScheduler::init(const unsigned int nbThread, const ThreadPlacement& placement)
+        {
+            if (m_threadPlacement != placement)
+            {
+                stop();
+                m_threadPlacement = placement;
+            }
+            init(nbThread);
+        }
+        
+        
+        std::vector<CpuTopology::ThreadSlot> TaskScheduler::placeThreads(const unsigned int nbThread)
+        {
+            std::vector<CpuTopology::ThreadSlot> slots = CpuTopology::computeThreadSlots(nbThread, m_threadPlacement);
+            if (!slots.empty() && !slots[0].cpus.empty())
+            {
+                // keep the affinity from before the first placement
+                if (!m_isMainThreadPlaced && !CpuTopology::getCurrentThreadAffinity(m_mainThreadAffinity))
+                    m_mainThreadAffinity.clear();
+                if (CpuTopology::setCurrentThreadAffinity(slots[0].cpus))
+                    m_isMainThreadPlaced = true;
+            }
+            else
+            {
+                // release the main thread from a previous placement
+                restoreMainThreadAffinity();
+            }
+            return slots;
+        }
+        
+        
+        void TaskScheduler::restoreMainThreadAffinity()
+        {
+            if (!m_isMainThreadPlaced)
+                return;
+            CpuTopology::setCurrentThreadAffinity(m_mainThreadAffinity);
+            m_isMainThreadPlaced = false;
+        }
+        
+        
         bool TaskScheduler::registerScheduler(const char* name, std::function<TaskScheduler* ()> creatorFunc)
         {
             _schedulers[name] = creatorFunc;
@@ -26,6 +26,7 @@
 
 #include <sofa/simulation/Task.h>
 #include <sofa/simulation/Locks.h>
+#include <sofa/simulation/CpuTopology.h>
 
 #include <thread>
 #include <mutex>
@@ -59,6 +60,15 @@ namespace sofa
              * @return A TaskScheduler
              */
             static TaskScheduler* create(const char* name = "");
+
+            /**
+             * Same as create(name), setting the placement of the threads started by the next call to init()
+             *
+             * @param name key to find or create a TaskScheduler
+             * @param placement placement of the threads on the CPUs
+             * @return A TaskScheduler
+             */
+            static TaskScheduler* create(const char* name, const ThreadPlacement& placement);
             
             typedef std::function<TaskScheduler* ()> TaskSchedulerCreatorFunction;
 
@@ -79,6 +89,13 @@ namespace sofa
              */
             static TaskScheduler* getInstance();
 
+            /**
+             * Get the current TaskScheduler instance, without creating it.
+             *
+             * @return The current TaskScheduler instance, or nullptr if none has been created yet
+             */
+            static TaskScheduler* getCurrentInstance()  { return _currentScheduler; }
+
             /**
              * Get the name of the current TaskScheduler instance
              * @return The name of the current TaskScheduler instance
@@ -87,6 +104,14 @@ namespace sofa
             
             // interface
             virtual void init(const unsigned int nbThread = 0) = 0;
+
+            /**
+             * Initialize the scheduler with the given placement of the threads.
+             * The threads are restarted if the placement changed.
+             */
+            void init(const unsigned int nbThread, const ThreadPlacement& placement);
+
+            const ThreadPlacement& getThreadPlacement() const { return m_threadPlacement; }
             
             virtual void stop(void) = 0;
             
@@ -105,6 +130,24 @@ namespace sofa
             
             
         protected:
+
+            /**
+             * Compute where the threads run, and restrict the calling (main) thread accordingly.
+             * To be called by the implementations when they start their worker threads.
+             *
+             * @param nbThread number of threads, including the main thread
+             * @return the slot of each thread, index 0 being the main thread
+             */
+            std::vector<CpuTopology::ThreadSlot> placeThreads(unsigned int nbThread);
+
+            /// Give back to the main thread the affinity it had before placeThreads restricted it.
+            /// To be called by the implementations when they stop, from the main thread.
+            void restoreMainThreadAffinity();
+
+            ThreadPlacement m_threadPlacement;
+
+            bool m_isMainThreadPlaced { false };
+            CpuTopology::CpuList m_mainThreadAffinity; ///< CPUs of the main thread before it was placed, empty if unknown
             
             // factory map: registered schedulers: name, creation function
             static std::map<std::string, std::function<TaskScheduler*()> > _schedulers;
@@ -0,0 +1,250 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/TaskVisitorScheduler.h>
+
+#include <sofa/core/ObjectFactory.h>
+#include <sofa/core/behavior/BaseMechanicalState.h>
+#include <sofa/simulation/AnimateBeginEvent.h>
+#include <sofa/simulation/BaseMechanicalVisitor.h>
+#include <sofa/simulation/CollisionEndEvent.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simulation/ParallelFor.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <unordered_map>
+
+namespace sofa::simulation
+{
+
+int TaskVisitorSchedulerClass = core::RegisterObject("Visitor scheduler traversing the independent child subtrees of its node in parallel, for the mechanical visitors")
+        .add< TaskVisitorScheduler >()
+        ;
+
+namespace
+{
+
+/// Representative of the set containing i (union-find with path halving)
+std::size_t findSet(type::vector<std::size_t>& sets, std::size_t i)
+{
+    while (sets[i] != i)
+    {
+        sets[i] = sets[sets[i]];
+        i = sets[i];
+    }
+    return i;
+}
+
+void mergeSets(type::vector<std::size_t>& sets, std::size_t a, std::size_t b)
+{
+    a = findSet(sets, a);
+    b = findSet(sets, b);
+    if (a < b)
+        sets[b] = a;
+    else if (b < a)
+        sets[a] = b;
+}
+
+}
+
+TaskVisitorScheduler::TaskVisitorScheduler()
+    : ParallelVisitorScheduler(false)
+{
+    f_listening.setValue(true);
+}
+
+void TaskVisitorScheduler::init()
+{
+    ParallelVisitorScheduler::init();
+
+    auto* taskScheduler = TaskScheduler::getInstance();
+    assert(taskScheduler != nullptr);
+    if (taskScheduler->getThreadCount() < 1)
+    {
+        taskScheduler->init(0);
+    }
+}
+
+void TaskVisitorScheduler::handleEvent(sofa::core::objectmodel::Event* event)
+{
+    if (AnimateBeginEvent::checkEventType(event) || CollisionEndEvent::checkEventType(event))
+    {
+        clearPartitionCache();
+    }
+}
+
+void TaskVisitorScheduler::clearPartitionCache()
+{
+    std::lock_guard<std::mutex> lock(m_partitionMutex);
+    m_partitions.clear();
+}
+
+ParallelVisitorScheduler* TaskVisitorScheduler::clone()
+{
+    return new TaskVisitorScheduler();
+}
+
+type::vector<TaskVisitorScheduler::ChildGroup> TaskVisitorScheduler::computeIndependentChildGroups(Node* node)
+{
+    type::vector<Node*> children;
+    for (const auto& c : node->child)
+        children.push_back(c.get());
+
+    const std::size_t nbChildren = children.size();
+
+    // nodes of each child subtree, and the child owning each mechanical state
+    type::vector<type::vector<Node*> > subtrees(nbChildren);
+    std::unordered_map<const core::behavior::BaseMechanicalState*, std::size_t> stateOwner;
+    for (std::size_t i = 0; i < nbChildren; ++i)
+    {
+        type::vector<Node*> stack { children[i] };
+        while (!stack.empty())
+        {
+            Node* n = stack.back();
+            stack.pop_back();
+
+            // a node with several parents would be traversed by several groups
+            if (n->getNbParents() > 1)
+                return {};
+
+            subtrees[i].push_back(n);
+            if (n->mechanicalState)
+                stateOwner[n->mechanicalState.get()] = i;
+            for (const auto& c : n->child)
+                stack.push_back(c.get());
+        }
+    }
+
+    // merge the children whose objects are linked to the mechanical state of another child
+    type::vector<std::size_t> sets(nbChildren);
+    for (std::size_t i = 0; i < nbChildren; ++i)
+        sets[i] = i;
+    type::vector<bool> external(nbChildren, false);
+
+    for (std::size_t i = 0; i < nbChildren; ++i)
+    {
+        for (Node* n : subtrees[i])
+        {
+            for (const auto& obj : n->object)
+            {
+                for (const core::objectmodel::BaseLink* link : obj->getLinks())
+                {
+                    for (std::size_t l = 0; l < link->getSize(); ++l)
+                    {
+                        core::objectmodel::Base* linked = link->getLinkedBase(l);
+                        const auto* state = linked ? linked->toBaseMechanicalState() : nullptr;
+                        if (!state)
+                            continue;
+
+                        const auto owner = stateOwner.find(state);
+                        if (owner != stateOwner.end())
+                            mergeSets(sets, i, owner->second);
+                        else
+                            external[i] = true;
+                    }
+                }
+            }
+        }
+    }
+
+    // the children linked to a state outside of the subtrees may write into the same state
+    std::size_t firstExternal = nbChildren;
+    for (std::size_t i = 0; i < nbChildren; ++i)
+    {
+        if (!external[i])
+            continue;
+        if (firstExternal == nbChildren)
+            firstExternal = i;
+        else
+            mergeSets(sets, firstExternal, i);
+    }
+
+    type::vector<ChildGroup> groups;
+    std::unordered_map<std::size_t, std::size_t> groupIndex;
+    for (std::size_t i = 0; i < nbChildren; ++i)
+    {
+        const auto inserted = groupIndex.emplace(findSet(sets, i), groups.size());
+        if (inserted.second)
+            groups.emplace_back();
+        groups[inserted.first->second].push_back(children[i]);
+    }
+    return groups;
+}
+
+type::vector<TaskVisitorScheduler::ChildGroup> TaskVisitorScheduler::getChildGroups(Node* node)
+{
+    type::vector<Node*> children;
+    for (const auto& c : node->child)
+        children.push_back(c.get());
+
+    std::lock_guard<std::mutex> lock(m_partitionMutex);
+    const auto it = m_partitions.find(node);
+    if (it != m_partitions.end() && it->second.children == children)
+        return it->second.groups;
+
+    Partition& partition = m_partitions[node];
+    partition.children = std::move(children);
+    partition.groups = computeIndependentChildGroups(node);
+    return partition.groups;
+}
+
+void TaskVisitorScheduler::executeParallelVisitor(Node* node, Visitor* action)
+{
+    const auto* mechanicalVisitor = dynamic_cast<const BaseMechanicalVisitor*>(action);
+    Visitor::TreeTraversalRepetition repeat;
+    if (!mechanicalVisitor || !mechanicalVisitor->isThreadSafeAcrossSubtrees() || mechanicalVisitor->writeNodeData()
+        || action->treeTraversal(repeat))
+    {
+        doExecuteVisitor(node, action);
+        return;
+    }
+
+    const type::vector<ChildGroup> groups = getChildGroups(node);
+    if (groups.size() < 2)
+    {
+        doExecuteVisitor(node, action);
+        return;
+    }
+
+    if (action->processNodeTopDown(node) != Visitor::RESULT_PRUNE)
+    {
+        const bool reversed = action->childOrderReversed(node);
+        const std::size_t nbGroups = groups.size();
+        parallelFor(TaskScheduler::getInstance(), std::size_t(0), nbGroups, std::size_t(1),
+            [&](std::size_t g)
+            {
+                const ChildGroup& group = groups[reversed ? nbGroups - 1 - g : g];
+                if (reversed)
+                {
+                    for (auto it = group.rbegin(); it != group.rend(); ++it)
+                        doExecuteVisitor(*it, action);
+                }
+                else
+                {
+                    for (Node* child : group)
+                        doExecuteVisitor(child, action);
+                }
+            });
+    }
+    action->processNodeBottomUp(node);
+}
+
+} // namespace sofa::simulation
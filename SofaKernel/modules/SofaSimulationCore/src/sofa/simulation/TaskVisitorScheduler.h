@@ -0,0 +1,95 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/ParallelVisitorScheduler.h>
+#include <sofa/type/vector.h>
+
+#include <map>
+#include <mutex>
+
+namespace sofa::simulation
+{
+
+/**
+ *  \brief VisitorScheduler dispatching the mechanical visitors on independent sibling subtrees to the TaskScheduler.
+ *
+ *  When a thread-safe BaseMechanicalVisitor is executed from the node containing this component, the children of
+ *  this node are partitioned into groups that do not share any mechanical state: two children belong to the same
+ *  group if an object of one subtree (mapping, interaction force field, ...) is linked to the mechanical state of
+ *  the other subtree. Children linked to a mechanical state located outside of the children subtrees (typically a
+ *  mapping from the state of this node) are gathered in the same group, as they would concurrently write into it.
+ *  The groups are traversed in parallel, the children of a group sequentially.
+ *
+ *  The visitors are executed sequentially if:
+ *  - the visitor is not a BaseMechanicalVisitor opting in with isThreadSafeAcrossSubtrees() (the visitors allocating
+ *    or freeing vectors, for instance, modify the ids of a MultiVecId shared by all the subtrees),
+ *  - the visitor accumulates a result in the node data (dot products, norms),
+ *  - the visitor requires a tree traversal,
+ *  - the subtrees contain nodes with several parents,
+ *  - the children cannot be split into at least two groups.
+ *
+ *  The partition is cached and recomputed at the beginning of each time step and after the collision pipeline,
+ *  which can add interaction force fields between the subtrees.
+ */
+class SOFA_SIMULATION_CORE_API TaskVisitorScheduler : public ParallelVisitorScheduler
+{
+public:
+    SOFA_CLASS(TaskVisitorScheduler, ParallelVisitorScheduler);
+
+    using ChildGroup = type::vector<Node*>;
+
+    /// Initialize the TaskScheduler if it has not been initialized yet
+    void init() override;
+
+    /// Invalidate the cached partitions when the graph may have changed
+    void handleEvent(sofa::core::objectmodel::Event* event) override;
+
+    /// Split the children of the node into groups of subtrees which can be traversed concurrently by a mechanical
+    /// visitor. The order of the children is preserved in the groups. Returns an empty list if the subtrees contain
+    /// nodes with several parents.
+    static type::vector<ChildGroup> computeIndependentChildGroups(Node* node);
+
+    /// Forget the cached partitions
+    void clearPartitionCache();
+
+protected:
+    TaskVisitorScheduler();
+    ~TaskVisitorScheduler() override = default;
+
+    ParallelVisitorScheduler* clone() override;
+    void executeParallelVisitor(Node* node, Visitor* action) override;
+
+    /// Return the (cached) partition of the children of the node
+    type::vector<ChildGroup> getChildGroups(Node* node);
+
+    struct Partition
+    {
+        type::vector<Node*> children; ///< children of the node when the partition was computed
+        type::vector<ChildGroup> groups;
+    };
+
+    std::map<Node*, Partition> m_partitions;
+    std::mutex m_partitionMutex;
+};
+
+} // namespace sofa::simulation
@@ -34,6 +34,21 @@ void VisitorScheduler::doExecuteVisitor(simulation::Node* node, Visitor* act)
     node->doExecuteVisitor(act);
 }
 
+bool VisitorScheduler::insertInNode( sofa::core::objectmodel::BaseNode* node )
+{
+    if (Node* n = dynamic_cast<Node*>(node))
+        n->m_visitorScheduler = this;
+    return false;
+}
+
+bool VisitorScheduler::removeInNode( sofa::core::objectmodel::BaseNode* node )
+{
+    Node* n = dynamic_cast<Node*>(node);
+    if (n && n->m_visitorScheduler == this)
+        n->m_visitorScheduler = nullptr;
+    return false;
+}
+
 } // namespace simulation
 
 } // namespace sofa
@@ -45,6 +45,11 @@ public:
     /// Specify whether this scheduler is multi-threaded.
     virtual bool isMultiThreaded() const { return false; }
 
+    /// Register this scheduler in the node it is added to, so that the visitors executed
+    /// from this node (or one of its descendants) are dispatched through executeVisitor().
+    bool insertInNode( sofa::core::objectmodel::BaseNode* node ) override;
+    bool removeInNode( sofa::core::objectmodel::BaseNode* node ) override;
+
 protected:
 
     VisitorScheduler() {}
@@ -0,0 +1,162 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace sofa::simulation
+{
+
+class Task;
+
+/**
+ * Lock-free single-producer/multi-consumer deque of tasks (Chase-Lev).
+ *
+ * Only the owner thread is allowed to call push() and pop(), which work on the bottom end of the
+ * deque (LIFO order). Any other thread can call steal(), which takes the oldest task from the top
+ * end (FIFO order). The implementation follows the C11 version of the algorithm described in
+ * "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al., PPoPP 2013).
+ *
+ * The capacity is fixed and must be a power of two: when the deque is full, push() fails and the
+ * caller is expected to run the task itself.
+ */
+class WorkStealingQueue
+{
+public:
+
+    explicit WorkStealingQueue(std::int64_t capacity = 4096)
+        : m_capacity(roundUpToPowerOfTwo(capacity))
+        , m_mask(m_capacity - 1)
+        , m_buffer(new std::atomic<Task*>[static_cast<std::size_t>(m_capacity)])
+    {
+        m_top.store(0, std::memory_order_relaxed);
+        m_bottom.store(0, std::memory_order_relaxed);
+    }
+
+    WorkStealingQueue(const WorkStealingQueue&) = delete;
+    WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+    /// Owner only: add a task at the bottom of the deque. Return false if the deque is full.
+    bool push(Task* task)
+    {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = m_top.load(std::memory_order_acquire);
+        if (b - t >= m_capacity)
+        {
+            return false;
+        }
+        m_buffer[b & m_mask].store(task, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Owner only: take the most recently pushed task. Return nullptr if the deque is empty.
+    Task* pop()
+    {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = m_top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            // empty deque
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Task* task = m_buffer[b & m_mask].load(std::memory_order_relaxed);
+        if (t == b)
+        {
+            // last task: race against the thieves
+            if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                task = nullptr;
+            }
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    /// Any thread: take the oldest task. Return nullptr if the deque is empty or if another thread won the race.
+    Task* steal()
+    {
+        std::int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = m_bottom.load(std::memory_order_acquire);
+        if (t >= b)
+        {
+            return nullptr;
+        }
+
+        Task* task = m_buffer[t & m_mask].load(std::memory_order_relaxed);
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        return task;
+    }
+
+    /// Approximate number of tasks in the deque
+    std::int64_t size() const
+    {
+        const std::int64_t b = m_bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = m_top.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    std::int64_t capacity() const { return m_capacity; }
+
+private:
+
+    static std::int64_t roundUpToPowerOfTwo(std::int64_t v)
+    {
+        std::int64_t p = 2;
+        while (p < v)
+        {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    enum
+    {
+        CACHE_LINE = 64
+    };
+
+    // top and bottom are written by different threads: keep them on different cache lines
+    alignas(CACHE_LINE) std::atomic<std::int64_t> m_top;
+    alignas(CACHE_LINE) std::atomic<std::int64_t> m_bottom;
+
+    alignas(CACHE_LINE) const std::int64_t m_capacity;
+    const std::int64_t m_mask;
+    std::unique_ptr<std::atomic<Task*>[]> m_buffer;
+};
+
+} // namespace sofa::simulation
@@ -0,0 +1,412 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/simulation/WorkStealingTaskScheduler.h>
+
+#include <sofa/simulation/TaskFrameAllocator.h>
+#include <sofa/simulation/WorkStealingQueue.h>
+#include <sofa/helper/system/thread/thread_specific_ptr.h>
+
+#include <cassert>
+#include <string>
+#include <thread>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+#include <immintrin.h>
+#define SOFA_WORKSTEALING_CPU_RELAX() _mm_pause()
+#else
+#define SOFA_WORKSTEALING_CPU_RELAX() std::this_thread::yield()
+#endif
+
+namespace sofa::simulation
+{
+
+class WorkStealingWorker
+{
+public:
+
+    WorkStealingWorker(unsigned int index, const std::string& name)
+        : m_index(index)
+        , m_name(name + std::to_string(index))
+        , m_randomState(2654435761u * (index + 1))
+        , m_currentStatus(nullptr)
+    {}
+
+    /// xorshift32: cheap pseudo-random generator used to choose the victims
+    unsigned int random()
+    {
+        unsigned int x = m_randomState;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        m_randomState = x;
+        return x;
+    }
+
+    const unsigned int m_index;
+    const std::string m_name;
+    unsigned int m_randomState;
+    Task::Status* m_currentStatus;
+    WorkStealingQueue m_tasks;
+    std::thread m_thread;
+    CpuTopology::ThreadSlot m_slot;
+};
+
+
+namespace
+{
+
+/// Never deleted: tasks may still be freed by static objects destroyed after this translation unit
+TaskFrameAllocator& workStealingTaskAllocator = *new TaskFrameAllocator();
+
+/// Backoff policy of an idle worker: spin first, then yield, then park
+enum
+{
+    SPIN_ATTEMPTS = 64,
+    YIELD_ATTEMPTS = 128,
+};
+
+} // namespace
+
+SOFA_THREAD_SPECIFIC_PTR(WorkStealingWorker, currentWorker);
+
+
+WorkStealingTaskScheduler* WorkStealingTaskScheduler::create()
+{
+    return new WorkStealingTaskScheduler();
+}
+
+WorkStealingTaskScheduler::WorkStealingTaskScheduler()
+    : TaskScheduler()
+    , m_threadCount(1)
+    , m_isInitialized(false)
+{
+    m_isClosing.store(false, std::memory_order_relaxed);
+    m_pendingTaskCount.store(0, std::memory_order_relaxed);
+    m_parkedWorkerCount.store(0, std::memory_order_relaxed);
+
+    // the thread creating the scheduler is the main thread
+    m_workers.emplace_back(new WorkStealingWorker(0, "Main  "));
+    currentWorker = m_workers[0].get();
+}
+
+WorkStealingTaskScheduler::~WorkStealingTaskScheduler()
+{
+    if (m_isInitialized)
+    {
+        stop();
+    }
+    if (currentWorker == m_workers[0].get())
+    {
+        currentWorker = nullptr;
+    }
+}
+
+unsigned WorkStealingTaskScheduler::GetHardwareThreadsCount()
+{
+    const unsigned count = std::thread::hardware_concurrency() / 2;
+    return count > 0 ? count : 1;
+}
+
+Task::Allocator* WorkStealingTaskScheduler::getTaskAllocator()
+{
+    return &workStealingTaskAllocator;
+}
+
+void WorkStealingTaskScheduler::init(const unsigned int nbThread)
+{
+    if (m_isInitialized)
+    {
+        if ((nbThread == m_threadCount) || (nbThread == 0 && m_threadCount == GetHardwareThreadsCount()))
+        {
+            return;
+        }
+        stop();
+    }
+
+    start(nbThread);
+}
+
+void WorkStealingTaskScheduler::start(const unsigned int nbThread)
+{
+    stop();
+
+    m_isClosing.store(false, std::memory_order_relaxed);
+    m_threadCount = (nbThread > 0) ? nbThread : GetHardwareThreadsCount();
+
+    for (unsigned int i = 1; i < m_threadCount; ++i)
+    {
+        m_workers.emplace_back(new WorkStealingWorker(i, "Worker"));
+    }
+
+    const std::vector<CpuTopology::ThreadSlot> slots = placeThreads(m_threadCount);
+    for (unsigned int i = 0; i < m_threadCount; ++i)
+    {
+        m_workers[i]->m_slot = slots[i];
+    }
+
+    // all the deques must exist before a worker starts stealing
+    for (unsigned int i = 1; i < m_threadCount; ++i)
+    {
+        WorkStealingWorker* worker = m_workers[i].get();
+        worker->m_thread = std::thread(&WorkStealingTaskScheduler::workerLoop, this, worker);
+    }
+
+    m_isInitialized = true;
+}
+
+void WorkStealingTaskScheduler::stop()
+{
+    if (!m_isInitialized)
+    {
+        return;
+    }
+
+    m_isClosing.store(true, std::memory_order_seq_cst);
+    wakeUpWorkers(true);
+
+    for (unsigned int i = 1; i < m_workers.size(); ++i)
+    {
+        if (m_workers[i]->m_thread.joinable())
+        {
+            m_workers[i]->m_thread.join();
+        }
+    }
+    m_workers.resize(1);
+    restoreMainThreadAffinity();
+
+    m_threadCount = 1;
+    m_isInitialized = false;
+}
+
+const char* WorkStealingTaskScheduler::getCurrentThreadName()
+{
+    WorkStealingWorker* worker = currentWorker;
+    return worker ? worker->m_name.c_str() : "";
+}
+
+int WorkStealingTaskScheduler::getCurrentThreadType()
+{
+    return 0;
+}
+
+bool WorkStealingTaskScheduler::addTask(Task* task)
+{
+    WorkStealingWorker* worker = currentWorker;
+
+    const int taskId = task->getStatus()->setBusy(true);
+    task->m_id = taskId;
+
+    // single threaded, unknown thread or full deque: run the task immediately
+    if (m_threadCount < 2 || worker == nullptr || !worker->m_tasks.push(task))
+    {
+        runTask(worker, task);
+        return false;
+    }
+
+    m_pendingTaskCount.fetch_add(1, std::memory_order_seq_cst);
+    if (m_parkedWorkerCount.load(std::memory_order_seq_cst) > 0)
+    {
+        wakeUpWorkers(false);
+    }
+    return true;
+}
+
+void WorkStealingTaskScheduler::workUntilDone(Task::Status* status)
+{
+    WorkStealingWorker* worker = currentWorker;
+
+    unsigned int failedAttempts = 0;
+    while (status->isBusy())
+    {
+        Task* task = worker ? findTask(worker) : nullptr;
+        if (task)
+        {
+            runTask(worker, task);
+            failedAttempts = 0;
+            continue;
+        }
+
+        // the remaining tasks are being run by other threads: never park here,
+        // the status can be released at any time
+        if (++failedAttempts < SPIN_ATTEMPTS)
+        {
+            SOFA_WORKSTEALING_CPU_RELAX();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void WorkStealingTaskScheduler::workerLoop(WorkStealingWorker* worker)
+{
+    currentWorker = worker;
+
+    if (!worker->m_slot.cpus.empty())
+    {
+        CpuTopology::setCurrentThreadAffinity(worker->m_slot.cpus);
+    }
+
+    unsigned int failedAttempts = 0;
+    while (!m_isClosing.load(std::memory_order_relaxed))
+    {
+        Task* task = findTask(worker);
+        if (task)
+        {
+            runTask(worker, task);
+            failedAttempts = 0;
+            continue;
+        }
+
+        ++failedAttempts;
+        if (failedAttempts < SPIN_ATTEMPTS)
+        {
+            SOFA_WORKSTEALING_CPU_RELAX();
+        }
+        else if (failedAttempts < YIELD_ATTEMPTS)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            park();
+            failedAttempts = 0;
+        }
+    }
+
+    currentWorker = nullptr;
+}
+
+Task* WorkStealingTaskScheduler::findTask(WorkStealingWorker* worker)
+{
+    Task* task = worker->m_tasks.pop();
+    if (!task)
+    {
+        task = stealTask(worker);
+    }
+
+    if (task)
+    {
+        m_pendingTaskCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+Task* WorkStealingTaskScheduler::stealTask(WorkStealingWorker* worker)
+{
+    if (m_pendingTaskCount.load(std::memory_order_relaxed) <= 0)
+    {
+        return nullptr;
+    }
+
+    const unsigned int nbWorkers = static_cast<unsigned int>(m_workers.size());
+    if (nbWorkers < 2)
+    {
+        return nullptr;
+    }
+
+    // with threads grouped by NUMA node, first try the victims of the same node
+    const bool localFirst = m_threadPlacement.groupByNumaNode;
+
+    // start from a random victim and try all the others once
+    const unsigned int first = worker->random() % nbWorkers;
+    for (int pass = localFirst ? 0 : 1; pass < 2; ++pass)
+    {
+        for (unsigned int i = 0; i < nbWorkers; ++i)
+        {
+            WorkStealingWorker* victim = m_workers[(first + i) % nbWorkers].get();
+            if (victim == worker)
+            {
+                continue;
+            }
+
+            const bool sameNode = victim->m_slot.numaNode == worker->m_slot.numaNode;
+            if ((pass == 0 && !sameNode) || (pass == 1 && localFirst && sameNode))
+            {
+                continue;
+            }
+
+            Task* task = victim->m_tasks.steal();
+            if (task)
+            {
+                return task;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void WorkStealingTaskScheduler::runTask(WorkStealingWorker* worker, Task* task)
+{
+    Task::Status* status = task->getStatus();
+
+    Task::Status* prevStatus = nullptr;
+    if (worker)
+    {
+        prevStatus = worker->m_currentStatus;
+        worker->m_currentStatus = status;
+    }
+
+    if (task->run() & Task::MemoryAlloc::Dynamic)
+    {
+        // pooled memory: call destructor and free
+        delete task;
+    }
+
+    status->setBusy(false);
+
+    if (worker)
+    {
+        worker->m_currentStatus = prevStatus;
+    }
+}
+
+void WorkStealingTaskScheduler::park()
+{
+    std::unique_lock<std::mutex> lock(m_parkMutex);
+    m_parkedWorkerCount.fetch_add(1, std::memory_order_seq_cst);
+    m_parkEvent.wait(lock, [this]
+    {
+        return m_pendingTaskCount.load(std::memory_order_seq_cst) > 0
+            || m_isClosing.load(std::memory_order_seq_cst);
+    });
+    m_parkedWorkerCount.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void WorkStealingTaskScheduler::wakeUpWorkers(bool all)
+{
+    {
+        // make sure a worker evaluating the wake up condition is either before the check or waiting
+        std::lock_guard<std::mutex> guard(m_parkMutex);
+    }
+    if (all)
+    {
+        m_parkEvent.notify_all();
+    }
+    else
+    {
+        m_parkEvent.notify_one();
+    }
+}
+
+} // namespace sofa::simulation
@@ -0,0 +1,141 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <sofa/simulation/config.h>
+
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace sofa::simulation
+{
+
+class WorkStealingWorker;
+
+/**
+ * Task scheduler based on per-worker lock-free deques (see WorkStealingQueue).
+ *
+ * Each thread (the main thread included) owns a deque: it pushes and pops its own tasks without any
+ * lock, while idle threads steal from a randomly chosen victim. When no task can be found, a worker
+ * spins, then yields, then parks on a condition variable until new tasks are pushed.
+ *
+ * Register name: "_workstealing"
+ */
+class SOFA_SIMULATION_CORE_API WorkStealingTaskScheduler : public TaskScheduler
+{
+public:
+
+    // interface
+
+    /**
+     * Call stop() and start() if not already initialized with the same number of threads
+     * @param nbThread number of threads, including the main thread. 0 means one thread per CPU core.
+     */
+    void init(const unsigned int nbThread = 0) final;
+
+    using TaskScheduler::init;
+
+    /**
+     * Wake up, wait and destroy the worker threads
+     */
+    void stop(void) final;
+
+    unsigned int getThreadCount(void) const final { return m_threadCount; }
+
+    const char* getCurrentThreadName() final;
+
+    int getCurrentThreadType() final;
+
+    // queue task if there is space, and run it otherwise
+    bool addTask(Task* task) final;
+
+    void workUntilDone(Task::Status* status) final;
+
+    Task::Allocator* getTaskAllocator() final;
+
+public:
+
+    // factory methods: name, creator function
+    static const char* name() { return "_workstealing"; }
+
+    static WorkStealingTaskScheduler* create();
+
+    static const bool isRegistered;
+
+private:
+
+    WorkStealingTaskScheduler();
+
+    ~WorkStealingTaskScheduler() override;
+
+    WorkStealingTaskScheduler(const WorkStealingTaskScheduler&) = delete;
+
+    void start(unsigned int nbThread);
+
+    /// Main loop of the worker threads
+    void workerLoop(WorkStealingWorker* worker);
+
+    /// Pop a task from the worker own deque, or steal one from another worker
+    Task* findTask(WorkStealingWorker* worker);
+
+    Task* stealTask(WorkStealingWorker* worker);
+
+    void runTask(WorkStealingWorker* worker, Task* task);
+
+    /// Block the worker until new tasks are available or the scheduler is closing
+    void park();
+
+    void wakeUpWorkers(bool all);
+
+    /**
+     * Assuming 2 concurrent threads by CPU core, return the number of CPU core on the system
+     */
+    static unsigned GetHardwareThreadsCount();
+
+private:
+
+    // index 0 is the main thread
+    std::vector<std::unique_ptr<WorkStealingWorker> > m_workers;
+
+    unsigned m_threadCount;
+
+    bool m_isInitialized;
+
+    std::atomic<bool> m_isClosing;
+
+    // number of tasks currently waiting in the deques
+    std::atomic<int> m_pendingTaskCount;
+
+    // number of workers blocked in park()
+    std::atomic<int> m_parkedWorkerCount;
+
+    std::mutex m_parkMutex;
+
+    std::condition_variable m_parkEvent;
+};
+
+} // namespace sofa::simulation
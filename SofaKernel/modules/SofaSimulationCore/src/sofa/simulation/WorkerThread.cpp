@@ -83,6 +83,11 @@ void WorkerThread::run(void)
     //workerThreadIndex = this;
     //TaskSchedulerDefault::_threads[std::this_thread::get_id()] = this;
 
+    if (!m_slot.cpus.empty())
+    {
+        CpuTopology::setCurrentThreadAffinity(m_slot.cpus);
+    }
+
     // main loop
     while (!m_taskScheduler->isClosing())
     {
@@ -251,28 +256,40 @@ bool WorkerThread::stealTask(Task **task)
     {
         //TASK_SCHEDULER_PROFILER(StealTask);
 
-        for (auto it : m_taskScheduler->_threads)
+        // with threads grouped by NUMA node, first steal from the threads of the same node
+        const bool localFirst = m_taskScheduler->getThreadPlacement().groupByNumaNode;
+
+        for (int pass = localFirst ? 0 : 1; pass < 2; ++pass)
         {
-            // if this is the main thread continue
-            if (std::this_thread::get_id() == it.first)
+            for (auto it : m_taskScheduler->_threads)
             {
-                continue;
-            }
+                // if this is the main thread continue
+                if (std::this_thread::get_id() == it.first)
+                {
+                    continue;
+                }
 
-            WorkerThread *otherThread = it.second;
+                WorkerThread *otherThread = it.second;
 
-            {
-                TASK_SCHEDULER_PROFILER(Steal);
+                const bool sameNode = otherThread->getNumaNode() == getNumaNode();
+                if ((pass == 0 && !sameNode) || (pass == 1 && localFirst && sameNode))
+                {
+                    continue;
+                }
 
-                simulation::ScopedLock lock(otherThread->m_taskMutex);
-                if (!otherThread->m_tasks.empty())
                 {
-                    *task = otherThread->m_tasks.front();
-                    otherThread->m_tasks.pop_front();
-                    return true;
+                    TASK_SCHEDULER_PROFILER(Steal);
+
+                    simulation::ScopedLock lock(otherThread->m_taskMutex);
+                    if (!otherThread->m_tasks.empty())
+                    {
+                        *task = otherThread->m_tasks.front();
+                        otherThread->m_tasks.pop_front();
+                        return true;
+                    }
                 }
-            }
 
+            }
         }
     }
 
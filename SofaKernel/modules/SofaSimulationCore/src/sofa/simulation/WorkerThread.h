@@ -27,6 +27,7 @@
 #include <thread>
 #include <deque>
 #include <sofa/simulation/Locks.h>
+#include <sofa/simulation/CpuTopology.h>
 
 namespace sofa::simulation
 {
@@ -62,6 +63,9 @@ public:
 
     std::uint64_t getTaskCount() { return m_tasks.size(); }
 
+    /// NUMA node the thread runs on (see ThreadPlacement)
+    unsigned int getNumaNode() const { return m_slot.numaNode; }
+
 private:
 
     bool start(DefaultTaskScheduler* const& taskScheduler);
@@ -110,6 +114,9 @@ private:
 
     DefaultTaskScheduler*     m_taskScheduler;
 
+    // CPUs the thread is restricted to
+    CpuTopology::ThreadSlot m_slot;
+
     // The following members may be accessed by _multiple_ threads at the same time:
     std::atomic<bool>	m_finished;
 
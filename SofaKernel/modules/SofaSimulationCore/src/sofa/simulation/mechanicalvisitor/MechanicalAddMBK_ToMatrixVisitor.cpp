@@ -23,14 +23,84 @@
 #include <sofa/simulation/mechanicalvisitor/MechanicalAddMBK_ToMatrixVisitor.h>
 
 #include <sofa/core/behavior/BaseForceField.h>
+#include <sofa/simulation/MatrixWriteBuffer.h>
+#include <sofa/simulation/ParallelFor.h>
+
+#include <algorithm>
 
 namespace sofa::simulation::mechanicalvisitor
 {
 
 MechanicalAddMBK_ToMatrixVisitor::MechanicalAddMBK_ToMatrixVisitor(const core::MechanicalParams *mparams,
-                                                                   const sofa::core::behavior::MultiMatrixAccessor *_matrix)
+                                                                   const sofa::core::behavior::MultiMatrixAccessor *_matrix,
+                                                                   bool parallelAssembly)
         : MechanicalVisitor(mparams) ,  matrix(_matrix) //,m(_m),b(_b),k(_k)
+        , m_parallelAssembly(parallelAssembly)
+{
+}
+
+void MechanicalAddMBK_ToMatrixVisitor::execute(sofa::core::objectmodel::BaseContext* node, bool precomputedOrder)
 {
+    m_forceFields.clear();
+    MechanicalVisitor::execute(node, precomputedOrder);
+    if (m_parallelAssembly)
+        assembleCollectedForceFields();
+}
+
+void MechanicalAddMBK_ToMatrixVisitor::assembleCollectedForceFields()
+{
+    if (m_forceFields.empty()) return;
+
+    // the scheduler is not created here: the force fields are only assembled concurrently if it already runs
+    TaskScheduler* taskScheduler = TaskScheduler::getCurrentInstance();
+    type::vector<std::size_t> threadSafe;
+    for (std::size_t i = 0; i < m_forceFields.size(); ++i)
+    {
+        if (m_forceFields[i]->isAddMBKToMatrixThreadSafe())
+            threadSafe.push_back(i);
+    }
+    if (threadSafe.size() < 2 || taskScheduler == nullptr || taskScheduler->getThreadCount() < 2)
+    {
+        for (core::behavior::BaseForceField* ff : m_forceFields)
+            ff->addMBKToMatrix(this->mparams, matrix);
+        m_forceFields.clear();
+        return;
+    }
+
+    std::mutex accessorMutex;
+    std::vector<BufferedMatrixAccessor> buffers;
+    buffers.reserve(m_forceFields.size());
+    for (std::size_t i = 0; i < m_forceFields.size(); ++i)
+        buffers.emplace_back(matrix, &accessorMutex);
+
+    parallelFor(taskScheduler, std::size_t(0), threadSafe.size(), std::size_t(1), [&](std::size_t k)
+    {
+        m_forceFields[threadSafe[k]]->addMBKToMatrix(this->mparams, &buffers[threadSafe[k]]);
+    });
+
+    // the other force fields are assembled one after the other, in their own buffers to keep the order of the writes
+    for (std::size_t i = 0; i < m_forceFields.size(); ++i)
+    {
+        if (!m_forceFields[i]->isAddMBKToMatrixThreadSafe())
+            m_forceFields[i]->addMBKToMatrix(this->mparams, &buffers[i]);
+    }
+
+    // the destination matrices are written concurrently, each one by a single task replaying the buffers in the traversal order
+    type::vector<defaulttype::BaseMatrix*> destinations;
+    for (const BufferedMatrixAccessor& buffer : buffers)
+    {
+        for (defaulttype::BaseMatrix* destination : buffer.getDestinations())
+        {
+            if (std::find(destinations.begin(), destinations.end(), destination) == destinations.end())
+                destinations.push_back(destination);
+        }
+    }
+    parallelFor(taskScheduler, std::size_t(0), destinations.size(), std::size_t(1), [&](std::size_t d)
+    {
+        for (BufferedMatrixAccessor& buffer : buffers)
+            buffer.flush(destinations[d]);
+    });
+    m_forceFields.clear();
 }
 
 Visitor::Result
@@ -45,7 +115,10 @@ Visitor::Result MechanicalAddMBK_ToMatrixVisitor::fwdForceField(simulation::Node
     if (matrix != nullptr)
     {
         assert( !ff->isCompliance.getValue() ); // if one day this visitor has to be used with compliance, K from compliance should not be added (by tweaking mparams with kfactor=0)
-        ff->addMBKToMatrix(this->mparams, matrix);
+        if (m_parallelAssembly)
+            m_forceFields.push_back(ff);
+        else
+            ff->addMBKToMatrix(this->mparams, matrix);
     }
 
     return RESULT_CONTINUE;
@@ -26,13 +26,21 @@
 namespace sofa::simulation::mechanicalvisitor
 {
 
-/** Accumulate the entries of a mechanical matrix (mass or stiffness) of the whole scene */
+/** Accumulate the entries of a mechanical matrix (mass or stiffness) of the whole scene
+ *
+ * In parallel mode, the force fields are only collected during the traversal. The ones declaring a thread-safe
+ * addMBKToMatrix are then assembled concurrently using the TaskScheduler, and the other ones sequentially, each
+ * one in its own MatrixWriteBuffer. The buffers are flushed in the traversal order, concurrently for different
+ * destination matrices: each matrix receives the same writes as in the sequential mode.
+ */
 class SOFA_SIMULATION_CORE_API MechanicalAddMBK_ToMatrixVisitor : public MechanicalVisitor
 {
 public:
     const sofa::core::behavior::MultiMatrixAccessor* matrix;
 
-    MechanicalAddMBK_ToMatrixVisitor(const core::MechanicalParams* mparams, const sofa::core::behavior::MultiMatrixAccessor* _matrix );
+    MechanicalAddMBK_ToMatrixVisitor(const core::MechanicalParams* mparams, const sofa::core::behavior::MultiMatrixAccessor* _matrix, bool parallelAssembly = false);
+
+    void execute(sofa::core::objectmodel::BaseContext* node, bool precomputedOrder = false) override;
 
     /// Return a class name for this visitor
     /// Only used for debugging / profiling purposes
@@ -43,5 +51,12 @@ public:
     Result fwdForceField(simulation::Node* /*node*/, core::behavior::BaseForceField* ff) override;
 
     bool stopAtMechanicalMapping(simulation::Node* node, core::BaseMapping* map) override;
+
+protected:
+    /// Assemble the collected force fields, concurrently for the thread-safe ones
+    void assembleCollectedForceFields();
+
+    bool m_parallelAssembly;
+    type::vector<core::behavior::BaseForceField*> m_forceFields; ///< force fields collected in parallel mode, in the traversal order
 };
 }
\ No newline at end of file
@@ -55,6 +55,10 @@ public:
     {
         return true;
     }
+    bool isThreadSafeAcrossSubtrees() const override
+    {
+        return true;
+    }
 #ifdef SOFA_DUMP_VISITOR_INFO
     void setReadWriteVectors() override
     {
@@ -57,6 +57,10 @@ public:
     {
         return true;
     }
+    bool isThreadSafeAcrossSubtrees() const override
+    {
+        return true;
+    }
 #ifdef SOFA_DUMP_VISITOR_INFO
     void setReadWriteVectors() override
     {
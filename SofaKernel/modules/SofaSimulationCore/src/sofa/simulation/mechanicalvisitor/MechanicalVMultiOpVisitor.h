@@ -59,6 +59,10 @@ public:
     {
         return true;
     }
+    bool isThreadSafeAcrossSubtrees() const override
+    {
+        return true;
+    }
     bool readNodeData() const override
     {
         return true;
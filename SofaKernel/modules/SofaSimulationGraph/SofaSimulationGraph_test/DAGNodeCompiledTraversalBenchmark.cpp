@@ -0,0 +1,133 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <SofaSimulationGraph/DAGNode.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+#include <sofa/core/ExecParams.h>
+#include <sofa/simulation/BaseMechanicalVisitor.h>
+
+#include <chrono>
+#include <iostream>
+
+namespace sofa
+{
+
+using sofa::simulation::Node;
+using sofa::simulation::graph::DAGNode;
+using MechanicalObject3 = sofa::component::container::MechanicalObject<defaulttype::Vec3Types>;
+
+/// Mechanical visitor counting the traversed mechanical states
+class CountingVisitor : public simulation::BaseMechanicalVisitor
+{
+public:
+    CountingVisitor() : BaseMechanicalVisitor(core::ExecParams::defaultInstance()) {}
+
+    Result fwdMechanicalState(simulation::Node*, core::behavior::BaseMechanicalState*) override
+    {
+        ++count;
+        return RESULT_CONTINUE;
+    }
+
+    const char* getClassName() const override { return "CountingVisitor"; }
+
+    std::size_t count { 0 };
+};
+
+/// Timings of the compiled and dynamic traversals, not run with the automatic tests
+struct DAGNodeCompiledTraversalBenchmark : public BaseTest
+{
+    Node::SPtr root;
+
+    void onSetUp() override
+    {
+        simulation::setSimulation(new simulation::graph::DAGSimulation());
+        root = simulation::getSimulation()->createNewNode("root");
+    }
+
+    void onTearDown() override
+    {
+        if (root)
+            simulation::getSimulation()->unload(root);
+    }
+
+    std::size_t countStates(bool compiled, std::size_t nbTraversals, double& timeMs)
+    {
+        static_cast<DAGNode*>(root.get())->d_compiledTraversal.setValue(compiled);
+        const auto start = std::chrono::high_resolution_clock::now();
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < nbTraversals; ++i)
+        {
+            CountingVisitor visitor;
+            root->executeVisitor(&visitor);
+            count += visitor.count;
+        }
+        const auto end = std::chrono::high_resolution_clock::now();
+        timeMs = std::chrono::duration<double, std::milli>(end - start).count();
+        return count;
+    }
+
+    void compareTraversalTimes(const std::string& graphName, std::size_t nbTraversals)
+    {
+        double dynamicTime = 0;
+        double compiledTime = 0;
+        const std::size_t dynamicCount = countStates(false, nbTraversals, dynamicTime);
+        const std::size_t compiledCount = countStates(true, nbTraversals, compiledTime);
+
+        EXPECT_EQ(dynamicCount, compiledCount);
+        std::cout << graphName << ", " << nbTraversals << " traversals: dynamic " << dynamicTime
+                  << " ms, compiled " << compiledTime << " ms" << std::endl;
+    }
+};
+
+TEST_F(DAGNodeCompiledTraversalBenchmark, deepGraph)
+{
+    Node::SPtr node = root;
+    for (unsigned int i = 0; i < 500; ++i)
+    {
+        node = simpleapi::createChild(node, "node" + std::to_string(i));
+        node->addObject(core::objectmodel::New<MechanicalObject3>());
+    }
+
+    compareTraversalTimes("Deep graph (500 levels)", 200);
+}
+
+TEST_F(DAGNodeCompiledTraversalBenchmark, wideGraph)
+{
+    for (unsigned int i = 0; i < 100; ++i)
+    {
+        Node::SPtr child = simpleapi::createChild(root, "child" + std::to_string(i));
+        child->addObject(core::objectmodel::New<MechanicalObject3>());
+        for (unsigned int j = 0; j < 10; ++j)
+        {
+            Node::SPtr grandChild = simpleapi::createChild(child, "grandChild" + std::to_string(j));
+            grandChild->addObject(core::objectmodel::New<MechanicalObject3>());
+        }
+    }
+
+    compareTraversalTimes("Wide graph (100x10 nodes)", 200);
+}
+
+} // namespace sofa
@@ -0,0 +1,231 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <SofaSimulationGraph/DAGNode.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+#include <sofa/core/ExecParams.h>
+#include <sofa/simulation/BaseMechanicalVisitor.h>
+
+namespace sofa
+{
+
+using sofa::simulation::Node;
+using sofa::simulation::graph::DAGNode;
+using MechanicalObject3 = sofa::component::container::MechanicalObject<defaulttype::Vec3Types>;
+
+/// Mechanical visitor recording the traversed nodes, pruning the nodes whose name starts with 'P'
+class TraversalRecordingVisitor : public simulation::BaseMechanicalVisitor
+{
+public:
+    TraversalRecordingVisitor() : BaseMechanicalVisitor(core::ExecParams::defaultInstance()) {}
+
+    Result processNodeTopDown(simulation::Node* node) override
+    {
+        topDown += node->getName() + " ";
+        BaseMechanicalVisitor::processNodeTopDown(node);
+        return node->getName()[0] == 'P' ? RESULT_PRUNE : RESULT_CONTINUE;
+    }
+
+    void processNodeBottomUp(simulation::Node* node) override
+    {
+        bottomUp += node->getName() + " ";
+        BaseMechanicalVisitor::processNodeBottomUp(node);
+    }
+
+    const char* getClassName() const override { return "TraversalRecordingVisitor"; }
+
+    std::string topDown;
+    std::string bottomUp;
+};
+
+/// Mechanical visitor counting the traversed mechanical states
+class CountingVisitor : public simulation::BaseMechanicalVisitor
+{
+public:
+    CountingVisitor() : BaseMechanicalVisitor(core::ExecParams::defaultInstance()) {}
+
+    Result fwdMechanicalState(simulation::Node*, core::behavior::BaseMechanicalState*) override
+    {
+        ++count;
+        return RESULT_CONTINUE;
+    }
+
+    const char* getClassName() const override { return "CountingVisitor"; }
+
+    std::size_t count { 0 };
+};
+
+struct DAGNodeCompiledTraversal_test : public BaseTest
+{
+    Node::SPtr root;
+
+    void onSetUp() override
+    {
+        simulation::setSimulation(new simulation::graph::DAGSimulation());
+        root = simulation::getSimulation()->createNewNode("root");
+    }
+
+    void onTearDown() override
+    {
+        if (root)
+            simulation::getSimulation()->unload(root);
+    }
+
+    void setCompiledTraversal(bool compiled)
+    {
+        static_cast<DAGNode*>(root.get())->d_compiledTraversal.setValue(compiled);
+    }
+
+    std::pair<std::string, std::string> traverse(bool compiled)
+    {
+        setCompiledTraversal(compiled);
+        TraversalRecordingVisitor visitor;
+        root->executeVisitor(&visitor);
+        return { visitor.topDown, visitor.bottomUp };
+    }
+
+    std::size_t countStates(bool compiled)
+    {
+        setCompiledTraversal(compiled);
+        CountingVisitor visitor;
+        root->executeVisitor(&visitor);
+        return visitor.count;
+    }
+
+    void checkSameTraversal(std::size_t nbStates)
+    {
+        EXPECT_EQ(countStates(false), nbStates);
+        EXPECT_EQ(countStates(true), nbStates);
+        EXPECT_EQ(traverse(true), traverse(false));
+    }
+};
+
+TEST_F(DAGNodeCompiledTraversal_test, sameOrderAsDynamicTraversal)
+{
+    /* root
+     * |-- A
+     * |   |-- P (pruned)
+     * |   |   `-- P1
+     * |   `-- S
+     * |       `-- S1
+     * |-- B
+     * |   |-- S
+     * |   `-- I (inactive)
+     * |       `-- I1
+     * `-- C
+     *     `-- Q (child of P and C)
+     */
+    Node::SPtr a = simpleapi::createChild(root, "A");
+    Node::SPtr b = simpleapi::createChild(root, "B");
+    Node::SPtr c = simpleapi::createChild(root, "C");
+    Node::SPtr p = simpleapi::createChild(a, "P");
+    simpleapi::createChild(p, "P1");
+    Node::SPtr s = simpleapi::createChild(a, "S");
+    simpleapi::createChild(s, "S1");
+    b->addChild(s);
+    Node::SPtr i = simpleapi::createChild(b, "I");
+    simpleapi::createChild(i, "I1");
+    i->setActive(false);
+    Node::SPtr q = simpleapi::createChild(c, "Q");
+    p->addChild(q);
+
+    const auto dynamicTraversal = traverse(false);
+    const auto compiledTraversal = traverse(true);
+
+    EXPECT_EQ(dynamicTraversal.first, "root A P B S S1 C Q ");
+    EXPECT_EQ(compiledTraversal.first, dynamicTraversal.first);
+    EXPECT_EQ(compiledTraversal.second, dynamicTraversal.second);
+}
+
+TEST_F(DAGNodeCompiledTraversal_test, multiParentNodeWithInactiveParent)
+{
+    /* root
+     * |-- A
+     * |   `-- M (child of A and I)
+     * `-- I (inactive)
+     */
+    Node::SPtr a = simpleapi::createChild(root, "A");
+    Node::SPtr i = simpleapi::createChild(root, "I");
+    Node::SPtr m = simpleapi::createChild(a, "M");
+    i->addChild(m);
+    i->setActive(false);
+
+    // M is reached from A before I has been visited, and I does not visit its children: M is not visited
+    EXPECT_EQ(traverse(false).first, "root A ");
+    EXPECT_EQ(traverse(true), traverse(false));
+
+    // I is visited first: M is visited from A
+    root->removeChild(a);
+    root->addChild(a);
+    EXPECT_EQ(traverse(false).first, "root A M ");
+    EXPECT_EQ(traverse(true), traverse(false));
+}
+
+TEST_F(DAGNodeCompiledTraversal_test, recompiledAfterGraphModification)
+{
+    Node::SPtr a = simpleapi::createChild(root, "A");
+    simpleapi::createChild(a, "A1");
+
+    EXPECT_EQ(traverse(true).first, "root A A1 ");
+
+    Node::SPtr b = simpleapi::createChild(a, "B");
+    EXPECT_EQ(traverse(true).first, "root A A1 B ");
+
+    a->removeChild(b);
+    root->addChild(b);
+    EXPECT_EQ(traverse(true).first, "root A A1 B ");
+    EXPECT_EQ(traverse(true), traverse(false));
+}
+
+TEST_F(DAGNodeCompiledTraversal_test, deepGraph)
+{
+    Node::SPtr node = root;
+    for (unsigned int i = 0; i < 500; ++i)
+    {
+        node = simpleapi::createChild(node, "node" + std::to_string(i));
+        node->addObject(core::objectmodel::New<MechanicalObject3>());
+    }
+
+    checkSameTraversal(500);
+}
+
+TEST_F(DAGNodeCompiledTraversal_test, wideGraph)
+{
+    for (unsigned int i = 0; i < 100; ++i)
+    {
+        Node::SPtr child = simpleapi::createChild(root, "child" + std::to_string(i));
+        child->addObject(core::objectmodel::New<MechanicalObject3>());
+        for (unsigned int j = 0; j < 10; ++j)
+        {
+            Node::SPtr grandChild = simpleapi::createChild(child, "grandChild" + std::to_string(j));
+            grandChild->addObject(core::objectmodel::New<MechanicalObject3>());
+        }
+    }
+
+    checkSameTraversal(1100);
+}
+
+} // namespace sofa
@@ -0,0 +1,189 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <sofa/core/DataEngine.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simulation/ParallelDataEngineEvaluator.h>
+#include <sofa/simulation/TaskScheduler.h>
+
+#include <atomic>
+
+namespace sofa
+{
+
+using sofa::simulation::Node;
+using sofa::simulation::ParallelDataEngineEvaluator;
+
+/// Engine computing the sum of its two inputs, and counting its updates
+class SumEngine : public core::DataEngine
+{
+public:
+    SOFA_CLASS(SumEngine, core::DataEngine);
+
+    Data<int> d_a;
+    Data<int> d_b;
+    Data<int> d_sum;
+    std::atomic<int> nbUpdates {0};
+
+    void init() override
+    {
+        addInput(&d_a);
+        addInput(&d_b);
+        addOutput(&d_sum);
+    }
+
+    void doUpdate() override
+    {
+        d_sum.setValue(d_a.getValue() + d_b.getValue());
+        ++nbUpdates;
+    }
+
+protected:
+    SumEngine()
+        : d_a(initData(&d_a, 0, "a", "first input"))
+        , d_b(initData(&d_b, 0, "b", "second input"))
+        , d_sum(initData(&d_sum, "sum", "sum of the inputs"))
+    {}
+};
+
+struct ParallelDataEngineEvaluator_test : public BaseTest
+{
+    Node::SPtr root;
+    type::vector<SumEngine::SPtr> engines;
+
+    void onSetUp() override
+    {
+        simulation::setSimulation(new simulation::graph::DAGSimulation());
+        root = simulation::getSimulation()->createNewNode("root");
+
+        /* E0   E1   E2
+         *  |    |    |
+         *  `-E3-'    |
+         *     |      |
+         *     `--E4--'
+         */
+        for (int i = 0; i < 5; ++i)
+        {
+            engines.push_back(core::objectmodel::New<SumEngine>());
+            engines.back()->setName("E" + std::to_string(i));
+            root->addObject(engines.back());
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            engines[i]->d_a.setValue(i + 1);
+            engines[i]->d_b.setValue(10 * (i + 1));
+        }
+        engines[3]->d_a.setParent(&engines[0]->d_sum);
+        engines[3]->d_b.setParent(&engines[1]->d_sum);
+        engines[4]->d_a.setParent(&engines[3]->d_sum);
+        engines[4]->d_b.setParent(&engines[2]->d_sum);
+    }
+
+    void onTearDown() override
+    {
+        if (root)
+            simulation::getSimulation()->unload(root);
+    }
+
+    void initEngines()
+    {
+        for (const auto& engine : engines)
+            engine->init();
+    }
+
+    type::vector<core::DataEngine*> getEngines(const type::vector<int>& ids) const
+    {
+        type::vector<core::DataEngine*> result;
+        for (int i : ids)
+            result.push_back(engines[i].get());
+        return result;
+    }
+
+    void checkSums(const type::vector<int>& expectedUpdates)
+    {
+        for (std::size_t i = 0; i < engines.size(); ++i)
+        {
+            EXPECT_FALSE(engines[i]->isDirty()) << engines[i]->getName();
+            EXPECT_EQ(engines[i]->nbUpdates, expectedUpdates[i]) << engines[i]->getName();
+        }
+
+        // the outputs are up to date: reading them does not update the engines again
+        EXPECT_EQ(engines[0]->d_sum.getValue(), engines[0]->d_a.getValue() + engines[0]->d_b.getValue());
+        EXPECT_EQ(engines[4]->d_sum.getValue(), engines[3]->d_sum.getValue() + engines[2]->d_sum.getValue());
+        EXPECT_EQ(engines[3]->d_sum.getValue(), engines[0]->d_sum.getValue() + engines[1]->d_sum.getValue());
+        for (std::size_t i = 0; i < engines.size(); ++i)
+            EXPECT_EQ(engines[i]->nbUpdates, expectedUpdates[i]) << engines[i]->getName();
+    }
+};
+
+TEST_F(ParallelDataEngineEvaluator_test, levels)
+{
+    initEngines();
+
+    type::vector<ParallelDataEngineEvaluator::EngineLevel> levels;
+    ASSERT_TRUE(ParallelDataEngineEvaluator::computeLevels(getEngines({4}), levels));
+
+    // the requested engine and all the dirty engines it depends on
+    const type::vector<ParallelDataEngineEvaluator::EngineLevel> expected {
+        getEngines({0, 1, 2}), getEngines({3}), getEngines({4}) };
+    EXPECT_EQ(levels, expected);
+
+    // clean engines are not evaluated
+    engines[0]->d_sum.getValue();
+    ASSERT_TRUE(ParallelDataEngineEvaluator::computeLevels(getEngines({0, 3}), levels));
+    const type::vector<ParallelDataEngineEvaluator::EngineLevel> expectedAfterUpdate { getEngines({1}), getEngines({3}) };
+    EXPECT_EQ(levels, expectedAfterUpdate);
+}
+
+TEST_F(ParallelDataEngineEvaluator_test, evaluate)
+{
+    simulation::TaskScheduler::getInstance()->init(4);
+    initEngines();
+
+    ParallelDataEngineEvaluator::evaluate(getEngines({0, 1, 2, 3, 4}));
+    checkSums({1, 1, 1, 1, 1});
+    EXPECT_EQ(engines[4]->d_sum.getValue(), 11 + 22 + 33);
+
+    // only the engines downstream of the modified input are evaluated again
+    engines[1]->d_a.setValue(5);
+    ParallelDataEngineEvaluator::evaluate(getEngines({0, 1, 2, 3, 4}));
+    checkSums({1, 2, 1, 2, 2});
+    EXPECT_EQ(engines[4]->d_sum.getValue(), 11 + 25 + 33);
+}
+
+TEST_F(ParallelDataEngineEvaluator_test, component)
+{
+    root->addObject(core::objectmodel::New<ParallelDataEngineEvaluator>());
+    simulation::getSimulation()->init(root.get());
+    checkSums({1, 1, 1, 1, 1});
+
+    engines[2]->d_b.setValue(100);
+    simulation::getSimulation()->animate(root.get(), 0.01);
+    checkSums({1, 1, 2, 1, 2});
+    EXPECT_EQ(engines[4]->d_sum.getValue(), 11 + 22 + 103);
+}
+
+} // namespace sofa
@@ -0,0 +1,221 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <SofaSimulationGraph/SimpleApi.h>
+#include <SofaSimulationGraph/DAGSimulation.h>
+#include <SofaBaseMechanics/MechanicalObject.h>
+#include <sofa/core/ExecParams.h>
+#include <sofa/simulation/BaseMechanicalVisitor.h>
+#include <sofa/simulation/Node.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/simulation/TaskVisitorScheduler.h>
+#include <sofa/simulation/mechanicalvisitor/MechanicalVReallocVisitor.h>
+#include <sofa/core/objectmodel/Link.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace sofa
+{
+
+using sofa::simulation::Node;
+using sofa::simulation::TaskVisitorScheduler;
+using sofa::core::behavior::BaseMechanicalState;
+using sofa::core::objectmodel::BaseLink;
+using MechanicalObject3 = sofa::component::container::MechanicalObject<defaulttype::Vec3Types>;
+
+/// Object linking a mechanical state, as a mapping or an interaction force field would do
+class StateLinkObject : public core::objectmodel::BaseObject
+{
+public:
+    SOFA_CLASS(StateLinkObject, core::objectmodel::BaseObject);
+
+    SingleLink<StateLinkObject, BaseMechanicalState, BaseLink::FLAG_STRONGLINK> l_state;
+
+protected:
+    StateLinkObject() : l_state(initLink("state", "linked mechanical state")) {}
+};
+
+/// Thread-safe mechanical visitor recording the order of the visited states
+class RecordingVisitor : public simulation::BaseMechanicalVisitor
+{
+public:
+    RecordingVisitor() : BaseMechanicalVisitor(core::ExecParams::defaultInstance()) {}
+
+    Result fwdMechanicalState(simulation::Node*, BaseMechanicalState* mm) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        topDown.push_back(mm);
+        return RESULT_CONTINUE;
+    }
+
+    void bwdMechanicalState(simulation::Node*, BaseMechanicalState* mm) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bottomUp.push_back(mm);
+    }
+
+    bool isThreadSafe() const override { return true; }
+    bool isThreadSafeAcrossSubtrees() const override { return true; }
+    const char* getClassName() const override { return "RecordingVisitor"; }
+
+    std::mutex mutex;
+    type::vector<BaseMechanicalState*> topDown;
+    type::vector<BaseMechanicalState*> bottomUp;
+};
+
+struct TaskVisitorScheduler_test : public BaseTest
+{
+    Node::SPtr root;
+    type::vector<Node::SPtr> children;
+    type::vector<MechanicalObject3::SPtr> states;
+    MechanicalObject3::SPtr rootState;
+
+    void onSetUp() override
+    {
+        simulation::setSimulation(new simulation::graph::DAGSimulation());
+        root = simulation::getSimulation()->createNewNode("root");
+        rootState = core::objectmodel::New<MechanicalObject3>();
+        root->addObject(rootState);
+
+        /* root
+         * |-- A
+         * |-- B
+         * |-- C   linked to A
+         * |-- D   linked to root
+         * |-- E
+         * |   `-- E1
+         * `-- F   linked to root
+         */
+        for (const std::string name : {"A", "B", "C", "D", "E", "F"})
+        {
+            children.push_back(simpleapi::createChild(root, name));
+            states.push_back(core::objectmodel::New<MechanicalObject3>());
+            children.back()->addObject(states.back());
+        }
+        Node::SPtr e1 = simpleapi::createChild(children[4], "E1");
+        states.push_back(core::objectmodel::New<MechanicalObject3>());
+        e1->addObject(states.back());
+
+        addStateLink(children[2], states[0]);
+        addStateLink(children[3], rootState);
+        addStateLink(children[5], rootState);
+    }
+
+    void onTearDown() override
+    {
+        if (root)
+            simulation::getSimulation()->unload(root);
+    }
+
+    static void addStateLink(Node::SPtr node, MechanicalObject3::SPtr state)
+    {
+        auto link = core::objectmodel::New<StateLinkObject>();
+        link->l_state.set(state.get());
+        node->addObject(link);
+    }
+
+    static type::vector<std::string> groupNames(const type::vector<TaskVisitorScheduler::ChildGroup>& groups)
+    {
+        type::vector<std::string> names;
+        for (const auto& group : groups)
+        {
+            std::string name;
+            for (const Node* node : group)
+                name += node->getName();
+            names.push_back(name);
+        }
+        return names;
+    }
+};
+
+TEST_F(TaskVisitorScheduler_test, independentChildGroups)
+{
+    const auto groups = groupNames(TaskVisitorScheduler::computeIndependentChildGroups(root.get()));
+    const type::vector<std::string> expected {"AC", "B", "DF", "E"};
+    EXPECT_EQ(groups, expected);
+}
+
+TEST_F(TaskVisitorScheduler_test, multiParentNodeDisablesPartition)
+{
+    Node::SPtr shared = simpleapi::createChild(children[1], "shared");
+    children[4]->addChild(shared);
+
+    EXPECT_TRUE(TaskVisitorScheduler::computeIndependentChildGroups(root.get()).empty());
+}
+
+TEST_F(TaskVisitorScheduler_test, mechanicalVisitorTraversal)
+{
+    simulation::TaskScheduler::getInstance()->init(4);
+    root->addObject(core::objectmodel::New<TaskVisitorScheduler>());
+
+    RecordingVisitor visitor;
+    root->executeVisitor(&visitor);
+
+    ASSERT_EQ(visitor.topDown.size(), states.size() + 1);
+    ASSERT_EQ(visitor.bottomUp.size(), states.size() + 1);
+    EXPECT_EQ(visitor.topDown.front(), rootState.get());
+    EXPECT_EQ(visitor.bottomUp.back(), rootState.get());
+
+    for (const auto& state : states)
+    {
+        EXPECT_EQ(std::count(visitor.topDown.begin(), visitor.topDown.end(), state.get()), 1);
+        EXPECT_EQ(std::count(visitor.bottomUp.begin(), visitor.bottomUp.end(), state.get()), 1);
+    }
+
+    // E1 is a child of E: visited after E top-down, before E bottom-up
+    const auto position = [](const type::vector<BaseMechanicalState*>& v, const MechanicalObject3::SPtr& s)
+    {
+        return std::find(v.begin(), v.end(), s.get()) - v.begin();
+    };
+    EXPECT_LT(position(visitor.topDown, states[4]), position(visitor.topDown, states[6]));
+    EXPECT_LT(position(visitor.bottomUp, states[6]), position(visitor.bottomUp, states[4]));
+
+    // C is linked to A: both are traversed in the same group, in the children order
+    EXPECT_LT(position(visitor.topDown, states[0]), position(visitor.topDown, states[2]));
+}
+
+TEST_F(TaskVisitorScheduler_test, vectorReallocationInIndependentSubtrees)
+{
+    simulation::TaskScheduler::getInstance()->init(4);
+    root->addObject(core::objectmodel::New<TaskVisitorScheduler>());
+
+    // the ids of the new vector are stored in the MultiVecId shared by all the subtrees
+    for (unsigned int i = 0; i < 50; ++i)
+    {
+        core::MultiVecDerivId v(core::VecDerivId::null());
+        simulation::mechanicalvisitor::MechanicalVReallocVisitor<core::V_DERIV> realloc(core::ExecParams::defaultInstance(), &v);
+        root->executeVisitor(&realloc);
+
+        for (const auto& state : states)
+        {
+            const core::VecDerivId id = v.getId(state.get());
+            ASSERT_FALSE(id.isNull()) << state->getName();
+            EXPECT_NE(state->read(core::ConstVecDerivId(id)), nullptr);
+        }
+        EXPECT_FALSE(v.getId(rootState.get()).isNull());
+    }
+}
+
+} // namespace sofa
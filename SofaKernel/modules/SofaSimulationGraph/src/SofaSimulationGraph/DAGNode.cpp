@@ -23,6 +23,7 @@
 #include <SofaSimulationCommon/xml/NodeElement.h>
 #include <sofa/helper/Factory.inl>
 #include <sofa/core/Mapping.h>
+#include <sofa/simulation/BaseMechanicalVisitor.h>
 
 namespace sofa::simulation::graph
 {
@@ -121,6 +122,7 @@ GetUpObjectsVisitor::~GetUpObjectsVisitor(){}
 
 DAGNode::DAGNode(const std::string& name, DAGNode* parent)
     : simulation::Node(name)
+    , d_compiledTraversal(initData(&d_compiledTraversal, false, "compiledTraversal", "If true, the mechanical visitors executed from this node follow a flat traversal plan, recompiled after each modification of the graph"))
     , l_parents(initLink("parents", "Parents nodes in the graph"))
 {
     if( parent )
@@ -586,6 +588,13 @@ void DAGNode::doExecuteVisitor(simulation::Visitor* action, bool precomputedOrde
             StatusMap statusMap;
             executeVisitorTreeTraversal( action, statusMap, repeat );
         }
+        else if( d_compiledTraversal.getValue() && dynamic_cast<BaseMechanicalVisitor*>(action) && !action->childOrderReversed(this) )
+        {
+            // Direct acyclic graph traversal order, following the compiled traversal plan
+            //
+            // Same order as below, without the recursion, the status map lookups nor the descendancy updates.
+            executeVisitorCompiled( action );
+        }
         else
         {
             // Direct acyclic graph traversal order
@@ -612,6 +621,142 @@ void DAGNode::doExecuteVisitor(simulation::Visitor* action, bool precomputedOrde
 }
 
 
+std::shared_ptr<const DAGNode::TraversalPlan> DAGNode::getTraversalPlan()
+{
+    if( !_traversalPlan )
+    {
+        updateDescendancy();
+
+        auto plan = std::make_shared<TraversalPlan>();
+        plan->nodes.reserve( _descendancy.size() + 1 );
+        plan->parentBegin.reserve( _descendancy.size() + 2 );
+
+        std::unordered_map<const DAGNode*, unsigned int> planIndex;
+        planIndex.reserve( _descendancy.size() + 1 );
+        compileTraversalPlan( *plan, planIndex, this );
+        plan->parentBegin.push_back( unsigned(plan->parents.size()) );
+
+        plan->childBegin.reserve( plan->nodes.size() + 1 );
+        for( DAGNode* node : plan->nodes )
+        {
+            plan->childBegin.push_back( unsigned(plan->children.size()) );
+            for( unsigned int i = 0; i<node->child.size(); ++i )
+                plan->children.push_back( planIndex[static_cast<DAGNode*>(node->child[i].get())] );
+        }
+        plan->childBegin.push_back( unsigned(plan->children.size()) );
+
+        _traversalPlan = plan;
+    }
+    return _traversalPlan;
+}
+
+void DAGNode::compileTraversalPlan( TraversalPlan& plan, std::unordered_map<const DAGNode*, unsigned int>& planIndex, DAGNode* visitorRoot )
+{
+    if( planIndex.find(this) != planIndex.end() )
+        return; // already in the plan
+
+    const LinkParents::Container &parents = l_parents.getValue();
+    const auto inSubGraph = [visitorRoot]( DAGNode* parent )
+    {
+        return parent == visitorRoot || visitorRoot->_descendancy.find(parent) != visitorRoot->_descendancy.end();
+    };
+
+    if( visitorRoot != this )
+    {
+        // same rule as the DAG traversal: all parents must be in the plan before
+        for ( unsigned int i = 0; i < parents.size() ; i++ )
+        {
+            if ( inSubGraph(parents[i]) && planIndex.find(parents[i]) == planIndex.end() )
+                return; // the other parent should come later
+        }
+    }
+
+    planIndex[this] = unsigned(plan.nodes.size());
+    plan.nodes.push_back( this );
+    plan.parentBegin.push_back( unsigned(plan.parents.size()) );
+    if( visitorRoot != this )
+    {
+        for ( unsigned int i = 0; i < parents.size() ; i++ )
+        {
+            if ( inSubGraph(parents[i]) )
+                plan.parents.push_back( planIndex[parents[i]] );
+        }
+    }
+
+    for( unsigned int i = 0; i<child.size(); ++i )
+        static_cast<DAGNode*>(child[i].get())->compileTraversalPlan( plan, planIndex, visitorRoot );
+}
+
+void DAGNode::executeVisitorCompiled( simulation::Visitor* action )
+{
+    // hold the plan, as the graph could be modified during the traversal
+    const std::shared_ptr<const TraversalPlan> plan = getTraversalPlan();
+    const std::size_t nbNodes = plan->nodes.size();
+
+    type::vector<VisitedStatus> status( nbNodes, NOT_VISITED );
+    type::vector<DAGNode*> executedNodes;
+    executedNodes.reserve( nbNodes );
+
+    // same rules as executeVisitorTopDown, returns true if the children must be reached
+    const auto visitTopDown = [&]( unsigned int i )
+    {
+        if( status[i] != NOT_VISITED )
+            return false; // already visited
+
+        DAGNode* node = plan->nodes[i];
+        if( !node->isActive() || ( node->isSleeping() && !action->canAccessSleepingNode ) )
+        {
+            // not executed, and its children are not reached through it
+            status[i] = PRUNED;
+            return false;
+        }
+
+        // all parents must have been visited before, a child node is 'pruned' only if all its parents are 'pruned'
+        const unsigned int parentBegin = plan->parentBegin[i];
+        const unsigned int parentEnd = plan->parentBegin[i+1];
+        bool allParentsPruned = parentBegin != parentEnd;
+        for( unsigned int p = parentBegin ; p < parentEnd ; ++p )
+        {
+            if( status[plan->parents[p]] == NOT_VISITED )
+                return false; // the other parent should come later
+            allParentsPruned = allParentsPruned && status[plan->parents[p]] == PRUNED;
+        }
+
+        if( allParentsPruned )
+        {
+            status[i] = PRUNED;
+        }
+        else
+        {
+            status[i] = action->processNodeTopDown( node ) == simulation::Visitor::RESULT_PRUNE ? PRUNED : VISITED;
+            executedNodes.push_back( node );
+        }
+        return true;
+    };
+
+    // depth-first traversal of the plan, with an explicit stack of (node, next child)
+    type::vector< std::pair<unsigned int, unsigned int> > stack;
+    stack.reserve( nbNodes );
+    if( nbNodes && visitTopDown( 0 ) )
+        stack.emplace_back( 0u, plan->childBegin[0] );
+
+    while( !stack.empty() )
+    {
+        auto& top = stack.back();
+        if( top.second == plan->childBegin[top.first+1] )
+        {
+            stack.pop_back();
+            continue;
+        }
+        const unsigned int c = plan->children[top.second++];
+        if( visitTopDown( c ) )
+            stack.emplace_back( c, plan->childBegin[c] );
+    }
+
+    for( auto it = executedNodes.rbegin(), itend = executedNodes.rend() ; it != itend ; ++it )
+        action->processNodeBottomUp( *it );
+}
+
 void DAGNode::executeVisitorTopDown(simulation::Visitor* action, NodeList& executedNodes, StatusMap& statusMap, DAGNode* visitorRoot )
 {
     if ( statusMap[this] != NOT_VISITED )
@@ -717,6 +862,7 @@ void DAGNode::executeVisitorBottomUp( simulation::Visitor* action, NodeList& exe
 void DAGNode::setDirtyDescendancy()
 {
     _descendancy.clear();
+    _traversalPlan.reset();
     const LinkParents::Container &parents = l_parents.getValue();
     for ( unsigned int i = 0; i < parents.size() ; i++ )
     {
@@ -25,6 +25,9 @@
 #include <sofa/core/objectmodel/Link.h>
 #include <sofa/simulation/Visitor.h>
 
+#include <memory>
+#include <unordered_map>
+
 namespace sofa::simulation::graph
 {
 
@@ -46,6 +49,9 @@ public:
     typedef MultiLink<DAGNode,DAGNode,BaseLink::FLAG_STOREPATH|BaseLink::FLAG_DOUBLELINK> LinkParents;
     typedef LinkParents::const_iterator ParentIterator;
 
+    /// If true, the mechanical visitors executed from this node follow a flat traversal plan, compiled at the
+    /// first traversal and recompiled after each modification of the graph below this node
+    Data<bool> d_compiledTraversal;
 
 protected:
     DAGNode( const std::string& name="", DAGNode* parent=nullptr  );
@@ -197,6 +203,32 @@ protected:
     /// the ordered list of Node to traverse from this Node
     NodeList _precomputedTraversalOrder;
 
+    /// Flat traversal plan of the sub-graph: the nodes in DAG traversal order and, for each of them,
+    /// the indices in the plan of its parents within the sub-graph and of its children (compressed row storage).
+    /// The parents encode the rule of the DAG traversal: a node is visited only when all its parents have been
+    /// visited, and it is reached through its children lists, so that a node below an inactive parent is
+    /// visited exactly as in the dynamic traversal
+    struct TraversalPlan
+    {
+        type::vector<DAGNode*> nodes;
+        type::vector<unsigned int> parentBegin;
+        type::vector<unsigned int> parents;
+        type::vector<unsigned int> childBegin;
+        type::vector<unsigned int> children;
+    };
+
+    /// the compiled traversal plan from this Node (reset when the graph below this Node is modified)
+    std::shared_ptr<const TraversalPlan> _traversalPlan;
+
+    /// return the compiled traversal plan from this Node, compiling it if needed
+    std::shared_ptr<const TraversalPlan> getTraversalPlan();
+
+    /// @internal append this node and its descendancy to the traversal plan, in the DAG traversal order
+    void compileTraversalPlan( TraversalPlan& plan, std::unordered_map<const DAGNode*, unsigned int>& planIndex, DAGNode* visitorRoot );
+
+    /// @internal performing the top-down then bottom-up traversals following the compiled traversal plan
+    void executeVisitorCompiled( simulation::Visitor* action );
+
     /// @internal performing only the top-down traversal on a DAG
     /// @executedNodes will be fill with the DAGNodes where the top-down action is processed
     /// @statusMap the visitor's flag map
@@ -71,6 +71,8 @@ namespace simulation
 		: Inherit()
         , schedulerName(initData(&schedulerName, "scheduler", "name of the scheduler to use"))
 		, threadNumber(initData(&threadNumber, (unsigned int)0, "threadNumber", "number of thread") )
+        , d_pinThreads(initData(&d_pinThreads, false, "pinThreads", "pin each thread to a single core"))
+        , d_groupByNumaNode(initData(&d_groupByNumaNode, false, "groupByNumaNode", "group the threads by NUMA node, and steal the tasks of the threads of the same node first"))
 		, mNbThread(0)
 		, gnode(_gnode)
         , _taskScheduler(nullptr)
@@ -99,11 +101,19 @@ namespace simulation
 
         if (TaskScheduler::getCurrentName() != schedulerName.getValue())
         {
-            _taskScheduler = TaskScheduler::create(schedulerName.getValue().c_str());
+            _taskScheduler = TaskScheduler::create(schedulerName.getValue().c_str(), getThreadPlacement());
         }        
-        _taskScheduler->init( mNbThread );
+        _taskScheduler->init( mNbThread, getThreadPlacement() );
 	}
 
+    ThreadPlacement AnimationLoopParallelScheduler::getThreadPlacement() const
+    {
+        ThreadPlacement placement;
+        placement.pinToCores = d_pinThreads.getValue();
+        placement.groupByNumaNode = d_groupByNumaNode.getValue();
+        return placement;
+    }
+
 
 
 	void AnimationLoopParallelScheduler::bwdInit()
@@ -114,10 +124,10 @@ namespace simulation
 
 	void AnimationLoopParallelScheduler::reinit()
 	{
-        if ( threadNumber.getValue() != _taskScheduler->getThreadCount() )
+        if ( threadNumber.getValue() != _taskScheduler->getThreadCount() || getThreadPlacement() != _taskScheduler->getThreadPlacement() )
         {
             mNbThread = threadNumber.getValue();
-            _taskScheduler->init(mNbThread);
+            _taskScheduler->init(mNbThread, getThreadPlacement());
             initThreadLocalData();
         }
 	}
@@ -27,6 +27,7 @@
 
 #include <sofa/simulation/Node.h>
 #include <sofa/simulation/Visitor.h>
+#include <sofa/simulation/CpuTopology.h>
 #include <sofa/helper/AdvancedTimer.h>
 
 using namespace sofa::core::objectmodel;
@@ -55,6 +56,10 @@ public:
 
 	Data<unsigned int> threadNumber; ///< number of thread
 
+    Data<bool> d_pinThreads; ///< pin each thread to a single core
+
+    Data<bool> d_groupByNumaNode; ///< group the threads by NUMA node, and steal the tasks of the same node first
+
 
 protected:
 	AnimationLoopParallelScheduler(simulation::Node* gnode = NULL);
@@ -88,6 +93,9 @@ public:
 
 private :
 
+    /// Placement of the threads set in the scene
+    ThreadPlacement getThreadPlacement() const;
+
 	unsigned int mNbThread;
 
 	simulation::Node* gnode;
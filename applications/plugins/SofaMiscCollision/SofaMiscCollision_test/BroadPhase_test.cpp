@@ -26,6 +26,7 @@
 #include <SofaGeneralMeshCollision/DirectSAPNarrowPhase.h>
 
 #include <SofaGeneralMeshCollision/IncrSAP.h>
+#include <sofa/simulation/TaskScheduler.h>
 
 typedef BroadPhaseTest<sofa::component::collision::BruteForceBroadPhase, sofa::component::collision::BVHNarrowPhase> Brut;
 TEST_F(Brut, rand_sparse_test ) { ASSERT_TRUE( randSparse()); }
@@ -34,7 +35,25 @@ TEST_F(Brut, rand_dense_test ) { ASSERT_TRUE( randDense()); }
 typedef BroadPhaseTest<sofa::component::collision::IncrSAP> IncrSAPTest;
 TEST_F(IncrSAPTest, rand_sparse_test ) { ASSERT_TRUE( randSparse()); }
 TEST_F(IncrSAPTest, rand_dense_test ) { ASSERT_TRUE( randDense()); }
+TEST_F(IncrSAPTest, rand_steps_test ) { ASSERT_TRUE( randSteps()); }
 
 typedef BroadPhaseTest<sofa::component::collision::BruteForceBroadPhase, sofa::component::collision::DirectSAPNarrowPhase> DirectSAPTest;
 TEST_F(DirectSAPTest, rand_sparse_test ) { ASSERT_TRUE( randSparse()); }
 TEST_F(DirectSAPTest, rand_dense_test ) { ASSERT_TRUE( randDense()); }
+
+/// DirectSAPNarrowPhase sweeping batches of end points concurrently
+class ParallelDirectSAPNarrowPhase : public sofa::component::collision::DirectSAPNarrowPhase
+{
+public:
+    SOFA_CLASS(ParallelDirectSAPNarrowPhase, sofa::component::collision::DirectSAPNarrowPhase);
+
+    ParallelDirectSAPNarrowPhase()
+    {
+        findData("parallelSweep")->read("true");
+        sofa::simulation::TaskScheduler::getInstance()->init(4);
+    }
+};
+
+typedef BroadPhaseTest<sofa::component::collision::BruteForceBroadPhase, ParallelDirectSAPNarrowPhase> ParallelDirectSAPTest;
+TEST_F(ParallelDirectSAPTest, rand_sparse_test ) { ASSERT_TRUE( randSparse()); }
+TEST_F(ParallelDirectSAPTest, rand_dense_test ) { ASSERT_TRUE( randDense()); }
@@ -99,9 +99,10 @@ struct BroadPhaseTest: public ::testing::Test
 
     static bool randSparse();
     static bool randDense();
+    static bool randSteps();
     static bool randTest3();
 
-    static bool randTest(int seed,int nb1,int nb2,const Vector3 & min,const Vector3 & max);
+    static bool randTest(int seed,int nb1,int nb2,const Vector3 & min,const Vector3 & max,int nbSteps = 2);
 };
 
 struct InitIntersection{
@@ -461,7 +462,7 @@ Vector3 randVect(const Vector3 & min, const Vector3& max) {
 
 
 template <class BroadPhase, class NarrowPhase>
-bool BroadPhaseTest<BroadPhase, NarrowPhase>::randTest(int seed,int nb1,int nb2,const Vector3 & min,const Vector3 & max)
+bool BroadPhaseTest<BroadPhase, NarrowPhase>::randTest(int seed,int nb1,int nb2,const Vector3 & min,const Vector3 & max,int nbSteps)
 {
     sofa::helper::srand(seed);
 
@@ -494,7 +495,7 @@ bool BroadPhaseTest<BroadPhase, NarrowPhase>::randTest(int seed,int nb1,int nb2,
         narrowPhase = New<NarrowPhase>();
     }
 
-    for(int i = 0 ; i < 2 ; ++i)
+    for(int i = 0 ; i < nbSteps ; ++i)
     {
         if(!GENTest(obbm1.get(),obbm2.get(), *broadPhase, *narrowPhase))
         {
@@ -523,6 +524,18 @@ bool BroadPhaseTest<BroadPhase, NarrowPhase>::randDense(){
     return true;
 }
 
+template <class BroadPhase, class NarrowPhase>
+bool BroadPhaseTest<BroadPhase, NarrowPhase>::randSteps(){
+    for(int i = 0 ; i < 20 ; ++i){
+        if(!randTest(i,40,20,Vector3(-5,-5,-5),Vector3(5,5,5),10)){
+            ADD_FAILURE() <<"FAIL seed number "<<i<< std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
 template <class BroadPhase, class NarrowPhase>
 bool BroadPhaseTest<BroadPhase, NarrowPhase>::randSparse(){
     for(int i = 0 ; i < 1000 ; ++i){
@@ -218,7 +218,7 @@ int main(int argc, char** argv)
         boost::program_options::value<std::string>(&computationTimeOutputType)
         ->default_value("stdout"),
         "computationTimeOutputType,o",
-        "Output type for the computation time statistics: either stdout, json or ljson"
+        "Output type for the computation time statistics: either stdout, json, ljson or trace (Chrome Trace Event file)"
     );
     argParser->addArgument(
         boost::program_options::value<std::string>(&gui)->default_value(""),
@@ -25,6 +25,13 @@ using sofa::testing::BaseSimulationTest;
 #include <SofaSimulationGraph/SimpleApi.h>
 using namespace sofa::simpleapi;
 
+#include <SofaConstraint/GenericConstraintSolver.h>
+using sofa::component::constraintset::GenericConstraintSolver;
+using sofa::component::constraintset::GenericConstraintProblem;
+
+#include <sofa/core/behavior/ConstraintResolution.h>
+#include <sofa/simulation/TaskScheduler.h>
+
 namespace
 {
 
@@ -69,6 +76,140 @@ TEST_F(GenericConstraintSolver_test, checkConstraintForce)
 }
 
 
+/// Non-penetration: the force is positive
+class UnilateralResolution : public sofa::core::behavior::ConstraintResolution
+{
+public:
+    UnilateralResolution() : ConstraintResolution(1) {}
+
+    void resolution(int line, double** w, double* d, double* force, double*) override
+    {
+        force[line] -= d[line] / w[line][line];
+        if(force[line] < 0)
+            force[line] = 0;
+    }
+};
+
+/// Two bilateral lines solved together
+class BilateralResolution : public sofa::core::behavior::ConstraintResolution
+{
+public:
+    BilateralResolution() : ConstraintResolution(2) {}
+
+    void resolution(int line, double** w, double* d, double* force, double*) override
+    {
+        const double a = w[line][line], b = w[line][line+1], c = w[line+1][line], e = w[line+1][line+1];
+        const double det = a * e - b * c;
+        force[line] -= ( e * d[line] - b * d[line+1]) / det;
+        force[line+1] -= (-c * d[line] + a * d[line+1]) / det;
+    }
+};
+
+/// Chain of constraint blocks, each one coupled to the next one
+void buildChainProblem(GenericConstraintProblem& problem, int nbBlocks)
+{
+    int dimension = 0;
+    for(int b=0; b<nbBlocks; b++)
+        dimension += (b % 3 == 2) ? 2 : 1;
+
+    problem.clear(dimension);
+    problem.tolerance = 1e-12;
+    problem.maxIterations = 10000;
+    problem.scaleTolerance = false;
+
+    double** w = problem.getW();
+    double* dfree = problem.getDfree();
+    for(int j=0, b=0; j<dimension; b++)
+    {
+        const int nb = (b % 3 == 2) ? 2 : 1;
+        if(nb == 2)
+            problem.constraintsResolutions[j] = new BilateralResolution();
+        else
+            problem.constraintsResolutions[j] = new UnilateralResolution();
+
+        for(int l=0; l<nb; l++)
+        {
+            w[j+l][j+l] = 4.0;
+            dfree[j+l] = (j+l) % 4 == 0 ? 0.5 : -1.0;
+            problem.getF()[j+l] = 0.0;
+        }
+        if(nb == 2)
+            w[j][j+1] = w[j+1][j] = 0.5;
+        if(j+nb < dimension)
+            w[j][j+nb] = w[j+nb][j] = 1.0;
+
+        j += nb;
+    }
+}
+
+TEST(GenericConstraintProblem_test, blockColors)
+{
+    GenericConstraintProblem problem;
+    buildChainProblem(problem, 30);
+    problem.computeBlockColors();
+
+    ASSERT_EQ(problem.blocks.size(), 30u);
+    EXPECT_EQ(problem.blockColors.size(), 2u);
+
+    // each block has exactly one color, and the blocks of a color are not coupled
+    std::vector<int> nbColors(problem.blocks.size(), 0);
+    double** w = problem.getW();
+    for(const auto& color : problem.blockColors)
+    {
+        for(const unsigned int b0 : color)
+        {
+            ++nbColors[b0];
+            for(const unsigned int b1 : color)
+            {
+                if(b0 == b1)
+                    continue;
+                const int j0 = problem.blocks[b0], j1 = problem.blocks[b1];
+                EXPECT_EQ(w[j0][j1], 0.0);
+            }
+        }
+    }
+    for(const int n : nbColors)
+        EXPECT_EQ(n, 1);
+}
+
+TEST(GenericConstraintProblem_test, parallelGaussSeidel)
+{
+    auto solver = sofa::core::objectmodel::New<GenericConstraintSolver>();
+
+    GenericConstraintProblem sequential;
+    buildChainProblem(sequential, 300);
+    sequential.gaussSeidel(0, solver.get());
+
+    sofa::simulation::TaskScheduler* scheduler = sofa::simulation::TaskScheduler::getInstance();
+
+    GenericConstraintProblem parallel;
+    buildChainProblem(parallel, 300);
+    parallel.parallelGaussSeidel = true;
+    scheduler->init(4);
+    parallel.gaussSeidel(0, solver.get());
+
+    GenericConstraintProblem singleThread;
+    buildChainProblem(singleThread, 300);
+    singleThread.parallelGaussSeidel = true;
+    scheduler->init(1);
+    singleThread.gaussSeidel(0, solver.get());
+    scheduler->stop();
+
+    EXPECT_LT(sequential.currentIterations, sequential.maxIterations);
+    EXPECT_LT(parallel.currentIterations, parallel.maxIterations);
+    EXPECT_LT(parallel.currentError, parallel.tolerance);
+
+    // same solution as the sequential relaxation
+    for(int i=0; i<parallel.getDimension(); i++)
+        EXPECT_NEAR(parallel.getF()[i], sequential.getF()[i], 1e-9);
+
+    // the colored relaxation does not depend on the number of threads
+    EXPECT_EQ(parallel.currentIterations, singleThread.currentIterations);
+    EXPECT_EQ(parallel.currentError, singleThread.currentError);
+    for(int i=0; i<parallel.getDimension(); i++)
+        EXPECT_EQ(parallel.getF()[i], singleThread.getF()[i]);
+}
+
 } /// namespace sofa
 
 
@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <sofa/core/behavior/MultiVec.h>
 #include <sofa/simulation/DefaultTaskScheduler.h>
+#include <sofa/simulation/ParallelFor.h>
 
 #include <thread>
 #include <functional>
@@ -68,6 +69,45 @@ void clearMultiVecId(sofa::core::objectmodel::BaseContext* ctx, const sofa::core
     ctx->executeVisitor(&clearVisitor);
 }
 
+/// Error of the constraint block starting at line j: displacement due to the new resolution (i.e. due to the new force)
+double computeConstraintError(double** w, const double* force, const double* previousForce, int j, int nb,
+                              double tol, double constraintTolerance, bool& constraintsAreVerified)
+{
+    double contraintError = 0.0;
+    if(nb > 1)
+    {
+        for(int l=0; l<nb; l++)
+        {
+            double lineError = 0.0;
+            for (int m=0; m<nb; m++)
+            {
+                double dofError = w[j+l][j+m] * (force[j+m] - previousForce[m]);
+                lineError += dofError * dofError;
+            }
+            lineError = sqrt(lineError);
+            if(lineError > tol)
+                constraintsAreVerified = false;
+
+            contraintError += lineError;
+        }
+    }
+    else
+    {
+        contraintError = fabs(w[j][j] * (force[j] - previousForce[0]));
+        if(contraintError > tol)
+            constraintsAreVerified = false;
+    }
+
+    if(constraintTolerance)
+    {
+        if(contraintError > constraintTolerance)
+            constraintsAreVerified = false;
+        contraintError *= tol / constraintTolerance;
+    }
+
+    return contraintError;
+}
+
 }
 
 GenericConstraintSolver::GenericConstraintSolver()
@@ -80,6 +120,7 @@ GenericConstraintSolver::GenericConstraintSolver()
     , schemeCorrection( initData(&schemeCorrection, false, "schemeCorrection", "Apply new scheme where compliance is progressively corrected"))
     , unbuilt(initData(&unbuilt, false, "unbuilt", "Compliance is not fully built"))
     , d_multithreading(initData(&d_multithreading, false, "multithreading", "Build compliances concurrently"))
+    , d_parallelGaussSeidel(initData(&d_parallelGaussSeidel, false, "parallelGaussSeidel", "Relax concurrently the constraint blocks which are not coupled in the compliance (built compliance only)"))
     , computeGraphs(initData(&computeGraphs, false, "computeGraphs", "Compute graphs of errors and forces during resolution"))
     , graphErrors( initData(&graphErrors,"graphErrors","Sum of the constraints' errors at each iteration"))
     , graphConstraints( initData(&graphConstraints,"graphConstraints","Graph of each constraint's error at the end of the resolution"))
@@ -126,7 +167,7 @@ GenericConstraintSolver::GenericConstraintSolver()
 
 GenericConstraintSolver::~GenericConstraintSolver()
 {
-    if(d_multithreading.getValue())
+    if(d_multithreading.getValue() || d_parallelGaussSeidel.getValue())
         simulation::TaskScheduler::getInstance()->stop();
 }
 
@@ -159,7 +200,7 @@ void GenericConstraintSolver::init()
         m_dxId = dx.id();
     }
 
-    if(d_multithreading.getValue())
+    if(d_multithreading.getValue() || d_parallelGaussSeidel.getValue())
         simulation::TaskScheduler::getInstance()->init();
 }
 
@@ -427,6 +468,7 @@ bool GenericConstraintSolver::solveSystem(const core::ConstraintParams * /*cPara
     current_cp->allVerified = allVerified.getValue();
     current_cp->sor = sor.getValue();
     current_cp->unbuilt = unbuilt.getValue();
+    current_cp->parallelGaussSeidel = d_parallelGaussSeidel.getValue();
 
     if (unbuilt.getValue())
     {
@@ -657,6 +699,65 @@ int GenericConstraintProblem::getNumConstraintGroups()
     return n;
 }
 
+void GenericConstraintProblem::computeBlockColors()
+{
+    double **w = getW();
+
+    blocks.clear();
+    std::vector<unsigned int> lineBlock(dimension);
+    for(int j=0; j<dimension; )
+    {
+        const int nb = constraintsResolutions[j]->getNbLines();
+        std::fill_n(lineBlock.begin() + j, nb, static_cast<unsigned int>(blocks.size()));
+        blocks.push_back(j);
+        j += nb;
+    }
+
+    const std::size_t nbBlocks = blocks.size();
+    blockCouplings.resize(nbBlocks);
+    blockColors.clear();
+
+    // greedy coloring in the order of the constraints: each block takes the first color not used by
+    // the blocks it is coupled with (W is symmetric)
+    std::vector<unsigned int> blockColor(nbBlocks);
+    std::vector<std::size_t> colorMark;
+    for(std::size_t b=0; b<nbBlocks; b++)
+    {
+        const int j = blocks[b];
+        const int nb = (b+1 < nbBlocks ? blocks[b+1] : dimension) - j;
+
+        auto& couplings = blockCouplings[b];
+        couplings.clear();
+        for(int k=0; k<dimension; k++)
+        {
+            for(int l=0; l<nb; l++)
+            {
+                if(w[j+l][k] != 0.0)
+                {
+                    couplings.push_back(k);
+
+                    const unsigned int other = lineBlock[k];
+                    if(other < b)
+                        colorMark[blockColor[other]] = b + 1;
+                    break;
+                }
+            }
+        }
+
+        unsigned int color = 0;
+        while(color < colorMark.size() && colorMark[color] == b + 1)
+            ++color;
+        if(color == colorMark.size())
+        {
+            colorMark.push_back(0);
+            blockColors.emplace_back();
+        }
+
+        blockColor[b] = color;
+        blockColors[color].push_back(static_cast<unsigned int>(b));
+    }
+}
+
 void GenericConstraintProblem::solveTimed(double tol, int maxIt, double timeout)
 {
     double tempTol = tolerance;
@@ -742,6 +843,46 @@ void GenericConstraintProblem::gaussSeidel(double timeout, GenericConstraintSolv
         tabErrors.resize(dimension);
     }
 
+    // the constraint blocks of a same color are not coupled: they can be relaxed concurrently
+    const bool colored = parallelGaussSeidel && solver;
+    simulation::TaskScheduler* taskScheduler = nullptr;
+    std::size_t grainSize = 1;
+    sofa::type::vector<double> blockErrors;
+    std::vector<char> blockVerified;
+    if(colored)
+    {
+        computeBlockColors();
+        blockErrors.resize(blocks.size());
+        blockVerified.resize(blocks.size());
+
+        taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+            taskScheduler->init(0);
+        // a few blocks per task, to amortize the scheduling on small colors
+        grainSize = std::max(std::size_t(8), blocks.size() / (8 * std::max(1u, taskScheduler->getThreadCount())));
+    }
+
+    const auto relaxBlock = [&](const std::size_t b)
+    {
+        const int jb = blocks[b];
+        const int nbLines = constraintsResolutions[jb]->getNbLines();
+
+        std::vector<double> previousForce(&force[jb], &force[jb+nbLines]);
+        std::copy_n(&dfree[jb], nbLines, &d[jb]);
+
+        // only the coupled columns of W contribute: the forces of the other blocks of the color are not read
+        for(const int col : blockCouplings[b])
+            for(int line=0; line<nbLines; line++)
+                d[jb+line] += w[jb+line][col] * force[col];
+
+        constraintsResolutions[jb]->resolution(jb, w, d, force, dfree);
+
+        bool verified = true;
+        blockErrors[b] = computeConstraintError(w, force, previousForce.data(), jb, nbLines, tol,
+                                                constraintsResolutions[jb]->getTolerance(), verified);
+        blockVerified[b] = verified;
+    };
+
     for(i=0; i<maxIterations; i++)
     {
         bool constraintsAreVerified = true;
@@ -751,63 +892,54 @@ void GenericConstraintProblem::gaussSeidel(double timeout, GenericConstraintSolv
         }
 
         error=0.0;
-        for(j=0; j<dimension; ) // increment of j realized at the end of the loop
+        if(colored)
         {
-            //1. nbLines provide the dimension of the constraint
-            nb = constraintsResolutions[j]->getNbLines();
-
-            //2. for each line we compute the actual value of d
-            //   (a)d is set to dfree
-            
-            std::vector<double> errF(&force[j], &force[j+nb]);
-            std::copy_n(&dfree[j], nb, &d[j]);
-
-            //   (b) contribution of forces are added to d     => TODO => optimization (no computation when force= 0 !!)
-            for(k=0; k<dimension; k++)
-                for(l=0; l<nb; l++)
-                    d[j+l] += w[j+l][k] * force[k];
-
-            //3. the specific resolution of the constraint(s) is called
-            constraintsResolutions[j]->resolution(j, w, d, force, dfree);
-
-            //4. the error is measured (displacement due to the new resolution (i.e. due to the new force))
-            double contraintError = 0.0;
-            if(nb > 1)
-            {
-                for(l=0; l<nb; l++)
-                {
-                    double lineError = 0.0;
-                    for (int m=0; m<nb; m++)
-                    {
-                        double dofError = w[j+l][j+m] * (force[j+m] - errF[m]);
-                        lineError += dofError * dofError;
-                    }
-                    lineError = sqrt(lineError);
-                    if(lineError > tol)
-                        constraintsAreVerified = false;
-
-                    contraintError += lineError;
-                }
-            }
-            else
+            for(const auto& color : blockColors)
             {
-                contraintError = fabs(w[j][j] * (force[j] - errF[0]));
-                if(contraintError > tol)
-                    constraintsAreVerified = false;
+                simulation::parallelFor(taskScheduler, std::size_t(0), color.size(), grainSize,
+                                        [&](const std::size_t c) { relaxBlock(color[c]); });
             }
 
-            if(constraintsResolutions[j]->getTolerance())
+            // the errors are summed in the order of the constraints, whatever the number of threads
+            for(std::size_t b=0; b<blocks.size(); b++)
             {
-                if(contraintError > constraintsResolutions[j]->getTolerance())
+                error += blockErrors[b];
+                if(!blockVerified[b])
                     constraintsAreVerified = false;
-                contraintError *= tol / constraintsResolutions[j]->getTolerance();
+                tabErrors[blocks[b]] = blockErrors[b];
             }
+        }
+        else
+        {
+            for(j=0; j<dimension; ) // increment of j realized at the end of the loop
+            {
+                //1. nbLines provide the dimension of the constraint
+                nb = constraintsResolutions[j]->getNbLines();
 
-            error += contraintError;
-            if(solver)
-                tabErrors[j] = contraintError;
+                //2. for each line we compute the actual value of d
+                //   (a)d is set to dfree
+            
+                std::vector<double> errF(&force[j], &force[j+nb]);
+                std::copy_n(&dfree[j], nb, &d[j]);
 
-            j += nb;
+                //   (b) contribution of forces are added to d     => TODO => optimization (no computation when force= 0 !!)
+                for(k=0; k<dimension; k++)
+                    for(l=0; l<nb; l++)
+                        d[j+l] += w[j+l][k] * force[k];
+
+                //3. the specific resolution of the constraint(s) is called
+                constraintsResolutions[j]->resolution(j, w, d, force, dfree);
+
+                //4. the error is measured (displacement due to the new resolution (i.e. due to the new force))
+                const double contraintError = computeConstraintError(w, force, errF.data(), j, nb, tol,
+                                                                     constraintsResolutions[j]->getTolerance(), constraintsAreVerified);
+
+                error += contraintError;
+                if(solver)
+                    tabErrors[j] = contraintError;
+
+                j += nb;
+            }
         }
 
         if(showGraphs)
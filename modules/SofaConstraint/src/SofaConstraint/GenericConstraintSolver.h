@@ -57,17 +57,27 @@ public:
 
     std::vector< ConstraintCorrections > cclist_elems;
 
+    // For parallel version :
+    bool parallelGaussSeidel;
+    std::vector<int> blocks; ///< first line of each constraint block
+    std::vector< std::vector<int> > blockCouplings; ///< for each block, the columns of W coupled to its lines
+    std::vector< std::vector<unsigned int> > blockColors; ///< blocks of each color: the blocks of a color are not coupled
+
 
     GenericConstraintProblem() : scaleTolerance(true), allVerified(false), sor(1.0)
       , sceneTime(0.0), currentError(0.0), currentIterations(0)
-      , change_sequence(false) {}
+      , change_sequence(false), parallelGaussSeidel(false) {}
     ~GenericConstraintProblem() override { freeConstraintResolutions(); }
 
     void clear(int nbConstraints) override;
     void freeConstraintResolutions();
     void solveTimed(double tol, int maxIt, double timeout) override;
 
+    /// When parallelGaussSeidel is set and the solver is given, the constraint blocks are colored and
+    /// the blocks of each color are relaxed concurrently on the task scheduler
     void gaussSeidel(double timeout=0, GenericConstraintSolver* solver = nullptr);
+    /// Group the constraint blocks in colors such that two blocks coupled in W have different colors
+    void computeBlockColors();
     void unbuiltGaussSeidel(double timeout=0, GenericConstraintSolver* solver = nullptr);
 
     int getNumConstraints();
@@ -109,6 +119,7 @@ public:
     Data<bool> schemeCorrection; ///< Apply new scheme where compliance is progressively corrected
     Data<bool> unbuilt; ///< Compliance is not fully built
     Data<bool> d_multithreading; ///< Compliances built concurrently
+    Data<bool> d_parallelGaussSeidel; ///< Constraint blocks relaxed concurrently
     Data<bool> computeGraphs; ///< Compute graphs of errors and forces during resolution
     Data<std::map < std::string, sofa::type::vector<double> > > graphErrors; ///< Sum of the constraints' errors at each iteration
     Data<std::map < std::string, sofa::type::vector<double> > > graphConstraints; ///< Graph of each constraint's error at the end of the resolution
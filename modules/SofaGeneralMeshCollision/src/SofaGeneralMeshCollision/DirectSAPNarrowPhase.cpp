@@ -24,7 +24,6 @@
 #include <sofa/helper/AdvancedTimer.h>
 #include <sofa/core/visual/VisualParams.h>
 #include <sofa/core/ObjectFactory.h>
-#include <unordered_map>
 
 namespace sofa::component::collision
 {
@@ -33,6 +32,7 @@ DirectSAPNarrowPhase::DirectSAPNarrowPhase()
         : d_draw(initData(&d_draw, false, "draw", "enable/disable display of results"))
         , d_showOnlyInvestigatedBoxes(initData(&d_showOnlyInvestigatedBoxes, true, "showOnlyInvestigatedBoxes", "Show only boxes which will be sent to narrow phase"))
         , d_nbPairs(initData(&d_nbPairs, 0, "nbPairs", "number of pairs of elements sent to narrow phase"))
+        , d_parallelSweep(initData(&d_parallelSweep, false, "parallelSweep", "Sweep concurrently batches of end points, using the task scheduler. The pairs sent to narrow phase are the same as in a sequential sweep"))
         , m_currentAxis(0)
         , m_alarmDist(0)
         , m_alarmDist_d2(0)
@@ -41,12 +41,27 @@ DirectSAPNarrowPhase::DirectSAPNarrowPhase()
     d_nbPairs.setReadOnly(true);
 }
 
+void DirectSAPNarrowPhase::init()
+{
+    NarrowPhaseDetection::init();
+
+    if (d_parallelSweep.getValue())
+    {
+        auto* taskScheduler = simulation::TaskScheduler::getInstance();
+        if (taskScheduler->getThreadCount() < 1)
+        {
+            taskScheduler->init(0);
+        }
+    }
+}
+
 void DirectSAPNarrowPhase::reset()
 {
-    m_endPointContainer.clear();
     m_boxes.clear();
     m_isBoxInvestigated.clear();
-    m_sortedEndPoints.clear();
+    m_intervalMin.clear();
+    m_intervalMax.clear();
+    m_sweepAndPrune = SweepAndPrune();
     m_addedCollisionModels.clear();
     m_newCollisionModels.clear();
     m_broadPhaseCollisionModels.clear();
@@ -68,7 +83,6 @@ void DirectSAPNarrowPhase::createBoxesFromCollisionModels()
     }
 
     m_boxes.reserve(m_boxes.size() + totalNbElements);
-    int cur_boxID = static_cast<int>(m_boxes.size());
 
     for (auto* cm : cube_models)
     {
@@ -76,21 +90,7 @@ void DirectSAPNarrowPhase::createBoxesFromCollisionModels()
         {
             for (Size j = 0; j < cm->getSize(); ++j)
             {
-                m_endPointContainer.emplace_back();
-                EndPoint* min = &m_endPointContainer.back();
-
-                m_endPointContainer.emplace_back();
-                EndPoint* max = &m_endPointContainer.back();
-
-                min->setBoxID(cur_boxID);
-                max->setBoxID(cur_boxID);
-                max->setMax();
-
-                m_sortedEndPoints.push_back(min);
-                m_sortedEndPoints.push_back(max);
-
-                m_boxes.emplace_back(Cube(cm, j), min, max);
-                ++cur_boxID;
+                m_boxes.emplace_back(Cube(cm, j));
             }
         }
     }
@@ -192,9 +192,12 @@ void DirectSAPNarrowPhase::updateBoxes()
 {
     sofa::helper::ScopedAdvancedTimer scopeTimer("Direct SAP update boxes");
     m_currentAxis = greatestVarianceAxis();
-    for (auto& dsapBox : m_boxes)
+    m_intervalMin.resize(m_boxes.size());
+    m_intervalMax.resize(m_boxes.size());
+    for (std::size_t i = 0; i < m_boxes.size(); ++i)
     {
-        dsapBox.update(m_currentAxis, m_alarmDist_d2);
+        m_intervalMin[i] = m_boxes[i].cube.minVect()[m_currentAxis] - m_alarmDist_d2;
+        m_intervalMax[i] = m_boxes[i].cube.maxVect()[m_currentAxis] + m_alarmDist_d2;
     }
 
     //used only for drawing
@@ -242,7 +245,7 @@ void DirectSAPNarrowPhase::cacheData()
 void DirectSAPNarrowPhase::sortEndPoints()
 {
     sofa::helper::ScopedAdvancedTimer scopeTimer("Direct SAP sort");
-    std::sort(m_sortedEndPoints.begin(), m_sortedEndPoints.end(), CompPEndPoint());
+    m_sweepAndPrune.setIntervals(m_intervalMin, m_intervalMax, m_currentAxis);
 }
 
 void DirectSAPNarrowPhase::narrowCollisionDetectionFromSortedEndPoints()
@@ -250,88 +253,54 @@ void DirectSAPNarrowPhase::narrowCollisionDetectionFromSortedEndPoints()
     sofa::helper::ScopedAdvancedTimer scopeTimer("Direct SAP intersection");
     int nbInvestigatedPairs{ 0 };
 
-    std::list<int> activeBoxes;//active boxes are the one that we encoutered only their min (end point), so if there are two boxes b0 and b1,
-    //if we encounter b1_min as b0_min < b1_min, on the current axis, the two boxes intersect :  b0_min--------------------b0_max
-    //                                                                                                      b1_min---------------------b1_max
-    //once we encouter b0_max, b0 will not intersect with nothing (trivial), so we delete it from active_boxes.
-    //so the rule is : -every time we encounter a box min end point, we check if it is overlapping with other active_boxes and add the owner (a box) of this end point to
-    //                  the active boxes.
-    //                 -every time we encounter a max end point of a box, we are sure that we encountered min end point of a box because _end_points is sorted,
-    //                  so, we delete the owner box, of this max end point from the active boxes
-
-    // Iterators to activeBoxes are stored in a map for a fast access from a box id
-    std::unordered_map<int, decltype(activeBoxes)::const_iterator> activeBoxesIt;
-
-    for (auto* endPoint : m_sortedEndPoints)
+    // The sweep goes through the sorted end points, and keeps the boxes for which it found only the min end point
+    // (the active boxes). When it finds the min end point of a box, this box overlaps all the active boxes on the
+    // current axis: the pairs which are not filtered out are sent to the narrow phase.
+    // When it finds the max end point of a box, this box is removed from the active boxes.
     {
-        assert(endPoint != nullptr);
+        sofa::helper::ScopedAdvancedTimer sweepTimer("Direct SAP sweep");
+        simulation::TaskScheduler* taskScheduler = d_parallelSweep.getValue() ? simulation::TaskScheduler::getInstance() : nullptr;
+        const std::size_t nbBatches = taskScheduler ? 4 * std::size_t(taskScheduler->getThreadCount()) : 1;
+        m_sweepAndPrune.sweep(taskScheduler, nbBatches,
+            [this](SweepAndPrune::BoxID boxId) { return m_boxData[boxId].isInBroadPhase; },
+            [this](SweepAndPrune::BoxID boxId0, SweepAndPrune::BoxID boxId1)
+            {
+                return !isPairFiltered(m_boxData[boxId0], m_boxData[boxId1], m_boxes[boxId0], int(boxId1));
+            },
+            m_overlappingPairs);
+    }
 
-        const int boxId0 = endPoint->boxID();
+    for (const auto& [boxId0, boxId1] : m_overlappingPairs)
+    {
         const BoxData& data0 = m_boxData[boxId0];
-        if (!data0.isInBroadPhase)
-        {
-            continue;
-        }
+        const BoxData& data1 = m_boxData[boxId1];
+        core::CollisionModel *cm0 = data0.lastCollisionModel;
+        core::CollisionModel *cm1 = data1.lastCollisionModel;
 
-        if (endPoint->max())
-        {
-            const auto foundIt = activeBoxesIt.find(endPoint->boxID()); // complexity: Constant on average, worst case linear in the size of the container
-            if (foundIt != activeBoxesIt.end())
-            {
-                //erase the box with id endPoint->boxID() from the list of active boxes
-                //the iterator is found from a map
-                //with std::list, erasing an element does not invalidate the other iterators
-                activeBoxes.erase(foundIt->second);// complexity: Constant
-            }
-        }
-        else //we encounter a min possible intersection between it and active_boxes
+        bool swapModels = false;
+        core::collision::ElementIntersector* finalintersector = intersectionMethod->findIntersector(cm0, cm1, swapModels);//find the method for the finnest CollisionModels
+
+        if (!swapModels && cm0->getClass() == cm1->getClass() && cm0 > cm1)//we do that to have only pair (p1,p2) without having (p2,p1)
+            swapModels = true;
+
+        if (finalintersector != nullptr)
         {
-            const DSAPBox& box0 = m_boxes[boxId0];
-            core::CollisionModel *cm0 = data0.lastCollisionModel;
             auto collisionElement0 = data0.collisionElementIterator;
+            auto collisionElement1 = data1.collisionElementIterator;
 
-            for (int boxId1 : activeBoxes)
+            if (swapModels)
             {
-                const BoxData& data1 = m_boxData[boxId1];
-
-                if (!isPairFiltered(data0, data1, box0, boxId1))
-                {
-                    core::CollisionModel *cm1 = data1.lastCollisionModel;
-
-                    bool swapModels = false;
-                    core::collision::ElementIntersector* finalintersector = intersectionMethod->findIntersector(cm0, cm1, swapModels);//find the method for the finnest CollisionModels
-
-                    if (!swapModels && cm0->getClass() == cm1->getClass() && cm0 > cm1)//we do that to have only pair (p1,p2) without having (p2,p1)
-                        swapModels = true;
-
-                    if (finalintersector != nullptr)
-                    {
-                        auto collisionElement1 = data1.collisionElementIterator;
-
-                        auto swappableCm0 = cm0;
-                        auto swappableCollisionElement0 = collisionElement0;
-
-                        if (swapModels)
-                        {
-                            std::swap(swappableCm0, cm1);
-                            std::swap(swappableCollisionElement0, collisionElement1);
-                        }
-
-                        narrowCollisionDetectionForPair(finalintersector, swappableCm0, cm1, swappableCollisionElement0, collisionElement1);
+                std::swap(cm0, cm1);
+                std::swap(collisionElement0, collisionElement1);
+            }
 
-                        //used only for drawing
-                        m_isBoxInvestigated[boxId0] = true;
-                        m_isBoxInvestigated[boxId1] = true;
+            narrowCollisionDetectionForPair(finalintersector, cm0, cm1, collisionElement0, collisionElement1);
 
-                        ++nbInvestigatedPairs;
-                    }
-                }
+            //used only for drawing
+            m_isBoxInvestigated[boxId0] = true;
+            m_isBoxInvestigated[boxId1] = true;
 
-            }
-            activeBoxes.push_back(boxId0);// complexity: Constant
-            auto last = activeBoxes.end();
-            --last;//iterator the last element of the list
-            activeBoxesIt.insert({boxId0, last});// complexity: Average case: O(1), worst case O(size())
+            ++nbInvestigatedPairs;
         }
     }
 
@@ -24,9 +24,9 @@
 #include <SofaGeneralMeshCollision/config.h>
 
 #include <sofa/core/collision/NarrowPhaseDetection.h>
-#include <SofaMeshCollision/EndPoint.h>
 #include <unordered_set>
 #include <SofaGeneralMeshCollision/DSAPBox.h>
+#include <SofaGeneralMeshCollision/SweepAndPrune.h>
 
 namespace sofa::core::collision
 {
@@ -46,8 +46,6 @@ class SOFA_SOFAGENERALMESHCOLLISION_API DirectSAPNarrowPhase : public core::coll
 public:
     SOFA_CLASS(DirectSAPNarrowPhase, core::collision::NarrowPhaseDetection);
 
-    typedef sofa::type::vector<EndPoint *> EndPointList;
-
 private:
 
     /** \brief Returns the axis number which have the greatest variance for the primitive end points.
@@ -66,14 +64,13 @@ private:
     Data<bool> d_draw; ///< enable/disable display of results
     Data<bool> d_showOnlyInvestigatedBoxes;
     Data<int> d_nbPairs; ///< number of pairs of elements sent to narrow phase
-
-    /// Store a permanent list of end points
-    /// The container is a std::list to avoid invalidation of pointers after an insertion
-    std::list<EndPoint> m_endPointContainer;
+    Data<bool> d_parallelSweep; ///< sweep concurrently batches of end points, using the task scheduler
 
     sofa::type::vector<DSAPBox> m_boxes;//boxes
     sofa::type::vector<bool> m_isBoxInvestigated;
-    EndPointList m_sortedEndPoints; ///< list of EndPoints dedicated to be sorted. Owner of pointers is m_endPointContainer
+    sofa::type::vector<double> m_intervalMin, m_intervalMax; ///< interval of each box on the current axis, enlarged by the alarm distance
+    SweepAndPrune m_sweepAndPrune; ///< sorted end points of the intervals
+    sofa::type::vector<SweepAndPrune::BoxPair> m_overlappingPairs;
     int m_currentAxis;//the current greatest variance axis
 
     std::unordered_set<core::CollisionModel *> m_addedCollisionModels;//used to check if a collision model is added
@@ -123,6 +120,8 @@ public:
     void setDraw(bool val)
     { d_draw.setValue(val); }
 
+    void init() override;
+
     void reset() override;
 
     void beginNarrowPhase() override;
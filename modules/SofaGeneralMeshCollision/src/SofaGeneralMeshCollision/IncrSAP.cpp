@@ -25,162 +25,6 @@
 namespace sofa::component::collision
 {
 
-inline EndPointID & ISAPBox::min(int dim){return *(_min[dim]);}
-inline const EndPointID & ISAPBox::min(int dim)const{return *(_min[dim]);}
-
-inline EndPointID & ISAPBox::max(int dim){return *(_max[dim]);}
-inline const EndPointID & ISAPBox::max(int dim)const{return *(_max[dim]);}
-
-inline double ISAPBox::curMin(int dim)const{return cube.minVect()[dim];}
-inline double ISAPBox::curMax(int dim)const{return cube.maxVect()[dim];}
-
-inline void ISAPBox::updatedMin(int dim,EndPointID & end_point, double alarmDist)const{
-    end_point = (*_min[dim]);
-    end_point.value = cube.minVect()[dim] - alarmDist;
-}
-
-inline void ISAPBox::updatedMax(int dim,EndPointID & end_point,double alarmDist)const{
-    end_point = (*_max[dim]);
-    end_point.value = cube.maxVect()[dim] + alarmDist;
-}
-
-inline void ISAPBox::update(double alarmDist){
-    for(int i = 0 ; i < 3 ; ++i){
-        _min[i]->value = cube.minVect()[i] - alarmDist;
-        _max[i]->value = cube.maxVect()[i] + alarmDist;
-    }
-}
-
-inline void ISAPBox::updateMin(int dim,double alarmDist){
-    _min[dim]->value = cube.minVect()[dim] - alarmDist;
-}
-
-inline void ISAPBox::updateMax(int dim,double alarmDist){
-    _max[dim]->value = cube.maxVect()[dim] + alarmDist;
-}
-
-inline bool ISAPBox::endPointsAreAlright(int ID){
-    for(int i = 0 ; i < 3 ; ++i){
-        if(!_min[i]->min())
-            return false;
-
-        if(!_max[i]->max())
-            return false;
-
-        if(_min[i]->boxID() != ID)
-            return false;
-
-        if(_max[i]->boxID() != ID)
-            return false;
-    }
-
-    return true;
-}
-
-
-inline void ISAPBox::init(int boxID,EndPointID ** endPts){
-    for(int i = 0 ; i < 3 ; ++i){
-        _min[i] = endPts[i];
-        _max[i] = endPts[3 + i];
-    }
-
-    for(int i = 0 ; i < 3 ; ++i){
-        _min[i]->setMinAndBoxID(boxID);
-        _max[i]->setMaxAndBoxID(boxID);
-//        _min[i]->setBoxID(boxID);
-//        _max[i]->setBoxID(boxID);
-//        _min[i]->setMin();
-//        _max[i]->setMax();
-    }
-
-    // update();
-}
-
-inline bool ISAPBox::endPointsOverlap(const ISAPBox & other, int axis) const{
-    assert(axis >= 0);
-    assert(axis < 3);
-//    const Vector3 & minVect_this = cube.minVect();
-//    const Vector3 & maxVect_this = cube.maxVect();
-//    const Vector3 & minVect_other = other.cube.minVect();
-//    const Vector3 & maxVect_other = other.cube.maxVect();
-
-
-    if((min(axis).value >= other.max(axis).value) || (other.min(axis).value >= max(axis).value))
-        return false;
-
-    return true;
-}
-
-inline bool ISAPBox::minMoving(int axis,double alarmDist) const{
-    return min(axis).value  != cube.minVect()[axis] - alarmDist;
-}
-
-inline bool ISAPBox::maxMoving(int axis,double alarmDist) const{
-    return max(axis).value != cube.maxVect()[axis] + alarmDist;
-}
-
-inline bool ISAPBox::moving(int axis,double alarmDist) const{
-    return minMoving(axis,alarmDist) || maxMoving(axis,alarmDist);
-//    const core::CollisionElementIterator & finE = finalElement();
-
-//    const core::CollisionModel * cm = finE.getCollisionModel();
-
-//    switch (cm->getEnumType()){
-//        case core::CollisionModel::OBB_TYPE:
-//            return fabs(((static_cast<const OBBModel*>(cm))->lvelocity(finE.getIndex()))[axis]) > tolerance;
-//            break;
-//        case core::CollisionModel::CAPSULE_TYPE:
-//            return fabs(((static_cast<const CapsuleModel*>(cm))->velocity(finE.getIndex()))[axis]) > tolerance;
-//            break;
-//        case core::CollisionModel::SPHERE_TYPE:
-//            return fabs(((static_cast<const SphereModel*>(cm))->velocity(finE.getIndex()))[axis]) > tolerance;
-//            break;
-//        case core::CollisionModel::TRIANGLE_TYPE:
-//            return fabs(((static_cast<const TriangleModel*>(cm))-> velocity(finE.getIndex()))[axis]) > tolerance;
-//            break;
-//        case core::CollisionModel::LINE_TYPE:
-//            return fabs(((static_cast<const LineModel*>(cm))->velocity(finE.getIndex()))[axis]) > tolerance;
-//            break;
-//        case core::CollisionModel::POINT_TYPE:
-//            return fabs(((static_cast<const PointModel*>(cm))->velocity(finE.getIndex()))[axis]) > tolerance;
-//            break;
-//        default:
-//            msg_info()<<"CollisionModel type not found within SAPBox::moving"<<std::endl;
-//            return true;
-//    }
-}
-
-inline bool ISAPBox::moving(double alarmDist) const{
-    return moving(0,alarmDist) || moving(1,alarmDist) || moving(2,alarmDist);
-//    const core::CollisionElementIterator & finE = finalElement();
-
-//    const core::CollisionModel * cm = finE.getCollisionModel();
-
-//    switch (cm->getEnumType()){
-//        case core::CollisionModel::OBB_TYPE:
-//            return ((static_cast<const OBBModel*>(cm))->lvelocity(finE.getIndex())).norm2() > tolerance*tolerance;
-//            break;
-//        case core::CollisionModel::CAPSULE_TYPE:
-//            return ((static_cast<const CapsuleModel*>(cm))->velocity(finE.getIndex())).norm2() > tolerance*tolerance;
-//            break;
-//        case core::CollisionModel::SPHERE_TYPE:
-//            return ((static_cast<const SphereModel*>(cm))->velocity(finE.getIndex())).norm2() > tolerance*tolerance;
-//            break;
-//        case core::CollisionModel::TRIANGLE_TYPE:
-//            return ((static_cast<const TriangleModel*>(cm))->velocity(finE.getIndex())).norm2() > tolerance*tolerance;
-//            break;
-//        case core::CollisionModel::LINE_TYPE:
-//            return ((static_cast<const LineModel*>(cm))->velocity(finE.getIndex())).norm2() > tolerance*tolerance;
-//            break;
-//        case core::CollisionModel::POINT_TYPE:
-//            return ((static_cast<const PointModel*>(cm))->velocity(finE.getIndex())).norm2() > tolerance*tolerance;
-//            break;
-//        default:
-//            msg_info()<<"CollisionModel type not found within SAPBox::moving"<<std::endl;
-//            return true;
-//    }
-}
-
 inline const core::CollisionElementIterator ISAPBox::finalElement()const{
     return cube.getExternalChildren().first;
 }
@@ -191,28 +35,17 @@ IncrSAP::IncrSAP()
     , box(initData(&box, "box", "if not empty, objects that do not intersect this bounding-box will be ignored")),
       _nothing_added(true)
 {
-    // _end_points = new EndPointList[3];
 }
 
 
 IncrSAP::~IncrSAP(){
-    for(int i = 0 ; i < 3 ; ++i)
-        for(EndPointList::iterator it = _end_points[i].begin() ; it != _end_points[i].end() ; ++it)
-            delete (*it);
-
-
-    // delete[] _end_points;
 }
 
 
 
 void IncrSAP::purge(){
-    for(int i = 0 ; i < 3 ; ++i){
-        for(EndPointList::iterator it = _end_points[i].begin() ; it != _end_points[i].end() ; ++it)
-            delete (*it);
-
-        _end_points[i].clear();
-    }
+    for(int i = 0 ; i < 3 ; ++i)
+        _end_points[i] = SweepAndPrune();
 
     _boxes.clear();
     _colliding_elems.clear();
@@ -278,22 +111,9 @@ inline void IncrSAP::addCollisionModel(core::CollisionModel *cm)
         int cube_model_size = cube_model->getSize();
         _boxes.resize(cube_model_size + old_size);
 
-        EndPointID * endPts[6];
-        for(Size i = 0 ; i < cube_model->getSize() ; ++i){
-            for(int j = 0 ; j < 6 ; ++j)
-                endPts[j] = new EndPointID;
-
-            ISAPBox & new_box = _boxes[old_size + i];
-            new_box.cube = Cube(cube_model,i);
-            new_box.init(i + old_size,endPts);
-
-            for(int j = 0 ; j < 3 ; ++j){
-                _end_points[j].push_back(&(new_box.min(j)));
-                _end_points[j].push_back(&(new_box.max(j)));
-            }
-
-            assert(new_box.endPointsAreAlright(i + old_size));
-        }
+        // the end points of the new boxes are sorted with the other ones in reinitDetection
+        for(Size i = 0 ; i < cube_model->getSize() ; ++i)
+            _boxes[old_size + i].cube = Cube(cube_model,i);
     }
 }
 
@@ -307,8 +127,8 @@ int IncrSAP::greatestVarianceAxis()const{
 
     // computing the mean value of end points on each axis
     for(int j = 0 ; j < 3 ; ++j)
-        for(EndPointList::const_iterator it = _end_points[j].begin() ; it != _end_points[j].end() ; ++it)
-            m[j] += (**it).value;
+        for(const double value : _end_points[j].values())
+            m[j] += value;
 
     m[0] /= 2*_boxes.size();
     m[1] /= 2*_boxes.size();
@@ -316,8 +136,8 @@ int IncrSAP::greatestVarianceAxis()const{
 
     // computing the variance of end points on each axis
     for(int j = 0 ; j < 3 ; ++j){
-        for(EndPointList::const_iterator it = _end_points[j].begin() ; it != _end_points[j].end() ; ++it){
-            diff = (**it).value - m[j];
+        for(const double value : _end_points[j].values()){
+            diff = value - m[j];
             v[j] += diff*diff;
         }
     }
@@ -331,32 +151,35 @@ int IncrSAP::greatestVarianceAxis()const{
 }
 
 
-void IncrSAP::updateEndPoints(){
+void IncrSAP::computeEndPoints(int axis){
+    _min_values.resize(_boxes.size());
+    _max_values.resize(_boxes.size());
     for(unsigned int i = 0 ; i < _boxes.size() ; ++i){
-        _boxes[i].update(_alarmDist_d2);
-        assert(_boxes[i].endPointsAreAlright(i));
+        _min_values[i] = _boxes[i].cube.minVect()[axis] - _alarmDist_d2;
+        _max_values[i] = _boxes[i].cube.maxVect()[axis] + _alarmDist_d2;
     }
 }
 
 
-void IncrSAP::setEndPointsID(){
-    for(int dim = 0 ; dim < 3 ; ++dim){
-        int ID = 0;
-        for(EndPointList::iterator it = _end_points[dim].begin() ; it != _end_points[dim].end() ; ++it){
-            (**it).ID = ID;
-            ++ID;
-        }
-    }
+inline bool IncrSAP::endPointsOverlap(int boxID1,int boxID2,int axis) const{
+    assert(axis >= 0);
+    assert(axis < 3);
+    const type::vector<double> & min_values = _end_points[axis].minValues();
+    const type::vector<double> & max_values = _end_points[axis].maxValues();
+
+    if((min_values[boxID1] >= max_values[boxID2]) || (min_values[boxID2] >= max_values[boxID1]))
+        return false;
+
+    return true;
 }
 
 
 void IncrSAP::reinitDetection(){
     _colliding_elems.clear();
-    CompPEndPoint comp;
     for(int j = 0 ; j < 3 ; ++j){
-        std::sort(_end_points[j].begin(),_end_points[j].end(),comp);
+        computeEndPoints(j);
+        _end_points[j].setIntervals(_min_values,_max_values,j);
     }
-    setEndPointsID();
 }
 
 
@@ -364,9 +187,9 @@ void IncrSAP::reinitDetection(){
 void IncrSAP::showEndPoints()const{
     for(int j = 0 ; j < 3 ; ++j){
         msg_info() <<"dimension "<<j<<"===========" ;
-        for(EndPointList::const_iterator it = _end_points[j].begin() ; it != _end_points[j].end() ; ++it){
-            const EndPointID & end_pt = (**it);
-            end_pt.show();
+        for(size_t i = 0 ; i < _end_points[j].endPoints().size() ; ++i){
+            msg_info() <<"\tvalue "<<_end_points[j].values()[i]<<msgendl
+                       <<"\tdata "<<_end_points[j].endPoints()[i] ;
         }
     }
 }
@@ -381,13 +204,13 @@ void IncrSAP::showBoxes()const{
 
         tmp<<"minBBox ";
         for(int j = 0 ; j < 3 ; ++j){
-            tmp<<" "<<box.min(j).value;
+            tmp<<" "<<_end_points[j].minValues()[i];
         }
         tmp<<msgendl ;
 
         tmp<<"maxBBox ";
         for(int j = 0 ; j < 3 ; ++j){
-            tmp<<" "<<box.max(j).value;
+            tmp<<" "<<_end_points[j].maxValues()[i];
         }
         msg_info() << tmp.str() ;
     }
@@ -428,7 +251,7 @@ void IncrSAP::addIfCollide(int boxID1,int boxID2,int axis1,int axis2){
     core::CollisionModel *finalcm2 = box1.cube.getCollisionModel()->getLast();
 
     if((finalcm1->isSimulated() || finalcm2->isSimulated()) &&
-            (((finalcm1->getContext() != finalcm2->getContext()) || finalcm1->canCollideWith(finalcm2)) && box0.endPointsOverlap(box1,axis1) && box0.endPointsOverlap(box1,axis2))){ // intersection on all axes
+            (((finalcm1->getContext() != finalcm2->getContext()) || finalcm1->canCollideWith(finalcm2)) && endPointsOverlap(boxID1,boxID2,axis1) && endPointsOverlap(boxID1,boxID2,axis2))){ // intersection on all axes
 
                 _colliding_elems.add(boxID1,boxID2,box0.finalElement(),box1.finalElement());
     }
@@ -443,29 +266,15 @@ void IncrSAP::boxPrune(){
 
     sofa::helper::AdvancedTimer::stepBegin("Box Prune SAP intersection");
 
-    std::deque<int> active_boxes; // active boxes are the one that we encoutered only their min (end point), so if there are two boxes b0 and b1,
-                                  // if we encounter b1_min as b0_min < b1_min, on the current axis, the two boxes intersect :  b0_min--------------------b0_max
-                                  //                                                                                                      b1_min---------------------b1_max
-                                  // once we encouter b0_max, b0 will not intersect with nothing (trivial), so we delete it from active_boxes.
-                                  // so the rule is : - every time we encounter a box min end point, we check if it is overlapping with other active_boxes and add the owner (a box) of this end point to
-                                  //                  the active boxes.
-                                  //                  - every time we encounter a max end point of a box, we are sure that we encountered min end point of a box because _end_points is sorted,
-                                  //                  so, we delete the owner box, of this max end point from the active boxes
-    for(EndPointList::iterator it = _end_points[_cur_axis].begin() ; it != _end_points[_cur_axis].end() ; ++it){
-        if((**it).max()){ // erase it from the active_boxes
-            assert(std::find(active_boxes.begin(),active_boxes.end(),(**it).boxID()) != active_boxes.end());
-            active_boxes.erase(std::find(active_boxes.begin(),active_boxes.end(),(**it).boxID()));
-        }
-        else{ // we encounter a min possible intersection between it and active_boxes
-            int new_box = (**it).boxID();
+    // the pairs overlapping along the current axis, in the order of the sweep: every time we encounter a box min end point,
+    // the box may intersect the active boxes, i.e. the boxes whose min end point only was encountered
+    _end_points[_cur_axis].sweep(nullptr, 1,
+        [](SweepAndPrune::BoxID) { return true; },
+        [](SweepAndPrune::BoxID, SweepAndPrune::BoxID) { return true; },
+        _overlapping_pairs);
 
-            for(unsigned int i = 0 ; i < active_boxes.size() ; ++i){
-
-                addIfCollide(new_box,active_boxes[i],axis1,axis2);
-            }
-            active_boxes.push_back(new_box);
-        }
-    }
+    for(const SweepAndPrune::BoxPair & pair : _overlapping_pairs)
+        addIfCollide(pair.first,pair.second,axis1,axis2);
 
     sofa::helper::AdvancedTimer::stepEnd("Box Prune SAP intersection");
 }
@@ -496,319 +305,29 @@ void IncrSAP::beginNarrowPhase(){
         updateMovingBoxes();
     }
     else{
-        updateEndPoints();
         reinitDetection();
-        assert(assertion_end_points_sorted());
         boxPrune();
-        assert(assertion_end_points_sorted());
     }
 
     _colliding_elems.intersect(this);
-    assert(assertion_end_points_sorted());
     _nothing_added = true;
 }
 
 
-bool IncrSAP::assertion_order(EndPointList::iterator it,EndPointList::iterator begin,EndPointList::iterator end){
-    CompPEndPoint comp;
-    EndPointList::iterator next_it = it;++next_it;
-    if(next_it != end && comp(*next_it,*it))
-        return false;
-
-    if(it != begin){
-        EndPointList::iterator prev_it = it;--prev_it;
-        if(comp(*it,*prev_it))
-            return false;
-    }
-
-    return true;
-}
-
-
-
-bool IncrSAP::assertion_list_order(EndPointList::iterator begin_it,const EndPointList::iterator & end_it){
-    CompPEndPoint inferior;
-    EndPointList::iterator next_it = begin_it;
-    ++next_it;
-    for(;next_it != end_it ; ++next_it,++begin_it){
-        if(inferior(*next_it,*begin_it))
-            return false;
-    }
-
-    return true;
-}
-
-
-
-bool IncrSAP::assertion_superior(EndPointList::iterator begin_it,const EndPointList::iterator & end_it,EndPoint* point){
-    CompPEndPoint inferior;
-    for(;begin_it != end_it ;++begin_it){
-        if(inferior(point,*begin_it)){
-            inferior(point,*begin_it);
-            inferior(*begin_it,point);
-            return false;
-        }
-    }
-
-    return true;
-}
-
-
-bool IncrSAP::assertion_inferior(EndPointList::iterator begin_it,const EndPointList::iterator & end_it,EndPoint* point){
-    CompPEndPoint inferior;
-    for(;begin_it != end_it ;++begin_it){
-        if(inferior(*begin_it,point))
-            return false;
-    }
-
-    return true;
-}
-
-
-
-bool IncrSAP::assertion_end_points_sorted() const{
-    CompPEndPoint inferior;
-    int n = 0;
-    for(int dim = 0 ; dim < 3 ; ++dim){
-        int ID = 0;
-        EndPointList::const_iterator next_it2;
-        int equality_number = 0;
-        for(EndPointList::const_iterator it2 = _end_points[dim].begin() ; it2 != _end_points[dim].end() ; ++it2){
-            assert((**it2).ID == ID);
-
-            next_it2 = it2;
-            ++next_it2;
-            if(next_it2 != _end_points[dim].end()){
-                assert((**next_it2).ID == ID + 1);
-
-                if(!inferior(*it2,*next_it2)){
-                    ++n;
-
-                    if((**it2).value == (**next_it2).value)
-                        ++equality_number;
-                }
-            }
-
-            ++ID;
-        }
-
-        msg_info_when(n!=0)
-                << "STOP !";
-
-    }
-
-    return n == 0;
-}
-
-void IncrSAP::moveMinForward(int dim,EndPointID * cur_end_point,EndPointList::iterator & it,EndPointList::iterator & next_it){
-    CompPEndPoint inferior;
-    do{
-        if((**next_it).max())
-            removeCollision(cur_end_point->boxID(),(**next_it).boxID());
-
-        ++(cur_end_point->ID);
-        --((**next_it).ID);
-        (*it) = (*next_it);
-        it = next_it;
-        ++next_it;
-    }
-    while((next_it != _end_points[dim].end()) && (inferior(*next_it,cur_end_point)));
-
-    (*it) = cur_end_point;
-}
-
-
-
-void IncrSAP::moveMaxForward(int dim,EndPointID * cur_end_point,EndPointList::iterator & it,EndPointList::iterator & next_it){
-    CompPEndPoint inferior;
-    do{
-        if((**next_it).min())
-            addIfCollide(cur_end_point->boxID(),(**next_it).boxID());
-
-        ++(cur_end_point->ID);
-        --((**next_it).ID);
-        (*it) = (*next_it);
-        it = next_it;
-        ++next_it;
-        }
-    while((next_it != _end_points[dim].end()) && (inferior(*next_it,cur_end_point)));
-
-    (*it) = cur_end_point;
-}
-
-
-void IncrSAP::moveMinBackward(int dim,EndPointID * cur_end_point,EndPointList::iterator & it,EndPointList::iterator & prev_it){
-    CompPEndPoint inferior;
-    do{
-        if((**prev_it).max())
-            addIfCollide(cur_end_point->boxID(),(**prev_it).boxID());
-
-        ++((**prev_it).ID);
-        --(cur_end_point->ID);
-        (*it) = (*prev_it);
-        it = prev_it;
-
-        if(prev_it == _end_points[dim].begin())
-            break;
-
-        --prev_it;
-    }
-    while(inferior(cur_end_point,*prev_it));
-
-    (*it) = cur_end_point;
-}
-
-
-void IncrSAP::moveMaxBackward(int dim,EndPointID * cur_end_point,EndPointList::iterator & it,EndPointList::iterator & prev_it){
-    CompPEndPoint inferior;
-    do{
-        if((**prev_it).min())
-            removeCollision(cur_end_point->boxID(),(**prev_it).boxID());
-
-        ++((**prev_it).ID);
-        --(cur_end_point->ID);
-        (*it) = (*prev_it);
-        it = prev_it;
-
-        if(prev_it == _end_points[dim].begin())
-            break;
-
-        --prev_it;
-    }
-    while(inferior(cur_end_point,*prev_it));
-
-    (*it) = cur_end_point;
-}
-
-
-
 void IncrSAP::updateMovingBoxes(){
-    assert(assertion_end_points_sorted());
-    CompPEndPoint inferior;
-
     if(_boxes.size() < 2)
         return;
 
-    EndPointID * cur_end_point_min,*cur_end_point_max;
-    cur_end_point_min = cur_end_point_max = nullptr;
-
-    EndPointList::iterator it_min,next_it_min,prev_it_min,base_it_min,it_max,next_it_max,prev_it_max,base_it_max;
-    bool min_updated,max_updated,min_moving,max_moving;
-    EndPointID updated_min;
-    EndPointID updated_max;
-
-    for(unsigned int i = 0 ; i < _boxes.size() ; ++i){
-        ISAPBox & cur_box = _boxes[i];
-        for(int dim = 0 ; dim < 3 ; ++dim){
-            min_updated = false;
-            max_updated = false;
-
-            // FIRST CREATING CONTACTS THEN DELETING, this order is very important, it doesn't work in the other sens
-            // MOVING MAX FOREWARD
-            if((max_moving = cur_box.maxMoving(dim,_alarmDist_d2))){
-                // we don't directly update the max of the box but a copy of it, because when
-                // moving an end point, only one end point can change its value. In this case, we could
-                // update the value of the max but not move it, it would mean that the max could not be at its right place and when moving
-                // the min backward (below), the list would not be sorted...                
-                cur_box.updatedMax(dim,updated_max,_alarmDist_d2);
-
-                cur_end_point_max = &(cur_box.max(dim));
-                it_max = _end_points[dim].begin() + cur_end_point_max->ID;
-                base_it_max = it_max;
-                assert((**it_max).ID == cur_end_point_max->ID);
-
-                next_it_max = it_max;
-                ++next_it_max;
-
-                prev_it_max = it_max;
-                if(it_max != _end_points[dim].begin())
-                    --prev_it_max;
-
-                if(next_it_max != _end_points[dim].end() && inferior(*next_it_max,&updated_max)){ // moving the max foreward
-                    // the real update of the end point (belonging to the end point list) is done
-                    // here because this end point will be put at its right place
-                    cur_end_point_max->value = updated_max.value;
-
-                    moveMaxForward(dim,cur_end_point_max,it_max,next_it_max);
-                    max_updated = true;
-                } // after, cases when the end point is at its right place
-                else if(next_it_max == _end_points[dim].end() && inferior(*prev_it_max,&updated_max)){
-                    cur_end_point_max->value = updated_max.value;
-                    max_updated = true;
-                }
-                else if(it_max == _end_points[dim].begin() && inferior(&updated_max,*next_it_max)){
-                    cur_end_point_max->value = updated_max.value;
-                    max_updated = true;
-                }
-                else if(inferior(*prev_it_max,&updated_max) && inferior(&updated_max,*next_it_max)){
-                    cur_end_point_max->value = updated_max.value;
-                    max_updated = true;
-                }
-            }
-
-            // MOVING MIN BACKWARD
-            if((min_moving = cur_box.minMoving(dim,_alarmDist_d2))){
-                cur_box.updatedMin(dim,updated_min,_alarmDist_d2);
-                cur_end_point_min = &(cur_box.min(dim));
-                it_min = _end_points[dim].begin() + cur_end_point_min->ID;
-                base_it_min = it_min;
-                assert((**it_min).ID == cur_end_point_min->ID);
-
-                next_it_min = it_min;
-                ++next_it_min;
-
-                prev_it_min = it_min;
-                if(it_min != _end_points[dim].begin())
-                    --prev_it_min;
-
-                if((it_min != _end_points[dim].begin()) && inferior(&updated_min,*prev_it_min)){ // moving the min backward
-                    cur_end_point_min->value = updated_min.value;
-                    moveMinBackward(dim,cur_end_point_min,it_min,prev_it_min);
-                    min_updated = true;
-                } // after, cases when the end point is at its right place
-                else if(it_min == _end_points[dim].begin() && inferior(&updated_min,*next_it_min)){
-                    cur_end_point_min->value = updated_min.value;
-                    min_updated = true;
-                }
-                else if(next_it_min == _end_points[dim].end() && inferior(*prev_it_min,&updated_min)){
-                    cur_end_point_min->value = updated_min.value;
-                    min_updated = true;
-                }
-                else if(inferior(&updated_min,*next_it_min) && inferior(*prev_it_min,&updated_min)){
-                    cur_end_point_min->value = updated_min.value;
-                    min_updated = true;
-                }
-            }
-
-            // THEN DELETING
-            if(min_moving && (!min_updated)){
-                cur_end_point_min->value = updated_min.value;
-
-                // MOVING MIN FOREWARD
-                if((next_it_min != _end_points[dim].end()) && (inferior(*next_it_min,cur_end_point_min))){
-                    moveMinForward(dim,cur_end_point_min,it_min,next_it_min);
-                }
-            }
-
-            // MOVING MAX BACKWARD
-            if(max_moving && (!max_updated)){
-                cur_end_point_max->value = updated_max.value;
-
-                it_max = _end_points[dim].begin() + cur_end_point_max->ID;
-                prev_it_max = it_max;
-                if(it_max != _end_points[dim].begin())
-                    --prev_it_max;
-
-
-                if((prev_it_max != it_max && inferior(cur_end_point_max,*prev_it_max))){
-                    moveMaxBackward(dim,cur_end_point_max,it_max,prev_it_max);
-                }
-            }
-
-            if(min_moving || max_moving){
-                assert(assertion_end_points_sorted());
-            }
-        }
+    // a min end point moving backward past a max end point may create a contact, a max end point moving backward past a
+    // min end point may delete one. The real positions of the boxes are checked, so the order of the moves does not matter
+    for(int dim = 0 ; dim < 3 ; ++dim){
+        computeEndPoints(dim);
+        _end_points[dim].updateIntervals(_min_values,_max_values,[this](std::uint32_t moving_end_point,std::uint32_t end_point){
+            if(!(moving_end_point & 1) && (end_point & 1))
+                addIfCollide(moving_end_point >> 1,end_point >> 1);
+            else if((moving_end_point & 1) && !(end_point & 1))
+                removeCollision(moving_end_point >> 1,end_point >> 1);
+        });
     }
 }
 
@@ -29,10 +29,9 @@
 #include <sofa/core/CollisionModel.h>
 #include <SofaBaseCollision/CubeModel.h>
 #include <sofa/type/Vec.h>
-#include <SofaMeshCollision/EndPoint.h>
+#include <SofaGeneralMeshCollision/SweepAndPrune.h>
 #include <set>
 #include <map>
-#include <deque>
 #include <SofaMeshCollision/TriangleModel.h>
 #include <SofaMeshCollision/LineModel.h>
 #include <SofaMeshCollision/PointModel.h>
@@ -44,14 +43,10 @@
 namespace sofa::component::collision
 {
 
-class EndPointID;
-
 /**
  * ISAPBox is a simple bounding box. It contains a Cube which contains only one final
- * CollisionElement and pointers to min and max EndPoints along the three dimensions. min and max end points
- * are respectively min and max coordinates of the cube on a coordinate axis.
- * The between end points (_min, _max) and the field cube is that cube is always updated whereas
- * _min and _max are stored values of the cube end points at previous time step.
+ * CollisionElement. Its end points along the three axes, i.e. the min and max coordinates of the cube
+ * at the previous time step, are stored in the SweepAndPrune of each axis of IncrSAP.
  */
 class SOFA_SOFAGENERALMESHCOLLISION_API ISAPBox{
 public:
@@ -59,15 +54,9 @@ public:
 
     ISAPBox(Cube c) : cube(c){}
 
-    /**
-     * Returns true if this overlaps other along the dimension axis.
-     * For the two following methods, end points are not used but real positions
-     * of end points of the field cube.
-     */
-    bool endPointsOverlap(const ISAPBox & other,int axis)const;
-
     /**
      * Returns true if this overlaps other along the three dimensions.
+     * The real positions of the end points of the field cube are used.
      */
     bool overlaps(const ISAPBox & other,double alarmDist)const;
 
@@ -78,68 +67,9 @@ public:
         msg_info("IncrSAP") <<"MAX "<<cube.maxVect() ;
     }
 
-    inline void showEndPoints()const{
-        std::stringstream tmp;
-        tmp<<"MIN ";
-        for(int i = 0 ; i < 3 ; ++i)
-            tmp<<min(i).value<<" ";
-        tmp<<msgendl;
-
-        tmp<<"MAX ";
-        for(int i = 0 ; i < 3 ; ++i)
-            tmp<<max(i).value<<" ";
-        msg_info("IncrSAP") << tmp.str() ;
-    }
-
-    /**
-     * Returns true if the ISAPBox is moving along the dimension axis. i.e., returns true if the value of the end point of dimension axis is different
-     * from the end point of the field cube (which is the real position of the ISAPBox).
-     */
-    bool moving(int axis,double alarmDist)const;
-
-    /**
-     * The same than the previous one except that this one checks the three dimensions, i.e. it returns true if
-     * the ISAPBox is moving at least along one dimension.
-     */
-    bool moving(double alarmDist)const;
-
-    /**
-     * Inits _min and _max fiels with endPts. endPts is an one dimension array of EndPointID pointers.
-     * After this method, the first three end points are the mins in the dimension 0, 1, 2.
-     * The last three end points are the maxs in the dimension 0, 1, 2.
-     * Values and IDs of endPts are updated after this method.
-     */
-    void init(int boxID,EndPointID ** endPts);
-
-    void update(double alarmDist);
-
-    void updatedMin(int dim,EndPointID &end_point,double alarmDist)const;
-    void updatedMax(int dim,EndPointID &end_point,double alarmDist)const;
-
-
-    void updateMin(int dim,double alarmDist);
-    void updateMax(int dim,double alarmDist);
-
-    bool minMoving(int axis,double alarmDist) const;
-    bool maxMoving(int axis,double alarmDist) const;
-
     const core::CollisionElementIterator finalElement()const;
 
-    EndPointID & min(int dim);
-    const EndPointID & min(int dim)const;
-    EndPointID & max(int dim);
-    const EndPointID & max(int dim)const;
-
-    double curMin(int dim) const;
-    double curMax(int dim)const;
-
-    /// Returns true if the endpoints have id ID and if min end points are min and max are max.
-    /// It checks only the field data.
-    bool endPointsAreAlright(int ID);
-
     Cube cube;
-    EndPointID * _min[3];
-    EndPointID * _max[3];
 
     static double tolerance;
 };
@@ -156,7 +86,6 @@ public:
     SOFA_CLASS2(IncrSAP, core::collision::BroadPhaseDetection, core::collision::NarrowPhaseDetection);
 
     typedef ISAPBox SAPBox;
-    typedef std::vector<EndPointID*> EndPointList;
 
 private:
     /**
@@ -169,14 +98,14 @@ private:
     bool add(core::CollisionModel * cm);
 
     /**
-     * Updates values of end points. These values are coordinates of AABB on axis that maximazes the variance for the AABBs.
+     * Computes the end points of the boxes along the dimension axis, i.e. the coordinates of their cubes extended by half the alarm distance.
      */
-    void updateEndPoints();
+    void computeEndPoints(int axis);
 
     /**
-     * Sets the end points ID, i.e. each end point in the list after this mehod have its position (ID) updated.
+     * Returns true if the end points of the boxes boxID1 and boxID2 overlap along the dimension axis.
      */
-    void setEndPointsID();
+    bool endPointsOverlap(int boxID1,int boxID2,int axis)const;
 
 
     /**
@@ -186,7 +115,8 @@ private:
     void boxPrune();
 
     /**
-     * When there is no added collision model, one update only the moving boxes and in the same time, the collisions.
+     * When there is no added collision model, the end points are sorted again from their previous order, and the collisions
+     * are updated in the same time, from the end points which cross each other.
      */
     void updateMovingBoxes();
 
@@ -215,22 +145,11 @@ private:
     CubeCollisionModel::SPtr boxModel;
 
     std::vector<ISAPBox> _boxes;
-    EndPointList _end_points[3];
+    SweepAndPrune _end_points[3]; ///< end points of the boxes along each dimension, sorted at the previous time step
     CollidingPM _colliding_elems;
 
-
-    // The following methods are used when updating end points in the end point lists, it updates in the same time the collisions.
-    void moveMinForward(int dim,EndPointID * cur_end_point,EndPointList::iterator & it,EndPointList::iterator & next_it);
-    void moveMaxForward(int dim,EndPointID * cur_end_point,EndPointList::iterator & it,EndPointList::iterator & next_it);
-    void moveMinBackward(int dim,EndPointID * cur_end_point,EndPointList::iterator & it,EndPointList::iterator & prev_it);
-    void moveMaxBackward(int dim,EndPointID * cur_end_point,EndPointList::iterator & it,EndPointList::iterator & prev_it);
-
-    static bool assertion_order(EndPointList::iterator it,EndPointList::iterator begin,EndPointList::iterator end);
-    static bool assertion_list_order(EndPointList::iterator begin_it,const EndPointList::iterator & end_it);
-    static bool assertion_superior(EndPointList::iterator begin_it,const EndPointList::iterator & end_it,EndPoint* point);
-    static bool assertion_inferior(EndPointList::iterator begin_it,const EndPointList::iterator & end_it,EndPoint* point);
-    bool assertion_end_points_sorted()const;
-    //EndPointID & findEndPoint(int dim,int data);
+    type::vector<double> _min_values, _max_values;
+    type::vector<SweepAndPrune::BoxPair> _overlapping_pairs;
 
 
 
@@ -0,0 +1,112 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaGeneralMeshCollision/SweepAndPrune.h>
+#include <cstring>
+
+namespace sofa::component::collision
+{
+
+namespace
+{
+/// Unsigned integer with the same order as the double value
+std::uint64_t sortKey(double value)
+{
+    if (value == 0) value = 0; // same key for -0 and +0
+    std::uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    constexpr std::uint64_t sign = std::uint64_t(1) << 63;
+    return (bits & sign) ? ~bits : (bits | sign);
+}
+}
+
+void SweepAndPrune::setIntervals(const sofa::type::vector<double>& minValues, const sofa::type::vector<double>& maxValues, int axis)
+{
+    const bool rebuild = minValues.size() != m_boxMin.size() || axis != m_axis;
+    m_boxMin = minValues;
+    m_boxMax = maxValues;
+    m_axis = axis;
+
+    if (rebuild)
+    {
+        radixSort();
+        return;
+    }
+
+    updateValues();
+
+    // the order of the previous step is a good guess, unless the boxes moved a lot
+    if (!insertionSort(8 * m_endPoints.size(), [](std::uint32_t, std::uint32_t) {}))
+        radixSort();
+}
+
+void SweepAndPrune::updateValues()
+{
+    for (std::size_t i = 0; i < m_endPoints.size(); ++i)
+    {
+        const std::uint32_t e = m_endPoints[i];
+        m_values[i] = (e & 1) ? m_boxMax[e >> 1] : m_boxMin[e >> 1];
+    }
+}
+
+void SweepAndPrune::radixSort()
+{
+    const std::size_t nbEndPoints = 2 * m_boxMin.size();
+
+    // start from the end points in the order of their box id and flag, so that the stable sort
+    // on the values gives the same order as isLess
+    m_endPoints.resize(nbEndPoints);
+    for (std::size_t i = 0; i < nbEndPoints; ++i)
+        m_endPoints[i] = std::uint32_t(i);
+
+    sofa::type::vector<std::uint64_t> keys(nbEndPoints), tmpKeys(nbEndPoints);
+    sofa::type::vector<std::uint32_t> tmpEndPoints(nbEndPoints);
+    for (std::size_t i = 0; i < m_boxMin.size(); ++i)
+    {
+        keys[2 * i] = sortKey(m_boxMin[i]);
+        keys[2 * i + 1] = sortKey(m_boxMax[i]);
+    }
+
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        std::size_t count[257] = {};
+        for (const std::uint64_t k : keys)
+            ++count[((k >> shift) & 0xff) + 1];
+        if (count[((keys.empty() ? 0 : keys[0] >> shift) & 0xff) + 1] == nbEndPoints)
+            continue; // all the keys have the same byte
+
+        for (int b = 0; b < 256; ++b)
+            count[b + 1] += count[b];
+        for (std::size_t i = 0; i < nbEndPoints; ++i)
+        {
+            const std::size_t pos = count[(keys[i] >> shift) & 0xff]++;
+            tmpKeys[pos] = keys[i];
+            tmpEndPoints[pos] = m_endPoints[i];
+        }
+        keys.swap(tmpKeys);
+        m_endPoints.swap(tmpEndPoints);
+    }
+
+    m_values.resize(nbEndPoints);
+    updateValues();
+}
+
+} // namespace sofa::component::collision
@@ -0,0 +1,244 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+
+#include <SofaGeneralMeshCollision/config.h>
+
+#include <sofa/simulation/ParallelFor.h>
+#include <sofa/type/vector.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace sofa::component::collision
+{
+
+/**
+ * Sweep and prune of boxes along one axis, on contiguous arrays.
+ *
+ * The end points are stored as a structure of arrays: their values, and their box id with a min/max flag
+ * (same encoding and same order as EndPoint and CompPEndPoint). The first sort is a radix sort; the
+ * following ones start from the previous order and use an insertion sort, which is linear when the
+ * boxes move little between two steps. The end points exchanged by this sort can be reported, to
+ * update incrementally the overlapping pairs.
+ *
+ * The sweep can be split in batches of end points processed concurrently. Each batch starts from the
+ * boxes overlapping its first end point, so the pairs are the same, and in the same order, as with a
+ * sequential sweep.
+ */
+class SOFA_SOFAGENERALMESHCOLLISION_API SweepAndPrune
+{
+public:
+    using BoxID = std::uint32_t;
+    using BoxPair = std::pair<BoxID, BoxID>;
+
+    /// Set the interval of each box along the sweep axis. If the number of boxes or the axis changed,
+    /// the end points are sorted from scratch.
+    void setIntervals(const sofa::type::vector<double>& minValues, const sofa::type::vector<double>& maxValues, int axis);
+
+    /**
+     * Set the interval of each box, the number of boxes being unchanged, and sort the end points from their
+     * previous order, whatever the number of moves.
+     * @param onCrossing called for each pair of end points exchanged by the sort (end point moving backward,
+     * end point it passes): a min passing a max means the boxes start to overlap, a max passing a min that they stop
+     */
+    template<class CrossingHandler>
+    void updateIntervals(const sofa::type::vector<double>& minValues, const sofa::type::vector<double>& maxValues, const CrossingHandler& onCrossing);
+
+    /// Number of boxes
+    std::size_t size() const { return m_boxMin.size(); }
+
+    /// Interval of each box
+    const sofa::type::vector<double>& minValues() const { return m_boxMin; }
+    const sofa::type::vector<double>& maxValues() const { return m_boxMax; }
+
+    /// Sorted values of the end points
+    const sofa::type::vector<double>& values() const { return m_values; }
+
+    /// Box id (bits 1 to 31) and max flag (bit 0) of the sorted end points
+    const sofa::type::vector<std::uint32_t>& endPoints() const { return m_endPoints; }
+
+    /**
+     * Find the pairs of boxes whose intervals overlap.
+     * @param isBoxEnabled disabled boxes are skipped
+     * @param acceptPair called for each overlapping pair (box of the current min end point, active box), possibly
+     * concurrently: the pair is added to the result if it returns true
+     * @param nbBatches number of batches of end points processed concurrently (1 for a sequential sweep)
+     */
+    template<class BoxFilter, class PairFilter>
+    void sweep(simulation::TaskScheduler* scheduler, std::size_t nbBatches,
+               const BoxFilter& isBoxEnabled, const PairFilter& acceptPair, sofa::type::vector<BoxPair>& pairs);
+
+protected:
+    static bool isLess(double value0, std::uint32_t endPoint0, double value1, std::uint32_t endPoint1)
+    {
+        return value0 < value1 || (value0 == value1 && endPoint0 < endPoint1);
+    }
+
+    void updateValues();
+    void radixSort();
+
+    template<class CrossingHandler>
+    bool insertionSort(std::size_t maxMoves, const CrossingHandler& onCrossing);
+
+    template<class BoxFilter, class PairFilter>
+    void sweepBatch(std::size_t begin, std::size_t end, const BoxFilter& isBoxEnabled, const PairFilter& acceptPair,
+                    sofa::type::vector<BoxPair>& pairs) const;
+
+    sofa::type::vector<double> m_boxMin, m_boxMax;
+    sofa::type::vector<double> m_values;
+    sofa::type::vector<std::uint32_t> m_endPoints;
+    int m_axis { -1 };
+
+    sofa::type::vector<std::uint32_t> m_maxPosition; ///< position of the max end point of each box, in the sorted end points
+    sofa::type::vector<sofa::type::vector<BoxPair> > m_batchPairs;
+};
+
+template<class CrossingHandler>
+void SweepAndPrune::updateIntervals(const sofa::type::vector<double>& minValues, const sofa::type::vector<double>& maxValues, const CrossingHandler& onCrossing)
+{
+    assert(minValues.size() == m_boxMin.size());
+    m_boxMin = minValues;
+    m_boxMax = maxValues;
+    updateValues();
+    insertionSort(std::numeric_limits<std::size_t>::max(), onCrossing);
+}
+
+template<class CrossingHandler>
+bool SweepAndPrune::insertionSort(std::size_t maxMoves, const CrossingHandler& onCrossing)
+{
+    std::size_t nbMoves = 0;
+    for (std::size_t i = 1; i < m_endPoints.size(); ++i)
+    {
+        const double value = m_values[i];
+        const std::uint32_t endPoint = m_endPoints[i];
+        std::size_t j = i;
+        while (j > 0 && isLess(value, endPoint, m_values[j - 1], m_endPoints[j - 1]))
+        {
+            onCrossing(endPoint, m_endPoints[j - 1]);
+            m_values[j] = m_values[j - 1];
+            m_endPoints[j] = m_endPoints[j - 1];
+            --j;
+            ++nbMoves;
+        }
+        m_values[j] = value;
+        m_endPoints[j] = endPoint;
+        if (nbMoves > maxMoves)
+            return false;
+    }
+    return true;
+}
+
+template<class BoxFilter, class PairFilter>
+void SweepAndPrune::sweep(simulation::TaskScheduler* scheduler, std::size_t nbBatches,
+                          const BoxFilter& isBoxEnabled, const PairFilter& acceptPair, sofa::type::vector<BoxPair>& pairs)
+{
+    pairs.clear();
+    const std::size_t nbEndPoints = m_endPoints.size();
+    nbBatches = std::max<std::size_t>(1, std::min(nbBatches, nbEndPoints / 32));
+    if (nbBatches == 1 || !simulation::parallel::isParallel(scheduler))
+    {
+        sweepBatch(0, nbEndPoints, isBoxEnabled, acceptPair, pairs);
+        return;
+    }
+
+    m_maxPosition.resize(size());
+    for (std::size_t i = 0; i < nbEndPoints; ++i)
+    {
+        if (m_endPoints[i] & 1)
+            m_maxPosition[m_endPoints[i] >> 1] = std::uint32_t(i);
+    }
+
+    m_batchPairs.resize(nbBatches);
+    simulation::parallelFor(scheduler, std::size_t(0), nbBatches, std::size_t(1), [&](std::size_t batch)
+    {
+        m_batchPairs[batch].clear();
+        sweepBatch(batch * nbEndPoints / nbBatches, (batch + 1) * nbEndPoints / nbBatches, isBoxEnabled, acceptPair, m_batchPairs[batch]);
+    });
+
+    for (const auto& batchPairs : m_batchPairs)
+        pairs.insert(pairs.end(), batchPairs.begin(), batchPairs.end());
+}
+
+template<class BoxFilter, class PairFilter>
+void SweepAndPrune::sweepBatch(std::size_t begin, std::size_t end, const BoxFilter& isBoxEnabled, const PairFilter& acceptPair,
+                               sofa::type::vector<BoxPair>& pairs) const
+{
+    static constexpr BoxID Removed = ~BoxID(0);
+
+    // active boxes, in the order of their min end point. Removed boxes are marked, and compacted from time to time
+    sofa::type::vector<BoxID> active;
+    sofa::type::vector<std::uint32_t> slot(size(), Removed); // position of each box in active
+    std::size_t nbRemoved = 0;
+
+    const auto activate = [&](BoxID box)
+    {
+        slot[box] = std::uint32_t(active.size());
+        active.push_back(box);
+    };
+
+    // boxes overlapping the first end point of the batch
+    for (std::size_t i = 0; i < begin; ++i)
+    {
+        const std::uint32_t e = m_endPoints[i];
+        if (!(e & 1) && m_maxPosition[e >> 1] >= begin && isBoxEnabled(e >> 1))
+            activate(e >> 1);
+    }
+
+    for (std::size_t i = begin; i < end; ++i)
+    {
+        const std::uint32_t e = m_endPoints[i];
+        const BoxID box0 = e >> 1;
+        if (!isBoxEnabled(box0))
+            continue;
+
+        if (e & 1)
+        {
+            if (slot[box0] != Removed)
+            {
+                active[slot[box0]] = Removed;
+                slot[box0] = Removed;
+                ++nbRemoved;
+            }
+            if (nbRemoved > 32 && 2 * nbRemoved > active.size())
+            {
+                active.erase(std::remove(active.begin(), active.end(), Removed), active.end());
+                for (std::size_t j = 0; j < active.size(); ++j)
+                    slot[active[j]] = std::uint32_t(j);
+                nbRemoved = 0;
+            }
+        }
+        else
+        {
+            for (const BoxID box1 : active)
+            {
+                if (box1 != Removed && acceptPair(box0, box1))
+                    pairs.emplace_back(box0, box1);
+            }
+            activate(box0);
+        }
+    }
+}
+
+} // namespace sofa::component::collision
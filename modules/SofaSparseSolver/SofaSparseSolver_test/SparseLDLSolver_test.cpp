@@ -0,0 +1,338 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#include <SofaSparseSolver/SparseLDLSolver.h>
+#include <SofaBaseLinearSolver/FullVector.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/helper/logging/LoggingMessageHandler.h>
+
+#include <sofa/testing/BaseTest.h>
+using sofa::testing::BaseTest;
+
+#include <list>
+#include <map>
+#include <random>
+
+namespace
+{
+
+using namespace sofa::component::linearsolver;
+using sofa::helper::logging::MessageDispatcher;
+using sofa::helper::logging::MainLoggingMessageHandler;
+using sofa::helper::logging::LogMessage;
+
+typedef CompressedRowSparseMatrix<sofa::type::Mat<3,3,double> > Matrix3;
+typedef FullVector<double> Vector;
+typedef SparseLDLSolver<Matrix3, Vector> Solver;
+typedef Solver::InvertData InvertData;
+
+/// Symmetric positive definite matrix of a grid of nx*ny*nz nodes with 3 dofs, coupling the nodes
+/// at a Manhattan distance smaller or equal to stencil
+struct GridMatrix
+{
+    int n = 0;
+    std::vector< std::map<int, double> > rows;
+
+    GridMatrix(int nx, int ny, int nz, int stencil, unsigned int seed)
+    {
+        const int nbNodes = nx * ny * nz;
+        n = 3 * nbNodes;
+        rows.resize(n);
+
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<double> distribution(-1, 1);
+        const auto index = [&](int x, int y, int z) { return (x * ny + y) * nz + z; };
+
+        for (int x = 0; x < nx; ++x) for (int y = 0; y < ny; ++y) for (int z = 0; z < nz; ++z)
+        {
+            const int a = index(x, y, z);
+            for (int dx = -1; dx <= 1; ++dx) for (int dy = -1; dy <= 1; ++dy) for (int dz = -1; dz <= 1; ++dz)
+            {
+                const int X = x + dx, Y = y + dy, Z = z + dz;
+                if (X < 0 || Y < 0 || Z < 0 || X >= nx || Y >= ny || Z >= nz) continue;
+                if (std::abs(dx) + std::abs(dy) + std::abs(dz) > stencil) continue;
+                const int b = index(X, Y, Z);
+                if (b < a) continue;
+                for (int i = 0; i < 3; ++i) for (int j = 0; j < 3; ++j)
+                {
+                    if (b == a && j < i) continue;
+                    const double v = 0.1 * distribution(generator);
+                    rows[3 * a + i][3 * b + j] = v;
+                    rows[3 * b + j][3 * a + i] = v;
+                }
+            }
+        }
+
+        // diagonal dominance
+        for (int i = 0; i < n; ++i)
+        {
+            double sum = 0;
+            for (const auto& e : rows[i]) sum += std::abs(e.second);
+            rows[i][i] += sum + 1;
+        }
+    }
+
+    void fill(Matrix3& M) const
+    {
+        M.resize(n, n);
+        for (int i = 0; i < n; ++i)
+            for (const auto& e : rows[i])
+                M.add(i, e.first, e.second);
+        M.compress();
+    }
+
+    /// Scalar compressed storage of the matrix, as given to the factorization
+    void compressed(std::vector<int>& colptr, std::vector<int>& rowind, std::vector<double>& values) const
+    {
+        colptr.assign(1, 0);
+        rowind.clear();
+        values.clear();
+        for (int i = 0; i < n; ++i)
+        {
+            for (const auto& e : rows[i])
+            {
+                rowind.push_back(e.first);
+                values.push_back(e.second);
+            }
+            colptr.push_back(int(rowind.size()));
+        }
+    }
+
+    std::size_t patternHash() const
+    {
+        std::vector<int> colptr, rowind;
+        std::vector<double> values;
+        compressed(colptr, rowind, values);
+        return CSPARSE_pattern_hash(n, colptr.data(), rowind.data());
+    }
+
+    Vector rhs(unsigned int seed) const
+    {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<double> distribution(-1, 1);
+        Vector b(n);
+        for (int i = 0; i < n; ++i) b[i] = distribution(generator);
+        return b;
+    }
+};
+
+/// Factorize a matrix and solve a system with it on a new solver
+struct LDLSolution
+{
+    Solver::SPtr solver;
+    Matrix3 M;
+    Vector x;
+
+    LDLSolution(const GridMatrix& grid, bool supernodal, bool parallel = false, unsigned int cacheSize = 1)
+        : solver(sofa::core::objectmodel::New<Solver>())
+    {
+        solver->d_supernodal.setValue(supernodal);
+        solver->d_parallelFactorization.setValue(parallel);
+        solver->d_symbolicCacheSize.setValue(cacheSize);
+        factorizeAndSolve(grid);
+    }
+
+    void factorizeAndSolve(const GridMatrix& grid)
+    {
+        M.clear();
+        grid.fill(M);
+        solver->invert(M);
+
+        Vector b = grid.rhs(7);
+        x.resize(grid.n);
+        x.clear();
+        solver->solve(M, x, b);
+    }
+
+    InvertData* data() { return static_cast<InvertData*>(solver->getMatrixInvertData(&M)); }
+
+    /// Factorize a new matrix and tell if the symbolic factorization of a previous pattern was reused
+    bool factorizeAndSolveReusingSymbolic(const GridMatrix& grid)
+    {
+        solver->f_printLog.setValue(true);
+        LogMessage log;
+        factorizeAndSolve(grid);
+        solver->f_printLog.setValue(false);
+
+        return std::any_of(log.begin(), log.end(), [](const sofa::helper::logging::Message& m) {
+            return m.messageAsString().find("Reusing the symbolic factorization") != std::string::npos;
+        });
+    }
+
+    /// Patterns of the symbolic factorizations in the cache, most recent first
+    std::list<std::size_t> cachedPatterns()
+    {
+        std::list<std::size_t> patterns;
+        for (const auto& f : data()->symbolicCache) patterns.push_back(f.patternHash);
+        return patterns;
+    }
+};
+
+void expectSameSolution(const Vector& x, const Vector& reference, double tolerance)
+{
+    ASSERT_EQ(x.size(), reference.size());
+    for (Vector::Index i = 0; i < x.size(); ++i)
+    {
+        EXPECT_NEAR(x[i], reference[i], tolerance) << "i = " << i;
+    }
+}
+
+struct SparseLDLSolver_test : public BaseTest
+{
+    unsigned int m_nbThreads = 0;
+
+    void onSetUp() override
+    {
+        m_nbThreads = sofa::simulation::TaskScheduler::getInstance()->getThreadCount();
+        MessageDispatcher::addHandler(&MainLoggingMessageHandler::getInstance());
+    }
+
+    void onTearDown() override
+    {
+        MessageDispatcher::rmHandler(&MainLoggingMessageHandler::getInstance());
+        sofa::simulation::TaskScheduler::getInstance()->init(m_nbThreads);
+    }
+
+    /// The supernodal factorization of a matrix of 3x3 blocks gives the same factors as the simplicial one,
+    /// computed with the same ordering, and the same solution as the simplicial solver
+    void checkSupernodalMatchesSimplicial(unsigned int nbThreads)
+    {
+        sofa::simulation::TaskScheduler::getInstance()->init(nbThreads);
+
+        const GridMatrix grid(5, 4, 6, 3, 1);
+
+        LDLSolution simplicial(grid, false);
+        LDLSolution supernodal(grid, true, nbThreads > 1);
+
+        InvertData* data = supernodal.data();
+        ASSERT_TRUE(data->supernodal);
+        ASSERT_EQ(data->n, grid.n);
+        EXPECT_GT(data->supernodes.nbSupernodes, 0);
+        EXPECT_LT(data->supernodes.nbSupernodes, grid.n);
+
+        // simplicial factorization with the ordering of the supernodal one
+        std::vector<int> colptr, rowind;
+        std::vector<double> values;
+        grid.compressed(colptr, rowind, values);
+
+        const int n = grid.n;
+        std::vector<int> L_colptr(n + 1), Parent(n), Flag(n), Lnz(n), Pattern(n);
+        CSPARSE_symbolic(n, colptr.data(), rowind.data(), L_colptr.data(), data->perm.data(), data->invperm.data(),
+                         Parent.data(), Flag.data(), Lnz.data());
+        ASSERT_EQ(L_colptr[n], data->L_nnz);
+
+        std::vector<int> L_rowind(data->L_nnz);
+        std::vector<double> L_values(data->L_nnz), D(n), Y(n);
+        CSPARSE_numeric<double>(n, colptr.data(), rowind.data(), values.data(), L_colptr.data(), L_rowind.data(), L_values.data(),
+                                D.data(), data->perm.data(), data->invperm.data(), Parent.data(), Flag.data(), Lnz.data(),
+                                Pattern.data(), Y.data());
+
+        for (int j = 0; j < n; ++j)
+        {
+            ASSERT_EQ(data->L_colptr[j], L_colptr[j]);
+            EXPECT_NEAR(data->invD[j], 1.0 / D[j], 1e-12) << "j = " << j;
+        }
+        for (int p = 0; p < data->L_nnz; ++p)
+        {
+            ASSERT_EQ(data->L_rowind[p], L_rowind[p]);
+            EXPECT_NEAR(data->L_values[p], L_values[p], 1e-12) << "p = " << p;
+        }
+
+        expectSameSolution(supernodal.x, simplicial.x, 1e-10);
+    }
+};
+
+TEST_F(SparseLDLSolver_test, supernodalMatchesSimplicial)
+{
+    checkSupernodalMatchesSimplicial(1);
+}
+
+TEST_F(SparseLDLSolver_test, parallelSupernodalMatchesSimplicial)
+{
+    checkSupernodalMatchesSimplicial(4);
+}
+
+/// The symbolic factorization of a pattern is reused when it comes back
+TEST_F(SparseLDLSolver_test, symbolicCacheHit)
+{
+    for (const bool supernodal : {false, true})
+    {
+        const GridMatrix A(4, 4, 4, 1, 1);
+        const GridMatrix B(4, 4, 4, 2, 2);
+        const GridMatrix A2(4, 4, 4, 1, 3); // pattern of A, other values
+
+        LDLSolution cached(A, supernodal, false, 3);
+        EXPECT_FALSE(cached.factorizeAndSolveReusingSymbolic(B));
+        EXPECT_TRUE(cached.factorizeAndSolveReusingSymbolic(A2));
+
+        EXPECT_EQ(cached.data()->patternHash, A.patternHash());
+        EXPECT_EQ(cached.cachedPatterns(), std::list<std::size_t>({ B.patternHash() }));
+
+        const LDLSolution uncached(A2, supernodal);
+        expectSameSolution(cached.x, uncached.x, 1e-12);
+    }
+}
+
+/// A new pattern is factorized, and the previous one is kept in the cache
+TEST_F(SparseLDLSolver_test, symbolicCacheMiss)
+{
+    const GridMatrix A(4, 4, 4, 1, 1);
+    const GridMatrix B(4, 4, 4, 2, 2);
+
+    LDLSolution cached(A, false, false, 3);
+    EXPECT_TRUE(cached.cachedPatterns().empty());
+    EXPECT_FALSE(cached.factorizeAndSolveReusingSymbolic(B));
+
+    EXPECT_EQ(cached.data()->patternHash, B.patternHash());
+    EXPECT_EQ(cached.cachedPatterns(), std::list<std::size_t>({ A.patternHash() }));
+
+    const LDLSolution uncached(B, false);
+    expectSameSolution(cached.x, uncached.x, 1e-12);
+}
+
+/// The least recently used pattern is evicted when the cache is full
+TEST_F(SparseLDLSolver_test, symbolicCacheEviction)
+{
+    const GridMatrix A(4, 4, 4, 1, 1);
+    const GridMatrix B(4, 4, 4, 2, 2);
+    const GridMatrix C(4, 4, 4, 3, 3);
+    const GridMatrix D(3, 4, 5, 3, 4);
+
+    // the current factorization and 2 previous ones
+    LDLSolution cached(A, false, false, 3);
+    const auto check = [&](const GridMatrix& M, bool reused, std::list<std::size_t> patterns)
+    {
+        EXPECT_EQ(cached.factorizeAndSolveReusingSymbolic(M), reused);
+        EXPECT_EQ(cached.data()->patternHash, M.patternHash());
+        EXPECT_EQ(cached.cachedPatterns(), patterns);
+
+        const LDLSolution uncached(M, false);
+        expectSameSolution(cached.x, uncached.x, 1e-12);
+    };
+
+    check(B, false, { A.patternHash() });
+    check(C, false, { B.patternHash(), A.patternHash() });
+    check(D, false, { C.patternHash(), B.patternHash() }); // A is evicted
+    check(A, false, { D.patternHash(), C.patternHash() }); // B is evicted
+    check(C, true,  { A.patternHash(), D.patternHash() });
+}
+
+} // namespace
@@ -25,6 +25,11 @@
 
 #include <sofa/core/behavior/LinearSolver.h>
 #include <SofaBaseLinearSolver/MatrixLinearSolver.h>
+#include <SofaSparseSolver/SparseLDLSupernodal.h>
+#include <sofa/simulation/TaskScheduler.h>
+#include <sofa/helper/AdvancedTimer.h>
+#include <sofa/helper/system/thread/CTime.h>
+#include <list>
 
 extern "C" {
 #include <metis.h>
@@ -49,6 +54,52 @@ public :
     VecReal P_values,L_values,LT_values,invD;
     type::vector<int> Parent;
     bool new_factorization_needed;
+
+    bool supernodal = false; ///< true if the symbolic factorization below is supernodal
+    SupernodalLDLStructure supernodes;
+    VecReal supernodeValues;
+
+    /// Symbolic factorization (ordering, elimination tree and pattern of L) of a sparsity pattern
+    struct SymbolicFactorization
+    {
+        std::size_t patternHash = 0;
+        int n = 0, P_nnz = 0, L_nnz = 0;
+        VecInt P_colptr, P_rowind, perm, invperm, L_colptr, L_rowind;
+        type::vector<int> Parent;
+        bool supernodal = false;
+        SupernodalLDLStructure supernodes;
+        double symbolicTime = 0; ///< time spent to compute it, in ms
+    };
+
+    std::size_t patternHash = 0; ///< hash of the current sparsity pattern
+    double symbolicTime = 0;     ///< time spent to compute the current symbolic factorization, in ms
+    std::list<SymbolicFactorization> symbolicCache; ///< previous symbolic factorizations, most recent first
+
+    /// Move the current symbolic factorization to a cache entry
+    void storeSymbolic(SymbolicFactorization& f)
+    {
+        f.patternHash = patternHash; f.n = n; f.P_nnz = P_nnz; f.L_nnz = L_nnz;
+        f.P_colptr.swap(P_colptr); f.P_rowind.swap(P_rowind);
+        f.perm.swap(perm); f.invperm.swap(invperm);
+        f.L_colptr.swap(L_colptr); f.L_rowind.swap(L_rowind);
+        f.Parent.swap(Parent);
+        f.supernodal = supernodal;
+        std::swap(f.supernodes, supernodes);
+        f.symbolicTime = symbolicTime;
+    }
+
+    /// Make a cache entry the current symbolic factorization
+    void restoreSymbolic(SymbolicFactorization& f)
+    {
+        patternHash = f.patternHash; n = f.n; P_nnz = f.P_nnz; L_nnz = f.L_nnz;
+        P_colptr.swap(f.P_colptr); P_rowind.swap(f.P_rowind);
+        perm.swap(f.perm); invperm.swap(f.invperm);
+        L_colptr.swap(f.L_colptr); L_rowind.swap(f.L_rowind);
+        Parent.swap(f.Parent);
+        supernodal = f.supernodal;
+        std::swap(supernodes, f.supernodes);
+        symbolicTime = f.symbolicTime;
+    }
 };
 
 inline void CSPARSE_symbolic (int n,int * M_colptr,int * M_rowind,int * colptr,int * perm,int * invperm,int * Parent, int * Flag, int * Lnz)
@@ -134,6 +185,15 @@ inline void CSPARSE_numeric(int n,int * M_colptr,int * M_rowind,Real * M_values,
     }
 }
 
+/// Hash of a sparsity pattern, used to find a previous symbolic factorization
+inline std::size_t CSPARSE_pattern_hash(int n, const int * M_colptr, const int * M_rowind) {
+    std::size_t h = std::hash<int>()(n);
+    const auto combine = [&h](int v) { h ^= std::hash<int>()(v) + 0x9e3779b9 + (h << 6) + (h >> 2); };
+    for (int i=0;i<=n;i++) combine(M_colptr[i]);
+    for (int i=0;i<M_colptr[n];i++) combine(M_rowind[i]);
+    return h;
+}
+
 inline bool CSPARSE_need_symbolic_factorization(int s_M, int * M_colptr,int * M_rowind, int s_P, int * P_colptr,int * P_rowind) {
     if (s_M != s_P) return true;
     if (M_colptr[s_M] != P_colptr[s_M] ) return true;
@@ -164,7 +224,26 @@ public:
 
 protected :
 
-    SparseLDLSolverImpl() : Inherit() {}
+    SparseLDLSolverImpl()
+        : Inherit()
+        , d_supernodal(initData(&d_supernodal, false, "supernodal", "Use a supernodal numeric factorization, with dense kernels on groups of columns sharing the same pattern. With blocks of 3x3 matrices, the ordering keeps the 3 dofs of each node together"))
+        , d_parallelFactorization(initData(&d_parallelFactorization, false, "parallelFactorization", "Factorize concurrently the independent branches of the elimination tree, using the task scheduler (supernodal factorization only)"))
+        , d_symbolicCacheSize(initData(&d_symbolicCacheSize, 1u, "symbolicCacheSize", "Number of symbolic factorizations (ordering, elimination tree and pattern of the factor) kept in memory, identified by a hash of the sparsity pattern of the matrix. When the pattern of the matrix returns to one of them, only the numeric factorization is computed"))
+    {}
+
+public:
+    Data<bool> d_supernodal; ///< Use a supernodal numeric factorization
+    Data<bool> d_parallelFactorization; ///< Factorize concurrently the independent branches of the elimination tree
+    Data<unsigned int> d_symbolicCacheSize; ///< Number of symbolic factorizations kept in memory
+
+    void init() override
+    {
+        Inherit::init();
+        if (d_parallelFactorization.getValue())
+            simulation::TaskScheduler::getInstance()->init();
+    }
+
+protected :
 
     template<class VecInt,class VecReal>
     void solve_cpu(Real * x,const Real * b,SparseLDLImplInvertData<VecInt,VecReal> * data) {
@@ -260,6 +339,44 @@ protected :
         METIS_NodeND(&n, xadj.data(), adj.data(), NULL, NULL, perm,invperm);
     }
 
+    /// Ordering of the graph of the blocks of size blockSize, so that the dofs of a block stay
+    /// consecutive (and then in the same supernode)
+    void LDL_blockOrdering(int n, int blockSize, int * M_colptr, int * M_rowind, int * perm, int * invperm) {
+        const int nbBlocks = n / blockSize;
+
+        //adjacency of the blocks, without the diagonal
+        tran_countvec.clear();
+        tran_countvec.resize(nbBlocks, -1);
+        adj.clear();
+        xadj.resize(nbBlocks+1);
+        xadj[0] = 0;
+        for (int b=0; b<nbBlocks; b++) {
+            tran_countvec[b] = b;
+            for (int j=b*blockSize; j<(b+1)*blockSize; j++) {
+                for (int ip = M_colptr[j]; ip < M_colptr[j+1]; ip++) {
+                    const int neighbor = M_rowind[ip] / blockSize;
+                    if (tran_countvec[neighbor] != b) {
+                        tran_countvec[neighbor] = b;
+                        adj.push_back(neighbor);
+                    }
+                }
+            }
+            xadj[b+1] = adj.size();
+        }
+
+        t_xadj.resize(nbBlocks);
+        t_adj.resize(nbBlocks);
+        int nbNodes = nbBlocks;
+        METIS_NodeND(&nbNodes, xadj.data(), adj.data(), NULL, NULL, t_xadj.data(), t_adj.data());
+
+        for (int b=0; b<nbBlocks; b++) {
+            for (int d=0; d<blockSize; d++) {
+                perm[b*blockSize+d] = t_xadj[b]*blockSize+d;
+                invperm[t_xadj[b]*blockSize+d] = b*blockSize+d;
+            }
+        }
+    }
+
     void LDL_symbolic (int n,int * M_colptr,int * M_rowind,int * colptr,int * perm,int * invperm,int * Parent) {
         Lnz.clear();
         Flag.clear();
@@ -278,19 +395,77 @@ protected :
         CSPARSE_numeric<Real>(n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,perm,invperm,Parent,Flag.data(),Lnz.data(),Pattern.data(),Y.data());
     }
 
+    /// blockSize is the size of the blocks of the system matrix, used by the supernodal factorization
     template<class VecInt,class VecReal>
-    void factorize(int n,int * M_colptr, int * M_rowind, Real * M_values, SparseLDLImplInvertData<VecInt,VecReal> * data) {
-        data->new_factorization_needed = data->P_colptr.size() == 0 || data->P_rowind.size() == 0 || CSPARSE_need_symbolic_factorization(n, M_colptr, M_rowind, data->n,
-                                                                                                                                         (int *) data->P_colptr.data(),(int *) data->P_rowind.data());
+    void factorize(int n,int * M_colptr, int * M_rowind, Real * M_values, SparseLDLImplInvertData<VecInt,VecReal> * data, int blockSize = 1) {
+        typedef typename SparseLDLImplInvertData<VecInt,VecReal>::SymbolicFactorization SymbolicFactorization;
+        const bool supernodal = d_supernodal.getValue();
+        const bool hasSymbolic = data->P_colptr.size() != 0 && data->P_rowind.size() != 0;
+        data->new_factorization_needed = !hasSymbolic || data->supernodal != supernodal
+                || CSPARSE_need_symbolic_factorization(n, M_colptr, M_rowind, data->n, (int *) data->P_colptr.data(),(int *) data->P_rowind.data());
+
+        // look for a previous symbolic factorization of this pattern
+        bool restored = false;
+        if (data->new_factorization_needed) {
+            const std::size_t hash = CSPARSE_pattern_hash(n, M_colptr, M_rowind);
+            const std::size_t cacheSize = std::max(d_symbolicCacheSize.getValue(), 1u);
+
+            auto cached = std::find_if(data->symbolicCache.begin(), data->symbolicCache.end(), [&](const SymbolicFactorization& f) {
+                return f.patternHash == hash && f.supernodal == supernodal
+                        && !CSPARSE_need_symbolic_factorization(n, M_colptr, M_rowind, f.n, (int *) f.P_colptr.data(), (int *) f.P_rowind.data());
+            });
+            SymbolicFactorization found;
+            if (cached != data->symbolicCache.end()) {
+                std::swap(found, *cached);
+                data->symbolicCache.erase(cached);
+                restored = true;
+            }
+            if (hasSymbolic && cacheSize > 1) {
+                data->symbolicCache.emplace_front();
+                data->storeSymbolic(data->symbolicCache.front());
+            }
+            while (data->symbolicCache.size() > cacheSize - 1) data->symbolicCache.pop_back();
+
+            if (restored) {
+                data->restoreSymbolic(found);
+            }
+            data->patternHash = hash;
+        }
+
+        if (!data->new_factorization_needed || restored) {
+            sofa::helper::AdvancedTimer::valSet("SparseLDLSolver symbolic time saved (ms)", data->symbolicTime);
+        }
 
         data->n = n;
         data->P_nnz = M_colptr[data->n];
         data->P_values.clear();data->P_values.fastResize(data->P_nnz);
         memcpy(data->P_values.data(),M_values,data->P_nnz * sizeof(Real));
 
+        if (restored) {
+            msg_info() << "Reusing the symbolic factorization of a previous sparsity pattern" ;
+
+            data->invD.clear();data->invD.fastResize(data->n);
+            data->LT_colptr.clear();data->LT_colptr.fastResize(data->n+1);
+            if (!supernodal) {
+                data->L_rowind.clear();data->L_rowind.fastResize(data->L_nnz);
+            }
+            data->L_values.clear();data->L_values.fastResize(data->L_nnz);
+            data->LT_rowind.clear();data->LT_rowind.fastResize(data->L_nnz);
+            data->LT_values.clear();data->LT_values.fastResize(data->L_nnz);
+            if (supernodal) {
+                data->supernodeValues.clear();data->supernodeValues.fastResize(data->supernodes.valuePtr[data->supernodes.nbSupernodes]);
+            }
+
+            // work vectors of the numeric factorization
+            Lnz.resize(data->n);
+            Flag.resize(data->n);
+            Pattern.resize(data->n);
+        }
         // we test if the matrix has the same struct as previous factorized matrix
-        if (data->new_factorization_needed) {
+        else if (data->new_factorization_needed) {
             msg_info() << "Recomputing new factorization" ;
+            sofa::helper::AdvancedTimer::stepBegin("SparseLDLSolver symbolic");
+            const auto symbolicStart = sofa::helper::system::thread::CTime::getRefTime();
 
             data->perm.clear();data->perm.fastResize(data->n);
             data->invperm.clear();data->invperm.fastResize(data->n);
@@ -304,7 +479,10 @@ protected :
             memcpy(data->P_rowind.data(),M_rowind,data->P_nnz * sizeof(int));
 
             //ordering function
-            LDL_ordering(data->n,M_colptr,M_rowind,data->perm.data(),data->invperm.data());
+            if (supernodal && blockSize > 1 && data->n % blockSize == 0)
+                LDL_blockOrdering(data->n,blockSize,M_colptr,M_rowind,data->perm.data(),data->invperm.data());
+            else
+                LDL_ordering(data->n,M_colptr,M_rowind,data->perm.data(),data->invperm.data());
 
             data->Parent.clear();
             data->Parent.resize(data->n);
@@ -319,6 +497,21 @@ protected :
             data->L_values.clear();data->L_values.fastResize(data->L_nnz);
             data->LT_rowind.clear();data->LT_rowind.fastResize(data->L_nnz);
             data->LT_values.clear();data->LT_values.fastResize(data->L_nnz);
+
+            data->supernodal = supernodal;
+            if (supernodal) {
+                SUPERNODAL_pattern(data->n,M_colptr,M_rowind,data->L_colptr.data(),data->L_rowind.data(),
+                                   data->perm.data(),data->invperm.data(),data->Parent.data(),Flag.data(),Lnz.data());
+                SUPERNODAL_symbolic(data->n,data->L_colptr.data(),data->L_rowind.data(),data->Parent.data(),data->supernodes);
+                data->supernodeValues.clear();data->supernodeValues.fastResize(data->supernodes.valuePtr[data->supernodes.nbSupernodes]);
+
+                msg_info() << data->supernodes.nbSupernodes << " supernodes for " << data->n << " columns, "
+                           << data->supernodes.levelPtr.size()-1 << " levels in the elimination tree" ;
+            }
+
+            data->symbolicTime = double(sofa::helper::system::thread::CTime::getRefTime() - symbolicStart) * 1000.0
+                    / double(sofa::helper::system::thread::CTime::getRefTicksPerSec());
+            sofa::helper::AdvancedTimer::stepEnd("SparseLDLSolver symbolic");
         }
 
         Real * D = data->invD.data();
@@ -330,8 +523,19 @@ protected :
         Real * tran_values = data->LT_values.data();
 
         //Numeric Factorization
-        LDL_numeric(data->n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,
-                    data->perm.data(),data->invperm.data(),data->Parent.data());
+        sofa::helper::AdvancedTimer::stepBegin("SparseLDLSolver numeric");
+        if (supernodal) {
+            simulation::TaskScheduler* taskScheduler = d_parallelFactorization.getValue() ? simulation::TaskScheduler::getInstance() : nullptr;
+            if (taskScheduler && taskScheduler->getThreadCount() < 2) taskScheduler = nullptr;
+            SUPERNODAL_numeric<Real>(M_colptr,M_rowind,M_values,colptr,values,D,data->perm.data(),data->invperm.data(),
+                                     data->supernodes,data->supernodeValues.data(),taskScheduler);
+        }
+        else {
+            LDL_numeric(data->n,M_colptr,M_rowind,M_values,colptr,rowind,values,D,
+                        data->perm.data(),data->invperm.data(),data->Parent.data());
+        }
+
+        sofa::helper::AdvancedTimer::stepEnd("SparseLDLSolver numeric");
 
         //inverse the diagonal
         for (int i=0;i<data->n;i++) D[i] = 1.0/D[i];
@@ -0,0 +1,327 @@
+/******************************************************************************
+*                 SOFA, Simulation Open-Framework Architecture                *
+*                    (c) 2006 INRIA, USTL, UJF, CNRS, MGH                     *
+*                                                                             *
+* This program is free software; you can redistribute it and/or modify it     *
+* under the terms of the GNU Lesser General Public License as published by    *
+* the Free Software Foundation; either version 2.1 of the License, or (at     *
+* your option) any later version.                                             *
+*                                                                             *
+* This program is distributed in the hope that it will be useful, but WITHOUT *
+* ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+* FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License *
+* for more details.                                                           *
+*                                                                             *
+* You should have received a copy of the GNU Lesser General Public License    *
+* along with this program. If not, see <http://www.gnu.org/licenses/>.        *
+*******************************************************************************
+* Authors: The SOFA Team and external contributors (see Authors.txt)          *
+*                                                                             *
+* Contact information: contact@sofa-framework.org                             *
+******************************************************************************/
+#pragma once
+#include <SofaSparseSolver/config.h>
+
+#include <sofa/simulation/ParallelFor.h>
+#include <sofa/helper/logging/Messaging.h>
+#include <sofa/type/vector.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace sofa::component::linearsolver
+{
+
+/**
+ * Supernodal structure of the factor L of a LDL^T factorization.
+ *
+ * A supernode is a set of consecutive columns of L sharing the same pattern below their diagonal
+ * block. Its values are stored as a dense column-major panel (rows x columns), the rows being the
+ * columns of the supernode followed by its off-diagonal rows.
+ * The supernodes are grouped by levels in the (supernodal) elimination tree: a supernode is only
+ * updated by its descendants, which all belong to lower levels, so that all the supernodes of a
+ * level can be factorized concurrently.
+ */
+struct SupernodalLDLStructure
+{
+    /// Maximum number of columns in a supernode
+    static constexpr int MaxSupernodeSize = 64;
+
+    int nbSupernodes = 0;
+    type::vector<int> first;       ///< first column of each supernode (nbSupernodes+1 entries)
+    type::vector<int> rowPtr;      ///< begin of the rows of each supernode in rows (nbSupernodes+1 entries)
+    type::vector<int> rows;        ///< rows of each supernode, sorted
+    type::vector<int> valuePtr;    ///< begin of the panel of each supernode in the values (nbSupernodes+1 entries)
+    type::vector<int> updatePtr;   ///< begin of the updates of each supernode (nbSupernodes+1 entries)
+    type::vector<int> updateSupernode; ///< descendant supernodes updating a supernode
+    type::vector<int> updateRow;   ///< position in the rows of the descendant of the first updated row
+    type::vector<int> levelPtr;    ///< begin of each level in levelSupernodes
+    type::vector<int> levelSupernodes; ///< supernodes sorted by level in the elimination tree
+};
+
+/// Compute the row pattern of each column of L (rowind, sorted by increasing row), given the
+/// elimination tree and the column pointers computed by CSPARSE_symbolic
+inline void SUPERNODAL_pattern(int n, const int* M_colptr, const int* M_rowind, const int* colptr, int* rowind,
+                               const int* perm, const int* invperm, const int* Parent, int* Flag, int* Lnz)
+{
+    for (int k = 0; k < n; k++)
+    {
+        Flag[k] = k;
+        Lnz[k] = 0;
+    }
+    for (int k = 0; k < n; k++)
+    {
+        const int kk = perm[k];
+        for (int p = M_colptr[kk]; p < M_colptr[kk+1]; p++)
+        {
+            int i = invperm[M_rowind[p]];
+            if (i < k)
+            {
+                for ( ; Flag[i] != k; i = Parent[i])
+                {
+                    rowind[colptr[i] + Lnz[i]++] = k; /* L(k,i) is nonzero */
+                    Flag[i] = k;
+                }
+            }
+        }
+    }
+}
+
+/// Group the columns of L in supernodes, and compute the update lists and the levels used by SUPERNODAL_numeric
+inline void SUPERNODAL_symbolic(int n, const int* colptr, const int* rowind, const int* Parent, SupernodalLDLStructure& s)
+{
+    // fundamental supernodes: column j+1 extends the supernode of column j if the pattern of column j
+    // is exactly {j+1} followed by the pattern of column j+1
+    s.first.clear();
+    type::vector<int> supernodeOf(n);
+    for (int j = 0; j < n; j++)
+    {
+        const bool extend = j > 0 && Parent[j-1] == j
+                && colptr[j] - colptr[j-1] == colptr[j+1] - colptr[j] + 1
+                && j - s.first.back() < SupernodalLDLStructure::MaxSupernodeSize;
+        if (!extend) s.first.push_back(j);
+        supernodeOf[j] = (int)s.first.size() - 1;
+    }
+    s.nbSupernodes = (int)s.first.size();
+    s.first.push_back(n);
+
+    // rows and panels
+    s.rowPtr.resize(s.nbSupernodes + 1);
+    s.valuePtr.resize(s.nbSupernodes + 1);
+    s.rowPtr[0] = 0;
+    s.valuePtr[0] = 0;
+    for (int J = 0; J < s.nbSupernodes; J++)
+    {
+        const int f = s.first[J];
+        const int width = s.first[J+1] - f;
+        const int nbRows = 1 + colptr[f+1] - colptr[f];
+        s.rowPtr[J+1] = s.rowPtr[J] + nbRows;
+        s.valuePtr[J+1] = s.valuePtr[J] + nbRows * width;
+    }
+    s.rows.resize(s.rowPtr[s.nbSupernodes]);
+    for (int J = 0; J < s.nbSupernodes; J++)
+    {
+        const int f = s.first[J];
+        int* r = &s.rows[s.rowPtr[J]];
+        r[0] = f;
+        std::copy(rowind + colptr[f], rowind + colptr[f+1], r + 1);
+    }
+
+    // updates: a supernode K updates the supernodes containing its off-diagonal rows
+    s.updatePtr.assign(s.nbSupernodes + 1, 0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        type::vector<int> count(s.nbSupernodes, 0);
+        for (int K = 0; K < s.nbSupernodes; K++)
+        {
+            const int width = s.first[K+1] - s.first[K];
+            int previous = -1;
+            for (int p = s.rowPtr[K] + width; p < s.rowPtr[K+1]; p++)
+            {
+                const int J = supernodeOf[s.rows[p]];
+                if (J == previous) continue;
+                previous = J;
+                if (pass == 1)
+                {
+                    const int u = s.updatePtr[J] + count[J];
+                    s.updateSupernode[u] = K;
+                    s.updateRow[u] = p - s.rowPtr[K];
+                }
+                count[J]++;
+            }
+        }
+        if (pass == 0)
+        {
+            for (int J = 0; J < s.nbSupernodes; J++)
+                s.updatePtr[J+1] = s.updatePtr[J] + count[J];
+            s.updateSupernode.resize(s.updatePtr[s.nbSupernodes]);
+            s.updateRow.resize(s.updatePtr[s.nbSupernodes]);
+        }
+    }
+
+    // levels in the supernodal elimination tree (children always have a lower index than their parent)
+    type::vector<int> level(s.nbSupernodes, 0);
+    int nbLevels = 0;
+    for (int J = 0; J < s.nbSupernodes; J++)
+    {
+        const int parentColumn = Parent[s.first[J+1] - 1];
+        if (parentColumn >= 0)
+        {
+            int& parentLevel = level[supernodeOf[parentColumn]];
+            parentLevel = std::max(parentLevel, level[J] + 1);
+        }
+        nbLevels = std::max(nbLevels, level[J] + 1);
+    }
+    s.levelPtr.assign(nbLevels + 1, 0);
+    for (int J = 0; J < s.nbSupernodes; J++) s.levelPtr[level[J] + 1]++;
+    for (int l = 0; l < nbLevels; l++) s.levelPtr[l+1] += s.levelPtr[l];
+    s.levelSupernodes.resize(s.nbSupernodes);
+    type::vector<int> position(s.levelPtr.begin(), s.levelPtr.end() - 1);
+    for (int J = 0; J < s.nbSupernodes; J++) s.levelSupernodes[position[level[J]]++] = J;
+}
+
+/// Compute the panel of the supernode J, once all its descendants are computed.
+/// \returns false if a zero pivot is found
+template<class Real>
+bool SUPERNODAL_factorizeSupernode(int J, const int* M_colptr, const int* M_rowind, const Real* M_values,
+                                   const int* perm, const int* invperm, const SupernodalLDLStructure& s,
+                                   Real* values, Real* D, type::vector<int>& relative)
+{
+    const int f = s.first[J];
+    const int width = s.first[J+1] - f;
+    const int* rows = &s.rows[s.rowPtr[J]];
+    const int nbRows = s.rowPtr[J+1] - s.rowPtr[J];
+    Real* P = values + s.valuePtr[J];
+    std::fill(P, P + nbRows * width, Real(0));
+
+    // scatter the lower part of the columns of A
+    for (int c = 0; c < width; c++)
+    {
+        const int k = f + c;
+        const int kk = perm[k];
+        for (int p = M_colptr[kk]; p < M_colptr[kk+1]; p++)
+        {
+            const int i = invperm[M_rowind[p]];
+            if (i < k) continue;
+            const int r = int(std::lower_bound(rows, rows + nbRows, i) - rows);
+            P[c * nbRows + r] += M_values[p];
+        }
+    }
+
+    // left-looking updates from the descendants: P(rows, cols) -= L_K D_K L_K^T
+    Real t[SupernodalLDLStructure::MaxSupernodeSize];
+    for (int u = s.updatePtr[J]; u < s.updatePtr[J+1]; u++)
+    {
+        const int K = s.updateSupernode[u];
+        const int startRow = s.updateRow[u];
+        const int widthK = s.first[K+1] - s.first[K];
+        const int* rowsK = &s.rows[s.rowPtr[K]];
+        const int nbRowsK = s.rowPtr[K+1] - s.rowPtr[K];
+        const Real* LK = values + s.valuePtr[K];
+        const Real* DK = D + s.first[K];
+
+        // position of the updated rows in the panel of J (both row lists are sorted)
+        const int nbUpdatedRows = nbRowsK - startRow;
+        relative.resize(nbUpdatedRows);
+        int nbUpdatedCols = 0;
+        for (int r = 0, q = 0; r < nbUpdatedRows; r++)
+        {
+            const int row = rowsK[startRow + r];
+            while (rows[q] != row) ++q;
+            relative[r] = q;
+            if (row < f + width) nbUpdatedCols = r + 1;
+        }
+
+        for (int c = 0; c < nbUpdatedCols; c++)
+        {
+            for (int k = 0; k < widthK; k++)
+                t[k] = LK[k * nbRowsK + startRow + c] * DK[k];
+            Real* Pc = P + (rowsK[startRow + c] - f) * nbRows;
+            for (int k = 0; k < widthK; k++)
+            {
+                const Real tk = t[k];
+                const Real* LKk = LK + k * nbRowsK + startRow;
+                for (int r = c; r < nbUpdatedRows; r++)
+                    Pc[relative[r]] -= LKk[r] * tk;
+            }
+        }
+    }
+
+    // dense LDL^T factorization of the panel
+    Real* DJ = D + f;
+    for (int j = 0; j < width; j++)
+    {
+        Real* Pj = P + j * nbRows;
+        for (int k = 0; k < j; k++)
+            t[k] = P[k * nbRows + j] * DJ[k];
+        for (int k = 0; k < j; k++)
+        {
+            const Real tk = t[k];
+            const Real* Pk = P + k * nbRows;
+            for (int r = j; r < nbRows; r++)
+                Pj[r] -= Pk[r] * tk;
+        }
+        DJ[j] = Pj[j];
+        if (DJ[j] == 0.0)
+            return false;
+        const Real invD = Real(1) / DJ[j];
+        Pj[j] = 1;
+        for (int r = j + 1; r < nbRows; r++)
+            Pj[r] *= invD;
+    }
+    return true;
+}
+
+/// Supernodal numeric factorization. The supernodes of each level of the elimination tree are
+/// factorized concurrently if a task scheduler is given. The factor is then copied in the column
+/// format (colptr, values) used by the simplicial factorization, its pattern (rowind) being given
+/// by SUPERNODAL_pattern.
+/// P must contain s.valuePtr[s.nbSupernodes] values.
+template<class Real>
+void SUPERNODAL_numeric(const int* M_colptr, const int* M_rowind, const Real* M_values,
+                        const int* colptr, Real* values, Real* D, const int* perm, const int* invperm,
+                        const SupernodalLDLStructure& s, Real* P, simulation::TaskScheduler* taskScheduler)
+{
+    std::atomic<bool> success { true };
+
+    const int nbLevels = (int)s.levelPtr.size() - 1;
+    for (int l = 0; l < nbLevels; l++)
+    {
+        const auto factorizeRange = [&](int begin, int end)
+        {
+            type::vector<int> relative;
+            for (int i = begin; i < end; i++)
+            {
+                if (!SUPERNODAL_factorizeSupernode<Real>(s.levelSupernodes[i], M_colptr, M_rowind, M_values,
+                                                         perm, invperm, s, P, D, relative))
+                    success = false;
+            }
+        };
+        if (taskScheduler && s.levelPtr[l+1] - s.levelPtr[l] > 1)
+            simulation::parallelForRange(taskScheduler, s.levelPtr[l], s.levelPtr[l+1], 0, factorizeRange);
+        else
+            factorizeRange(s.levelPtr[l], s.levelPtr[l+1]);
+    }
+
+    if (!success)
+    {
+        msg_error("SparseLDLSolver") << "Failed to factorize, D(k,k) is zero" ;
+        return;
+    }
+
+    // copy the panels in the column format
+    for (int J = 0; J < s.nbSupernodes; J++)
+    {
+        const int f = s.first[J];
+        const int width = s.first[J+1] - f;
+        const int nbRows = s.rowPtr[J+1] - s.rowPtr[J];
+        const Real* PJ = P + s.valuePtr[J];
+        for (int c = 0; c < width; c++)
+        {
+            const Real* column = PJ + c * nbRows + c + 1;
+            std::copy(column, column + (colptr[f+c+1] - colptr[f+c]), values + colptr[f+c]);
+        }
+    }
+}
+
+} // namespace sofa::component::linearsolver